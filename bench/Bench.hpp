@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/* Minimal micro benchmark harness : every benchmark is a function running an operation
+ * "iterations" times. The harness finds an iteration count giving samples long enough
+ * to be measured, then takes several samples and reports ns per operation statistics. */
+namespace Bench
+{
+	/* keeps the compiler from removing a computation whose result is never used */
+	template<typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		const volatile void* volatile sink = &value;
+		(void)sink;
+		_ReadWriteBarrier();
+#endif
+	}
+
+	struct Settings
+	{
+		int			repeats		= 15;		// number of timed samples per benchmark
+		double		minSampleMs	= 20.0;		// an iteration count is searched to make one sample at least this long
+		std::string	filter;					// only run benchmarks whose name contains this
+		std::string	jsonPath;				// write the results there when not empty
+	};
+
+	struct Result
+	{
+		std::string name;
+		size_t		iterations	= 0;
+		int			repeats		= 0;
+		double		minNs		= 0.0;
+		double		medianNs	= 0.0;
+		double		meanNs		= 0.0;
+		double		stddevNs	= 0.0;
+	};
+
+	/* the function runs the operation "iterations" times */
+	using Function = std::function<void(size_t iterations)>;
+
+	class Runner
+	{
+	public:
+
+		Runner(const Settings& settings_) : settings{ settings_ } {}
+
+		/* lets the benchmarks skip an expensive setup when none of its benchmarks will run */
+		bool IsSelected(const char* name) const
+		{
+			return settings.filter.empty() || std::strstr(name, settings.filter.c_str()) != nullptr;
+		}
+
+		void Run(const char* name, const Function& function)
+		{
+			if (!IsSelected(name))
+				return;
+
+			/* warm up and find the iteration count */
+			size_t iterations = 1;
+			while (TimeNs(function, iterations) < settings.minSampleMs * 1e6 && iterations < (size_t(1) << 40))
+				iterations *= 2;
+
+			std::vector<double> samples(settings.repeats);
+			for (double& sample : samples)
+				sample = TimeNs(function, iterations) / static_cast<double>(iterations);
+
+			Result result;
+			result.name			= name;
+			result.iterations	= iterations;
+			result.repeats		= settings.repeats;
+
+			std::sort(samples.begin(), samples.end());
+			result.minNs	= samples.front();
+
+			/* the two middle samples averaged when the repeat count is even */
+			size_t middle	= samples.size() / 2;
+			result.medianNs	= samples.size() % 2 == 0 ? (samples[middle - 1] + samples[middle]) * 0.5 : samples[middle];
+
+			for (double sample : samples)
+				result.meanNs += sample;
+			result.meanNs /= samples.size();
+
+			for (double sample : samples)
+				result.stddevNs += (sample - result.meanNs) * (sample - result.meanNs);
+			result.stddevNs = std::sqrt(result.stddevNs / samples.size());
+
+			printf("%-48s %12.3f ns/op  (min %10.3f, mean %10.3f, stddev %8.3f, %zu iterations x %d)\n",
+				name, result.medianNs, result.minNs, result.meanNs, result.stddevNs, result.iterations, result.repeats);
+
+			results.push_back(result);
+		}
+
+		bool WriteJson(const char* buildType) const
+		{
+			if (settings.jsonPath.empty())
+				return true;
+
+			FILE* file = fopen(settings.jsonPath.c_str(), "w");
+			if (!file)
+			{
+				printf("Failed to open %s to write the benchmark results\n", settings.jsonPath.c_str());
+				return false;
+			}
+
+			fprintf(file, "{\n\t\"build\": \"%s\",\n\t\"unit\": \"ns/op\",\n\t\"benchmarks\": [\n", buildType);
+			for (size_t i = 0; i < results.size(); i++)
+			{
+				const Result& result = results[i];
+				fprintf(file, "\t\t{ \"name\": \"%s\", \"iterations\": %zu, \"repeats\": %d, \"min\": %.4f, \"median\": %.4f, \"mean\": %.4f, \"stddev\": %.4f }%s\n",
+					result.name.c_str(), result.iterations, result.repeats, result.minNs, result.medianNs, result.meanNs, result.stddevNs,
+					i + 1 < results.size() ? "," : "");
+			}
+			fprintf(file, "\t]\n}\n");
+			fclose(file);
+
+			return true;
+		}
+
+	private:
+
+		Settings			settings;
+		std::vector<Result>	results;
+
+		static double TimeNs(const Function& function, size_t iterations)
+		{
+			auto start = std::chrono::steady_clock::now();
+			function(iterations);
+			auto end = std::chrono::steady_clock::now();
+
+			return std::chrono::duration<double, std::nano>(end - start).count();
+		}
+	};
+}
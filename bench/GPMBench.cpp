@@ -0,0 +1,683 @@
+/* system include */
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <string>
+#include <algorithm>
+#include <vector>
+
+#include "Bench.hpp"
+
+/* math */
+#include "GPM/Calc.hpp"
+#include "GPM/Matrix4.hpp"
+#include "GPM/Transform.hpp"
+#include "GPM/Quaternion.hpp"
+#include "GPM/conversion.hpp"
+#include "GPM/Random.hpp"
+#include "GPM/ShapeRelation/Intersection.hpp"
+#include "GPM/ShapeRelation/SegmentPlane.hpp"
+#include "GPM/ShapeRelation/SpherePlane.hpp"
+#include "GPM/ShapeRelation/AABBPlane.hpp"
+#include "GPM/ShapeRelation/RayShape.hpp"
+#include "GPM/ShapeRelation/QuadraticSolver.hpp"
+#include "GPM/Broadphase/SweepAndPrune.hpp"
+#include "GPM/Broadphase/AABBTree.hpp"
+
+using namespace GPM;
+
+/* inputs are read in a loop from arrays of this size, big enough to defeat constant folding,
+ * small enough to stay in cache so that only the maths is measured */
+#define INPUT_COUNT 1024u
+#define INPUT_MASK	(INPUT_COUNT - 1u)
+
+struct Inputs
+{
+	std::vector<Mat4>			matrices;
+	std::vector<Vec3>			positions;
+	std::vector<Vec3>			angles;
+	std::vector<Vec3>			scales;
+	std::vector<Quat>			quaternions;
+	std::vector<Ray>			rays;
+	std::vector<Segment>		segments;
+	std::vector<Sphere>			spheres;
+	std::vector<AABB>			aabbs;
+	std::vector<OrientedBox>	boxes;
+	std::vector<Plane>			planes;
+	std::vector<Quad>			quads;
+	std::vector<Cylinder>		cylinders;
+	std::vector<Capsule>		capsules;
+	std::vector<float>			a, b, c;
+};
+
+static Vec3 RandomVec3(float min, float max)
+{
+	return { Random::ranged(min, max), Random::ranged(min, max), Random::ranged(min, max) };
+}
+
+static void MakeInputs(Inputs& inputs)
+{
+	Random::initSeed(42u);
+
+	for (u32 i = 0; i < INPUT_COUNT; i++)
+	{
+		inputs.positions.push_back(RandomVec3(-10.f, 10.f));
+		inputs.angles.push_back(RandomVec3(-PI, PI));
+		inputs.scales.push_back(RandomVec3(0.5f, 2.f));
+		inputs.matrices.push_back(Transform::TRS(inputs.positions.back(), inputs.angles.back(), inputs.scales.back()));
+		inputs.quaternions.push_back(Quat::fromEuler(inputs.angles.back()));
+
+		/* rays from a shell around the origin toward a point near it, so about half of the tests hit */
+		Vec3 origin = RandomVec3(-20.f, 20.f);
+		Vec3 target = RandomVec3(-2.f, 2.f);
+		inputs.rays.push_back(Ray{ origin, target - origin });
+		inputs.segments.push_back(Segment(origin, target + (target - origin)));
+
+		inputs.spheres.push_back(Sphere(Random::ranged(0.5f, 2.f), RandomVec3(-1.f, 1.f)));
+		inputs.aabbs.push_back(AABB(RandomVec3(-1.f, 1.f), Random::ranged(0.5f, 2.f), Random::ranged(0.5f, 2.f), Random::ranged(0.5f, 2.f)));
+		inputs.boxes.push_back(OrientedBox(Random::ranged(0.5f, 2.f), Random::ranged(0.5f, 2.f), Random::ranged(0.5f, 2.f), RandomVec3(-1.f, 1.f), inputs.angles.back()));
+		inputs.planes.push_back(Plane(RandomVec3(-1.f, 1.f), RandomVec3(-1.f, 1.f)));
+
+		Referential referential;
+		referential.origin	= RandomVec3(-1.f, 1.f);
+		referential.unitI	= inputs.matrices.back().c[0].xyz.normalized();
+		referential.unitJ	= inputs.matrices.back().c[1].xyz.normalized();
+		referential.unitK	= inputs.matrices.back().c[2].xyz.normalized();
+		inputs.quads.push_back(Quad(referential, Random::ranged(0.5f, 2.f), Random::ranged(0.5f, 2.f)));
+
+		inputs.cylinders.push_back(Cylinder(RandomVec3(-2.f, 2.f), RandomVec3(-2.f, 2.f), Random::ranged(0.5f, 2.f)));
+		inputs.capsules.push_back(Capsule(Segment(RandomVec3(-2.f, 2.f), RandomVec3(-2.f, 2.f)), Random::ranged(0.5f, 2.f)));
+
+		inputs.a.push_back(Random::ranged(0.5f, 2.f));
+		inputs.b.push_back(Random::ranged(-2.f, 2.f));
+		inputs.c.push_back(Random::ranged(-2.f, 2.f));
+	}
+}
+
+/* the libm and fast versions run over the same arrays so that the loops can be vectorized the same way */
+static void RunCalc(Bench::Runner& runner, const Inputs& inputs)
+{
+	std::vector<float> out0(INPUT_COUNT), out1(INPUT_COUNT);
+
+	auto runArray = [&](const char* name, auto&& function)
+	{
+		runner.Run(name, [&](size_t iterations)
+		{
+			for (size_t i = 0; i < iterations; i += INPUT_COUNT)
+			{
+				size_t count = iterations - i < INPUT_COUNT ? iterations - i : INPUT_COUNT;
+				for (size_t j = 0; j < count; j++)
+					function(j);
+				Bench::DoNotOptimize(out0[0]);
+				Bench::DoNotOptimize(out1[0]);
+			}
+		});
+	};
+
+	const float* angles	= inputs.b.data();	// [-2, 2]
+	const float* unit	= inputs.c.data();	// [-2, 2], halved for acos
+	const float* positive	= inputs.a.data();	// [0.5, 2]
+
+	runArray("Calc std::sin + std::cos",	[&](size_t j) { out0[j] = std::sin(angles[j]); out1[j] = std::cos(angles[j]); });
+	runArray("Calc fastSinCos",				[&](size_t j) { fastSinCos(angles[j], out0[j], out1[j]); });
+	runArray("Calc 1 / std::sqrt",			[&](size_t j) { out0[j] = 1.f / std::sqrt(positive[j]); });
+	runArray("Calc fastRsqrt",				[&](size_t j) { out0[j] = fastRsqrt(positive[j]); });
+	runArray("Calc std::exp2",				[&](size_t j) { out0[j] = std::exp2(angles[j]); });
+	runArray("Calc fastExp2",				[&](size_t j) { out0[j] = fastExp2(angles[j]); });
+	runArray("Calc std::log2",				[&](size_t j) { out0[j] = std::log2(positive[j]); });
+	runArray("Calc fastLog2",				[&](size_t j) { out0[j] = fastLog2(positive[j]); });
+	runArray("Calc std::pow",				[&](size_t j) { out0[j] = std::pow(positive[j], 2.2f); });
+	runArray("Calc fastPow",				[&](size_t j) { out0[j] = fastPow(positive[j], 2.2f); });
+	runArray("Calc std::acos",				[&](size_t j) { out0[j] = std::acos(unit[j] * 0.5f); });
+	runArray("Calc fastAcos",				[&](size_t j) { out0[j] = fastAcos(unit[j] * 0.5f); });
+	runArray("Calc std::atan2",				[&](size_t j) { out0[j] = std::atan2(angles[j], unit[j]); });
+	runArray("Calc fastAtan2",				[&](size_t j) { out0[j] = fastAtan2(angles[j], unit[j]); });
+}
+
+static void RunMatrix(Bench::Runner& runner, const Inputs& inputs)
+{
+	runner.Run("Mat4::operator*(Mat4)", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(inputs.matrices[i & INPUT_MASK] * inputs.matrices[(i + 1) & INPUT_MASK]);
+	});
+
+	runner.Run("Mat4::operator*(Vec4)", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(inputs.matrices[i & INPUT_MASK] * Vec4(inputs.positions[(i + 1) & INPUT_MASK]));
+	});
+
+	runner.Run("Mat4::inversed", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(inputs.matrices[i & INPUT_MASK].inversed());
+	});
+
+	runner.Run("Mat4::transposed", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(inputs.matrices[i & INPUT_MASK].transposed());
+	});
+}
+
+static void RunTransform(Bench::Runner& runner, const Inputs& inputs)
+{
+	runner.Run("Transform::TRS", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(Transform::TRS(inputs.positions[i & INPUT_MASK], inputs.angles[i & INPUT_MASK], inputs.scales[i & INPUT_MASK]));
+	});
+
+	runner.Run("Transform::lookAt", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(Transform::lookAt(inputs.positions[i & INPUT_MASK], inputs.positions[(i + 1) & INPUT_MASK]));
+	});
+
+	runner.Run("Transform::perspective", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(Transform::perspective(inputs.scales[i & INPUT_MASK].x, inputs.scales[i & INPUT_MASK].y, 0.01f, 100.f));
+	});
+
+	runner.Run("Transform::rotation", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(Transform::rotation(inputs.angles[i & INPUT_MASK]));
+	});
+}
+
+static void RunQuaternion(Bench::Runner& runner, const Inputs& inputs)
+{
+	runner.Run("Quat::operator*(Quat)", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(inputs.quaternions[i & INPUT_MASK] * inputs.quaternions[(i + 1) & INPUT_MASK]);
+	});
+
+	runner.Run("Quat::rotate", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(inputs.quaternions[i & INPUT_MASK].rotate(inputs.positions[i & INPUT_MASK]));
+	});
+
+	runner.Run("Quat::fromEuler", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(Quat::fromEuler(inputs.angles[i & INPUT_MASK]));
+	});
+
+	runner.Run("Quat::slerp", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(inputs.quaternions[i & INPUT_MASK].slerp(inputs.quaternions[(i + 1) & INPUT_MASK], 0.3f));
+	});
+
+	runner.Run("Quat::nlerp", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(inputs.quaternions[i & INPUT_MASK].nlerp(inputs.quaternions[(i + 1) & INPUT_MASK], 0.3f));
+	});
+
+	runner.Run("Quat::normalized", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(inputs.quaternions[i & INPUT_MASK].normalized());
+	});
+
+	runner.Run("toMatrix4(Quat)", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(toMatrix4(inputs.quaternions[i & INPUT_MASK]));
+	});
+
+	runner.Run("toQuaternion(Mat4)", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(toQuaternion(inputs.matrices[i & INPUT_MASK]));
+	});
+}
+
+/* single ray against each shape type */
+template<typename Shape>
+static void RunRaycast(Bench::Runner& runner, const char* name, const Inputs& inputs, const std::vector<Shape>& shapes)
+{
+	runner.Run(name, [&](size_t iterations)
+	{
+		RayHit hit;
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(RayShape::raycast(inputs.rays[i & INPUT_MASK], shapes[i & INPUT_MASK], hit));
+	});
+}
+
+/* one call over the whole input arrays, reported per ray/shape pair */
+template<typename Shape>
+static void RunRaycastBatch(Bench::Runner& runner, const char* name, const Inputs& inputs, const std::vector<Shape>& shapes)
+{
+	std::vector<RayHit> hits(INPUT_COUNT);
+
+	runner.Run(name, [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i += INPUT_COUNT)
+		{
+			size_t count = iterations - i < INPUT_COUNT ? iterations - i : INPUT_COUNT;
+			RayShape::raycast(inputs.rays.data(), shapes.data(), hits.data(), count);
+			Bench::DoNotOptimize(hits[0]);
+		}
+	});
+}
+
+static void RunShapes(Bench::Runner& runner, const Inputs& inputs)
+{
+	RunRaycast(runner, "RayShape::raycast(Sphere)",			inputs, inputs.spheres);
+	RunRaycast(runner, "RayShape::raycast(AABB)",			inputs, inputs.aabbs);
+	RunRaycast(runner, "RayShape::raycast(OrientedBox)",	inputs, inputs.boxes);
+	RunRaycast(runner, "RayShape::raycast(Plane)",			inputs, inputs.planes);
+	RunRaycast(runner, "RayShape::raycast(Quad)",			inputs, inputs.quads);
+	RunRaycast(runner, "RayShape::raycast(Cylinder)",		inputs, inputs.cylinders);
+	RunRaycast(runner, "RayShape::raycast(Capsule)",		inputs, inputs.capsules);
+
+	RunRaycastBatch(runner, "RayShape::raycast(Sphere) batch",		inputs, inputs.spheres);
+	RunRaycastBatch(runner, "RayShape::raycast(Cylinder) batch",	inputs, inputs.cylinders);
+	RunRaycastBatch(runner, "RayShape::raycast(Capsule) batch",		inputs, inputs.capsules);
+
+	runner.Run("RayShape::getNormal(Capsule)", [&](size_t iterations)
+	{
+		RayHit hit;
+		for (size_t i = 0; i < iterations; i++)
+		{
+			hit.t		= 0.5f;
+			hit.part	= i % 3u;
+			Bench::DoNotOptimize(RayShape::getNormal(inputs.rays[i & INPUT_MASK], inputs.capsules[i & INPUT_MASK], hit));
+		}
+	});
+
+	runner.Run("QuadraticSolver::solve batch", [&](size_t iterations)
+	{
+		std::vector<float>	t0(INPUT_COUNT), t1(INPUT_COUNT);
+		std::vector<u8>		mask(INPUT_COUNT);
+
+		for (size_t i = 0; i < iterations; i += INPUT_COUNT)
+		{
+			size_t count = iterations - i < INPUT_COUNT ? iterations - i : INPUT_COUNT;
+			QuadraticSolver::solve(inputs.a.data(), inputs.b.data(), inputs.c.data(), t0.data(), t1.data(), mask.data(), count);
+			Bench::DoNotOptimize(t0[0]);
+		}
+	});
+
+	runner.Run("Intersection::computeDiscriminentAndSolveEquation", [&](size_t iterations)
+	{
+		Intersection intersection;
+		for (size_t i = 0; i < iterations; i++)
+		{
+			const Segment& segment = inputs.segments[i & INPUT_MASK];
+			Bench::DoNotOptimize(Intersection::computeDiscriminentAndSolveEquation(inputs.a[i & INPUT_MASK], inputs.b[i & INPUT_MASK], inputs.c[i & INPUT_MASK],
+				segment.getPt1(), segment.getPt2(), intersection));
+		}
+	});
+
+	runner.Run("SegmentPlane::isSegmentPlaneCollided", [&](size_t iterations)
+	{
+		Intersection intersection;
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(SegmentPlane::isSegmentPlaneCollided(inputs.segments[i & INPUT_MASK], inputs.planes[i & INPUT_MASK], intersection));
+	});
+
+	runner.Run("SpherePlane::isSphereOnOrForwardPlaneCollided", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(SpherePlane::isSphereOnOrForwardPlaneCollided(inputs.spheres[i & INPUT_MASK], inputs.planes[(i + 1) & INPUT_MASK]));
+	});
+
+	runner.Run("AABBPlane::isAABBOnOrForwardPlane", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(AABBPlane::isAABBOnOrForwardPlane(inputs.aabbs[i & INPUT_MASK], inputs.planes[(i + 1) & INPUT_MASK]));
+	});
+}
+
+/* boxes of sizes 0.5 to 1.5 spread in a cube keeping the same density whatever their count,
+ * so every shape overlaps a few others */
+struct BroadphaseScene
+{
+	std::vector<Bounds>	bounds;
+	std::vector<Vec3>	moves;
+	std::vector<Bounds>	queries;
+	std::vector<Ray>	rays;
+};
+
+static void MakeBroadphaseScene(BroadphaseScene& scene, size_t count)
+{
+	Random::initSeed(7u);
+	const float side = std::cbrt(static_cast<float>(count)) * 2.f;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		Vec3 center		= RandomVec3(0.f, side);
+		Vec3 extents	= RandomVec3(0.25f, 0.75f);
+		scene.bounds.push_back(Bounds{ center - extents, center + extents });
+		scene.moves.push_back(RandomVec3(-0.05f, 0.05f));
+	}
+
+	for (u32 i = 0; i < INPUT_COUNT; i++)
+	{
+		Vec3 center = RandomVec3(0.f, side);
+		scene.queries.push_back(Bounds{ center - Vec3(1.f), center + Vec3(1.f) });
+		scene.rays.push_back(Ray{ center, RandomVec3(-1.f, 1.f), 0.f, 10.f });
+	}
+}
+
+/* move every shape back and forth, the amplitude stays in the default AABBTree margin most of the time */
+static void MoveBroadphaseScene(BroadphaseScene& scene, size_t frame)
+{
+	const float direction = frame & 1u ? -1.f : 1.f;
+	for (size_t i = 0; i < scene.bounds.size(); i++)
+	{
+		scene.bounds[i].min += scene.moves[i] * direction;
+		scene.bounds[i].max += scene.moves[i] * direction;
+	}
+}
+
+static void SortPairs(std::vector<BroadphasePair>& pairs)
+{
+	for (BroadphasePair& pair : pairs)
+		if (pair.a > pair.b)
+			std::swap(pair.a, pair.b);
+
+	std::sort(pairs.begin(), pairs.end(), [](const BroadphasePair& lhs, const BroadphasePair& rhs)
+	{
+		return lhs.a < rhs.a || (lhs.a == rhs.a && lhs.b < rhs.b);
+	});
+}
+
+static bool IsSamePairs(std::vector<BroadphasePair> lhs, std::vector<BroadphasePair> rhs)
+{
+	SortPairs(lhs);
+	SortPairs(rhs);
+	return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(),
+		[](const BroadphasePair& l, const BroadphasePair& r) { return l.a == r.a && l.b == r.b; });
+}
+
+static void FindPairsBruteForce(const std::vector<Bounds>& bounds, const std::vector<bool>& isAlive, std::vector<BroadphasePair>& pairs)
+{
+	pairs.clear();
+	for (u32 i = 0; i < bounds.size(); i++)
+		for (u32 j = i + 1; j < bounds.size(); j++)
+			if (isAlive[i] && isAlive[j] && bounds[i].overlaps(bounds[j]))
+				pairs.push_back(BroadphasePair{ i, j });
+}
+
+/* the broadphase structures must find the same pairs as the brute force after inserts, moves and removes.
+ * The tree is built without margin so that its pairs are exact too */
+static bool CheckBroadphase()
+{
+	BroadphaseScene scene;
+	MakeBroadphaseScene(scene, 4000u);
+
+	SweepAndPrune				sap;
+	AABBTree					tree(0.f);
+	std::vector<BroadphaseHandle>	sapHandles, treeHandles;
+	std::vector<bool>			isAlive(scene.bounds.size(), true);
+
+	for (u32 i = 0; i < scene.bounds.size(); i++)
+	{
+		sapHandles.push_back(sap.insert(scene.bounds[i], i));
+		treeHandles.push_back(tree.insert(scene.bounds[i], i));
+	}
+
+	std::vector<BroadphasePair> expected, sapPairs, treePairs;
+	bool isOk = true;
+
+	AABBTree builtTree(0.f);
+	builtTree.build(scene.bounds.data(), scene.bounds.size());
+	builtTree.findPairs(treePairs);
+	FindPairsBruteForce(scene.bounds, isAlive, expected);
+	isOk &= IsSamePairs(expected, treePairs);
+	printf("%-48s %zu pairs, tree height %d%s\n", "Broadphase AABBTree::build check", expected.size(), builtTree.getHeight(),
+		isOk ? "" : "  /!\\ FAILED");
+
+	for (size_t frame = 0; frame < 3; frame++)
+	{
+		FindPairsBruteForce(scene.bounds, isAlive, expected);
+		sap.findPairs(sapPairs);
+		tree.findPairs(treePairs);
+
+		bool isFrameOk = IsSamePairs(expected, sapPairs) && IsSamePairs(expected, treePairs);
+		printf("%-48s frame %zu : %zu pairs, tree height %d%s\n", "Broadphase pairs check", frame, expected.size(), tree.getHeight(),
+			isFrameOk ? "" : "  /!\\ FAILED");
+		isOk &= isFrameOk;
+
+		/* move everything, remove one shape every 7 and insert it back at the next frame */
+		MoveBroadphaseScene(scene, frame);
+		for (u32 i = 0; i < scene.bounds.size(); i++)
+		{
+			if (!isAlive[i])
+			{
+				sapHandles[i]	= sap.insert(scene.bounds[i], i);
+				treeHandles[i]	= tree.insert(scene.bounds[i], i);
+				isAlive[i]		= true;
+			}
+			else if ((i + frame) % 7 == 0)
+			{
+				sap.remove(sapHandles[i]);
+				tree.remove(treeHandles[i]);
+				isAlive[i] = false;
+			}
+			else
+			{
+				sap.move(sapHandles[i], scene.bounds[i]);
+				tree.move(treeHandles[i], scene.bounds[i]);
+			}
+		}
+	}
+
+	std::vector<BroadphasePair> sapHits, treeHits;
+	sap.query(scene.queries.data(), scene.queries.size(), sapHits);
+	tree.query(scene.queries.data(), scene.queries.size(), treeHits);
+	bool isQueryOk = IsSamePairs(sapHits, treeHits);
+	printf("%-48s %zu hits%s\n", "Broadphase query check", sapHits.size(), isQueryOk ? "" : "  /!\\ FAILED");
+
+	return isOk && isQueryOk;
+}
+
+static void BuildBroadphase(SweepAndPrune& sap, const BroadphaseScene& scene, std::vector<BroadphaseHandle>& handles)
+{
+	sap.clear();
+	handles.clear();
+	for (u32 i = 0; i < scene.bounds.size(); i++)
+		handles.push_back(sap.insert(scene.bounds[i], i));
+}
+
+static void BuildBroadphase(AABBTree& tree, const BroadphaseScene& scene, std::vector<BroadphaseHandle>& handles)
+{
+	tree.build(scene.bounds.data(), scene.bounds.size());
+	handles.resize(scene.bounds.size());
+	for (u32 i = 0; i < scene.bounds.size(); i++)
+		handles[i] = i;
+}
+
+template<typename Broadphase>
+static void RunBroadphaseStructure(Bench::Runner& runner, const char* structureName, const char* countName, BroadphaseScene& scene)
+{
+	Broadphase broadphase;
+	std::vector<BroadphaseHandle> handles;
+	std::vector<BroadphasePair> pairs;
+
+	auto build = [&]()
+	{
+		BuildBroadphase(broadphase, scene, handles);
+		broadphase.findPairs(pairs);
+	};
+
+	std::string name = std::string(structureName) + " build + findPairs " + countName;
+	runner.Run(name.c_str(), [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			build();
+		Bench::DoNotOptimize(pairs.size());
+	});
+
+	size_t frame = 0;
+	name = std::string(structureName) + " move all + findPairs " + countName;
+	if (runner.IsSelected(name.c_str()))
+		build();
+	runner.Run(name.c_str(), [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+		{
+			MoveBroadphaseScene(scene, frame++);
+			for (u32 j = 0; j < scene.bounds.size(); j++)
+				broadphase.move(handles[j], scene.bounds[j]);
+			broadphase.findPairs(pairs);
+		}
+		Bench::DoNotOptimize(pairs.size());
+	});
+
+	name = std::string(structureName) + " query " + std::to_string(INPUT_COUNT) + " boxes " + countName;
+	if (runner.IsSelected(name.c_str()) && handles.empty())
+		build();
+	runner.Run(name.c_str(), [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			broadphase.query(scene.queries.data(), scene.queries.size(), pairs);
+		Bench::DoNotOptimize(pairs.size());
+	});
+}
+
+/* sweep and prune tests every proxy against the ones overlapping it along x : in a cube of n shapes
+ * that is about n^(5/3) tests, so like the one by one tree insertions it is only measured up to 100k shapes */
+static void RunBroadphase(Bench::Runner& runner)
+{
+	const size_t	counts[]		= { 10000u, 100000u, 1000000u };
+	const char*		countNames[]	= { "10k", "100k", "1M" };
+
+	for (size_t i = 0; i < 3; i++)
+	{
+		BroadphaseScene scene;
+		MakeBroadphaseScene(scene, counts[i]);
+
+		if (counts[i] <= 100000u)
+			RunBroadphaseStructure<SweepAndPrune>(runner, "SweepAndPrune", countNames[i], scene);
+		RunBroadphaseStructure<AABBTree>(runner, "AABBTree", countNames[i], scene);
+
+		/* one by one insertions are much slower than AABBTree::build */
+		std::string name = std::string("AABBTree insert one by one ") + countNames[i];
+		if (counts[i] <= 100000u)
+		{
+			runner.Run(name.c_str(), [&](size_t iterations)
+			{
+				AABBTree tree;
+				for (size_t j = 0; j < iterations; j++)
+				{
+					tree.clear();
+					for (u32 k = 0; k < scene.bounds.size(); k++)
+						tree.insert(scene.bounds[k], k);
+				}
+				Bench::DoNotOptimize(tree.getHeight());
+			});
+		}
+
+		name = std::string("AABBTree raycast ") + std::to_string(INPUT_COUNT) + " rays " + countNames[i];
+		if (runner.IsSelected(name.c_str()))
+		{
+			AABBTree tree;
+			tree.build(scene.bounds.data(), scene.bounds.size());
+
+			std::vector<BroadphasePair> hits;
+			runner.Run(name.c_str(), [&](size_t iterations)
+			{
+				for (size_t j = 0; j < iterations; j++)
+					tree.raycast(scene.rays.data(), scene.rays.size(), hits);
+				Bench::DoNotOptimize(hits.size());
+			});
+		}
+
+		/* the O(n^2) reference, only at the smallest count */
+		if (i == 0)
+		{
+			std::vector<BroadphasePair> pairs;
+			std::vector<bool> isAlive(scene.bounds.size(), true);
+			runner.Run("Broadphase brute force findPairs 10k", [&](size_t iterations)
+			{
+				for (size_t j = 0; j < iterations; j++)
+					FindPairsBruteForce(scene.bounds, isAlive, pairs);
+				Bench::DoNotOptimize(pairs.size());
+			});
+		}
+	}
+}
+
+static void RunRandom(Bench::Runner& runner)
+{
+	runner.Run("Random::unitValue<float>", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(Random::unitValue<float>());
+	});
+
+	runner.Run("Random::ranged<float>", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(Random::ranged(-1.f, 1.f));
+	});
+
+	runner.Run("Random::sphericalCoordinate", [&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; i++)
+			Bench::DoNotOptimize(Random::sphericalCoordinate(Vec3::zero(), 1.f));
+	});
+}
+
+static void PrintUsage()
+{
+	printf("GPMBench [--filter <name part>] [--repeats <count>] [--min-time-ms <ms>] [--json <file>]\n");
+}
+
+int main(int argc, char** argv)
+{
+	Bench::Settings settings;
+
+	for (int i = 1; i < argc; i++)
+	{
+		bool hasValue = i + 1 < argc;
+
+		if (hasValue && strcmp(argv[i], "--filter") == 0)
+			settings.filter = argv[++i];
+		else if (hasValue && strcmp(argv[i], "--repeats") == 0)
+			settings.repeats = std::max(1, atoi(argv[++i]));
+		else if (hasValue && strcmp(argv[i], "--min-time-ms") == 0)
+			settings.minSampleMs = atof(argv[++i]);
+		else if (hasValue && strcmp(argv[i], "--json") == 0)
+			settings.jsonPath = argv[++i];
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+#ifdef DEBUG
+	const char* buildType = "debug";
+	printf("/!\\ GPMBench was built without optimizations (configure with -DCMAKE_BUILD_TYPE=Release) /!\\\n");
+#else
+	const char* buildType = "release";
+#endif
+
+	Inputs inputs;
+	MakeInputs(inputs);
+
+	Bench::Runner runner(settings);
+
+	bool isAccurate = CheckBroadphase();
+
+	RunCalc(runner, inputs);
+	RunMatrix(runner, inputs);
+	RunTransform(runner, inputs);
+	RunQuaternion(runner, inputs);
+	RunShapes(runner, inputs);
+	RunRandom(runner);
+	RunBroadphase(runner);
+
+	return runner.WriteJson(buildType) && isAccurate ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2021 Amara Sami, Dallard Thomas, Nardone William, Six Jonathan
+ * This file is subject to the LGNU license terms in the LICENSE file
+ * found in the top-level directory of this distribution.
+ */
+
+#pragma once
+
+#include "Bounds.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace GPM
+{
+    /* Dynamic bounding volume hierarchy over plain data proxies. Leaves store fattened bounds so that
+     * small moves do not touch the tree, insertions descend along the smallest surface area increase
+     * and the tree is kept balanced with rotations. Suited to shapes of any sizes, to sparse updates
+     * and to ray queries. */
+    class AABBTree
+    {
+        protected:
+
+        struct Node
+        {
+            Bounds  bounds;
+            u32     parent;         /* next free node when the node is in the free list */
+            u32     child1;         /* BROADPHASE_NULL_HANDLE for leaves */
+            u32     child2;
+            s32     height;         /* 0 for leaves, -1 for free nodes */
+            u32     userData;
+
+            bool isLeaf() const noexcept { return child1 == BROADPHASE_NULL_HANDLE; }
+        };
+
+        std::vector<Node>   m_nodes;
+        u32                 m_root      {BROADPHASE_NULL_HANDLE};
+        u32                 m_freeList  {BROADPHASE_NULL_HANDLE};
+        size_t              m_leafCount {0u};
+        float               m_margin    {0.1f};
+
+        u32  allocateNode   ();
+        void freeNode       (u32 node);
+        void insertLeaf     (u32 leaf);
+        void removeLeaf     (u32 leaf);
+        u32  balance        (u32 node);
+        void refitFrom      (u32 node);
+        u32  buildRange     (u32* leaves, size_t count);
+
+        public:
+
+        AABBTree () = default;
+
+        /* margin added around the inserted bounds, proxies moving within it are not reinserted */
+        explicit AABBTree (float margin)
+            :   m_margin {margin}
+        {}
+
+        /**
+         * @brief Replace the content of the tree by count proxies built top down at once, much faster than
+         * count inserts and giving a better tree. The proxy of bounds[i] gets the handle and the user data i.
+         *
+         * @param bounds : count tight bounds
+         * @param count
+         */
+        void build(const Bounds* bounds, size_t count);
+
+        BroadphaseHandle insert (const Bounds& bounds, u32 userData);
+        void             remove (BroadphaseHandle handle);
+        void             clear  ();
+
+        /**
+         * @brief Update the bounds of a proxy
+         *
+         * @param handle
+         * @param bounds : the new tight bounds
+         * @return true if the proxy left its fattened bounds and was reinserted
+         */
+        bool move(BroadphaseHandle handle, const Bounds& bounds);
+
+        size_t          size            ()                          const noexcept { return m_leafCount; }
+        s32             getHeight       ()                          const noexcept { return m_root == BROADPHASE_NULL_HANDLE ? 0 : m_nodes[m_root].height; }
+        const Bounds&   getFatBounds    (BroadphaseHandle handle)   const noexcept { return m_nodes[handle].bounds; }
+        u32             getUserData     (BroadphaseHandle handle)   const noexcept { return m_nodes[handle].userData; }
+
+        /**
+         * @brief Find every pair of proxies whose fattened bounds overlap, each pair once.
+         * It is a superset of the pairs of tight bounds, the narrow phase rejects the extra ones.
+         *
+         * @param pairs : cleared then filled with the user data of both proxies
+         */
+        void findPairs(std::vector<BroadphasePair>& pairs) const;
+
+        /**
+         * @brief Batch overlap queries
+         *
+         * @param queries : count boxes
+         * @param hits : cleared then filled with (query index, proxy user data) for each overlap
+         */
+        void query(const Bounds* queries, size_t count, std::vector<BroadphasePair>& hits) const;
+
+        /**
+         * @brief Batch ray queries : the proxies whose fattened bounds are crossed by the ray interval.
+         * The narrow phase (RayShape::raycast) then runs on these candidates only.
+         *
+         * @param rays : count rays
+         * @param hits : cleared then filled with (ray index, proxy user data) for each candidate
+         */
+        void raycast(const Ray* rays, size_t count, std::vector<BroadphasePair>& hits) const;
+    };
+
+} /*namespace GPM*/
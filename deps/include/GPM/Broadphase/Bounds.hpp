@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2021 Amara Sami, Dallard Thomas, Nardone William, Six Jonathan
+ * This file is subject to the LGNU license terms in the LICENSE file
+ * found in the top-level directory of this distribution.
+ */
+
+#pragma once
+
+#include "../Vector3.hpp"
+#include "../Shape3D/Ray.hpp"
+#include "../Shape3D/Sphere.hpp"
+#include "../Shape3D/AABB.hpp"
+#include "../Shape3D/OrientedBox.hpp"
+#include "../Shape3D/Cylinder.hpp"
+#include "../Shape3D/Capsule.hpp"
+
+#include <cmath>
+
+namespace GPM
+{
+    /* handle of a proxy in a broadphase structure, it stays valid until the proxy is removed */
+    using BroadphaseHandle = u32;
+    #define BROADPHASE_NULL_HANDLE 0xffffffffu
+
+    /* two proxies whose bounds overlap, given by the user data they were inserted with */
+    struct BroadphasePair
+    {
+        u32 a;
+        u32 b;
+    };
+
+    /* axis aligned box given by its corners. Unlike AABB it is plain data (no Volume vtable)
+     * so the broadphase structures can store it in dense arrays */
+    struct Bounds
+    {
+        Vec3 min;
+        Vec3 max;
+
+        /* fminf/fmaxf are library calls without fast math, these compile to single min/max instructions */
+        static float minOf(float a, float b) noexcept { return a < b ? a : b; }
+        static float maxOf(float a, float b) noexcept { return a > b ? a : b; }
+
+        bool overlaps(const Bounds& other) const noexcept
+        {
+            return  (min.x <= other.max.x) & (other.min.x <= max.x) &
+                    (min.y <= other.max.y) & (other.min.y <= max.y) &
+                    (min.z <= other.max.z) & (other.min.z <= max.z);
+        }
+
+        bool contains(const Bounds& other) const noexcept
+        {
+            return  (min.x <= other.min.x) & (other.max.x <= max.x) &
+                    (min.y <= other.min.y) & (other.max.y <= max.y) &
+                    (min.z <= other.min.z) & (other.max.z <= max.z);
+        }
+
+        Bounds merged(const Bounds& other) const noexcept
+        {
+            return Bounds{  {minOf(min.x, other.min.x), minOf(min.y, other.min.y), minOf(min.z, other.min.z)},
+                            {maxOf(max.x, other.max.x), maxOf(max.y, other.max.y), maxOf(max.z, other.max.z)}};
+        }
+
+        Bounds fattened(float margin) const noexcept
+        {
+            return Bounds{min - Vec3(margin), max + Vec3(margin)};
+        }
+
+        /* half of the surface area, the cost metric used to build the AABB tree */
+        float halfArea() const noexcept
+        {
+            const Vec3 size = max - min;
+            return size.x * size.y + size.y * size.z + size.z * size.x;
+        }
+
+        /**
+         * @brief Slab test of the ray against the box, with the ray inverse direction given by the caller
+         * so that it is computed once per ray when many boxes are tested.
+         *
+         * @param ray
+         * @param invDir : 1 / ray.dir component wise
+         * @param tEnter : the first t of the ray interval inside the box, only written on success
+         * @return true if the ray interval crosses the box
+         */
+        bool raycast(const Ray& ray, const Vec3& invDir, float& tEnter) const noexcept
+        {
+            const Vec3 t0 = (min - ray.origin) * invDir;
+            const Vec3 t1 = (max - ray.origin) * invDir;
+
+            const float tNear = maxOf(maxOf(minOf(t0.x, t1.x), minOf(t0.y, t1.y)), maxOf(minOf(t0.z, t1.z), ray.tMin));
+            const float tFar  = minOf(minOf(maxOf(t0.x, t1.x), maxOf(t0.y, t1.y)), minOf(maxOf(t0.z, t1.z), ray.tMax));
+
+            if (tNear > tFar)
+                return false;
+
+            tEnter = tNear;
+            return true;
+        }
+
+        static Bounds fromAABB(const AABB& aabb) noexcept
+        {
+            return Bounds{aabb.center - aabb.extents, aabb.center + aabb.extents};
+        }
+
+        static Bounds fromSphere(const Sphere& sphere) noexcept
+        {
+            const Vec3  center = sphere.getCenter();
+            const float radius = sphere.getRadius();
+            return Bounds{center - Vec3(radius), center + Vec3(radius)};
+        }
+
+        static Bounds fromOrientedBox(const OrientedBox& box) noexcept
+        {
+            return fromAABB(box.getAABB());
+        }
+
+        /* exact bounds of the disks at both ends : along an axis a disk of normal n spans radius * sqrt(1 - n.axis^2) */
+        static Bounds fromCylinder(const Cylinder& cylinder) noexcept
+        {
+            const Vec3 pt1  = cylinder.getSegment().getPt1();
+            const Vec3 pt2  = cylinder.getSegment().getPt2();
+            const Vec3 axis = pt2 - pt1;
+            const float sqrLength = axis.sqrLength();
+
+            Vec3 extents(cylinder.getRadius());
+            if (sqrLength > 0.f)
+            {
+                extents.x *= std::sqrt(maxOf(0.f, 1.f - axis.x * axis.x / sqrLength));
+                extents.y *= std::sqrt(maxOf(0.f, 1.f - axis.y * axis.y / sqrLength));
+                extents.z *= std::sqrt(maxOf(0.f, 1.f - axis.z * axis.z / sqrLength));
+            }
+
+            const Bounds segment = fromPoints(pt1, pt2);
+            return Bounds{segment.min - extents, segment.max + extents};
+        }
+
+        static Bounds fromCapsule(const Capsule& capsule) noexcept
+        {
+            const Bounds segment = fromPoints(capsule.getSegment().getPt1(), capsule.getSegment().getPt2());
+            return segment.fattened(capsule.getRadius());
+        }
+
+        static Bounds fromPoints(const Vec3& pt1, const Vec3& pt2) noexcept
+        {
+            return Bounds{  {minOf(pt1.x, pt2.x), minOf(pt1.y, pt2.y), minOf(pt1.z, pt2.z)},
+                            {maxOf(pt1.x, pt2.x), maxOf(pt1.y, pt2.y), maxOf(pt1.z, pt2.z)}};
+        }
+    };
+
+} /*namespace GPM*/
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2021 Amara Sami, Dallard Thomas, Nardone William, Six Jonathan
+ * This file is subject to the LGNU license terms in the LICENSE file
+ * found in the top-level directory of this distribution.
+ */
+
+#pragma once
+
+#include "Bounds.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace GPM
+{
+    /* Sweep and prune along x over plain data proxies. The proxies are kept sorted by min.x with an
+     * insertion sort, which is almost linear when they moved a little since the previous sort.
+     * Suited to many moving shapes of similar sizes queried for all their pairs each frame. */
+    class SweepAndPrune
+    {
+        protected:
+
+        std::vector<Bounds>             m_bounds;       /* by handle, min.x is +inf for removed handles */
+        std::vector<u32>                m_userData;     /* by handle */
+        std::vector<BroadphaseHandle>   m_freeHandles;
+        std::vector<BroadphaseHandle>   m_removedHandles; /* reusable once they left m_order */
+        std::vector<BroadphaseHandle>   m_order;        /* live handles sorted by min.x */
+
+        /* m_order gathered in contiguous arrays for the sweeps */
+        std::vector<Bounds>             m_sortedBounds;
+        std::vector<u32>                m_sortedUserData;
+
+        size_t  m_changedCount  {0u};   /* inserted, moved or removed since the last sort */
+        float   m_maxWidthX     {0.f};  /* widest proxy along x, bounds the backward range of a query */
+        bool    m_isSorted      {true};
+
+        void sort();
+
+        public:
+
+        BroadphaseHandle insert (const Bounds& bounds, u32 userData);
+        void             move   (BroadphaseHandle handle, const Bounds& bounds);
+        void             remove (BroadphaseHandle handle);
+        void             clear  ();
+
+        size_t          size        ()                          const noexcept { return m_bounds.size() - m_freeHandles.size() - m_removedHandles.size(); }
+        const Bounds&   getBounds   (BroadphaseHandle handle)   const noexcept { return m_bounds[handle]; }
+        u32             getUserData (BroadphaseHandle handle)   const noexcept { return m_userData[handle]; }
+
+        /**
+         * @brief Find every pair of proxies whose bounds overlap, each pair once
+         *
+         * @param pairs : cleared then filled with the user data of both proxies
+         */
+        void findPairs(std::vector<BroadphasePair>& pairs);
+
+        /**
+         * @brief Batch overlap queries
+         *
+         * @param queries : count boxes
+         * @param hits : cleared then filled with (query index, proxy user data) for each overlap
+         */
+        void query(const Bounds* queries, size_t count, std::vector<BroadphasePair>& hits);
+    };
+
+} /*namespace GPM*/
@@ -7,7 +7,7 @@
 #   endif
 #endif
 
-#include "Types.hpp"
+#include "types.hpp"
 #include <math.h>
 
 namespace GPM
@@ -20,6 +20,32 @@ bool f32AreEqual(const f32 a, const f32 b, const f32 eps);
 
 f32 lerpf(const f32 a, const f32 b, const f32 alpha);
 
+/* Fast approximations of the libm functions. They have no branch (only selects)
+ * so loops calling them can be vectorized, and they do not set errno.
+ * The errors are the max measured against the double precision libm results
+ * over the given range, checked by test/CalcTest.cpp. */
+
+/* sin and cos of x in radians at once, |x| < 1e4 : abs error < 1e-7 (1e-6 up to 1e5) */
+void fastSinCos(const f32 x, f32& s, f32& c);
+
+/* 1 / sqrt(x) for x > 0 normal : bit trick and one Newton step, rel error < 1.8e-3 */
+f32 fastRsqrt(const f32 x);
+
+/* 2^x for x in [-126, 127] (not clamped) : rel error < 3e-7 */
+f32 fastExp2(const f32 x);
+
+/* log2(x) for x > 0 normal : abs error < 2e-7, rel error < 2e-7 out of [0.5, 2] */
+f32 fastLog2(const f32 x);
+
+/* x^y = 2^(y * log2(x)) for x > 0 and y * log2(x) in [-126, 127] : rel error < 2e-7 * (1 + |y * log2(x)|) */
+f32 fastPow(const f32 x, const f32 y);
+
+/* acos(x) for x in [-1, 1] : abs error < 5e-7 */
+f32 fastAcos(const f32 x);
+
+/* atan2(y, x), atan2(0, 0) is 0 : abs error < 4e-7 */
+f32 fastAtan2(const f32 y, const f32 x);
+
 #include "Calc.inl"
 
 }
\ No newline at end of file
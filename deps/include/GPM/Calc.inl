@@ -25,4 +25,109 @@ inline f32 lerpf(const f32 a, const f32 b, const f32 alpha)
 inline f32 Modulo(f32 a, f32 b)
 {
     return fmod(a,b);
-}
\ No newline at end of file
+}
+
+inline void fastSinCos(const f32 x, f32& s, f32& c)
+{
+    /* x = q * PI/2 + r with r in [-PI/4, PI/4], PI/2 is split in 3 floats (Cody-Waite)
+     * so that q * PI/2 is subtracted without losing the bits of r */
+    const f32 qf = x * 0.636619772f;
+    const s32 q  = static_cast<s32>(qf + (qf >= 0.f ? 0.5f : -0.5f));
+    const f32 fq = static_cast<f32>(q);
+    const f32 r  = ((x - fq * 1.5703125f) - fq * 4.837512969970703125e-4f) - fq * 7.549789954891882e-8f;
+    const f32 r2 = r * r;
+
+    /* minimax polynomials on [-PI/4, PI/4] (cephes) */
+    const f32 sinR = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+    const f32 cosR = 1.f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+
+    /* odd quadrants swap sin and cos, quadrants 2 and 3 negate sin, 1 and 2 negate cos */
+    const bool swap = (q & 1) != 0;
+    const f32 sinV  = swap ? cosR : sinR;
+    const f32 cosV  = swap ? sinR : cosR;
+    s = (q & 2) != 0       ? -sinV : sinV;
+    c = ((q + 1) & 2) != 0 ? -cosV : cosV;
+}
+
+
+inline f32 fastRsqrt(const f32 x)
+{
+    f32u u;
+    u.f    = x;
+    u.bits = 0x5f375a86 - (u.bits >> 1);
+    return u.f * (1.5f - 0.5f * x * u.f * u.f);
+}
+
+
+inline f32 fastExp2(const f32 x)
+{
+    /* 2^x = 2^i * 2^f with i = round(x) built in the exponent bits and f in [-0.5, 0.5] */
+    const s32 i = static_cast<s32>(x + 128.5f) - 128; /* x + 128.5 > 0, so the truncation is a floor */
+    const f32 f = x - static_cast<f32>(i);
+
+    const f32 p = 1.0000000754548972f + f * (0.6931471880262287f + f * (0.24022107485308267f
+                + f * (0.05550357114219194f + f * (0.009676031918324871f + f * 0.0013390863364616103f))));
+
+    f32u scale;
+    scale.bits = (i + 127) << 23;
+    return p * scale.f;
+}
+
+
+inline f32 fastLog2(const f32 x)
+{
+    /* x = 2^e * m, m is brought in [sqrt(0.5), sqrt(2)) so that log2(m) = log2(1 + t) with small |t|.
+     * The bits are moved in integers, float selects with an arithmetic on one side would be branches */
+    f32u u;
+    u.f = x;
+    const s32 big = (u.bits & 0x007fffff) > 0x003504f3 ? 1 : 0; /* mantissa of sqrt(2) */
+    const f32 fe  = static_cast<f32>(((u.bits >> 23) & 0xff) - 127 + big);
+    u.bits        = (u.bits & 0x007fffff) | ((127 - big) << 23);
+    const f32 t   = u.f - 1.f;
+
+    const f32 p = 1.4426949948930465f + t * (-0.7213529313629773f + t * (0.48091670800016945f
+                + t * (-0.3602251824607826f + t * (0.28728888237577427f + t * (-0.24927182207952067f
+                + t * (0.23265257880774415f + t * -0.14275973432823494f))))));
+
+    return fe + t * p;
+}
+
+
+inline f32 fastPow(const f32 x, const f32 y)
+{
+    return fastExp2(y * fastLog2(x));
+}
+
+
+inline f32 fastAcos(const f32 x)
+{
+    /* acos(|x|) = sqrt(1 - |x|) * P(|x|) (Abramowitz and Stegun 4.4.46), acos(-x) = PI - acos(x) */
+    const f32 ax = fabsf(x);
+    const f32 p  = 1.5707963050f + ax * (-0.2145988016f + ax * (0.0889789874f + ax * (-0.0501743046f
+                 + ax * (0.0308918810f + ax * (-0.0170881256f + ax * (0.0066700901f + ax * -0.0012624911f))))));
+    const f32 r  = sqrtf(1.f - ax) * p;
+    /* the selects only pick signs and constants, an arithmetic on one side only would be a branch */
+    return (x < 0.f ? -r : r) + (x < 0.f ? 3.14159265358979323846f : 0.f);
+}
+
+
+inline f32 fastAtan2(const f32 y, const f32 x)
+{
+    /* atan of a = min / max in [0, 1], then moved to the right octant */
+    const f32 ax = fabsf(x);
+    const f32 ay = fabsf(y);
+    const f32 mx = ax > ay ? ax : ay;
+    const f32 mn = ax > ay ? ay : ax;
+    const f32 a  = mn / (mx > 1e-30f ? mx : 1e-30f); /* 0 / 0 gives 0, mn is 0 when mx is */
+    const f32 s  = a * a;
+
+    const f32 p = 0.999999881996493f + s * (-0.33331812655627785f + s * (0.19966961829590915f
+                + s * (-0.14003290184646563f + s * (0.09868865458110483f + s * (-0.058829753142672046f
+                + s * (0.023780518596838274f + s * -0.004559791986027567f))))));
+
+    /* the selects only pick signs and constants, an arithmetic on one side only would be a branch */
+    f32 r = a * p;
+    r = (ay > ax ? -r : r) + (ay > ax ? 1.57079632679489661923f : 0.f);
+    r = (x < 0.f ? -r : r) + (x < 0.f ? 3.14159265358979323846f : 0.f);
+    return y < 0.f ? -r : r;
+}
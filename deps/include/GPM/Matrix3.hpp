@@ -5,7 +5,7 @@
  */
 
 #pragma once
-#include "Types.hpp"
+#include "types.hpp"
 #include "Vector3.hpp"
 
 namespace GPM
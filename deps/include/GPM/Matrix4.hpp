@@ -7,7 +7,7 @@
 #pragma once
 
 #include "Vector4.hpp"
-#include "Types.hpp"
+#include "types.hpp"
 
 namespace GPM
 {
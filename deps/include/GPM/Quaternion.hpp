@@ -8,7 +8,7 @@
 
 #include "Vector3.hpp"
 #include "constants.hpp"
-#include "Types.hpp"
+#include "types.hpp"
 
 namespace GPM
 {
@@ -22,22 +22,15 @@ union alignas(16) Quaternion
     // - f32 z
     // - f32 w
     // - f32 e[4], which is the same as {x, y, z, w}
-    struct
-    {
-        union
-        {
-            Vec3 v;
-            struct
-            {
-                f32 x;
-                f32 y;
-                f32 z;
-            };
-        };
-        f32 w;
-    };
+    // v is a direct member of the union, see Vector3.
+    struct { f32 x; f32 y; f32 z; f32 w; };
+    Vec3 v;
     f32 e[4];
 
+    // Constructors
+    Quaternion() noexcept = default;
+    constexpr Quaternion(const Vec3& v, const f32 w)                       noexcept;
+
     static constexpr Quaternion identity  ()                                       noexcept;
     static Quaternion           angleAxis (const f32 angle, const Vec3& axis)      noexcept;
     static Quaternion           fromEuler (const Vec3& angles)                     noexcept;
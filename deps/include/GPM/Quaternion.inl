@@ -1,4 +1,12 @@
-﻿/* =================== Static methods (pseudo-constructors) =================== */
+﻿/* =================== Constructors =================== */
+inline constexpr Quaternion::Quaternion(const Vec3& v_, const f32 w_) noexcept
+    : x{v_.x}, y{v_.y}, z{v_.z}, w{w_}
+{}
+
+
+
+
+/* =================== Static methods (pseudo-constructors) =================== */
 inline constexpr Quaternion Quaternion::identity() noexcept
 {
     return {Vec3::zero(), 1.f};
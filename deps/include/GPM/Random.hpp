@@ -18,7 +18,7 @@
 #include <time.h>
 #include <cmath>
 
-#include "Constants.hpp"
+#include "constants.hpp"
 
 namespace GPM::Random
 {
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2021 Amara Sami, Dallard Thomas, Nardone William, Six Jonathan
+ * This file is subject to the LGNU license terms in the LICENSE file
+ * found in the top-level directory of this distribution.
+ */
+
+#pragma once
+
+#include "../Vector3.hpp"
+#include "Segment.hpp"
+
+#include <limits>
+
+namespace GPM
+{
+    /* a ray is the set of points origin + t * dir for t in [tMin, tMax].
+     * dir does not need to be normalized, t is expressed in units of dir. */
+    struct Ray
+    {
+        Vec3    origin  {Vec3::zero()};
+        Vec3    dir     {Vec3::forward()};
+        float   tMin    {0.f};
+        float   tMax    {std::numeric_limits<float>::infinity()};
+
+        Vec3 at(float t) const noexcept
+        {
+            return origin + dir * t;
+        }
+
+        /* the segment [pt1, pt2] as a ray with t in [0, 1] */
+        static Ray fromSegment(const Segment& seg) noexcept
+        {
+            return Ray{seg.getPt1(), seg.getPt2() - seg.getPt1(), 0.f, 1.f};
+        }
+    };
+
+    /* result of a ray query. Only the parametric distance is computed,
+     * the point is ray.at(t) and the normal is computed on demand from part. */
+    struct RayHit
+    {
+        float   t       {std::numeric_limits<float>::infinity()};
+        u32     part    {0u}; /* shape dependant : which face/cap/body was hit */
+
+        /* batch queries leave t to infinity when there is no hit */
+        bool isHit() const noexcept
+        {
+            return t < std::numeric_limits<float>::infinity();
+        }
+    };
+
+} /*namespace GPM*/
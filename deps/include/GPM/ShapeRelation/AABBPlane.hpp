@@ -20,7 +20,7 @@ namespace GPM::AABBPlane
  * @param plane
  * @return
  */
-bool isAABBOnOrForwardPlane(const AABB& aabb, const Plane& plane)
+inline bool isAABBOnOrForwardPlane(const AABB& aabb, const Plane& plane)
 {
     // Compute the projection interval radius of b onto L(t) = b.c + t * p.n
     const float r = aabb.extents.x * std::abs(plane.getNormal().x) + aabb.extents.y * std::abs(plane.getNormal().y) +
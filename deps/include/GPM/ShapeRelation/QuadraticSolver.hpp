@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2021 Amara Sami, Dallard Thomas, Nardone William, Six Jonathan
+ * This file is subject to the LGNU license terms in the LICENSE file
+ * found in the top-level directory of this distribution.
+ */
+
+#pragma once
+
+#include "../types.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+/* Branchless solver for the quadratics of the ray/shape tests.
+ * Every path is computed and the result is picked with masks (selects), so loops
+ * over these functions can be vectorized by the compiler (needs -fno-math-errno or /fp:fast for sqrt). */
+namespace GPM::QuadraticSolver
+{
+    /**
+     * @brief Roots of a * t² + 2 * halfB * t + c = 0, with a >= 0 as in every ray equation.
+     *
+     * @param t0 : smallest root, only meaningful if the equation has a solution
+     * @param t1 : biggest root, only meaningful if the equation has a solution
+     * @return true if there are real roots
+     */
+    inline bool solve(float a, float halfB, float c, float& t0, float& t1) noexcept
+    {
+        const float discriminent        = halfB * halfB - a * c;
+        const float rootDiscriminent    = std::sqrt(discriminent > 0.f ? discriminent : 0.f);
+        const float invA                = 1.f / a;
+
+        t0 = (-halfB - rootDiscriminent) * invA;
+        t1 = (-halfB + rootDiscriminent) * invA;
+
+        return (discriminent >= 0.f) & (a > 0.f);
+    }
+
+    /**
+     * @brief Pick the smallest valid root in [tMin, tMax].
+     *
+     * @return the root or infinity if there is none
+     */
+    inline float nearestRoot(float t0, float t1, bool valid, float tMin, float tMax) noexcept
+    {
+        const bool isT0In = valid & (t0 >= tMin) & (t0 <= tMax);
+        const bool isT1In = valid & (t1 >= tMin) & (t1 <= tMax);
+
+        return isT0In ? t0 : (isT1In ? t1 : std::numeric_limits<float>::infinity());
+    }
+
+    /**
+     * @brief Batch version of solve over structure of arrays, all arrays have count elements.
+     *
+     * @param mask : 1 where the equation has real roots, 0 otherwise
+     */
+    inline void solve(const float* a, const float* halfB, const float* c, float* t0, float* t1, u8* mask, size_t count) noexcept
+    {
+        for (size_t i = 0; i < count; i++)
+            mask[i] = static_cast<u8>(solve(a[i], halfB[i], c[i], t0[i], t1[i]));
+    }
+
+    /**
+     * @brief Batch version of nearestRoot, out[i] is infinity where there is no root in [tMin, tMax].
+     */
+    inline void nearestRoot(const float* t0, const float* t1, const u8* mask, float tMin, float tMax, float* out, size_t count) noexcept
+    {
+        for (size_t i = 0; i < count; i++)
+            out[i] = nearestRoot(t0[i], t1[i], mask[i] != 0u, tMin, tMax);
+    }
+
+} /*namespace GPM::QuadraticSolver*/
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2021 Amara Sami, Dallard Thomas, Nardone William, Six Jonathan
+ * This file is subject to the LGNU license terms in the LICENSE file
+ * found in the top-level directory of this distribution.
+ */
+
+#pragma once
+
+#include "../Shape3D/Ray.hpp"
+#include "../Shape3D/Sphere.hpp"
+#include "../Shape3D/AABB.hpp"
+#include "../Shape3D/OrientedBox.hpp"
+#include "../Shape3D/Plane.hpp"
+#include "../Shape3D/Quad.hpp"
+#include "../Shape3D/Capsule.hpp"
+#include "../Shape3D/Cylinder.hpp"
+
+#include <cstddef>
+
+namespace GPM::RayShape
+{
+    /* RayHit::part values */
+    #define RAY_PART_FRONT      0u  // plane/quad : hit on the normal side
+    #define RAY_PART_BACK       1u  // plane/quad : hit on the opposite side
+    #define RAY_PART_BODY       0u  // cylinder/capsule : hit on the side
+    #define RAY_PART_PT1        1u  // cylinder/capsule : hit on the cap/sphere of pt1
+    #define RAY_PART_PT2        2u  // cylinder/capsule : hit on the cap/sphere of pt2
+    /* box faces are encoded axis * 2 + (1 if negative face), axis being 0 for i/x, 1 for j/y and 2 for k/z */
+
+    /* number of shapes whose data is gathered at once by the batch queries */
+    #define RAY_BATCH_BLOCK     64u
+
+    /**
+     * @brief Find the first t in [ray.tMin, ray.tMax] where the ray touches the shape.
+     * If the ray starts inside a closed shape, the exit point is returned.
+     *
+     * @param ray
+     * @param shape
+     * @param hit : t and part are only written on success
+     * @return true if there is a hit in the ray interval
+     */
+    bool raycast(const Ray& ray, const Sphere&      sphere,   RayHit& hit);
+    bool raycast(const Ray& ray, const AABB&        aabb,     RayHit& hit);
+    bool raycast(const Ray& ray, const OrientedBox& box,      RayHit& hit);
+    bool raycast(const Ray& ray, const Plane&       plane,    RayHit& hit);
+    bool raycast(const Ray& ray, const Quad&        quad,     RayHit& hit);
+    bool raycast(const Ray& ray, const Cylinder&    cylinder, RayHit& hit);
+    bool raycast(const Ray& ray, const Capsule&     capsule,  RayHit& hit);
+
+    /**
+     * @brief Batch queries over ray/shape pairs : hits[i] is the first hit of rays[i] on shapes[i].
+     * There is no branch per pair, all roots are computed and selected with masks so the loops
+     * can be vectorized. hits[i].isHit() is false when there is no hit in the ray interval.
+     *
+     * @param rays : count rays
+     * @param shapes : count shapes
+     * @param hits : count results, always written
+     */
+    void raycast(const Ray* rays, const Sphere*   spheres,   RayHit* hits, size_t count);
+    void raycast(const Ray* rays, const Cylinder* cylinders, RayHit* hits, size_t count);
+    void raycast(const Ray* rays, const Capsule*  capsules,  RayHit* hits, size_t count);
+
+    /**
+     * @brief Compute the unit normal of a hit returned by raycast, only when it is needed.
+     * Closed shapes return the outward normal, plane and quad return the normal facing the ray origin.
+     *
+     * @param ray : the ray given to raycast
+     * @param shape : the shape given to raycast
+     * @param hit : the hit filled by raycast
+     * @return Vec3
+     */
+    Vec3 getNormal(const Ray& ray, const Sphere&      sphere,   const RayHit& hit);
+    Vec3 getNormal(const Ray& ray, const AABB&        aabb,     const RayHit& hit);
+    Vec3 getNormal(const Ray& ray, const OrientedBox& box,      const RayHit& hit);
+    Vec3 getNormal(const Ray& ray, const Plane&       plane,    const RayHit& hit);
+    Vec3 getNormal(const Ray& ray, const Quad&        quad,     const RayHit& hit);
+    Vec3 getNormal(const Ray& ray, const Cylinder&    cylinder, const RayHit& hit);
+    Vec3 getNormal(const Ray& ray, const Capsule&     capsule,  const RayHit& hit);
+
+} /*namespace GPM::RayShape*/
@@ -12,6 +12,6 @@
 
 namespace GPM::SegmentPlane
 {
-    static bool isSegmentPlaneCollided(const Segment& seg, const Plane& plane, Intersection& intersection);
+    bool isSegmentPlaneCollided(const Segment& seg, const Plane& plane, Intersection& intersection);
 
 } /*namespace GPM*/
\ No newline at end of file
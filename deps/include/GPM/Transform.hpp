@@ -6,7 +6,7 @@
 
 #pragma once
 
-#include "Types.hpp"
+#include "types.hpp"
 #include "Vector3.hpp"
 #include "Matrix4.hpp"
 #include "Quaternion.hpp"
@@ -72,7 +72,7 @@ struct Transform
     constexpr void        setLocalTranslation (const Vec3& t)                 noexcept;
     constexpr void        setGlobalTranslation(const Vec3& t)                 noexcept;
     void                  setRotation         (const Vec3& r)                 noexcept;
-    constexpr void        setScale            (const Vec3& s)                 noexcept;
+    void                  setScale            (const Vec3& s)                 noexcept;
 
     constexpr void 	setVectorUp(const Vec3& newUp) noexcept;
     constexpr void 	setVectorRight(const Vec3& newRight) noexcept;
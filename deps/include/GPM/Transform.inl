@@ -297,7 +297,7 @@ inline void Transform::setRotation(const Vec3& r) noexcept
 }
 
 
-inline constexpr void Transform::setScale(const Vec3& s) noexcept
+inline void Transform::setScale(const Vec3& s) noexcept
 {
 	scale(s / scaling());
 }
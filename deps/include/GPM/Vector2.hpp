@@ -9,7 +9,7 @@
 #include <cfloat>
 #include <cmath>
 
-#include "Types.hpp"
+#include "types.hpp"
 
 namespace GPM
 {
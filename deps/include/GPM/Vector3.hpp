@@ -22,17 +22,10 @@ union Vector3
     // - f32 y, which is the same as xy.y
     // - f32 z
     // - f32 e[3], which is the same as {x, y, z}
-    struct
-    {
-        union
-        {
-            Vec2 xy;
-            struct { f32 x; f32 y; };
-        };
-        
-        f32 z;
-    };
-
+    // xy is a direct member of the union (not nested in the anonymous struct)
+    // as GCC refuses members with constructors in anonymous structs.
+    struct { f32 x; f32 y; f32 z; };
+    Vec2 xy;
     f32 e[3];
 
     // Constructors
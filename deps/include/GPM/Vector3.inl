@@ -10,7 +10,7 @@ inline constexpr Vector3::Vector3(const f32 x_, const f32 y_, const f32 z_) noex
 
 
 inline constexpr Vector3::Vector3(const Vec2 v, const f32 z_) noexcept
-    : xy{v}, z{z_}
+    : x{v.x}, y{v.y}, z{z_}
 {}
 
 
@@ -23,27 +23,10 @@ union alignas(16) Vector4
     // - f32 z, which is the same as xyz.z or xy.z
     // - f32 w
     // - f32 e[4], which is the same as {x, y, z, w}
-    struct
-    {
-        union 
-        {
-            Vec3 xyz;
-
-            struct
-            {
-                union
-                {
-                    Vec2 xy;
-                    struct { f32 x; f32 y; };
-                };
-
-                f32 z;
-            };
-        };
-
-        f32 w;
-    };
-
+    // xyz and xy are direct members of the union, see Vector3.
+    struct { f32 x; f32 y; f32 z; f32 w; };
+    Vec3 xyz;
+    Vec2 xy;
     f32 e[4];
 
     Vector4() noexcept = default;
@@ -5,17 +5,17 @@ inline constexpr Vector4::Vector4(const f32 k) noexcept
 
 
 inline constexpr Vector4::Vector4(const f32 x, const f32 y, const f32 z, const f32 w_) noexcept
-    : xyz{x, y, z}, w{w_}
+    : e{x, y, z, w_}
 {}
 
 
 inline constexpr Vector4::Vector4(const Vec2& v, const f32 z_, const f32 w_) noexcept
-    : xy{v}, z{z_}, w{w_}
+    : x{v.x}, y{v.y}, z{z_}, w{w_}
 {}
 
 
 inline constexpr Vector4::Vector4(const Vec3& v, const f32 w_) noexcept
-    : xyz{v}, w{w_}
+    : x{v.x}, y{v.y}, z{v.z}, w{w_}
 {}
 
 
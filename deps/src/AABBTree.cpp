@@ -0,0 +1,494 @@
+#include "GPM/Broadphase/AABBTree.hpp"
+
+#include <algorithm>
+
+using namespace GPM;
+
+/* the tree height stays close to 1.44 * log2(leaf count), this is enough for any leaf count fitting a u32 */
+#define AABB_TREE_STACK_SIZE 128u
+
+
+u32 AABBTree::allocateNode()
+{
+    u32 node;
+    if (m_freeList == BROADPHASE_NULL_HANDLE)
+    {
+        node = static_cast<u32>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    else
+    {
+        node        = m_freeList;
+        m_freeList  = m_nodes[node].parent;
+    }
+
+    Node& newNode   = m_nodes[node];
+    newNode.parent  = BROADPHASE_NULL_HANDLE;
+    newNode.child1  = BROADPHASE_NULL_HANDLE;
+    newNode.child2  = BROADPHASE_NULL_HANDLE;
+    newNode.height  = 0;
+    newNode.userData = 0u;
+    return node;
+}
+
+
+void AABBTree::freeNode(u32 node)
+{
+    m_nodes[node].parent = m_freeList;
+    m_nodes[node].height = -1;
+    m_freeList = node;
+}
+
+
+BroadphaseHandle AABBTree::insert(const Bounds& bounds, u32 userData)
+{
+    const u32 leaf = allocateNode();
+    m_nodes[leaf].bounds    = bounds.fattened(m_margin);
+    m_nodes[leaf].userData  = userData;
+
+    insertLeaf(leaf);
+    m_leafCount++;
+    return leaf;
+}
+
+
+void AABBTree::remove(BroadphaseHandle handle)
+{
+    removeLeaf(handle);
+    freeNode(handle);
+    m_leafCount--;
+}
+
+
+bool AABBTree::move(BroadphaseHandle handle, const Bounds& bounds)
+{
+    if (m_nodes[handle].bounds.contains(bounds))
+        return false;
+
+    removeLeaf(handle);
+    m_nodes[handle].bounds = bounds.fattened(m_margin);
+    insertLeaf(handle);
+    return true;
+}
+
+
+void AABBTree::clear()
+{
+    m_nodes.clear();
+    m_root      = BROADPHASE_NULL_HANDLE;
+    m_freeList  = BROADPHASE_NULL_HANDLE;
+    m_leafCount = 0u;
+}
+
+
+void AABBTree::build(const Bounds* bounds, size_t count)
+{
+    clear();
+    if (count == 0u)
+        return;
+
+    m_nodes.reserve(2u * count - 1u);
+
+    /* leaves are allocated first so that the handle of bounds[i] is i */
+    std::vector<u32> leaves(count);
+    for (u32 i = 0u; i < count; i++)
+    {
+        leaves[i] = allocateNode();
+        m_nodes[i].bounds   = bounds[i].fattened(m_margin);
+        m_nodes[i].userData = i;
+    }
+
+    m_leafCount = count;
+    m_root = buildRange(leaves.data(), count);
+    m_nodes[m_root].parent = BROADPHASE_NULL_HANDLE;
+}
+
+
+/* split the leaves in two halves along the widest axis of their centers, the depth is log2(count) */
+u32 AABBTree::buildRange(u32* leaves, size_t count)
+{
+    if (count == 1u)
+        return leaves[0];
+
+    Bounds centers = Bounds::fromPoints(m_nodes[leaves[0]].bounds.min + m_nodes[leaves[0]].bounds.max,
+                                        m_nodes[leaves[0]].bounds.min + m_nodes[leaves[0]].bounds.max);
+    for (size_t i = 1u; i < count; i++)
+    {
+        const Vec3 center = m_nodes[leaves[i]].bounds.min + m_nodes[leaves[i]].bounds.max;
+        centers = centers.merged(Bounds{center, center});
+    }
+
+    const Vec3 size = centers.max - centers.min;
+    const u32 axis  = size.x > size.y ? (size.x > size.z ? 0u : 2u) : (size.y > size.z ? 1u : 2u);
+
+    const std::vector<Node>& nodes = m_nodes;
+    const size_t half = count / 2u;
+    std::nth_element(leaves, leaves + half, leaves + count, [&](u32 lhs, u32 rhs)
+    {
+        return nodes[lhs].bounds.min.e[axis] + nodes[lhs].bounds.max.e[axis] < nodes[rhs].bounds.min.e[axis] + nodes[rhs].bounds.max.e[axis];
+    });
+
+    const u32 child1 = buildRange(leaves, half);
+    const u32 child2 = buildRange(leaves + half, count - half);
+    const u32 parent = allocateNode();
+
+    Node& node  = m_nodes[parent];
+    node.child1 = child1;
+    node.child2 = child2;
+    node.bounds = m_nodes[child1].bounds.merged(m_nodes[child2].bounds);
+    node.height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+    m_nodes[child1].parent = parent;
+    m_nodes[child2].parent = parent;
+    return parent;
+}
+
+
+void AABBTree::insertLeaf(u32 leaf)
+{
+    if (m_root == BROADPHASE_NULL_HANDLE)
+    {
+        m_root = leaf;
+        m_nodes[leaf].parent = BROADPHASE_NULL_HANDLE;
+        return;
+    }
+
+    /* branch and bound search of the sibling adding the least area to the tree : the cost of a sibling is
+     * the area of its new parent plus the area increase of all its ancestors (the inherited cost).
+     * A subtree is skipped when even the leaf alone would cost more than the best sibling found */
+    const Bounds leafBounds = m_nodes[leaf].bounds;
+    const float  leafArea   = leafBounds.halfArea();
+
+    u32   index     = m_root;
+    float bestCost  = m_nodes[m_root].bounds.merged(leafBounds).halfArea();
+
+    u32   stack[AABB_TREE_STACK_SIZE];
+    float inheritedCosts[AABB_TREE_STACK_SIZE];
+    u32   stackSize = 0u;
+
+    stack[stackSize]            = m_root;
+    inheritedCosts[stackSize++] = 0.f;
+    while (stackSize > 0u)
+    {
+        stackSize--;
+        const u32   current   = stack[stackSize];
+        const float inherited = inheritedCosts[stackSize];
+        const Node& node      = m_nodes[current];
+
+        const float directCost = node.bounds.merged(leafBounds).halfArea();
+        if (directCost + inherited < bestCost)
+        {
+            bestCost = directCost + inherited;
+            index    = current;
+        }
+
+        if (node.isLeaf())
+            continue;
+
+        const float childInherited = inherited + directCost - node.bounds.halfArea();
+        if (leafArea + childInherited < bestCost)
+        {
+            stack[stackSize]            = node.child1;
+            inheritedCosts[stackSize++] = childInherited;
+            stack[stackSize]            = node.child2;
+            inheritedCosts[stackSize++] = childInherited;
+        }
+    }
+
+    const u32 sibling   = index;
+    const u32 oldParent = m_nodes[sibling].parent;
+    const u32 newParent = allocateNode();
+
+    Node& parentNode    = m_nodes[newParent];
+    parentNode.parent   = oldParent;
+    parentNode.bounds   = leafBounds.merged(m_nodes[sibling].bounds);
+    parentNode.height   = m_nodes[sibling].height + 1;
+    parentNode.child1   = sibling;
+    parentNode.child2   = leaf;
+
+    if (oldParent != BROADPHASE_NULL_HANDLE)
+    {
+        if (m_nodes[oldParent].child1 == sibling)
+            m_nodes[oldParent].child1 = newParent;
+        else
+            m_nodes[oldParent].child2 = newParent;
+    }
+    else
+        m_root = newParent;
+
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent    = newParent;
+
+    refitFrom(m_nodes[leaf].parent);
+}
+
+
+void AABBTree::removeLeaf(u32 leaf)
+{
+    if (leaf == m_root)
+    {
+        m_root = BROADPHASE_NULL_HANDLE;
+        return;
+    }
+
+    const u32 parent      = m_nodes[leaf].parent;
+    const u32 grandParent = m_nodes[parent].parent;
+    const u32 sibling     = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+    freeNode(parent);
+
+    if (grandParent == BROADPHASE_NULL_HANDLE)
+    {
+        m_root = sibling;
+        m_nodes[sibling].parent = BROADPHASE_NULL_HANDLE;
+        return;
+    }
+
+    if (m_nodes[grandParent].child1 == parent)
+        m_nodes[grandParent].child1 = sibling;
+    else
+        m_nodes[grandParent].child2 = sibling;
+    m_nodes[sibling].parent = grandParent;
+
+    refitFrom(grandParent);
+}
+
+
+void AABBTree::refitFrom(u32 node)
+{
+    while (node != BROADPHASE_NULL_HANDLE)
+    {
+        node = balance(node);
+
+        Node& current = m_nodes[node];
+        const Node& child1 = m_nodes[current.child1];
+        const Node& child2 = m_nodes[current.child2];
+
+        current.height = 1 + std::max(child1.height, child2.height);
+        current.bounds = child1.bounds.merged(child2.bounds);
+
+        node = current.parent;
+    }
+}
+
+
+/* AVL like rotation : if a child of a is 2 levels higher than the other, it becomes the parent of a.
+ * Returns the node now at the place of a */
+u32 AABBTree::balance(u32 iA)
+{
+    Node& a = m_nodes[iA];
+    if (a.isLeaf() || a.height < 2)
+        return iA;
+
+    const u32 iB = a.child1;
+    const u32 iC = a.child2;
+    Node& b = m_nodes[iB];
+    Node& c = m_nodes[iC];
+
+    const s32 balanceFactor = c.height - b.height;
+
+    /* rotate c up */
+    if (balanceFactor > 1)
+    {
+        const u32 iF = c.child1;
+        const u32 iG = c.child2;
+        Node& f = m_nodes[iF];
+        Node& g = m_nodes[iG];
+
+        c.child1 = iA;
+        c.parent = a.parent;
+        a.parent = iC;
+
+        if (c.parent != BROADPHASE_NULL_HANDLE)
+        {
+            if (m_nodes[c.parent].child1 == iA)
+                m_nodes[c.parent].child1 = iC;
+            else
+                m_nodes[c.parent].child2 = iC;
+        }
+        else
+            m_root = iC;
+
+        /* the higher child of c stays under c, the other one replaces c under a */
+        if (f.height > g.height)
+        {
+            c.child2 = iF;
+            a.child2 = iG;
+            g.parent = iA;
+            a.bounds = b.bounds.merged(g.bounds);
+            c.bounds = a.bounds.merged(f.bounds);
+            a.height = 1 + std::max(b.height, g.height);
+            c.height = 1 + std::max(a.height, f.height);
+        }
+        else
+        {
+            c.child2 = iG;
+            a.child2 = iF;
+            f.parent = iA;
+            a.bounds = b.bounds.merged(f.bounds);
+            c.bounds = a.bounds.merged(g.bounds);
+            a.height = 1 + std::max(b.height, f.height);
+            c.height = 1 + std::max(a.height, g.height);
+        }
+
+        return iC;
+    }
+
+    /* rotate b up */
+    if (balanceFactor < -1)
+    {
+        const u32 iD = b.child1;
+        const u32 iE = b.child2;
+        Node& d = m_nodes[iD];
+        Node& e = m_nodes[iE];
+
+        b.child1 = iA;
+        b.parent = a.parent;
+        a.parent = iB;
+
+        if (b.parent != BROADPHASE_NULL_HANDLE)
+        {
+            if (m_nodes[b.parent].child1 == iA)
+                m_nodes[b.parent].child1 = iB;
+            else
+                m_nodes[b.parent].child2 = iB;
+        }
+        else
+            m_root = iB;
+
+        if (d.height > e.height)
+        {
+            b.child2 = iD;
+            a.child1 = iE;
+            e.parent = iA;
+            a.bounds = c.bounds.merged(e.bounds);
+            b.bounds = a.bounds.merged(d.bounds);
+            a.height = 1 + std::max(c.height, e.height);
+            b.height = 1 + std::max(a.height, d.height);
+        }
+        else
+        {
+            b.child2 = iE;
+            a.child1 = iD;
+            d.parent = iA;
+            a.bounds = c.bounds.merged(d.bounds);
+            b.bounds = a.bounds.merged(e.bounds);
+            a.height = 1 + std::max(c.height, d.height);
+            b.height = 1 + std::max(a.height, e.height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
+
+
+void AABBTree::findPairs(std::vector<BroadphasePair>& pairs) const
+{
+    pairs.clear();
+    if (m_root == BROADPHASE_NULL_HANDLE)
+        return;
+
+    /* the leaves are visited in tree order, so consecutive queries go down the same cached nodes */
+    u32 leafStack[AABB_TREE_STACK_SIZE];
+    u32 leafStackSize = 0u;
+    leafStack[leafStackSize++] = m_root;
+
+    u32 stack[AABB_TREE_STACK_SIZE];
+    while (leafStackSize > 0u)
+    {
+        const u32 leaf = leafStack[--leafStackSize];
+        const Node& leafNode = m_nodes[leaf];
+        if (!leafNode.isLeaf())
+        {
+            leafStack[leafStackSize++] = leafNode.child2;
+            leafStack[leafStackSize++] = leafNode.child1;
+            continue;
+        }
+
+        u32 stackSize = 0u;
+        stack[stackSize++] = m_root;
+        while (stackSize > 0u)
+        {
+            const u32 index  = stack[--stackSize];
+            const Node& node = m_nodes[index];
+            if (!node.bounds.overlaps(leafNode.bounds))
+                continue;
+
+            if (node.isLeaf())
+            {
+                /* both leaves find each other, the pair is kept once */
+                if (index > leaf)
+                    pairs.push_back(BroadphasePair{leafNode.userData, node.userData});
+            }
+            else
+            {
+                stack[stackSize++] = node.child1;
+                stack[stackSize++] = node.child2;
+            }
+        }
+    }
+}
+
+
+void AABBTree::query(const Bounds* queries, size_t count, std::vector<BroadphasePair>& hits) const
+{
+    hits.clear();
+    if (m_root == BROADPHASE_NULL_HANDLE)
+        return;
+
+    u32 stack[AABB_TREE_STACK_SIZE];
+    for (size_t i = 0u; i < count; i++)
+    {
+        u32 stackSize = 0u;
+        stack[stackSize++] = m_root;
+        while (stackSize > 0u)
+        {
+            const Node& node = m_nodes[stack[--stackSize]];
+            if (!node.bounds.overlaps(queries[i]))
+                continue;
+
+            if (node.isLeaf())
+                hits.push_back(BroadphasePair{static_cast<u32>(i), node.userData});
+            else
+            {
+                stack[stackSize++] = node.child1;
+                stack[stackSize++] = node.child2;
+            }
+        }
+    }
+}
+
+
+void AABBTree::raycast(const Ray* rays, size_t count, std::vector<BroadphasePair>& hits) const
+{
+    hits.clear();
+    if (m_root == BROADPHASE_NULL_HANDLE)
+        return;
+
+    u32 stack[AABB_TREE_STACK_SIZE];
+    for (size_t i = 0u; i < count; i++)
+    {
+        const Ray& ray = rays[i];
+        const Vec3 invDir(1.f / ray.dir.x, 1.f / ray.dir.y, 1.f / ray.dir.z);
+
+        u32 stackSize = 0u;
+        stack[stackSize++] = m_root;
+        while (stackSize > 0u)
+        {
+            const Node& node = m_nodes[stack[--stackSize]];
+
+            float tEnter;
+            if (!node.bounds.raycast(ray, invDir, tEnter))
+                continue;
+
+            if (node.isLeaf())
+                hits.push_back(BroadphasePair{static_cast<u32>(i), node.userData});
+            else
+            {
+                stack[stackSize++] = node.child1;
+                stack[stackSize++] = node.child2;
+            }
+        }
+    }
+}
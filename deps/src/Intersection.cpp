@@ -1,4 +1,5 @@
 ﻿#include "GPM/ShapeRelation/Intersection.hpp"
+#include "GPM/ShapeRelation/QuadraticSolver.hpp"
 #include <limits>
 
 using namespace GPM;
@@ -7,6 +8,10 @@ bool Intersection::computeDiscriminentAndSolveEquation(float a, float b, float c
 {
     float discriminent = b * b - 4.f * a * c;
 
+    /*the roots come from the shared branchless solver, the branches below only classify them*/
+    float t1, t2;
+    QuadraticSolver::solve(a, 0.5f * b, c, t1, t2);
+
     if(discriminent < -std::numeric_limits<float>::epsilon()) /*no solution*/
     {
         intersection.setNotIntersection();
@@ -18,11 +23,6 @@ bool Intersection::computeDiscriminentAndSolveEquation(float a, float b, float c
         {
             if (discriminent > std::numeric_limits<float>::epsilon()) /*2 intersections with the line*/
             {
-                
-                float rootDiscriminent = std::sqrt(discriminent);
-                float t1 = (-b - rootDiscriminent) / (2.f * a);
-                float t2 = (-b + rootDiscriminent) / (2.f * a);
-
                 /*Check if t1 and t2 is between [0, 1]. So if the intersections belongs to the segment**/
                 if (t1 >= std::numeric_limits<float>::epsilon() && t1 <= 1.f)
                 {
@@ -62,7 +62,7 @@ bool Intersection::computeDiscriminentAndSolveEquation(float a, float b, float c
             }
             else /*1 intersection with the line*/
             {
-                float t = -b / (2.f * a);
+                float t = (t1 + t2) * 0.5f;
 
                 /*Check if t is between [0, 1]. So if the intersection belongs to the segment*/
                 if(t >= std::numeric_limits<float>::epsilon() && t <= 1.f)
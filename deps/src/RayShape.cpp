@@ -0,0 +1,379 @@
+#include "GPM/ShapeRelation/RayShape.hpp"
+#include "GPM/ShapeRelation/QuadraticSolver.hpp"
+#include <limits>
+#include <utility>
+
+using namespace GPM;
+
+/* t is accepted only if it lies in the ray interval, NaN is always rejected */
+static inline bool isInRayRange(const Ray& ray, float t)
+{
+    return t >= ray.tMin && t <= ray.tMax;
+}
+
+/* keep t if it is valid, in the ray interval and closer than the current best.
+ * written as selects so the kernels using it stay branchless */
+static inline void keepClosest(const Ray& ray, float t, bool valid, u32 part, RayHit& best)
+{
+    const bool isCloser = valid & isInRayRange(ray, t) & (t < best.t);
+
+    best.t      = isCloser ? t      : best.t;
+    best.part   = isCloser ? part   : best.part;
+}
+
+/* slab test against the box [min, max] expressed in the same space as origin and dir */
+static bool raycastSlabs(const Ray& ray, const Vec3& origin, const Vec3& dir, const Vec3& min, const Vec3& max, RayHit& hit)
+{
+    float tNear = -std::numeric_limits<float>::infinity();
+    float tFar  = std::numeric_limits<float>::infinity();
+    u32 nearPart = 0u, farPart = 0u;
+
+    for (u32 axis = 0u; axis < 3u; axis++)
+    {
+        /* a null component gives an infinite inverse, which correctly rejects or keeps the whole slab */
+        float invDir = 1.f / dir.e[axis];
+        float t0 = (min.e[axis] - origin.e[axis]) * invDir;
+        float t1 = (max.e[axis] - origin.e[axis]) * invDir;
+        u32 part0 = axis * 2u + 1u;
+        u32 part1 = axis * 2u;
+
+        if (invDir < 0.f)
+        {
+            std::swap(t0, t1);
+            std::swap(part0, part1);
+        }
+
+        if (t0 > tNear)
+        {
+            tNear       = t0;
+            nearPart    = part0;
+        }
+
+        if (t1 < tFar)
+        {
+            tFar    = t1;
+            farPart = part1;
+        }
+    }
+
+    if (tNear > tFar)
+        return false;
+
+    if (isInRayRange(ray, tNear))
+    {
+        hit.t       = tNear;
+        hit.part    = nearPart;
+        return true;
+    }
+
+    /*origin inside the box, the exit face is the one seen by the ray*/
+    if (tNear < ray.tMin && isInRayRange(ray, tFar))
+    {
+        hit.t       = tFar;
+        hit.part    = farPart;
+        return true;
+    }
+
+    return false;
+}
+
+static Vec3 slabNormal(u32 part)
+{
+    Vec3 normal = Vec3::zero();
+    normal.e[part / 2u] = (part & 1u) ? -1.f : 1.f;
+    return normal;
+}
+
+/* roots of the infinite cylinder around [pt1, pt2] restricted to the body, in the ray interval */
+static inline void raycastCylinderBody(const Ray& ray, const Vec3& pt1, const Vec3& pt2, float radius, RayHit& best)
+{
+    const Vec3  ba    = pt2 - pt1;
+    const Vec3  oc    = ray.origin - pt1;
+    const float baba  = Vec3::dot(ba, ba);
+    const float bard  = Vec3::dot(ba, ray.dir);
+    const float baoc  = Vec3::dot(ba, oc);
+
+    /*every term is scaled by baba to avoid normalizing the axis*/
+    const float a = baba * Vec3::dot(ray.dir, ray.dir) - bard * bard;
+    const float b = baba * Vec3::dot(oc, ray.dir) - baoc * bard;
+    const float c = baba * Vec3::dot(oc, oc) - baoc * baoc - radius * radius * baba;
+
+    float t0, t1;
+    /*ray parallel to the axis : only the ends can be hit*/
+    const bool valid = QuadraticSolver::solve(a, b, c, t0, t1) & (a > std::numeric_limits<float>::epsilon());
+
+    const float y0 = baoc + t0 * bard;
+    const float y1 = baoc + t1 * bard;
+
+    keepClosest(ray, t0, valid & (y0 >= 0.f) & (y0 <= baba), RAY_PART_BODY, best);
+    keepClosest(ray, t1, valid & (y1 >= 0.f) & (y1 <= baba), RAY_PART_BODY, best);
+}
+
+/*===== KERNELS =====*/
+/* branchless per ray/shape kernels shared by the single and the batch queries,
+ * best.t is left to infinity when there is no hit */
+
+static inline void raycastSphereKernel(const Ray& ray, const Vec3& center, float radius, RayHit& best)
+{
+    const Vec3 oc = ray.origin - center;
+
+    float t0, t1;
+    /*b is the half of the usual b, this removes the 2 and 4 factors*/
+    const bool valid = QuadraticSolver::solve(Vec3::dot(ray.dir, ray.dir), Vec3::dot(oc, ray.dir), Vec3::dot(oc, oc) - radius * radius, t0, t1);
+
+    /*origin inside the sphere or sphere behind tMin, the second root is the only one left*/
+    best.t      = QuadraticSolver::nearestRoot(t0, t1, valid, ray.tMin, ray.tMax);
+    best.part   = 0u;
+}
+
+static inline void raycastCylinderKernel(const Ray& ray, const Vec3& pt1, const Vec3& pt2, float radius, RayHit& best)
+{
+    best = {};
+    raycastCylinderBody(ray, pt1, pt2, radius, best);
+
+    /*caps : intersection with the end planes inside the disks.
+     *a ray parallel to the caps gives infinite or NaN t that are rejected by the masks*/
+    const Vec3  ba      = pt2 - pt1;
+    const Vec3  oc      = ray.origin - pt1;
+    const float bard    = Vec3::dot(ba, ray.dir);
+    const float baoc    = Vec3::dot(ba, oc);
+    const bool  valid   = std::abs(bard) > std::numeric_limits<float>::epsilon();
+
+    const float t1 = -baoc / bard;
+    const Vec3  q1 = oc + ray.dir * t1;
+    keepClosest(ray, t1, valid & (Vec3::dot(q1, q1) <= radius * radius), RAY_PART_PT1, best);
+
+    const float t2 = (Vec3::dot(ba, ba) - baoc) / bard;
+    const Vec3  q2 = oc + ray.dir * t2 - ba;
+    keepClosest(ray, t2, valid & (Vec3::dot(q2, q2) <= radius * radius), RAY_PART_PT2, best);
+}
+
+static inline void raycastCapsuleKernel(const Ray& ray, const Vec3& pt1, const Vec3& pt2, float radius, RayHit& best)
+{
+    best = {};
+    raycastCylinderBody(ray, pt1, pt2, radius, best);
+
+    /*end spheres : only the half outside of the body is part of the capsule surface*/
+    const Vec3  ba = pt2 - pt1;
+    const float a  = Vec3::dot(ray.dir, ray.dir);
+
+    const Vec3  oc1 = ray.origin - pt1;
+    float t10, t11;
+    const bool valid1 = QuadraticSolver::solve(a, Vec3::dot(oc1, ray.dir), Vec3::dot(oc1, oc1) - radius * radius, t10, t11);
+
+    /*position along the axis, relative to the center of the sphere*/
+    keepClosest(ray, t10, valid1 & (Vec3::dot(ba, oc1 + ray.dir * t10) <= 0.f), RAY_PART_PT1, best);
+    keepClosest(ray, t11, valid1 & (Vec3::dot(ba, oc1 + ray.dir * t11) <= 0.f), RAY_PART_PT1, best);
+
+    const Vec3  oc2 = ray.origin - pt2;
+    float t20, t21;
+    const bool valid2 = QuadraticSolver::solve(a, Vec3::dot(oc2, ray.dir), Vec3::dot(oc2, oc2) - radius * radius, t20, t21);
+
+    keepClosest(ray, t20, valid2 & (Vec3::dot(ba, oc2 + ray.dir * t20) >= 0.f), RAY_PART_PT2, best);
+    keepClosest(ray, t21, valid2 & (Vec3::dot(ba, oc2 + ray.dir * t21) >= 0.f), RAY_PART_PT2, best);
+}
+
+static Vec3 cylinderBodyNormal(const Vec3& pt1, const Vec3& pt2, const Vec3& point)
+{
+    Vec3 ba = pt2 - pt1;
+    Vec3 pa = point - pt1;
+
+    /*rejection of pa on the axis*/
+    return (pa - ba * (Vec3::dot(pa, ba) / Vec3::dot(ba, ba))).normalized();
+}
+
+/*===== SPHERE =====*/
+
+bool RayShape::raycast(const Ray& ray, const Sphere& sphere, RayHit& hit)
+{
+    RayHit best;
+    raycastSphereKernel(ray, sphere.getCenter(), sphere.getRadius(), best);
+
+    if (!best.isHit())
+        return false;
+
+    hit = best;
+    return true;
+}
+
+void RayShape::raycast(const Ray* rays, const Sphere* spheres, RayHit* hits, size_t count)
+{
+    /*the sphere getters are virtual, read them once per block so the kernel loop is only maths*/
+    Vec3  centers[RAY_BATCH_BLOCK];
+    float radii[RAY_BATCH_BLOCK];
+
+    for (size_t first = 0; first < count; first += RAY_BATCH_BLOCK)
+    {
+        const size_t blockCount = count - first < RAY_BATCH_BLOCK ? count - first : RAY_BATCH_BLOCK;
+
+        for (size_t i = 0; i < blockCount; i++)
+        {
+            centers[i]  = spheres[first + i].getCenter();
+            radii[i]    = spheres[first + i].getRadius();
+        }
+
+        for (size_t i = 0; i < blockCount; i++)
+            raycastSphereKernel(rays[first + i], centers[i], radii[i], hits[first + i]);
+    }
+}
+
+Vec3 RayShape::getNormal(const Ray& ray, const Sphere& sphere, const RayHit& hit)
+{
+    return (ray.at(hit.t) - sphere.getCenter()) / sphere.getRadius();
+}
+
+/*===== BOXES =====*/
+
+bool RayShape::raycast(const Ray& ray, const AABB& aabb, RayHit& hit)
+{
+    return raycastSlabs(ray, ray.origin, ray.dir, aabb.center - aabb.extents, aabb.center + aabb.extents, hit);
+}
+
+Vec3 RayShape::getNormal(const Ray& /*ray*/, const AABB& /*aabb*/, const RayHit& hit)
+{
+    return slabNormal(hit.part);
+}
+
+bool RayShape::raycast(const Ray& ray, const OrientedBox& box, RayHit& hit)
+{
+    Referential referential = box.getReferential();
+    Vec3        extents     = {box.getExtI(), box.getExtJ(), box.getExtK()};
+
+    /*the referential is orthonormal, so t is the same in local space*/
+    Vec3 localOrigin    = Referential::globalToLocalPosition(referential, ray.origin);
+    Vec3 localDir       = Referential::globalToLocalVector(referential, ray.dir);
+
+    return raycastSlabs(ray, localOrigin, localDir, -extents, extents, hit);
+}
+
+Vec3 RayShape::getNormal(const Ray& /*ray*/, const OrientedBox& box, const RayHit& hit)
+{
+    return Referential::localToGlobalVector(box.getReferential(), slabNormal(hit.part));
+}
+
+/*===== PLANES =====*/
+
+bool RayShape::raycast(const Ray& ray, const Plane& plane, RayHit& hit)
+{
+    float sub = Vec3::dot(ray.dir, plane.getNormal());
+
+    /*ray parallel to the plane, either no hit or an infinity of them*/
+    if (std::abs(sub) <= std::numeric_limits<float>::epsilon())
+        return false;
+
+    float t = (plane.getDistance() - Vec3::dot(ray.origin, plane.getNormal())) / sub;
+
+    if (!isInRayRange(ray, t))
+        return false;
+
+    hit.t       = t;
+    hit.part    = sub < 0.f ? RAY_PART_FRONT : RAY_PART_BACK;
+    return true;
+}
+
+Vec3 RayShape::getNormal(const Ray& /*ray*/, const Plane& plane, const RayHit& hit)
+{
+    return hit.part == RAY_PART_FRONT ? plane.getNormal() : -plane.getNormal();
+}
+
+bool RayShape::raycast(const Ray& ray, const Quad& quad, RayHit& hit)
+{
+    const Referential& referential = quad.getReferential();
+
+    float sub = Vec3::dot(ray.dir, referential.unitK);
+
+    if (std::abs(sub) <= std::numeric_limits<float>::epsilon())
+        return false;
+
+    Vec3  originToCenter = referential.origin - ray.origin;
+    float t = Vec3::dot(originToCenter, referential.unitK) / sub;
+
+    if (!isInRayRange(ray, t))
+        return false;
+
+    /*projection of the hit point on the quad axis, without building the point*/
+    float projI = t * Vec3::dot(ray.dir, referential.unitI) - Vec3::dot(originToCenter, referential.unitI);
+    float projJ = t * Vec3::dot(ray.dir, referential.unitJ) - Vec3::dot(originToCenter, referential.unitJ);
+
+    if (std::abs(projI) > quad.getExtI() || std::abs(projJ) > quad.getExtJ())
+        return false;
+
+    hit.t       = t;
+    hit.part    = sub < 0.f ? RAY_PART_FRONT : RAY_PART_BACK;
+    return true;
+}
+
+Vec3 RayShape::getNormal(const Ray& /*ray*/, const Quad& quad, const RayHit& hit)
+{
+    return hit.part == RAY_PART_FRONT ? quad.getReferential().unitK : -quad.getReferential().unitK;
+}
+
+/*===== CYLINDERS =====*/
+
+bool RayShape::raycast(const Ray& ray, const Cylinder& cylinder, RayHit& hit)
+{
+    RayHit best;
+    raycastCylinderKernel(ray, cylinder.getSegment().getPt1(), cylinder.getSegment().getPt2(), cylinder.getRadius(), best);
+
+    if (!best.isHit())
+        return false;
+
+    hit = best;
+    return true;
+}
+
+void RayShape::raycast(const Ray* rays, const Cylinder* cylinders, RayHit* hits, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const Segment& segment = cylinders[i].getSegment();
+        raycastCylinderKernel(rays[i], segment.getPt1(), segment.getPt2(), cylinders[i].getRadius(), hits[i]);
+    }
+}
+
+Vec3 RayShape::getNormal(const Ray& ray, const Cylinder& cylinder, const RayHit& hit)
+{
+    const Vec3& pt1 = cylinder.getSegment().getPt1();
+    const Vec3& pt2 = cylinder.getSegment().getPt2();
+
+    switch (hit.part)
+    {
+        case RAY_PART_PT1:  return (pt1 - pt2).normalized();
+        case RAY_PART_PT2:  return (pt2 - pt1).normalized();
+        default:            return cylinderBodyNormal(pt1, pt2, ray.at(hit.t));
+    }
+}
+
+bool RayShape::raycast(const Ray& ray, const Capsule& capsule, RayHit& hit)
+{
+    RayHit best;
+    raycastCapsuleKernel(ray, capsule.getSegment().getPt1(), capsule.getSegment().getPt2(), capsule.getRadius(), best);
+
+    if (!best.isHit())
+        return false;
+
+    hit = best;
+    return true;
+}
+
+void RayShape::raycast(const Ray* rays, const Capsule* capsules, RayHit* hits, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const Segment& segment = capsules[i].getSegment();
+        raycastCapsuleKernel(rays[i], segment.getPt1(), segment.getPt2(), capsules[i].getRadius(), hits[i]);
+    }
+}
+
+Vec3 RayShape::getNormal(const Ray& ray, const Capsule& capsule, const RayHit& hit)
+{
+    const Vec3& pt1 = capsule.getSegment().getPt1();
+    const Vec3& pt2 = capsule.getSegment().getPt2();
+
+    switch (hit.part)
+    {
+        case RAY_PART_PT1:  return (ray.at(hit.t) - pt1) / capsule.getRadius();
+        case RAY_PART_PT2:  return (ray.at(hit.t) - pt2) / capsule.getRadius();
+        default:            return cylinderBodyNormal(pt1, pt2, ray.at(hit.t));
+    }
+}
@@ -0,0 +1,157 @@
+#include "GPM/Broadphase/SweepAndPrune.hpp"
+
+#include <algorithm>
+#include <limits>
+
+using namespace GPM;
+
+/* above this ratio of changed proxies the insertion sort is replaced by a full sort */
+#define SAP_FULL_SORT_RATIO 16u
+
+
+BroadphaseHandle SweepAndPrune::insert(const Bounds& bounds, u32 userData)
+{
+    BroadphaseHandle handle;
+    if (m_freeHandles.empty())
+    {
+        handle = static_cast<BroadphaseHandle>(m_bounds.size());
+        m_bounds.push_back(bounds);
+        m_userData.push_back(userData);
+    }
+    else
+    {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+        m_bounds[handle]    = bounds;
+        m_userData[handle]  = userData;
+    }
+
+    m_order.push_back(handle);
+    m_changedCount++;
+    m_isSorted = false;
+    return handle;
+}
+
+
+void SweepAndPrune::move(BroadphaseHandle handle, const Bounds& bounds)
+{
+    m_bounds[handle] = bounds;
+    m_changedCount++;
+    m_isSorted = false;
+}
+
+
+void SweepAndPrune::remove(BroadphaseHandle handle)
+{
+    /* the handle sorts to the end of m_order where the next sort drops it */
+    m_bounds[handle].min.x = std::numeric_limits<float>::infinity();
+    m_removedHandles.push_back(handle);
+    m_changedCount++;
+    m_isSorted = false;
+}
+
+
+void SweepAndPrune::clear()
+{
+    m_bounds.clear();
+    m_userData.clear();
+    m_freeHandles.clear();
+    m_removedHandles.clear();
+    m_order.clear();
+    m_sortedBounds.clear();
+    m_sortedUserData.clear();
+    m_changedCount  = 0u;
+    m_maxWidthX     = 0.f;
+    m_isSorted      = true;
+}
+
+
+void SweepAndPrune::sort()
+{
+    if (m_isSorted)
+        return;
+
+    const std::vector<Bounds>& bounds = m_bounds;
+    if (m_changedCount * SAP_FULL_SORT_RATIO > m_order.size())
+    {
+        std::sort(m_order.begin(), m_order.end(), [&](BroadphaseHandle lhs, BroadphaseHandle rhs)
+        {
+            return bounds[lhs].min.x < bounds[rhs].min.x;
+        });
+    }
+    else
+    {
+        for (size_t i = 1u; i < m_order.size(); i++)
+        {
+            const BroadphaseHandle handle = m_order[i];
+            const float minX = bounds[handle].min.x;
+
+            size_t j = i;
+            for (; j > 0u && bounds[m_order[j - 1u]].min.x > minX; j--)
+                m_order[j] = m_order[j - 1u];
+            m_order[j] = handle;
+        }
+    }
+
+    /* removed handles are at the end, they can be reused now */
+    m_order.resize(m_order.size() - m_removedHandles.size());
+    m_freeHandles.insert(m_freeHandles.end(), m_removedHandles.begin(), m_removedHandles.end());
+    m_removedHandles.clear();
+
+    m_sortedBounds.resize(m_order.size());
+    m_sortedUserData.resize(m_order.size());
+    m_maxWidthX = 0.f;
+    for (size_t i = 0u; i < m_order.size(); i++)
+    {
+        m_sortedBounds[i]   = bounds[m_order[i]];
+        m_sortedUserData[i] = m_userData[m_order[i]];
+        m_maxWidthX         = std::max(m_maxWidthX, m_sortedBounds[i].max.x - m_sortedBounds[i].min.x);
+    }
+
+    m_changedCount  = 0u;
+    m_isSorted      = true;
+}
+
+
+void SweepAndPrune::findPairs(std::vector<BroadphasePair>& pairs)
+{
+    sort();
+    pairs.clear();
+
+    const size_t count = m_sortedBounds.size();
+    for (size_t i = 0u; i < count; i++)
+    {
+        const Bounds& bounds = m_sortedBounds[i];
+
+        /* proxies after i start after bounds.min.x, they overlap on x until one starts after bounds.max.x */
+        for (size_t j = i + 1u; j < count && m_sortedBounds[j].min.x <= bounds.max.x; j++)
+        {
+            const Bounds& other = m_sortedBounds[j];
+            if ((bounds.min.y <= other.max.y) & (other.min.y <= bounds.max.y) &
+                (bounds.min.z <= other.max.z) & (other.min.z <= bounds.max.z))
+                pairs.push_back(BroadphasePair{m_sortedUserData[i], m_sortedUserData[j]});
+        }
+    }
+}
+
+
+void SweepAndPrune::query(const Bounds* queries, size_t count, std::vector<BroadphasePair>& hits)
+{
+    sort();
+    hits.clear();
+
+    auto isBefore = [](const Bounds& bounds, float x) { return bounds.min.x < x; };
+
+    for (size_t i = 0u; i < count; i++)
+    {
+        const Bounds& query = queries[i];
+
+        /* no proxy starting before query.min.x - m_maxWidthX can reach the query */
+        auto first = std::lower_bound(m_sortedBounds.begin(), m_sortedBounds.end(), query.min.x - m_maxWidthX, isBefore);
+        for (size_t j = first - m_sortedBounds.begin(); j < m_sortedBounds.size() && m_sortedBounds[j].min.x <= query.max.x; j++)
+        {
+            if (m_sortedBounds[j].overlaps(query))
+                hits.push_back(BroadphasePair{static_cast<u32>(i), m_sortedUserData[j]});
+        }
+    }
+}
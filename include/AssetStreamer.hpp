@@ -0,0 +1,77 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "DX12Helper.hpp"
+
+class DX12Handle;
+
+/* a model loaded in the background, usable from the main thread once it is not STATE_LOADING anymore */
+struct StreamedModel
+{
+	enum EState
+	{
+		STATE_LOADING = 0,
+		STATE_PLACEHOLDER,	/* the meshes are there, every texture is the black one */
+		STATE_READY,
+		STATE_FAILED
+	};
+
+	std::string						filePath;
+	EState							state = STATE_LOADING;
+
+	/* only changed by AssetStreamer::Update, the owner may change the rest (trs) */
+	std::vector<DX12Helper::Model>	models;
+
+	/* filled by the loading thread, released with the model. The heaps of the placeholder are kept
+	 * as the frames in flight may still use them when the real ones are swapped in */
+	std::vector<ID3D12DescriptorHeap*>	placeholderHeaps;
+	std::vector<ID3D12DescriptorHeap*>	textureHeaps;
+	std::vector<ID3D12Resource*>		textures;
+	std::vector<ID3D12Resource*>		vertexBuffers;
+
+	~StreamedModel();
+};
+
+/* Loads models on the WorkerPool while the frames go on. LoadModel returns at once, a job then loads the model in two steps,
+ * each one waiting on the fence of its own upload :
+ * - the baked cache and the meshes, drawn with the black texture of UploadPlaceholderTexture in every slot
+ * - the images, swapped in the materials once uploaded
+ * The steps are handed to the main thread by Update so that the models drawn are never written by another thread.
+ * The uploads are recorded with their own command allocator and go to the queue of the frames. */
+class AssetStreamer
+{
+public:
+
+	AssetStreamer(const DX12Handle& dx12Handle_);
+	AssetStreamer(const AssetStreamer&) = delete;
+	AssetStreamer& operator=(const AssetStreamer&) = delete;
+
+	/* waits for the jobs in flight, their remaining steps are dropped */
+	~AssetStreamer();
+
+	/* see DX12Helper::UploadModel for staticBatching */
+	std::shared_ptr<StreamedModel> LoadModel(const std::string& filePath, bool staticBatching = false);
+
+	/* applies the steps finished since the last call, on the main thread before drawing. True when a model changed */
+	bool Update();
+
+private:
+
+	ID3D12Device*		device	= nullptr;
+	ID3D12CommandQueue*	queue	= nullptr;
+
+	std::mutex							mutex;
+	std::condition_variable				jobsCondition;
+	std::vector<std::function<void()>>	finishedSteps;
+	unsigned int						jobCount	= 0;
+	bool								isStopping	= false;
+
+	bool Stream(const std::shared_ptr<StreamedModel>& streamedModel, bool staticBatching);
+	void Finish(std::function<void()> step);
+};
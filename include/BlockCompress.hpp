@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* CPU encoders for the BC block compressed formats, a 4x4 texels block is turned into 8 or 16 bytes
+ * read by the gpu as is (4 to 8 times less memory than rgba8 texels).
+ * The endpoints are fitted on the principal axis of the block then refined by least squares,
+ * good enough for a bake done once, not meant to compete with the offline compressors. */
+namespace BlockCompress
+{
+	enum EFormat : uint32_t
+	{
+		FORMAT_NONE	= 0,	/* not compressed */
+		FORMAT_BC1	= 1,	/* rgb 5:6:5 endpoints, 4 colors, 8 bytes */
+		FORMAT_BC4	= 2,	/* one channel, 8 values, 8 bytes */
+		FORMAT_BC5	= 3,	/* two BC4 channels (red green), 16 bytes */
+		FORMAT_BC7	= 4		/* rgba, only mode 6 (one subset, 7 bits endpoints with p-bit, 16 values), 16 bytes */
+	};
+
+	/* bytes of a 4x4 block, 0 for FORMAT_NONE */
+	uint32_t GetBlockSize(EFormat format);
+
+	/* bytes of a row of blocks and of a whole level, the sizes that are not multiple of 4 are padded to a block */
+	size_t GetRowPitch(uint32_t width, EFormat format);
+	size_t GetLevelSize(uint32_t width, uint32_t height, EFormat format);
+
+	/* one block, texels are the 16 rgba texels of the block in rows, values the 16 values of a channel */
+	void EncodeBC1(const uint8_t texels[64], uint8_t block[8]);
+	void EncodeBC4(const uint8_t values[16], uint8_t block[8]);
+	void EncodeBC5(const uint8_t reds[16], const uint8_t greens[16], uint8_t block[16]);
+	void EncodeBC7(const uint8_t texels[64], uint8_t block[16]);
+
+	/* a whole level of rgba texels, BC4 keeps the red channel and BC5 red and green.
+	 * The texels out of the image in the last blocks repeat the edges. The rows of blocks are split over the worker pool. */
+	void Encode(const uint8_t* src, size_t srcRowPitch, uint32_t width, uint32_t height, EFormat format, uint8_t* dst, size_t dstRowPitch);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/* Writing of the cache files (meshes, textures, shaders, pipelines) : the bytes go to a file beside the cache,
+ * renamed over it once complete, so that a crash while writing never leaves a truncated cache.
+ * Nothing depends on the gpu. */
+namespace CacheFile
+{
+	/* false when the file could not be written, the cache left at filePath is then the previous one, if any */
+	bool Write(const std::string& filePath, const void* data, size_t size);
+}
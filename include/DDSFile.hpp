@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Reading of dds files in place, from a mapping (see MeshCache::MappedFile) : the headers are parsed where they are,
+ * then each subresource is copied straight from the file into its footprint in the upload buffer, without
+ * the copy of the whole file and the subresources table of DDSTextureLoader.
+ * Both headers are read : the legacy one with the formats of its pixel format (DXT, ATI, D3DFMT numbers, masks)
+ * and the DX10 one. The footprints follow the rules of ID3D12Device::GetCopyableFootprints.
+ * Nothing depends on the gpu. */
+namespace DDSFile
+{
+	#define DDS_MAGIC				0x20534444u /* "DDS " */
+	#define DDS_FOURCC_DX10			0x30315844u /* "DX10" */
+
+	/* the values of D3D12_RESOURCE_DIMENSION, as written in the DX10 header */
+	#define DDS_DIMENSION_TEXTURE1D	2u
+	#define DDS_DIMENSION_TEXTURE2D	3u
+	#define DDS_DIMENSION_TEXTURE3D	4u
+
+	/* D3D12_TEXTURE_DATA_PITCH_ALIGNMENT and D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT */
+	#define DDS_FOOTPRINT_PITCH_ALIGNMENT		256u
+	#define DDS_FOOTPRINT_PLACEMENT_ALIGNMENT	512u
+
+	struct PixelFormat
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t fourCC;
+		uint32_t rgbBitCount;
+		uint32_t masks[4];
+	};
+
+	struct Header
+	{
+		uint32_t	size;
+		uint32_t	flags;
+		uint32_t	height;
+		uint32_t	width;
+		uint32_t	pitchOrLinearSize;
+		uint32_t	depth;
+		uint32_t	mipMapCount;
+		uint32_t	reserved1[11];
+		PixelFormat	pixelFormat;
+		uint32_t	caps[4];
+		uint32_t	reserved2;
+	};
+
+	struct HeaderDX10
+	{
+		uint32_t dxgiFormat;
+		uint32_t resourceDimension;
+		uint32_t miscFlag;
+		uint32_t arraySize;
+		uint32_t miscFlags2;
+	};
+
+	/* what the file holds, whatever its header */
+	struct Desc
+	{
+		uint32_t	dimension	= DDS_DIMENSION_TEXTURE2D;
+		uint32_t	dxgiFormat	= 0;	/* a DXGI_FORMAT value */
+		uint32_t	width		= 0;
+		uint32_t	height		= 1;
+		uint32_t	depth		= 1;	/* of a volume, 1 otherwise */
+		uint32_t	arraySize	= 1;	/* six per cube */
+		uint32_t	mipCount	= 1;
+		bool		isCube		= false;
+	};
+
+	/* a subresource in the file, its rows of texels (or of 4x4 blocks) packed one after another */
+	struct Surface
+	{
+		size_t		offset;		/* from the start of the file */
+		size_t		rowSize;
+		uint32_t	rowCount;	/* of one slice */
+		uint32_t	depth;		/* slices of the level of a volume, 1 otherwise */
+	};
+
+	/* a subresource in the upload buffer, as D3D12_PLACED_SUBRESOURCE_FOOTPRINT */
+	struct Footprint
+	{
+		uint64_t	offset;
+		uint32_t	width;		/* whole blocks for the block formats */
+		uint32_t	height;
+		uint32_t	depth;
+		uint32_t	rowPitch;
+	};
+
+	/* bits per texel, or bytes per 4x4 block when isBlock. False for the formats not read (video, packed, 1 bit) */
+	bool GetFormatSize(uint32_t dxgiFormat, uint32_t& size, bool& isBlock);
+
+	/* the layout of one level, rowSize and rowCount are of the whole blocks for the block formats */
+	bool GetSurfaceSize(uint32_t dxgiFormat, uint32_t width, uint32_t height, size_t& rowSize, uint32_t& rowCount);
+
+	/* check the headers and that the file holds every subresource, surfaces are in the order of D3D12CalcSubresource
+	 * (mips of the first array slice or face, then of the next one) */
+	bool Parse(const uint8_t* data, size_t size, Desc& desc, std::vector<Surface>& surfaces);
+
+	/* the footprints of every subresource from offset 0, returns the size the upload buffer needs.
+	 * The upload takes the ones of the device, these are checked against them in the debug builds */
+	uint64_t GetFootprints(const Desc& desc, std::vector<Footprint>& footprints);
+
+	/* copy the rows of surface from the file to its footprint, dst being the start of the mapped upload buffer */
+	void CopySurface(const uint8_t* data, const Surface& surface, const Footprint& footprint, uint8_t* dst);
+}
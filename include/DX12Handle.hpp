@@ -1,12 +1,18 @@
 #ifndef __D3D12_HANDLE__
 #define __D3D12_HANDLE__
 
+#include <memory>
 #include <vector>
 #include <d3dx12.h>
 #include <dxgi1_6.h>
 
 struct GLFWwindow;
 
+namespace DX12Helper
+{
+	class PipelineStateCache;
+}
+
 
 struct DX12Contextual
 {
@@ -50,6 +56,9 @@ class DX12Handle
 		HANDLE										_fenceEvent;
 		D3D12_RESOURCE_BARRIER						_barrier				= {};
 
+		/* the root signatures and pipeline states of the demos go through it */
+		std::unique_ptr<DX12Helper::PipelineStateCache>	_pipelineCache;
+
 
 		DX12Contextual _context;
 
@@ -74,6 +83,7 @@ class DX12Handle
 		bool MakeDepthBuffer(unsigned int windowWidth, unsigned int windowHeight);
 		bool CreateCmdObjects(unsigned int bufferCount);
 		bool CreateFenceObjects(unsigned int bufferCount);
+		bool CreatePipelineCache();
 };
 
 #endif /* __D3D12_HANDLE__*/
\ No newline at end of file
@@ -12,12 +12,25 @@
 
 class DX12Handle;
 
-namespace tinygltf
+namespace MeshCache
 {
-	class Model;
+	struct View;
+}
+
+namespace StaticBatch
+{
+	struct Arena;
+}
+
+namespace VertexLayout
+{
+	struct Layout;
 }
 
 #include "GPM/Transform.hpp"
+#include "Meshlets.hpp"
+#include "MipChain.hpp"
+#include "PipelineCache.hpp"
 
 namespace DX12Helper
 {
@@ -26,6 +39,57 @@ namespace DX12Helper
 	bool CompileVertex(const std::string& shaderSource_, ID3DBlob** VS_, D3D12_SHADER_BYTECODE& shader_);
 	bool CompilePixel(const std::string& shaderSource_, ID3DBlob** PS_, D3D12_SHADER_BYTECODE& shader_);
 
+	/* Pipeline */
+
+	/* the d3d12 side of the pipeline cache, the desc given to Create is a serialized root signature (ID3DBlob) */
+	class RootSignatureDevice : public PipelineCache::Device
+	{
+	public:
+
+		ID3D12Device*	device		= nullptr;
+		HRESULT			lastResult	= S_OK;
+
+		void* Create(const void* desc, const std::vector<uint8_t>& blob, std::vector<uint8_t>& createdBlob) override;
+		void Release(void* object) override;
+	};
+
+	/* the desc given to Create is a D3D12_GRAPHICS_PIPELINE_STATE_DESC */
+	class PipelineStateDevice : public PipelineCache::Device
+	{
+	public:
+
+		ID3D12Device*	device		= nullptr;
+		HRESULT			lastResult	= S_OK;
+
+		void* Create(const void* desc, const std::vector<uint8_t>& blob, std::vector<uint8_t>& createdBlob) override;
+		void Release(void* object) override;
+	};
+
+	/* the root signatures and pipeline states of the demos, shared when their content is the same (see PipelineCache.hpp).
+	 * A pipeline state is keyed by its root signature, its shader bytecodes and every state of its desc, the root signature
+	 * has to come from CreateRootSignature. The objects returned hold a reference of their own, the demos release them as before.
+	 * The driver blobs of the pipelines are read from filePath, and written back there on destruction */
+	class PipelineStateCache
+	{
+	public:
+
+		PipelineStateCache(ID3D12Device* device_, const std::string& filePath_);
+		PipelineStateCache(const PipelineStateCache&) = delete;
+		PipelineStateCache& operator=(const PipelineStateCache&) = delete;
+		~PipelineStateCache();
+
+		HRESULT CreateRootSignature(ID3DBlob* serialized_, ID3D12RootSignature** rootSignature_);
+		HRESULT CreatePipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc_, ID3D12PipelineState** pso_);
+
+	private:
+
+		std::string				filePath;
+		RootSignatureDevice		rootSignatureDevice;
+		PipelineStateDevice		pipelineStateDevice;
+		PipelineCache::Cache	rootSignatures;
+		PipelineCache::Cache	pipelineStates;
+	};
+
 	/* Resources */
 
 	struct DefaultResource
@@ -45,8 +109,23 @@ namespace DX12Helper
 		~DefaultResourceUploader();
 	};
 
+	/* records with the allocator of the current frame and waits on the event of the frames */
 	bool MakeUploader(DefaultResourceUploader& uploader_, const DX12Handle& dx12Handle_);
+	/* for the uploads made away from the frames, on another thread (see AssetStreamer) */
+	bool MakeUploader(DefaultResourceUploader& uploader_, ID3D12Device* device_, ID3D12CommandQueue* queue_, ID3D12CommandAllocator* allocator_,
+					  HANDLE const* fenceEvent_);
 	bool CreateDefaultBuffer(D3D12_SUBRESOURCE_DATA* bufferData_, DefaultResource& resourceData_, DefaultResourceUploader& uploader_);
+
+	/* a part of a default buffer, copied from data to offset in the upload heap */
+	struct BufferPiece
+	{
+		const void*	data;
+		UINT64		size;
+		UINT64		offset;
+	};
+
+	/* one buffer of size bytes gathered from its pieces, the bytes between them are left undefined */
+	bool CreateDefaultBuffer(const BufferPiece* pieces_, UINT pieceCount_, UINT64 size_, DefaultResource& resourceData_, DefaultResourceUploader& uploader_);
 	bool UploadResources(const DefaultResourceUploader& uploader_);
 
 	struct ConstantResourceUploader
@@ -78,20 +157,31 @@ namespace DX12Helper
 
 		D3D12_SUBRESOURCE_DATA texData;
 
+		/* channels per pixel of texData when they have to be converted to the texture format
+		 * while copied to the upload heap, 0 copies texData as is */
+		UINT srcChannels = 0;
+
+		/* mips 1 and after when the texture has more than one, generated from texData when empty */
+		std::vector<D3D12_SUBRESOURCE_DATA> mipData;
+		MipChain::EUsage					mipUsage = MipChain::USAGE_COLOR;
+
 		~TextureResource();
 	};
 
 
 	/* Texture */
-	void LoadTexture(const std::string& filePath_, D3D12_SUBRESOURCE_DATA& texData, D3D12_RESOURCE_DESC& texDesc_);
+	void LoadTexture(const std::string& filePath_, D3D12_SUBRESOURCE_DATA& texData, D3D12_RESOURCE_DESC& texDesc_, UINT& srcChannels_);
 	bool CreateTexture(const std::string& filePath_, TextureResource& resourceData_, DefaultResourceUploader& uploader_);
 
-	/* assumes data is already filled up in resourceData_.texData*/
+	/* assumes data is already filled up in resourceData_.texData (and resourceData_.srcChannels when it needs a conversion) */
 	bool CreateRawTexture(const D3D12_RESOURCE_DESC& texDesc_, TextureResource& resourceData_, DefaultResourceUploader& uploader_);
 
 	/* DDS Texture */
 	bool CreateDDSTexture(const std::string& filePath_, TextureResource& resourceData_, DefaultResourceUploader& uploader_);
 
+	/* creates and records the upload of a dds file without making its view */
+	bool UploadDDSTexture(const std::string& filePath_, TextureResource& resourceData_, DefaultResourceUploader& uploader_, bool* isCube_ = nullptr);
+
 	/* Model */
 
 	/* this will be used to represent a model */
@@ -109,8 +199,39 @@ namespace DX12Helper
 		ID3D12Resource*							indexBuffer;
 		D3D12_INDEX_BUFFER_VIEW					iBufferView;
 
+		/* index of its material in the descHeaps of the ModelResource */
+		int32_t									material = -1;
+
 		UINT count = 0;
 
+		/* simplified indices drawn with the same vertex buffers, see SelectLod */
+		struct Lod
+		{
+			D3D12_INDEX_BUFFER_VIEW	iBufferView;
+			UINT					count = 0;
+			float					error = 0.f;	/* in model space */
+		};
+		std::vector<Lod>						lods;
+
+		/* dequantization of the vertex streams, see GetModelInputLayout */
+		GPM::Vec3								positionScale	= { 1.f, 1.f, 1.f };
+		GPM::Vec3								positionOffset	= {};
+		GPM::Vec4								uvScaleOffset	= { 1.f, 1.f, 0.f, 0.f };
+
+		/* bounding sphere in model space */
+		GPM::Vec3								center = {};
+		float									radius = 0.f;
+
+		/* clusters of the full mesh, culled on the cpu into a compacted index list (see Meshlets::Cull).
+		 * The offsets of the meshlets are in the two arrays of the model */
+		std::vector<Meshlets::Meshlet>			meshlets;
+		std::vector<uint32_t>					meshletVertices;
+		std::vector<uint8_t>					meshletTriangles;
+
+		/* world transforms of the nodes drawing the primitive, one instance each, in the MODEL_SLOT_INSTANCES slot.
+		 * trs is applied over all of them, see GetInstanceWorld */
+		std::vector<GPM::Mat4>					instances;
+
 		GPM::Transform trs;
 	};
 
@@ -127,12 +248,40 @@ namespace DX12Helper
 
 
 
-	/* used to load a gltf2.0 model onto the GPU
-	 * /!\ this method will merge all the mesh and pre-transform all the vertices /!\ */
-	bool UploadModel(const std::string& filePath, ModelResource& modelResource, DefaultResourceUploader& uploader_);
-
-	bool UploadMesh(const tinygltf::Model& gltfModel, ModelResource& modelResource, DefaultResourceUploader& uploader_);
-	bool UploadMeshBuffer(const tinygltf::Model& gltfModel, ModelResource& modelResource, DefaultResourceUploader& uploader_);
-	bool UploadTextureBuffer(const tinygltf::Model& gltfModel, ModelResource& modelResource, DefaultResourceUploader& uploader_);
-	bool UploadTexture(const tinygltf::Model& gltfModel, ModelResource& modelResource, DefaultResourceUploader& uploader_);
+	/* used to load a gltf2.0 model (.gltf or .glb) onto the GPU, through the baked cache next to it (see MeshCache.hpp).
+	 * One model per primitive of the scene, drawn once per node using its mesh.
+	 * With staticBatching, the primitives drawn by few nodes are pre-transformed and merged into one model per material instead
+	 * (see StaticBatch.hpp), their vertices are then in world space */
+	bool UploadModel(const std::string& filePath, ModelResource& modelResource, DefaultResourceUploader& uploader_, bool staticBatching = false);
+
+	/* the primitives merged in arena, if any, are left to UploadBatch */
+	bool UploadMesh(const MeshCache::View& view, ModelResource& modelResource, DefaultResourceUploader& uploader_, const StaticBatch::Arena* arena = nullptr);
+	bool UploadBatch(const MeshCache::View& view, const StaticBatch::Arena& arena, ModelResource& modelResource);
+
+	/* the vBufferViews slots of the models */
+	#define MODEL_SLOT_VERTICES		0u
+	#define MODEL_SLOT_INSTANCES	1u
+	#define MODEL_SLOT_COUNT		2u
+
+	/* the attributes of layout interleaved in the MODEL_SLOT_VERTICES slot : POSITION as 4 unorm16 and UV0 as 2 unorm16, both to
+	 * scale and offset with the model (position * positionScale + positionOffset, uv * uvScaleOffset.xy + uvScaleOffset.zw),
+	 * NORMAL as 2 snorm16 of an octahedral mapping, TANGENT as 4 snorm8, COLOR as 4 unorm8 and UV1 as 2 halves.
+	 * See VertexLayout.hpp for the encoding. WORLD0 to WORLD3 are the rows of the world transform of the instance,
+	 * read per instance from the MODEL_SLOT_INSTANCES slot. The returned desc points into elements */
+	D3D12_INPUT_LAYOUT_DESC GetModelInputLayout(const VertexLayout::Layout& layout, std::vector<D3D12_INPUT_ELEMENT_DESC>& elements);
+
+	/* the transform of the given instance of the model, its node then the trs of the model */
+	GPM::Mat4 GetInstanceWorld(const Model& model, UINT instance);
+
+	/* the coarsest level of detail of the model whose error, seen from eyePos, stays under maxPixelError pixels once moved by world.
+	 * projectionScale is the viewport height divided by 2 * tan(fovY / 2). 0 is the full mesh, n is model.lods[n - 1] */
+	UINT SelectLod(const Model& model, const GPM::Mat4& world, const GPM::Vec3& eyePos, float projectionScale, float maxPixelError);
+	/* only the ranges of the cache buffers the primitives read are uploaded, packed in one buffer (see MeshCache::GetUploadRanges).
+	 * The primitives merged in arena, if any, are not read, give the same arena to UploadMesh */
+	bool UploadMeshBuffer(const MeshCache::View& view, ModelResource& modelResource, DefaultResourceUploader& uploader_, const StaticBatch::Arena* arena = nullptr);
+	bool UploadBatchBuffer(const MeshCache::View& view, const StaticBatch::Arena& arena, ModelResource& modelResource, DefaultResourceUploader& uploader_);
+	/* the black 1x1 texture, first of the textures, standing for the images a material does not have or that are not uploaded yet */
+	bool UploadPlaceholderTexture(const MeshCache::View& view, ModelResource& modelResource, DefaultResourceUploader& uploader_);
+	bool UploadTextureBuffer(const MeshCache::View& view, ModelResource& modelResource, DefaultResourceUploader& uploader_);
+	bool UploadTexture(const MeshCache::View& view, ModelResource& modelResource, DefaultResourceUploader& uploader_);
 }
\ No newline at end of file
@@ -3,8 +3,11 @@
 #include "Camera.hpp"
 #include "Demo.hpp"
 #include <array>
+#include <memory>
 
+class AssetStreamer;
 class DX12Handle;
+struct StreamedModel;
 struct ID3D12RootSignature;
 
 namespace DX12Helper
@@ -23,6 +26,9 @@ public:
 
 	void UpdateAndRender(const DemoInputs& inputs_) final;
 
+	/* fills the caches of the model from any thread, before the demo is built (see DemoRegistry) */
+	static void WarmUp();
+
 	inline const char* Name() const final { return typeid(*this).name(); }
 
 private:
@@ -33,19 +39,25 @@ private:
 
 
 
+	ID3D12Device*											_device = nullptr;
 	std::array<ID3D12DescriptorHeap*, FRAME_BUFFER_COUNT>	_descHeaps;
 	std::vector<DX12Helper::ConstantResource>				_constantBuffers;
 
-	std::vector<ID3D12DescriptorHeap*>	_texDescriptorHeap;
-	std::vector<ID3D12Resource*>		_textureResources;
-	std::vector<ID3D12Resource*>		_vBuffers;
+	/* the model is loaded in the background, owning the gpu resources, _models is a copy taken when it changes */
+	std::unique_ptr<AssetStreamer>		_streamer;
+	std::shared_ptr<StreamedModel>		_streamedModel;
 	
 	std::vector<DX12Helper::Model>		_models;
 
+	/* the heap of the last draw, the models sharing their material do not bind it again */
+	ID3D12DescriptorHeap*				_boundDescHeap = nullptr;
+
 	D3D12_VIEWPORT viewport		= {};
 	D3D12_RECT     scissorRect	= {};
 
 	bool MakeModel(const DX12Handle& dx12Handle_);
+	bool MakeConstantBuffers();
+	void ApplyStreamedModel();
 	bool MakeShader(D3D12_SHADER_BYTECODE& vertex, D3D12_SHADER_BYTECODE& pixel);
 	bool MakePipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_BYTECODE& vertex, D3D12_SHADER_BYTECODE& pixel);
 
@@ -2,9 +2,13 @@
 
 #include "Camera.hpp"
 #include "Demo.hpp"
+#include "Meshlets.hpp"
 #include <array>
+#include <memory>
 
+class AssetStreamer;
 class DX12Handle;
+struct StreamedModel;
 struct ID3D12RootSignature;
 
 namespace DX12Helper
@@ -23,6 +27,9 @@ public:
 
 	void UpdateAndRender(const DemoInputs& inputs_) final;
 
+	/* fills the caches of the model from any thread, before the demo is built (see DemoRegistry) */
+	static void WarmUp();
+
 	inline const char* Name() const final { return typeid(*this).name(); }
 
 private:
@@ -32,15 +39,29 @@ private:
 	ID3D12RootSignature* _rootSignature = nullptr;
 	ID3D12PipelineState* _pso			= nullptr;
 
+	ID3D12Device*											_device = nullptr;
 	std::array<ID3D12DescriptorHeap*, FRAME_BUFFER_COUNT>	_descHeaps;
 	std::vector<DX12Helper::ConstantResource>				_constantBuffers;
 
-	std::vector<ID3D12DescriptorHeap*>	_texDescriptorHeap;
-	std::vector<ID3D12Resource*>		_textureResources;
-	std::vector<ID3D12Resource*>		_vBuffers;
+	/* the model is loaded in the background, owning the gpu resources, _models is a copy taken when it changes */
+	std::unique_ptr<AssetStreamer>		_streamer;
+	std::shared_ptr<StreamedModel>		_streamedModel;
 
 	std::vector<DX12Helper::Model>		_models;
 
+	/* the heap of the last draw, the models sharing their material do not bind it again */
+	ID3D12DescriptorHeap*				_boundDescHeap = nullptr;
+
+	/* screen space error, in pixels, allowed when picking the level of detail of the models */
+	float _lodPixelError = 1.f;
+
+	/* the indices of the meshlets left by the cpu culling, written every frame in a persistently mapped upload buffer per frame */
+	std::array<ID3D12Resource*, FRAME_BUFFER_COUNT>	_culledIndexBuffers = {};
+	std::array<uint32_t*, FRAME_BUFFER_COUNT>		_culledIndices		= {};
+
+	bool						_clusterCulling = true;
+	Meshlets::CullStatistics	_cullStatistics;
+
 	/* model info */
 	ID3D12RootSignature* _skyBoxRootSignature	= nullptr;
 	ID3D12PipelineState* _skyBoxPso				= nullptr;
@@ -57,6 +78,9 @@ private:
 	bool MakeModel(const DX12Handle& dx12Handle_);
 	bool MakeModelShader(D3D12_SHADER_BYTECODE& vertex, D3D12_SHADER_BYTECODE& pixel);
 	bool MakeModelPipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_BYTECODE& vertex, D3D12_SHADER_BYTECODE& pixel);
+	bool MakeCulledIndexBuffers();
+	bool MakeConstantBuffers();
+	void ApplyStreamedModel();
 
 	bool MakeSkyBox(const DX12Handle& dx12Handle_);
 	bool MakeSkyBoxShader(D3D12_SHADER_BYTECODE& vertex, D3D12_SHADER_BYTECODE& pixel);
@@ -66,6 +90,8 @@ private:
 	void Update(const DemoInputs& inputs_);
 	void Render(const DemoInputs& inputs_);
 
-	void DrawModel(ID3D12GraphicsCommandList4* cmdList, const DX12Helper::Model& model);
+	/* the instances are the nodes of the model, culledIndices, when given, replaces the indices of the full mesh */
+	void DrawModel(ID3D12GraphicsCommandList4* cmdList, const DX12Helper::Model& model, UINT lod, UINT firstInstance, UINT instanceCount,
+				   const D3D12_INDEX_BUFFER_VIEW* culledIndices = nullptr, UINT culledCount = 0);
 	void DrawSkyBox(ID3D12GraphicsCommandList4* cmdList, int frameIndex);
 };
\ No newline at end of file
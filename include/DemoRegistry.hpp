@@ -0,0 +1,73 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "Demo.hpp"
+
+class DX12Handle;
+
+/* The demos known by the application, each one built the first time it is shown : a demo compiles its shaders
+ * and uploads its assets in its constructor, the ones never opened cost nothing.
+ * A demo may come with a warm up, the work of its loading that does not need the device (filling the mesh and
+ * texture caches), run on the WorkerPool by WarmUp so that opening the demo later only maps the caches.
+ * The demos themselves are built on the main thread, out of the recording of a frame (see Get). */
+class DemoRegistry
+{
+public:
+
+	using Factory	= std::function<std::unique_ptr<Demo>(const DemoInputs&, const DX12Handle&)>;
+	using Warmer	= std::function<void()>;
+
+	DemoRegistry(const DemoInputs& inputs_, const DX12Handle& dx12Handle_);
+	DemoRegistry(const DemoRegistry&) = delete;
+	DemoRegistry& operator=(const DemoRegistry&) = delete;
+
+	/* waits for the warm ups in flight */
+	~DemoRegistry();
+
+	/* name is the label of the demo in the picker, built or not */
+	template <typename T>
+	void Add(const char* name, Warmer warmUp = nullptr)
+	{
+		Add(name, [](const DemoInputs& inputs_, const DX12Handle& dx12Handle_) { return std::unique_ptr<Demo>(std::make_unique<T>(inputs_, dx12Handle_)); },
+			std::move(warmUp));
+	}
+
+	void Add(const char* name, Factory factory, Warmer warmUp = nullptr);
+
+	/* queue the warm ups of the demos not built yet, once */
+	void WarmUp();
+
+	int Size() const { return static_cast<int>(entries.size()); }
+	const char* GetName(int id) const;
+	bool IsBuilt(int id) const;
+
+	/* builds the demo on its first call. It uploads with the allocator of the current frame :
+	 * call it between DX12Handle::WaitForPrevFrame and DX12Handle::StartDrawing */
+	Demo* Get(int id);
+
+	/* destroys the demos built, the gpu must be done with them */
+	void Clear();
+
+private:
+
+	struct Entry
+	{
+		const char*					name;
+		Factory						factory;
+		Warmer						warmUp;
+		std::shared_future<void>	warmedUp;
+		std::unique_ptr<Demo>		demo;
+	};
+
+	const DemoInputs&	inputs;
+	const DX12Handle&	dx12Handle;
+
+	std::vector<Entry>	entries;
+	bool				isWarmingUp = false;
+
+	void WaitWarmUp(Entry& entry);
+};
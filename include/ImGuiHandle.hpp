@@ -9,7 +9,7 @@
 struct GLFWwindow;
 class DX12Handle;
 struct DX12Contextual;
-class Demo;
+class DemoRegistry;
 
 class ImGuiHandle
 {
@@ -27,7 +27,7 @@ class ImGuiHandle
 
 		bool Init(GLFWwindow* window, const DX12Handle& dx12Handle);
 		void NewFrame();
-		void ChooseDemo(const std::vector<std::unique_ptr<Demo>>& demos_, int& demoId_);
+		void ChooseDemo(const DemoRegistry& demos_, int& demoId_);
 		void Render(DX12Contextual& currFrameIndex_);
 		void Terminate();
 
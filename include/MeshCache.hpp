@@ -0,0 +1,289 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Meshlets.hpp"
+#include "VertexLayout.hpp"
+
+namespace tinygltf
+{
+	class Model;
+}
+
+/* Baked model cache : the vertex/index streams, the material table and the decoded textures of a glTF (or .glb)
+ * are written in one versioned binary file next to the asset (<asset>.meshcache). The next launches map
+ * this file and give its pointers straight to the upload, there is no JSON parsing and no image decoding.
+ * The buffers stored in their own file (the .bin, or the binary chunk of a .glb) are not copied in the cache,
+ * their file is mapped too and read in place.
+ * The images that can be block compressed are kept in their own dds files instead (see TextureCache),
+ * the small ones of the materials may be packed in shared pages (see Options and TextureAtlas).
+ * The cache is rebuilt when its version or one of the source files (gltf, bin, images, dds) changed. */
+namespace MeshCache
+{
+	/* increase when the layout or the content of the cache changes, older caches are then rebaked */
+	#define MESH_CACHE_VERSION	11u
+	#define MESH_CACHE_MAGIC	0x4843534Du /* "MSCH" */
+	#define MESH_CACHE_EXT		".meshcache"
+
+	/* simplified levels of detail kept per primitive after the full one, each one aims at half the triangles of the previous */
+	#define MESH_CACHE_MAX_LODS			4u
+
+	/* everything below is stored as is in the file, offsets are from the start of the file */
+
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t fileSize;
+
+		uint32_t dependencyCount;
+		uint32_t bufferCount;
+		uint32_t primitiveCount;
+		uint32_t materialCount;
+		uint32_t imageCount;
+		uint32_t meshletCount;
+		uint32_t meshletVertexCount;
+		uint32_t meshletTriangleCount;
+		uint32_t instanceCount;
+		uint32_t atlasMaxSize;	/* of the Options it was baked with */
+
+		/* of the vertices of every primitive (see GetVertexLayout) */
+		VertexLayout::Layout vertexLayout;
+
+		uint64_t dependencies;
+		uint64_t buffers;
+		uint64_t primitives;
+		uint64_t materials;
+		uint64_t images;
+		uint64_t instances;
+
+		/* the clusters of all the primitives (see Meshlets), only read by the cpu so they are not in a buffer */
+		uint64_t meshlets;
+		uint64_t meshletVertices;
+		uint64_t meshletTriangles;
+	};
+
+	/* a source file of the asset, the cache is stale when one of them changed */
+	struct Dependency
+	{
+		char		path[260];
+		uint32_t	padding;
+		uint64_t	size;
+		int64_t		writeTime;
+	};
+
+	struct Blob
+	{
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	/* the bytes of a glTF buffer, a range of one of the dependencies or a blob of the cache (data uri buffers).
+	 * The streams rewritten by the mesh optimizer (see MeshOptimizer) are one more buffer in the cache,
+	 * the glTF buffers that are not read anymore have a size of 0. */
+	struct Buffer
+	{
+		int32_t		dependency;	/* -1 when the bytes are in the cache */
+		uint32_t	padding;
+		Blob		data;
+	};
+
+	/* a range of a buffer, size is 0 when the stream does not exist */
+	struct BufferRange
+	{
+		uint32_t buffer;
+		uint32_t offset;
+		uint32_t size;
+		uint32_t stride;
+	};
+
+	/* a simplified version of the indices of a primitive, drawn with the same vertex streams (see MeshOptimizer::Simplify) */
+	struct Lod
+	{
+		BufferRange	indices;
+		uint32_t	count;
+		float		error;	/* how far the surface may be from the full one, in the units of the positions */
+	};
+
+	/* a primitive of a mesh of the scene, drawn once per node using the mesh (its instances) */
+	struct Primitive
+	{
+		char		name[64];
+
+		/* one interleaved stream in the vertexLayout of the header. attributes are the bits of the ones the glTF
+		 * primitive has, the other attributes of the layout hold their default value */
+		BufferRange	vertices;
+		uint32_t	attributes;
+		BufferRange	indices;
+		uint32_t	indexComponentType;	/* TINYGLTF_COMPONENT_TYPE_*, 0 when not indexed */
+		uint32_t	count;
+		int32_t		material;
+
+		/* the vertices are quantized (see VertexLayout) : position = unorm16 * positionScale + positionOffset,
+		 * the same for the first uvs, and the normals are octahedral snorm16 */
+		float		positionOffset[3];
+		float		positionScale[3];
+		float		uvOffset[2];
+		float		uvScale[2];
+
+		/* sphere around the positions, in the space of the node */
+		float		center[3];
+		float		radius;
+
+		/* coarser and coarser levels, with the index type of the primitive and increasing errors */
+		uint32_t	lodCount;
+		Lod			lods[MESH_CACHE_MAX_LODS];
+
+		/* the clusters of the full mesh, a range of the meshlets of the header, their vertices index the streams of the primitive */
+		uint32_t	meshletOffset;
+		uint32_t	meshletCount;
+
+		/* the nodes drawing it, a range of the instances of the header */
+		uint32_t	instanceOffset;
+		uint32_t	instanceCount;
+	};
+
+	/* the world transform of a node drawing a primitive, its local one composed with the ones of its parents.
+	 * Row major, position = transform * p as GPM::Mat4 does. The table is uploaded as is as the per instance stream. */
+	struct Instance
+	{
+		float transform[16];
+	};
+
+	/* images used by a material, -1 when the material does not have it.
+	 * The materials reading the same images are one entry, the primitives share it */
+	struct Material
+	{
+		int32_t baseColor;
+		int32_t normal;
+		int32_t metallicRoughness;
+	};
+
+	/* decoded pixels, 3 channels images are already expanded to 4 as there is no 3 bytes dxgi format.
+	 * pixels holds the whole mip chain, the levels are tightly packed one after another (see MipChain).
+	 * A block compressed image has no pixels nor channels, its chain is in the dds file at cachePath. */
+	struct Image
+	{
+		uint32_t	width;
+		uint32_t	height;
+		uint32_t	channels;
+		uint32_t	rowPitch;				/* of the first level */
+		uint32_t	mipCount;
+		uint32_t	usage;					/* MipChain::EUsage the chain was filtered with */
+		uint32_t	format;					/* BlockCompress::EFormat, FORMAT_NONE when the chain is in pixels */
+		uint8_t		componentMapping[4];	/* see TextureCache::Info */
+		char		cachePath[260];
+		uint32_t	padding;
+		Blob		pixels;
+	};
+
+	/* read only access to a baked model, the pointers are in the mapped file or in the freshly baked bytes */
+	struct View
+	{
+		const uint8_t*		base			= nullptr;
+		const Header*		header			= nullptr;
+		const Dependency*	dependencies	= nullptr;
+		const Buffer*		buffers			= nullptr;
+		const Primitive*	primitives		= nullptr;
+		const Material*		materials		= nullptr;
+		const Image*		images			= nullptr;
+		const Instance*		instances		= nullptr;
+
+		const Meshlets::Meshlet*	meshlets			= nullptr;
+		const uint32_t*				meshletVertices		= nullptr;
+		const uint8_t*				meshletTriangles	= nullptr;
+
+		/* where the bytes of each buffer are, in the cache or in a mapped dependency */
+		std::vector<const uint8_t*> bufferData;
+
+		const void* GetData(const Blob& blob) const { return base + blob.offset; }
+		const void* GetBufferData(uint32_t buffer) const { return bufferData[buffer]; }
+	};
+
+	/* read only memory mapping of a whole file */
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile();
+
+		bool Open(const std::string& filePath);
+		void Close();
+
+		const uint8_t*	Data() const { return data; }
+		size_t			Size() const { return size; }
+
+	private:
+		const uint8_t*	data		= nullptr;
+		size_t			size		= 0;
+#ifdef _WIN32
+		void*			file		= nullptr;
+		void*			mapping		= nullptr;
+#endif
+	};
+
+	/* how a model is baked, a cache baked with other options is baked again */
+	struct Options
+	{
+		/* the images of a material up to this size are packed in shared pages (see TextureAtlas), its primitives
+		 * read them with their uv transform remapped. 0 keeps every image in its own texture */
+		uint32_t atlasMaxSize = 256u;
+
+		/* the bits of the VertexLayout attributes interleaved in the vertices, VERTEX_LAYOUT_DEFAULT is always in */
+		uint32_t vertexAttributes = VERTEX_LAYOUT_DEFAULT;
+	};
+
+	/* a range of a buffer of the cache, uploaded at arenaOffset of the one gpu buffer holding every range drawn */
+	struct UploadRange
+	{
+		uint32_t buffer;
+		uint64_t offset;
+		uint64_t size;
+		uint64_t arenaOffset;
+	};
+
+	/* a loaded model, from the cache file or baked from the glTF */
+	struct CachedModel
+	{
+		MappedFile									file;
+		std::vector<uint8_t>						bakedBytes;	/* only used when the cache could not be read */
+		std::vector<std::unique_ptr<MappedFile>>	bufferFiles;	/* the dependencies holding buffers */
+		View										view;
+		bool										isFromCache = false;
+	};
+
+	std::string GetCachePath(const std::string& assetPath);
+
+	/* the layout of the vertices baked with options, the input layout of the shaders drawing them follows it */
+	VertexLayout::Layout GetVertexLayout(const Options& options);
+
+	/* check the header and the tables fit in the size, and the vertex and index ranges in their buffers, then point the view into data.
+	 * The buffers in dependencies are left null, see MapBuffers. */
+	bool MakeView(const uint8_t* data, size_t size, View& view);
+
+	/* map the dependencies holding buffers and point the view into them, false when a range is out of its file */
+	bool MapBuffers(CachedModel& model);
+
+	/* true if every source file still has the size and write time it had when baking */
+	bool IsUpToDate(const View& view);
+
+	/* the union of the buffer ranges the primitives read (vertices, indices and levels), the other bytes of the buffers are not
+	 * uploaded. isSkipped is by primitive and may be empty, the skipped ones are drawn from elsewhere (see StaticBatch).
+	 * The ranges are widened to alignment, merged when they overlap or touch and packed one after another sorted by buffer
+	 * and offset, so that every offset keeps its alignment in the arena. Returns the size of the arena */
+	uint64_t GetUploadRanges(const View& view, const std::vector<char>& isSkipped, uint64_t alignment, std::vector<UploadRange>& ranges);
+
+	/* where an offset of a buffer is in the arena of ranges, ~0 when no range holds it */
+	uint64_t GetArenaOffset(const std::vector<UploadRange>& ranges, uint32_t buffer, uint64_t offset);
+
+	/* convert a parsed glTF to the cache layout, the source files are read from assetPath directory */
+	bool Bake(const tinygltf::Model& gltfModel, const std::string& assetPath, const Options& options, std::vector<uint8_t>& bytes);
+
+	/* map the cache when it is up to date, otherwise parse the glTF, bake it and write the cache for the next launch */
+	bool Load(const std::string& assetPath, CachedModel& model, const Options& options = Options());
+}
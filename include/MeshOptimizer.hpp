@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Import time reordering of indexed triangle lists, run when baking (see MeshCache).
+ * The usual chain is OptimizeVertexCache, OptimizeOverdraw with its clusters, then OptimizeVertexFetch
+ * and RemapVertices on every vertex stream so that the indices and the vertices stay consistent.
+ * Simplify then makes the levels of detail from the optimized indices.
+ * Everything works on 32 bits indices and plain memory, nothing depends on the gpu. */
+namespace MeshOptimizer
+{
+	/* vertices kept by the simulated post transform cache, a FIFO as on most gpus */
+	#define MESH_OPTIMIZER_CACHE_SIZE 16u
+
+	struct VertexCacheStatistics
+	{
+		uint32_t	misses	= 0;
+		float		acmr	= 0.f;	/* average cache miss ratio : transformed vertices per triangle, 0.5 at best */
+		float		atvr	= 0.f;	/* average transform to vertex ratio : transformed vertices per used vertex, 1 at best */
+	};
+
+	VertexCacheStatistics AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = MESH_OPTIMIZER_CACHE_SIZE);
+
+	/* Tipsify (Sander, Nehab and Barczak 2007) : the triangles are emitted in fans around vertices chosen to still be in the cache.
+	 * clusters, when given, gets the first triangle of each run that started from a cache miss, see OptimizeOverdraw. */
+	void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>* clusters = nullptr,
+							 uint32_t cacheSize = MESH_OPTIMIZER_CACHE_SIZE);
+
+	/* sort the clusters so that the ones facing away from the center of the mesh are drawn first, they are the
+	 * most likely to occlude the others. The order inside a cluster, and so the vertex cache, is kept.
+	 * positions are 3 floats per vertex, positionStride bytes apart. */
+	void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const uint8_t* positions, size_t positionStride, size_t vertexCount,
+						  const std::vector<uint32_t>& clusters);
+
+	/* number the vertices in the order the indices first use them, rewrite the indices and fill remap (vertexCount entries,
+	 * remap[old] = new, ~0u for the unused ones). Returns the number of used vertices. */
+	size_t OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t* remap);
+
+	/* move elementSize bytes per vertex from src to dst following remap, the unused vertices are dropped */
+	void RemapVertices(const uint8_t* src, size_t srcStride, size_t vertexCount, const uint32_t* remap, uint8_t* dst, size_t dstStride, size_t elementSize);
+
+	/* quadric error simplification (Garland and Heckbert 1997) by edge collapses onto existing vertices, so the vertex
+	 * streams are shared with the full mesh and only the indices change. The vertices at the same position with other
+	 * attributes (uv or normal seams) only collapse along their seam, together, and the open borders only along the border.
+	 * Writes at most indexCount indices in dst and returns their count, that can stay above targetIndexCount when
+	 * no collapse is possible anymore. error_ gets the largest distance from a removed vertex to the simplified surface,
+ * in the units of the positions. */
+	size_t Simplify(uint32_t* dst, const uint32_t* indices, size_t indexCount, const uint8_t* positions, size_t positionStride, size_t vertexCount,
+					size_t targetIndexCount, float* error_ = nullptr);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Clusters of triangles (meshlets) small enough to be culled one by one : each one has a bounding sphere and a cone
+ * holding the normals of its triangles, so that a whole cluster can be dropped when it is out of the frustum or when all
+ * its triangles face away from the eye. Built when baking (see MeshCache), culled on the cpu every frame into a compacted
+ * index list. The limits are the ones of the mesh shaders so that the same clusters can be drawn by them later.
+ * Everything works on 32 bits indices and plain memory, nothing depends on the gpu. */
+namespace Meshlets
+{
+	#define MESHLET_MAX_VERTICES	64u
+	#define MESHLET_MAX_TRIANGLES	124u
+
+	struct Meshlet
+	{
+		uint32_t	vertexOffset;	/* first of its vertices in the meshlet vertices */
+		uint32_t	triangleOffset;	/* first of its triangles in the meshlet triangles, 3 bytes each */
+		uint32_t	vertexCount;
+		uint32_t	triangleCount;
+
+		float		center[3];
+		float		radius;
+
+		/* the triangles all face away from an eye in the cone of apex coneApex, around -coneAxis, of the angle whose cosine is coneCutoff.
+		 * coneCutoff is 1 when the normals spread too much for the cluster to be culled that way. */
+		float		coneApex[3];
+		float		coneAxis[3];
+		float		coneCutoff;
+		uint32_t	padding;
+	};
+
+	/* split a triangle list into meshlets, appended to meshlets with their vertices (indices of the mesh vertices) and their
+	 * triangles (3 indices in the vertices of the meshlet), the offsets of the meshlets are in the whole arrays.
+	 * The clusters grow through the neighbour triangles, the ones adding the least vertices first then the closest.
+	 * positions are 3 floats per vertex, positionStride bytes apart. Returns the number of meshlets added. */
+	size_t Build(const uint32_t* indices, size_t indexCount, const uint8_t* positions, size_t positionStride, size_t vertexCount,
+				 std::vector<Meshlet>& meshlets, std::vector<uint32_t>& meshletVertices, std::vector<uint8_t>& meshletTriangles);
+
+	/* the 6 planes of a frustum, a * x + b * y + c * z + d is the distance to the plane, positive inside */
+	struct Frustum
+	{
+		float planes[6][4];
+	};
+
+	/* from a row major matrix taking the positions to clip space (clip = matrix * position, as DX12Helper does),
+	 * so the frustum is in the space of the positions. The near plane is the one of -w <= z, which also holds the 0 <= z one. */
+	Frustum MakeFrustum(const float clip[16]);
+
+	struct CullStatistics
+	{
+		uint32_t visible		= 0;
+		uint32_t frustumCulled	= 0;
+		uint32_t backfaceCulled	= 0;
+		uint32_t triangles		= 0;	/* of the visible meshlets */
+	};
+
+	/* write in dst the indices of the triangles of the meshlets in the frustum that can face the eye, in the order of the
+	 * meshlets. eye is in the space of the positions. dst holds all the triangles at worst. Returns the number of indices written. */
+	size_t Cull(const Meshlet* meshlets, size_t meshletCount, const uint32_t* meshletVertices, const uint8_t* meshletTriangles,
+				const Frustum& frustum, const float eye[3], uint32_t* dst, CullStatistics* statistics = nullptr);
+}
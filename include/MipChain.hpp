@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* CPU mip chain generation for 8 bits textures. The levels are filtered in linear float, each one from the
+ * previous one, split in row bands over the worker pool, then encoded back to 8 bits in the destination given
+ * by the caller (a mapped upload heap, the baked mesh cache...) so nothing but the float levels is allocated. */
+namespace MipChain
+{
+	enum EFilter : uint32_t
+	{
+		FILTER_BOX		= 0,	/* 2x2 average */
+		FILTER_KAISER	= 1		/* 8 taps Kaiser windowed sinc, sharper with less aliasing */
+	};
+
+	/* how the texels are encoded, changes the space they are filtered in */
+	enum EUsage : uint32_t
+	{
+		USAGE_DATA		= 0,	/* linear values (roughness, metalness, masks...) */
+		USAGE_COLOR		= 1,	/* sRGB encoded color, filtered in linear, alpha stays linear */
+		USAGE_NORMAL	= 2		/* xyz mapped to [0, 1], renormalized on each level */
+	};
+
+	/* destination of a level, data is width * channels bytes per row */
+	struct Level
+	{
+		uint8_t*	data		= nullptr;
+		size_t		rowPitch	= 0;
+	};
+
+	/* full chain length, down to 1x1 */
+	uint32_t GetLevelCount(uint32_t width, uint32_t height);
+
+	/* width or height of a level, the odd sizes are rounded down */
+	inline uint32_t GetLevelSize(uint32_t size, uint32_t level) { return (size >> level) > 0 ? size >> level : 1; }
+
+	/* bytes of a tightly packed chain of levelCount levels */
+	size_t GetChainSize(uint32_t width, uint32_t height, uint32_t channels, uint32_t levelCount);
+
+	/* fill levels[0, levelCount) from src, an image of srcChannels per texel converted to channels (see PixelConvert).
+	 * levels[0] gets the converted source, a level with null data is computed but not written. */
+	void Generate(const uint8_t* src, size_t srcRowPitch, uint32_t srcChannels, uint32_t width, uint32_t height, uint32_t channels,
+				  EUsage usage, EFilter filter, const Level* levels, uint32_t levelCount);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/* Pipeline objects shared by hash : the demos asking for the same pipeline (same states, same shaders,
+ * same root signature) get the same object, created once. The blob the driver gives back for a pipeline
+ * is kept in one file between runs and handed back to it on the next creation, so that it skips compiling
+ * the shaders to the gpu again. The cache only sees handles : what the desc and the objects are is up
+ * to its Device (d3d12 in DX12Helper, the hashing of the d3d12 descs is there too).
+ * Used from the main thread only. Nothing depends on the gpu. */
+namespace PipelineCache
+{
+	/* increase when the hashing of the descs changes, the older blobs are then dropped */
+	#define PIPELINE_CACHE_VERSION	1u
+	#define PIPELINE_CACHE_MAGIC	0x48435350u /* "PSCH" */
+	#define PIPELINE_CACHE_EXT		".psocache"
+
+	/* FNV-1a, the same on every run. The values are added one by one, never whole structures,
+	 * so that their padding is never part of a key */
+	class Hasher
+	{
+	public:
+
+		void Add(const void* data, size_t size);
+
+		/* the string and its terminator, null hashes apart from the empty string */
+		void AddString(const char* string);
+
+		template <typename T>
+		void AddValue(const T& value)
+		{
+			static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "the structures are added field by field");
+			Add(&value, sizeof(value));
+		}
+
+		uint64_t Get() const { return hash; }
+
+	private:
+
+		uint64_t hash = 0xcbf29ce484222325ull;
+	};
+
+	/* what creates the objects on a miss */
+	class Device
+	{
+	public:
+
+		virtual ~Device() {}
+
+		/* the object of desc, created from the blob of an earlier run when blob is not empty (the driver may refuse
+		 * a blob made by another driver, then it is created without). createdBlob is the blob to keep for the next run,
+		 * left empty when there is none. Null when the creation fails */
+		virtual void* Create(const void* desc, const std::vector<uint8_t>& blob, std::vector<uint8_t>& createdBlob) = 0;
+
+		virtual void Release(void* object) = 0;
+	};
+
+	class Cache
+	{
+	public:
+
+		Cache(Device& device_);
+		Cache(const Cache&) = delete;
+		Cache& operator=(const Cache&) = delete;
+
+		/* releases the objects, not written to the file */
+		~Cache();
+
+		/* the blobs of an earlier run, false when the file is missing or invalid (the cache is then empty) */
+		bool Read(const std::string& path);
+
+		/* the blobs of every known hash, used in this run or not. Only written when a blob was added since Read */
+		bool Write(const std::string& path);
+
+		/* the object of hash, created from desc on the first call. Null when the creation fails */
+		void* Get(uint64_t hash, const void* desc);
+
+		/* the hash an object of the cache was made for, false for the objects it does not hold */
+		bool GetHash(const void* object, uint64_t& hash) const;
+
+		/* objects created, and calls answered by an object created before */
+		uint32_t GetCreatedCount() const { return createdCount; }
+		uint32_t GetSharedCount() const { return sharedCount; }
+
+	private:
+
+		struct Entry
+		{
+			void*				 object = nullptr;
+			std::vector<uint8_t> blob;
+		};
+
+		Device&								device;
+		std::unordered_map<uint64_t, Entry>	entries;
+		uint32_t							createdCount	= 0;
+		uint32_t							sharedCount		= 0;
+		bool								isDirty			= false;
+	};
+}
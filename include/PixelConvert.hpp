@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* Pixel format conversions used when loading textures. Every function converts "pixelCount" (or "count" values)
+ * from src to dst, which may be rows of a mapped upload buffer, nothing is allocated.
+ * The kernels use SSE2 (always there on x64) and SSSE3 when the cpu has it, with a scalar fallback.
+ *
+ * 8 bits channel layouts follow stb_image : 1 = grey, 2 = grey alpha, 3 = rgb, 4 = rgba. */
+namespace PixelConvert
+{
+	/* change the channel count of 8 bits pixels : grey is replicated to rgb, rgb to grey uses the rec 601 luma,
+	 * a missing alpha is 0xFF. src and dst must not overlap. */
+	void ConvertChannels(const uint8_t* src, uint32_t srcChannels, uint8_t* dst, uint32_t dstChannels, size_t pixelCount);
+
+	/* reorder the channels of 8 bits rgba pixels : dst[c] = src[order[c]], src and dst may be the same */
+	void Swizzle4(const uint8_t* src, uint8_t* dst, size_t pixelCount, const uint8_t order[4]);
+	void SwapRedBlue(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+
+	/* sRGB encoded 8 bits to linear float and back, the alpha (4th channel of 4 channels pixels, 2nd of 2) stays linear.
+	 * LinearToSrgb is within 1 of the exactly rounded value. */
+	void SrgbToLinear(const uint8_t* src, float* dst, size_t pixelCount, uint32_t channels);
+	void LinearToSrgb(const float* src, uint8_t* dst, size_t pixelCount, uint32_t channels);
+
+	/* single value sRGB transfer functions, exact */
+	float SrgbToLinear(float value);
+	float LinearToSrgb(float value);
+
+	/* IEEE half floats, rounding to nearest even, overflow gives infinity and NaN stays NaN */
+	void FloatToHalf(const float* src, uint16_t* dst, size_t count);
+	void HalfToFloat(const uint16_t* src, float* dst, size_t count);
+
+	/* unsigned normalized values, floats are clamped to [0, 1] (NaN gives 0) and rounded to nearest */
+	void FloatToUnorm8(const float* src, uint8_t* dst, size_t count);
+	void Unorm8ToFloat(const uint8_t* src, float* dst, size_t count);
+	void FloatToUnorm16(const float* src, uint16_t* dst, size_t count);
+	void Unorm16ToFloat(const uint16_t* src, float* dst, size_t count);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Compiled shaders kept on disk, one file per shader named by the hash of what the compilation depends on :
+ * the source, the entry point, the target and the flags. A hit reads the bytecode back instead of compiling,
+ * a changed source, entry or flag is another hash and so another file. The compiler is given by the caller
+ * (D3DCompile in DX12Helper), the stale files of the older sources are not removed.
+ * Nothing depends on the gpu. */
+namespace ShaderCache
+{
+	/* increase when the compiler changes, the older files are then compiled again */
+	#define SHADER_CACHE_VERSION	2u
+	#define SHADER_CACHE_MAGIC		0x48435348u /* "HSCH" */
+	#define SHADER_CACHE_EXT		".cso"
+
+	/* what compiles the shaders on a miss */
+	class Compiler
+	{
+	public:
+
+		virtual ~Compiler() {}
+
+		/* false with the messages of the compiler in errors */
+		virtual bool Compile(const std::string& source, const char* entryPoint, const char* target, uint32_t flags,
+							 std::vector<uint8_t>& bytecode, std::string& errors) = 0;
+	};
+
+	/* the key of a shader, the same for the same inputs on every run */
+	uint64_t GetHash(const std::string& source, const char* entryPoint, const char* target, uint32_t flags);
+
+	/* the file of a hash in directory */
+	std::string GetCachePath(const std::string& directory, uint64_t hash);
+
+	/* the bytecode of the file of hash, false when it is missing, invalid, truncated or damaged */
+	bool Read(const std::string& cachePath, uint64_t hash, std::vector<uint8_t>& bytecode);
+
+	bool Write(const std::string& cachePath, uint64_t hash, const std::vector<uint8_t>& bytecode);
+
+	/* read the shader from directory, or compile it and write it there (the directory is created).
+	 * False when it is not cached and does not compile, errors then holds the messages of the compiler.
+	 * isHit, when given, tells whether the compilation was skipped */
+	bool Compile(Compiler& compiler, const std::string& directory, const std::string& source, const char* entryPoint, const char* target,
+				 uint32_t flags, std::vector<uint8_t>& bytecode, std::string& errors, bool* isHit = nullptr);
+}
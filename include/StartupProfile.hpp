@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+
+/* Time spent since launch in each phase of the loading, printed with the time to first frame.
+ * The phases are timed where they happen, on any thread : the loading jobs run side by side,
+ * so the phases may add up to more than the time elapsed. Nothing depends on the gpu. */
+namespace StartupProfile
+{
+	enum EPhase
+	{
+		PHASE_WINDOW = 0,
+		PHASE_DEVICE,		/* the device, swapchain and imgui */
+		PHASE_SHADER,		/* shader compilation */
+		PHASE_ASSET_IO,		/* reading or mapping the files, parsing the glTF, writing the caches */
+		PHASE_DECODE,		/* decoding the images and baking the models */
+		PHASE_UPLOAD,		/* filling the upload heaps and waiting for their copy */
+		PHASE_COUNT
+	};
+
+	const char* GetName(EPhase phase);
+
+	/* thread safe */
+	void Add(EPhase phase, double ms);
+	double Get(EPhase phase);
+
+	/* totalMs is the wall time it is compared to, the time to first frame */
+	void Print(double totalMs);
+
+	/* adds the time from its construction to its destruction to phase */
+	class Scope
+	{
+	public:
+
+		Scope(EPhase phase_);
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		~Scope();
+
+	private:
+
+		EPhase									phase;
+		std::chrono::steady_clock::time_point	start;
+	};
+}
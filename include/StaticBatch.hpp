@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "MeshCache.hpp"
+#include "Meshlets.hpp"
+#include "VertexLayout.hpp"
+
+/* Optional load time merge of the static primitives of a baked model (see MeshCache) : the vertices of each instance are
+ * moved to world space, then the primitives sharing a material are packed one after another in one arena of vertices
+ * and 32 bits indices, so that a material takes one draw. The vertices keep the layout of the cache (see VertexLayout),
+ * quantized again in the box of their batch, with their levels of detail and meshlets.
+ * Primitives drawn by many nodes stay instanced, copying them would cost more memory than the draws it saves.
+ * Nothing depends on the gpu. */
+namespace StaticBatch
+{
+	/* a primitive drawn by more nodes than this is left out of the batches */
+	#define STATIC_BATCH_MAX_INSTANCES	4u
+
+	/* a range of the indices of the arena */
+	struct Lod
+	{
+		uint32_t	indexOffset;
+		uint32_t	indexCount;
+		float		error;	/* the largest error of the merged levels, in world units */
+	};
+
+	struct Batch
+	{
+		int32_t		material;
+		uint32_t	drawCount;	/* primitive instances merged into it */
+
+		/* its vertices in the arena, its indices start from vertexOffset */
+		uint32_t	vertexOffset;
+		uint32_t	vertexCount;
+		uint32_t	indexOffset;
+		uint32_t	indexCount;
+
+		/* level n merges the level n of every primitive, or their coarsest one when they have less */
+		uint32_t	lodCount;
+		Lod			lods[MESH_CACHE_MAX_LODS];
+
+		/* as in MeshCache::Primitive, for the box of the batch */
+		float		positionOffset[3];
+		float		positionScale[3];
+		float		uvOffset[2];
+		float		uvScale[2];
+
+		/* sphere around the positions, in world space */
+		float		center[3];
+		float		radius;
+
+		/* a range of the meshlets of the arena, their vertices start from vertexOffset too */
+		uint32_t	meshletOffset;
+		uint32_t	meshletCount;
+	};
+
+	/* the vertices are interleaved in the layout of the cache, the attributes a primitive does not have hold their default */
+	struct Arena
+	{
+		VertexLayout::Layout			layout;
+		std::vector<uint8_t>			vertices;	/* layout.stride bytes per vertex */
+		std::vector<uint32_t>			indices;
+
+		std::vector<Meshlets::Meshlet>	meshlets;
+		std::vector<uint32_t>			meshletVertices;
+		std::vector<uint8_t>			meshletTriangles;
+
+		std::vector<Batch>				batches;
+		std::vector<char>				isBatched;	/* per primitive of the view, the others are still drawn on their own */
+	};
+
+	/* dst = matrix * (src, 1) for count points of 3 floats, matrix is row major as MeshCache::Instance. dst may be src (SSE2 when available) */
+	void TransformPoints(const float matrix[16], const float* src, float* dst, size_t count);
+
+	/* the same without the translation, dst = matrix * (src, 0) */
+	void TransformVectors(const float matrix[16], const float* src, float* dst, size_t count);
+
+	/* merge the primitives of view into arena, cleared first. Returns the number of batches */
+	size_t Build(const MeshCache::View& view, Arena& arena);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "MipChain.hpp"
+
+/* Packing of small images in shared pages (stb rect pack), so that many materials draw with the same textures
+ * and descriptors. Each image keeps a gutter of its border texels repeated around it, and the places are
+ * aligned so that every level of the page chain halves the gutter without mixing two images :
+ * the gutter of TEXTURE_ATLAS_GUTTER texels on the first level is still one texel on the last one.
+ * The images read with uvs out of [0, 1] (repeating) can not be packed, the sampler would not wrap in the image.
+ * Nothing depends on the gpu. */
+namespace TextureAtlas
+{
+	/* levels of the page chains, the smaller ones would mix the neighbour images */
+	#define TEXTURE_ATLAS_MIP_COUNT		4u
+	#define TEXTURE_ATLAS_GUTTER		(1u << (TEXTURE_ATLAS_MIP_COUNT - 1))
+
+	/* a page holds the images up to this side, a page is shrunk to the images it got */
+	#define TEXTURE_ATLAS_MAX_PAGE_SIZE	2048u
+
+	struct Size
+	{
+		uint32_t width;
+		uint32_t height;
+	};
+
+	/* the place of an image on the first level of its page, x and y are of its first texel, the gutter is around */
+	struct Rect
+	{
+		uint32_t page;
+		uint32_t x;
+		uint32_t y;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	/* the image sizes that keep their gutter on every level, and their size with the gutter fits a page */
+	bool IsPackable(uint32_t width, uint32_t height, uint32_t maxSize);
+
+	/* place the images on as few pages as they fit, rects[i] is the place of sizes[i].
+	 * False when an image is not packable (see IsPackable) */
+	bool Pack(const std::vector<Size>& sizes, std::vector<Rect>& rects, std::vector<Size>& pages);
+
+	/* from the uvs of an image to the ones of its page : pageUv = uv * scale + offset */
+	void GetUvTransform(const Rect& rect, const Size& page, float scale[2], float offset[2]);
+
+	/* the levels of a page chain tightly packed in pixels, as MipChain::GetChainSize lays them */
+	void GetPageLevels(const Size& page, uint32_t channels, uint8_t* pixels, MipChain::Level levels[TEXTURE_ATLAS_MIP_COUNT]);
+
+	/* where the levels of an image go in the levels of its page, to generate its chain in place (see MipChain::Generate) */
+	void GetImageLevels(const Rect& rect, uint32_t channels, const MipChain::Level pageLevels[TEXTURE_ATLAS_MIP_COUNT],
+						MipChain::Level imageLevels[TEXTURE_ATLAS_MIP_COUNT]);
+
+	/* repeat the border texels of the image in its gutter, on every level */
+	void FillGutter(const Rect& rect, uint32_t channels, const MipChain::Level pageLevels[TEXTURE_ATLAS_MIP_COUNT]);
+
+	/* set the image and its gutter to one texel value, on every level */
+	void Fill(const Rect& rect, uint32_t channels, const uint8_t* texel, const MipChain::Level pageLevels[TEXTURE_ATLAS_MIP_COUNT]);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "BlockCompress.hpp"
+#include "MipChain.hpp"
+
+/* Block compressed copies of the model images, written once as dds files next to their source
+ * (<image>.bc.dds) with their whole mip chain, then uploaded as is instead of decoding the image again.
+ * The format follows the usage of the image :
+ * - color		: BC7
+ * - normal		: BC5 of x and y, the shaders rebuild z
+ * - data		: BC4 when the channels are the same (grey masks), otherwise BC5 of green and blue
+ *				  (roughness and metalness of the glTF metallicRoughness textures)
+ * The dds header keeps the size and write time of the source, a changed source is compressed again. */
+namespace TextureCache
+{
+	/* increase when the encoders or the choice of the formats change, the older files are then compressed again */
+	#define TEXTURE_CACHE_VERSION	1u
+	#define TEXTURE_CACHE_MAGIC		0x48435854u /* "TXCH" */
+	#define TEXTURE_CACHE_EXT		".bc.dds"
+
+	/* what a cached file holds */
+	struct Info
+	{
+		uint32_t				width				= 0;
+		uint32_t				height				= 0;
+		uint32_t				mipCount			= 0;
+		BlockCompress::EFormat	format				= BlockCompress::FORMAT_NONE;
+
+		/* source of the r, g, b, a read by the shaders, as the d3d12 shader component mappings :
+		 * 0 to 3 a channel of the texture, 4 forces 0 and 5 forces 1 */
+		uint8_t					componentMapping[4]	= { 0, 1, 2, 3 };
+	};
+
+	/* sourcePath names the image, the file is not read */
+	std::string GetCachePath(const std::string& sourcePath);
+
+	/* the block formats need the first level made of whole blocks */
+	bool IsCompressible(uint32_t width, uint32_t height);
+
+	/* read the header of a cached file, false when it is missing, invalid, or was not made
+	 * from a source of this size and write time with this usage */
+	bool ReadInfo(const std::string& cachePath, MipChain::EUsage usage, uint64_t sourceSize, int64_t sourceWriteTime, Info& info);
+
+	/* generate the mip chain of an 8 bits image of srcChannels per texel (see PixelConvert), compress it and write the dds */
+	bool Write(const std::string& cachePath, const uint8_t* src, size_t srcRowPitch, uint32_t srcChannels, uint32_t width, uint32_t height,
+			   MipChain::EUsage usage, uint64_t sourceSize, int64_t sourceWriteTime, Info& info);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* Interleaved vertex layouts : the attributes a model is drawn with are packed one after another in a single stream,
+ * in their quantized formats (see VertexQuantize), so that fetching a vertex reads one cache line instead of one per stream :
+ * - POSITION	: 4 x unorm16 in the box of the primitive
+ * - TEXCOORD_0	: 2 x unorm16 in the box of the uvs
+ * - NORMAL		: 2 x snorm16, octahedral
+ * - TANGENT	: 4 x snorm8, the handedness in w
+ * - COLOR_0	: 4 x unorm8, the rgb colors get an alpha of 1
+ * - TEXCOORD_1	: 2 x float16
+ * The offsets follow the order of EAttribute, the stride is rounded up to a power of two so that no vertex
+ * straddles two cache lines. The attributes a primitive does not have are written with their default value.
+ * Nothing depends on the gpu. */
+namespace VertexLayout
+{
+	/* the bit of each attribute in Layout::attributes, and the order of the attributes in a vertex */
+	enum EAttribute : uint32_t
+	{
+		ATTRIBUTE_POSITION		= 0,
+		ATTRIBUTE_TEXCOORD_0	= 1,
+		ATTRIBUTE_NORMAL		= 2,
+		ATTRIBUTE_TANGENT		= 3,
+		ATTRIBUTE_COLOR_0		= 4,
+		ATTRIBUTE_TEXCOORD_1	= 5,
+		ATTRIBUTE_COUNT			= 6
+	};
+
+	#define VERTEX_LAYOUT_BIT(attribute)	(1u << (attribute))
+
+	/* what the model shaders read */
+	#define VERTEX_LAYOUT_DEFAULT			(VERTEX_LAYOUT_BIT(VertexLayout::ATTRIBUTE_POSITION) | VERTEX_LAYOUT_BIT(VertexLayout::ATTRIBUTE_TEXCOORD_0) | \
+											 VERTEX_LAYOUT_BIT(VertexLayout::ATTRIBUTE_NORMAL))
+
+	/* a stride above it is only rounded up to a multiple of 4 */
+	#define VERTEX_LAYOUT_CACHE_LINE		64u
+
+	struct Layout
+	{
+		uint32_t attributes;				/* bits of EAttribute */
+		uint32_t stride;
+		uint32_t offsets[ATTRIBUTE_COUNT];	/* in a vertex, 0 for the attributes not in the layout */
+	};
+
+	/* the name of the glTF attribute */
+	const char* GetName(EAttribute attribute);
+
+	/* floats per element given to Write and returned by Read */
+	uint32_t GetComponentCount(EAttribute attribute);
+
+	/* bytes of the quantized element in a vertex */
+	uint32_t GetSize(EAttribute attribute);
+
+	/* the layout of the given attributes, POSITION is always in */
+	Layout Build(uint32_t attributes);
+
+	inline bool Has(const Layout& layout, EAttribute attribute) { return (layout.attributes & VERTEX_LAYOUT_BIT(attribute)) != 0; }
+
+	/* quantize count elements of GetComponentCount floats into their place in count vertices, values may be null
+	 * to write the default value (zero uvs, a +z normal, a +x tangent, a white color). offset and scale are the box
+	 * of POSITION and TEXCOORD_0 (see VertexQuantize::GetRange), unused by the others.
+	 * Returns the largest error of the attribute as VertexQuantize reports it */
+	float Write(const Layout& layout, EAttribute attribute, const float* values, size_t count, const float* offset, const float* scale,
+				uint8_t* vertices);
+
+	/* the elements of count vertices back to floats, as the shaders read them */
+	void Read(const Layout& layout, EAttribute attribute, const uint8_t* vertices, size_t count, const float* offset, const float* scale,
+			  float* values);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* Import time compression of the vertex streams, the gpu expands them back to floats when fetching :
+ * - positions	: 4 x unorm16 (w unused) in the box of the mesh, 8 bytes instead of 12
+ * - uvs		: 2 x unorm16 in the box of the uvs, 4 bytes instead of 8
+ * - normals	: 2 x snorm16, octahedral mapping of the unit sphere, 4 bytes instead of 12
+ * - tangents	: 4 x snorm8, the direction and its handedness in w, 4 bytes instead of 16
+ * - colors		: 4 x unorm8, 4 bytes instead of 16
+ * - more uvs	: 2 x float16, without a box as they often repeat (lightmaps, details), 4 bytes instead of 8
+ * The box comes as an offset and a scale per component, value = unorm * scale + offset, given to the shaders. */
+namespace VertexQuantize
+{
+	#define VERTEX_QUANTIZE_POSITION_SIZE	8u
+	#define VERTEX_QUANTIZE_UV_SIZE			4u
+	#define VERTEX_QUANTIZE_NORMAL_SIZE		4u
+	#define VERTEX_QUANTIZE_TANGENT_SIZE	4u
+	#define VERTEX_QUANTIZE_COLOR_SIZE		4u
+	#define VERTEX_QUANTIZE_HALF_UV_SIZE	4u
+
+	/* box of count elements of components floats, scale is 1 for a flat component so it stays invertible */
+	void GetRange(const float* values, size_t count, uint32_t components, float* offset, float* scale);
+
+	/* each component to the closest unorm16 of the range, dstStride bytes apart (the components past the
+	 * given ones are left untouched). Returns the largest difference between a value and its decoded unorm */
+	float QuantizeUnorm16(const float* values, size_t count, uint32_t components, const float* offset, const float* scale,
+						  uint8_t* dst, size_t dstStride);
+
+	/* unit normal to the 2 snorm16 of its octahedral mapping (Cigolle et al. 2014), the best of the 4 neighbour codes is kept */
+	void EncodeOctahedral(const float normal[3], int16_t octahedral[2]);
+	void DecodeOctahedral(const int16_t octahedral[2], float normal[3]);
+
+	/* 3 floats per normal, normalized before encoding. Returns the largest angle, in radians, between a normal and its decoded code */
+	float QuantizeNormals(const float* normals, size_t count, uint8_t* dst, size_t dstStride);
+
+	/* 4 floats per tangent, xyz normalized before encoding, w is the sign of the bitangent and becomes -1 or 1.
+	 * Returns the largest angle, in radians, between a direction and its decoded code */
+	float QuantizeTangents(const float* tangents, size_t count, uint8_t* dst, size_t dstStride);
+
+	/* each component clamped to [0, 1] to the closest unorm8. Returns the largest difference between a value and its decoded unorm */
+	float QuantizeUnorm8(const float* values, size_t count, uint32_t components, uint8_t* dst, size_t dstStride);
+
+	/* each of the up to 4 components to a half (see PixelConvert::FloatToHalf). Returns the largest difference between a value and its decoded half */
+	float QuantizeHalf(const float* values, size_t count, uint32_t components, uint8_t* dst, size_t dstStride);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Fixed set of worker threads consuming a job queue, shared by the loading code (image decode, conversions).
+ * ParallelFor makes the calling thread work too and returns once every index is done, so it may be called
+ * from a worker without deadlocking the pool. */
+class WorkerPool
+{
+public:
+
+	/* 0 uses one thread per core, minus the calling thread */
+	WorkerPool(unsigned int threadCount = 0);
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+	~WorkerPool();
+
+	/* the pool shared by the whole application, created on first use */
+	static WorkerPool& Get();
+
+	/* workers + the calling thread */
+	unsigned int GetConcurrency() const { return static_cast<unsigned int>(workers.size()) + 1; }
+
+	/* queue a job, there is no way to wait for it, it has to signal its end itself */
+	void Submit(std::function<void()> job);
+
+	/* call task(i) for every i in [0, count), in any order and on any thread, blocking until all are done */
+	void ParallelFor(size_t count, const std::function<void(size_t)>& task);
+
+private:
+
+	std::vector<std::thread>			workers;
+	std::deque<std::function<void()>>	jobs;
+	std::mutex							jobsMutex;
+	std::condition_variable				jobsCondition;
+	bool								isStopping = false;
+
+	void WorkerLoop();
+};
@@ -0,0 +1,204 @@
+/* system include */
+#include <chrono>
+#include <cstdio>
+#include <system_error>
+
+#include "AssetStreamer.hpp"
+#include "DX12Handle.hpp"
+#include "MeshCache.hpp"
+#include "StaticBatch.hpp"
+#include "WorkerPool.hpp"
+
+StreamedModel::~StreamedModel()
+{
+	for (ID3D12DescriptorHeap* heap : placeholderHeaps)
+	{
+		if (heap)
+			heap->Release();
+	}
+
+	for (ID3D12DescriptorHeap* heap : textureHeaps)
+	{
+		if (heap)
+			heap->Release();
+	}
+
+	for (ID3D12Resource* texture : textures)
+	{
+		if (texture)
+			texture->Release();
+	}
+
+	for (ID3D12Resource* buffer : vertexBuffers)
+	{
+		if (buffer)
+			buffer->Release();
+	}
+}
+
+AssetStreamer::AssetStreamer(const DX12Handle& dx12Handle_) :
+	device	{ dx12Handle_._device },
+	queue	{ dx12Handle_._queue }
+{
+
+}
+
+AssetStreamer::~AssetStreamer()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	isStopping = true;
+	jobsCondition.wait(lock, [this] { return jobCount == 0; });
+}
+
+std::shared_ptr<StreamedModel> AssetStreamer::LoadModel(const std::string& filePath, bool staticBatching)
+{
+	std::shared_ptr<StreamedModel> streamedModel = std::make_shared<StreamedModel>();
+	streamedModel->filePath = filePath;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobCount++;
+	}
+
+	WorkerPool::Get().Submit([this, streamedModel, staticBatching]()
+	{
+		/* a model whose images failed is still drawn with the placeholder */
+		if (!Stream(streamedModel, staticBatching))
+		{
+			Finish([streamedModel]()
+			{
+				if (streamedModel->models.empty())
+					streamedModel->state = StreamedModel::STATE_FAILED;
+			});
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		jobCount--;
+		jobsCondition.notify_all();
+	});
+
+	return streamedModel;
+}
+
+bool AssetStreamer::Update()
+{
+	std::vector<std::function<void()>> steps;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		steps.swap(finishedSteps);
+	}
+
+	for (std::function<void()>& step : steps)
+		step();
+
+	return !steps.empty();
+}
+
+void AssetStreamer::Finish(std::function<void()> step)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	finishedSteps.push_back(std::move(step));
+}
+
+/* an uploader recording with the allocator of the job and waiting on its event, the allocator is free again */
+static bool MakeStreamUploader(DX12Helper::DefaultResourceUploader& uploader, ID3D12Device* device, ID3D12CommandQueue* queue,
+							   ID3D12CommandAllocator* allocator, const HANDLE& fenceEvent)
+{
+	if (FAILED(allocator->Reset()))
+		return false;
+
+	return DX12Helper::MakeUploader(uploader, device, queue, allocator, &fenceEvent);
+}
+
+bool AssetStreamer::Stream(const std::shared_ptr<StreamedModel>& streamedModel, bool staticBatching)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	ID3D12CommandAllocator* allocator = nullptr;
+	HRESULT hr = device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator));
+	if (FAILED(hr))
+	{
+		printf("Failing creating the stream command allocator of %s: %s\n", streamedModel->filePath.c_str(), std::system_category().message(hr).c_str());
+		return false;
+	}
+
+	HANDLE fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+	/* the cached model keeps the mapping alive until the images are uploaded */
+	MeshCache::CachedModel		model;
+	StaticBatch::Arena			arena;
+	DX12Helper::ModelResource	modelResource = {};
+	modelResource.descHeaps		= &streamedModel->placeholderHeaps;
+	modelResource.textures		= &streamedModel->textures;
+	modelResource.vertexBuffers	= &streamedModel->vertexBuffers;
+
+	bool isStreamed = fenceEvent && MeshCache::Load(streamedModel->filePath, model);
+	if (isStreamed && staticBatching)
+		StaticBatch::Build(model.view, arena);
+
+	/* the meshes, with the placeholder in every material */
+	if (isStreamed)
+	{
+		DX12Helper::DefaultResourceUploader uploader;
+		isStreamed = MakeStreamUploader(uploader, device, queue, allocator, fenceEvent) &&
+					 DX12Helper::UploadMeshBuffer(model.view, modelResource, uploader, &arena) &&
+					 DX12Helper::UploadBatchBuffer(model.view, arena, modelResource, uploader) &&
+					 DX12Helper::UploadPlaceholderTexture(model.view, modelResource, uploader) &&
+					 DX12Helper::UploadResources(uploader) &&
+					 DX12Helper::UploadMesh(model.view, modelResource, uploader, &arena) &&
+					 DX12Helper::UploadBatch(model.view, arena, modelResource) &&
+					 DX12Helper::UploadTexture(model.view, modelResource, uploader);
+	}
+
+	double meshMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	if (isStreamed)
+	{
+		Finish([streamedModel, models = modelResource.models]()
+		{
+			streamedModel->models	= models;
+			streamedModel->state	= StreamedModel::STATE_PLACEHOLDER;
+		});
+	}
+
+	/* then the images, in new heaps as the placeholder ones may be in flight */
+	bool isStopped = false;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		isStopped = isStopping;
+	}
+
+	if (isStreamed && !isStopped)
+	{
+		modelResource.descHeaps = &streamedModel->textureHeaps;
+
+		DX12Helper::DefaultResourceUploader uploader;
+		isStreamed = MakeStreamUploader(uploader, device, queue, allocator, fenceEvent) &&
+					 DX12Helper::UploadTextureBuffer(model.view, modelResource, uploader) &&
+					 DX12Helper::UploadResources(uploader) &&
+					 DX12Helper::UploadTexture(model.view, modelResource, uploader);
+
+		if (isStreamed)
+		{
+			Finish([streamedModel, models = modelResource.models]()
+			{
+				for (size_t i = 0; i < models.size(); i++)
+				{
+					streamedModel->models[i].descHeap	= models[i].descHeap;
+					streamedModel->models[i].textures	= models[i].textures;
+				}
+				streamedModel->state = StreamedModel::STATE_READY;
+			});
+		}
+	}
+
+	double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	if (isStreamed)
+		printf("Streamed %s from %s, meshes in %.2f ms, textures in %.2f ms\n", streamedModel->filePath.c_str(),
+			   model.isFromCache ? "baked cache" : "glTF", meshMs, totalMs - meshMs);
+
+	if (fenceEvent)
+		CloseHandle(fenceEvent);
+	allocator->Release();
+
+	return isStreamed;
+}
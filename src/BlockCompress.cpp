@@ -0,0 +1,636 @@
+/* system include */
+#include <cmath>
+#include <cstring>
+
+#include "BlockCompress.hpp"
+#include "WorkerPool.hpp"
+
+/* rows of blocks encoded by one job */
+#define BLOCK_COMPRESS_BAND_ROWS	8
+
+/* least squares passes run after the principal axis fit, each one is kept only when it lowers the error */
+#define BLOCK_COMPRESS_REFINE_COUNT	2
+
+/*===== FIT =====*/
+
+static inline float Clamp(float value, float min, float max)
+{
+	return value < min ? min : (value > max ? max : value);
+}
+
+/* principal axis of the points of a block (power iteration on the covariance), zero for a flat block */
+static void GetPrincipalAxis(const float (*points)[4], uint32_t channels, const float mean[4], float axis[4])
+{
+	float covariance[4][4] = {};
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		for (uint32_t a = 0; a < channels; a++)
+		{
+			for (uint32_t b = a; b < channels; b++)
+				covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+		}
+	}
+
+	for (uint32_t a = 0; a < channels; a++)
+	{
+		for (uint32_t b = 0; b < a; b++)
+			covariance[a][b] = covariance[b][a];
+	}
+
+	/* start from the diagonal with the largest spread, it is rarely orthogonal to the answer */
+	uint32_t largest = 0;
+	for (uint32_t a = 1; a < channels; a++)
+	{
+		if (covariance[a][a] > covariance[largest][largest])
+			largest = a;
+	}
+
+	for (uint32_t a = 0; a < 4; a++)
+		axis[a] = a < channels ? covariance[largest][a] : 0.f;
+
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[4] = {};
+		float length = 0.f;
+		for (uint32_t a = 0; a < channels; a++)
+		{
+			for (uint32_t b = 0; b < channels; b++)
+				next[a] += covariance[a][b] * axis[b];
+			length += next[a] * next[a];
+		}
+
+		if (length < 1e-12f)
+		{
+			for (uint32_t a = 0; a < 4; a++)
+				axis[a] = 0.f;
+			return;
+		}
+
+		length = 1.f / std::sqrt(length);
+		for (uint32_t a = 0; a < channels; a++)
+			axis[a] = next[a] * length;
+	}
+}
+
+/* endpoints at the extremes of the projections of the points on their principal axis */
+static void FitEndpoints(const float (*points)[4], uint32_t channels, float endpoint0[4], float endpoint1[4])
+{
+	float mean[4] = {};
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		for (uint32_t c = 0; c < channels; c++)
+			mean[c] += points[i][c];
+	}
+	for (uint32_t c = 0; c < channels; c++)
+		mean[c] /= 16.f;
+
+	float axis[4];
+	GetPrincipalAxis(points, channels, mean, axis);
+
+	float minProjection = 0.f;
+	float maxProjection = 0.f;
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		float projection = 0.f;
+		for (uint32_t c = 0; c < channels; c++)
+			projection += (points[i][c] - mean[c]) * axis[c];
+
+		minProjection = projection < minProjection ? projection : minProjection;
+		maxProjection = projection > maxProjection ? projection : maxProjection;
+	}
+
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		endpoint0[c] = c < channels ? Clamp(mean[c] + axis[c] * minProjection, 0.f, 255.f) : 0.f;
+		endpoint1[c] = c < channels ? Clamp(mean[c] + axis[c] * maxProjection, 0.f, 255.f) : 0.f;
+	}
+}
+
+/* endpoints minimizing the error of the points for given interpolation weights (0 is endpoint0, 1 endpoint1),
+ * false when the weights do not allow it (all the same) */
+static bool RefitEndpoints(const float (*points)[4], uint32_t channels, const float weights[16], float endpoint0[4], float endpoint1[4])
+{
+	float a = 0.f;
+	float b = 0.f;
+	float c = 0.f;
+	float rhs0[4] = {};
+	float rhs1[4] = {};
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		float w		= weights[i];
+		float wInv	= 1.f - w;
+		a += wInv * wInv;
+		b += wInv * w;
+		c += w * w;
+
+		for (uint32_t ch = 0; ch < channels; ch++)
+		{
+			rhs0[ch] += wInv * points[i][ch];
+			rhs1[ch] += w * points[i][ch];
+		}
+	}
+
+	float determinant = a * c - b * b;
+	if (std::fabs(determinant) < 1e-6f)
+		return false;
+
+	determinant = 1.f / determinant;
+	for (uint32_t ch = 0; ch < channels; ch++)
+	{
+		endpoint0[ch] = Clamp((c * rhs0[ch] - b * rhs1[ch]) * determinant, 0.f, 255.f);
+		endpoint1[ch] = Clamp((a * rhs1[ch] - b * rhs0[ch]) * determinant, 0.f, 255.f);
+	}
+
+	return true;
+}
+
+/* little endian bit stream of a block */
+struct BlockWriter
+{
+	uint8_t*	block;
+	uint32_t	bit = 0;
+
+	void Write(uint32_t value, uint32_t bitCount)
+	{
+		for (uint32_t i = 0; i < bitCount; i++, bit++)
+		{
+			if (value & (1u << i))
+				block[bit >> 3] |= uint8_t(1u << (bit & 7));
+		}
+	}
+};
+
+/*===== BC1 =====*/
+
+struct Color565
+{
+	uint16_t	packed;
+	float		rgb[3];
+};
+
+static Color565 QuantizeColor565(const float rgb[3])
+{
+	uint32_t r = static_cast<uint32_t>(rgb[0] * (31.f / 255.f) + 0.5f);
+	uint32_t g = static_cast<uint32_t>(rgb[1] * (63.f / 255.f) + 0.5f);
+	uint32_t b = static_cast<uint32_t>(rgb[2] * (31.f / 255.f) + 0.5f);
+
+	Color565 color;
+	color.packed = static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	color.rgb[0] = static_cast<float>((r << 3) | (r >> 2));
+	color.rgb[1] = static_cast<float>((g << 2) | (g >> 4));
+	color.rgb[2] = static_cast<float>((b << 3) | (b >> 2));
+	return color;
+}
+
+/* 4 colors palette : endpoint0, endpoint1, then the two thirds */
+static const float bc1Weights[4] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+
+static float SelectBC1Indices(const float (*points)[4], const Color565& color0, const Color565& color1, uint8_t indices[16])
+{
+	float palette[4][3];
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		for (uint32_t c = 0; c < 3; c++)
+			palette[i][c] = color0.rgb[c] + (color1.rgb[c] - color0.rgb[c]) * bc1Weights[i];
+	}
+
+	float error = 0.f;
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		float bestError = 1e30f;
+		for (uint8_t p = 0; p < 4; p++)
+		{
+			float dr = points[i][0] - palette[p][0];
+			float dg = points[i][1] - palette[p][1];
+			float db = points[i][2] - palette[p][2];
+			float pointError = dr * dr + dg * dg + db * db;
+			if (pointError < bestError)
+			{
+				bestError	= pointError;
+				indices[i]	= p;
+			}
+		}
+		error += bestError;
+	}
+
+	return error;
+}
+
+void BlockCompress::EncodeBC1(const uint8_t texels[64], uint8_t block[8])
+{
+	float points[16][4];
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+			points[i][c] = texels[i * 4 + c];
+	}
+
+	float endpoint0[4];
+	float endpoint1[4];
+	FitEndpoints(points, 3, endpoint0, endpoint1);
+
+	Color565	color0		= QuantizeColor565(endpoint0);
+	Color565	color1		= QuantizeColor565(endpoint1);
+	uint8_t		indices[16];
+	float		error		= SelectBC1Indices(points, color0, color1, indices);
+
+	for (int refine = 0; refine < BLOCK_COMPRESS_REFINE_COUNT; refine++)
+	{
+		float weights[16];
+		for (uint32_t i = 0; i < 16; i++)
+			weights[i] = bc1Weights[indices[i]];
+
+		if (!RefitEndpoints(points, 3, weights, endpoint0, endpoint1))
+			break;
+
+		Color565	refined0	= QuantizeColor565(endpoint0);
+		Color565	refined1	= QuantizeColor565(endpoint1);
+		uint8_t		refinedIndices[16];
+		float		refinedError = SelectBC1Indices(points, refined0, refined1, refinedIndices);
+		if (refinedError >= error)
+			break;
+
+		color0	= refined0;
+		color1	= refined1;
+		error	= refinedError;
+		memcpy(indices, refinedIndices, sizeof(indices));
+	}
+
+	/* the 4 colors mode needs color0 > color1, equal endpoints are the 3 colors mode where index 0 is still color0 */
+	if (color0.packed < color1.packed)
+	{
+		Color565 swap = color0;
+		color0 = color1;
+		color1 = swap;
+
+		for (uint32_t i = 0; i < 16; i++)
+			indices[i] ^= 1;
+	}
+	else if (color0.packed == color1.packed)
+	{
+		memset(indices, 0, sizeof(indices));
+	}
+
+	memset(block, 0, 8);
+	BlockWriter writer = { block };
+	writer.Write(color0.packed, 16);
+	writer.Write(color1.packed, 16);
+	for (uint32_t i = 0; i < 16; i++)
+		writer.Write(indices[i], 2);
+}
+
+/*===== BC4 =====*/
+
+/* weight of endpoint1 for the 8 values palette : endpoint0, endpoint1, then 6 values from endpoint0 to endpoint1 */
+static const float bc4Weights[8] = { 0.f, 1.f, 1.f / 7.f, 2.f / 7.f, 3.f / 7.f, 4.f / 7.f, 5.f / 7.f, 6.f / 7.f };
+
+static float SelectBC4Indices(const float (*points)[4], float value0, float value1, uint8_t indices[16])
+{
+	float palette[8];
+	for (uint32_t p = 0; p < 8; p++)
+		palette[p] = value0 + (value1 - value0) * bc4Weights[p];
+
+	float error = 0.f;
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		float bestError = 1e30f;
+		for (uint8_t p = 0; p < 8; p++)
+		{
+			float difference = points[i][0] - palette[p];
+			if (difference * difference < bestError)
+			{
+				bestError	= difference * difference;
+				indices[i]	= p;
+			}
+		}
+		error += bestError;
+	}
+
+	return error;
+}
+
+void BlockCompress::EncodeBC4(const uint8_t values[16], uint8_t block[8])
+{
+	float points[16][4] = {};
+	uint8_t minValue = 255;
+	uint8_t maxValue = 0;
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		points[i][0] = values[i];
+		minValue = values[i] < minValue ? values[i] : minValue;
+		maxValue = values[i] > maxValue ? values[i] : maxValue;
+	}
+
+	float	value0	= maxValue;
+	float	value1	= minValue;
+	uint8_t	indices[16];
+	float	error	= SelectBC4Indices(points, value0, value1, indices);
+
+	for (int refine = 0; refine < BLOCK_COMPRESS_REFINE_COUNT && error > 0.f; refine++)
+	{
+		float weights[16];
+		for (uint32_t i = 0; i < 16; i++)
+			weights[i] = bc4Weights[indices[i]];
+
+		float endpoint0[4];
+		float endpoint1[4];
+		if (!RefitEndpoints(points, 1, weights, endpoint0, endpoint1))
+			break;
+
+		float	refined0 = std::floor(endpoint0[0] + 0.5f);
+		float	refined1 = std::floor(endpoint1[0] + 0.5f);
+		uint8_t	refinedIndices[16];
+		float	refinedError = SelectBC4Indices(points, refined0, refined1, refinedIndices);
+		if (refinedError >= error)
+			break;
+
+		value0	= refined0;
+		value1	= refined1;
+		error	= refinedError;
+		memcpy(indices, refinedIndices, sizeof(indices));
+	}
+
+	/* the 8 values mode needs value0 > value1, equal values are the 6 values mode where index 0 is still value0 */
+	if (value0 < value1)
+	{
+		float swap = value0;
+		value0 = value1;
+		value1 = swap;
+
+		for (uint32_t i = 0; i < 16; i++)
+			indices[i] = indices[i] < 2 ? indices[i] ^ 1 : 9 - indices[i];
+	}
+	else if (value0 == value1)
+	{
+		memset(indices, 0, sizeof(indices));
+	}
+
+	memset(block, 0, 8);
+	BlockWriter writer = { block };
+	writer.Write(static_cast<uint32_t>(value0), 8);
+	writer.Write(static_cast<uint32_t>(value1), 8);
+	for (uint32_t i = 0; i < 16; i++)
+		writer.Write(indices[i], 3);
+}
+
+void BlockCompress::EncodeBC5(const uint8_t reds[16], const uint8_t greens[16], uint8_t block[16])
+{
+	EncodeBC4(reds, block);
+	EncodeBC4(greens, block + 8);
+}
+
+/*===== BC7 =====*/
+
+/* interpolation weights of 4 bits indices, out of 64 */
+static const uint32_t bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/* mode 6 endpoint : 7 bits per channel and a p-bit shared by the channels, giving 8 bits values */
+struct EndpointBC7
+{
+	uint32_t	quantized[4];
+	uint32_t	pBit;
+	uint32_t	values[4];
+};
+
+static EndpointBC7 QuantizeEndpointBC7(const float endpoint[4])
+{
+	EndpointBC7 best	= {};
+	float bestError		= 1e30f;
+	for (uint32_t pBit = 0; pBit < 2; pBit++)
+	{
+		EndpointBC7 candidate = {};
+		candidate.pBit = pBit;
+
+		float error = 0.f;
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			float quantized = std::floor((endpoint[c] - pBit) * 0.5f + 0.5f);
+			candidate.quantized[c]	= static_cast<uint32_t>(Clamp(quantized, 0.f, 127.f));
+			candidate.values[c]		= (candidate.quantized[c] << 1) | pBit;
+
+			float difference = candidate.values[c] - endpoint[c];
+			error += difference * difference;
+		}
+
+		if (error < bestError)
+		{
+			bestError	= error;
+			best		= candidate;
+		}
+	}
+
+	return best;
+}
+
+static float SelectBC7Indices(const uint8_t texels[64], const EndpointBC7& endpoint0, const EndpointBC7& endpoint1, uint8_t indices[16])
+{
+	int32_t palette[16][4];
+	for (uint32_t p = 0; p < 16; p++)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+			palette[p][c] = static_cast<int32_t>(((64 - bc7Weights[p]) * endpoint0.values[c] + bc7Weights[p] * endpoint1.values[c] + 32) >> 6);
+	}
+
+	/* the projection on the endpoints segment gives the index, its neighbours are checked for the rounding of the palette */
+	float axis[4];
+	float axisLength = 0.f;
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		axis[c] = static_cast<float>(endpoint1.values[c]) - static_cast<float>(endpoint0.values[c]);
+		axisLength += axis[c] * axis[c];
+	}
+	float projectionScale = axisLength > 0.f ? 15.f / axisLength : 0.f;
+
+	float error = 0.f;
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		const uint8_t* texel = texels + i * 4;
+
+		float projection = 0.f;
+		for (uint32_t c = 0; c < 4; c++)
+			projection += (texel[c] - static_cast<float>(endpoint0.values[c])) * axis[c];
+
+		int32_t guess	= static_cast<int32_t>(Clamp(projection * projectionScale + 0.5f, 0.f, 15.f));
+		int32_t first	= guess > 0 ? guess - 1 : 0;
+		int32_t last	= guess < 15 ? guess + 1 : 15;
+
+		int32_t bestError = INT32_MAX;
+		for (int32_t p = first; p <= last; p++)
+		{
+			int32_t pointError = 0;
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				int32_t difference = texel[c] - palette[p][c];
+				pointError += difference * difference;
+			}
+
+			if (pointError < bestError)
+			{
+				bestError	= pointError;
+				indices[i]	= static_cast<uint8_t>(p);
+			}
+		}
+		error += static_cast<float>(bestError);
+	}
+
+	return error;
+}
+
+void BlockCompress::EncodeBC7(const uint8_t texels[64], uint8_t block[16])
+{
+	float points[16][4];
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+			points[i][c] = texels[i * 4 + c];
+	}
+
+	float endpoint0[4];
+	float endpoint1[4];
+	FitEndpoints(points, 4, endpoint0, endpoint1);
+
+	EndpointBC7	quantized0	= QuantizeEndpointBC7(endpoint0);
+	EndpointBC7	quantized1	= QuantizeEndpointBC7(endpoint1);
+	uint8_t		indices[16];
+	float		error		= SelectBC7Indices(texels, quantized0, quantized1, indices);
+
+	for (int refine = 0; refine < BLOCK_COMPRESS_REFINE_COUNT && error > 0.f; refine++)
+	{
+		float weights[16];
+		for (uint32_t i = 0; i < 16; i++)
+			weights[i] = bc7Weights[indices[i]] / 64.f;
+
+		if (!RefitEndpoints(points, 4, weights, endpoint0, endpoint1))
+			break;
+
+		EndpointBC7	refined0	= QuantizeEndpointBC7(endpoint0);
+		EndpointBC7	refined1	= QuantizeEndpointBC7(endpoint1);
+		uint8_t		refinedIndices[16];
+		float		refinedError = SelectBC7Indices(texels, refined0, refined1, refinedIndices);
+		if (refinedError >= error)
+			break;
+
+		quantized0	= refined0;
+		quantized1	= refined1;
+		error		= refinedError;
+		memcpy(indices, refinedIndices, sizeof(indices));
+	}
+
+	/* the first index is stored without its high bit, the endpoints are swapped when it is set */
+	if (indices[0] & 8)
+	{
+		EndpointBC7 swap = quantized0;
+		quantized0 = quantized1;
+		quantized1 = swap;
+
+		for (uint32_t i = 0; i < 16; i++)
+			indices[i] = 15 - indices[i];
+	}
+
+	memset(block, 0, 16);
+	BlockWriter writer = { block };
+	writer.Write(1u << 6, 7);	/* mode 6 */
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		writer.Write(quantized0.quantized[c], 7);
+		writer.Write(quantized1.quantized[c], 7);
+	}
+	writer.Write(quantized0.pBit, 1);
+	writer.Write(quantized1.pBit, 1);
+
+	writer.Write(indices[0], 3);
+	for (uint32_t i = 1; i < 16; i++)
+		writer.Write(indices[i], 4);
+}
+
+/*===== LEVEL =====*/
+
+uint32_t BlockCompress::GetBlockSize(EFormat format)
+{
+	switch (format)
+	{
+		case FORMAT_BC1:
+		case FORMAT_BC4:	return 8;
+		case FORMAT_BC5:
+		case FORMAT_BC7:	return 16;
+		default:			return 0;
+	}
+}
+
+size_t BlockCompress::GetRowPitch(uint32_t width, EFormat format)
+{
+	return size_t((width + 3) / 4) * GetBlockSize(format);
+}
+
+size_t BlockCompress::GetLevelSize(uint32_t width, uint32_t height, EFormat format)
+{
+	return GetRowPitch(width, format) * ((height + 3) / 4);
+}
+
+static void EncodeBlock(const uint8_t texels[64], BlockCompress::EFormat format, uint8_t* block)
+{
+	uint8_t channels[2][16];
+
+	switch (format)
+	{
+		case BlockCompress::FORMAT_BC1:
+			BlockCompress::EncodeBC1(texels, block);
+			break;
+		case BlockCompress::FORMAT_BC4:
+			for (uint32_t i = 0; i < 16; i++)
+				channels[0][i] = texels[i * 4];
+			BlockCompress::EncodeBC4(channels[0], block);
+			break;
+		case BlockCompress::FORMAT_BC5:
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				channels[0][i] = texels[i * 4];
+				channels[1][i] = texels[i * 4 + 1];
+			}
+			BlockCompress::EncodeBC5(channels[0], channels[1], block);
+			break;
+		case BlockCompress::FORMAT_BC7:
+			BlockCompress::EncodeBC7(texels, block);
+			break;
+		default:
+			break;
+	}
+}
+
+void BlockCompress::Encode(const uint8_t* src, size_t srcRowPitch, uint32_t width, uint32_t height, EFormat format, uint8_t* dst, size_t dstRowPitch)
+{
+	uint32_t blockSize	= GetBlockSize(format);
+	uint32_t blockRows	= (height + 3) / 4;
+	uint32_t blockCols	= (width + 3) / 4;
+	uint32_t bandCount	= (blockRows + BLOCK_COMPRESS_BAND_ROWS - 1) / BLOCK_COMPRESS_BAND_ROWS;
+
+	if (blockSize == 0 || width == 0 || height == 0)
+		return;
+
+	WorkerPool::Get().ParallelFor(bandCount, [&](size_t band)
+	{
+		uint32_t firstRow	= static_cast<uint32_t>(band) * BLOCK_COMPRESS_BAND_ROWS;
+		uint32_t lastRow	= firstRow + BLOCK_COMPRESS_BAND_ROWS < blockRows ? firstRow + BLOCK_COMPRESS_BAND_ROWS : blockRows;
+
+		uint8_t texels[64];
+		for (uint32_t blockY = firstRow; blockY < lastRow; blockY++)
+		{
+			uint8_t* block = dst + blockY * dstRowPitch;
+			for (uint32_t blockX = 0; blockX < blockCols; blockX++, block += blockSize)
+			{
+				for (uint32_t y = 0; y < 4; y++)
+				{
+					uint32_t		srcY	= blockY * 4 + y < height ? blockY * 4 + y : height - 1;
+					const uint8_t*	srcRow	= src + srcY * srcRowPitch;
+					for (uint32_t x = 0; x < 4; x++)
+					{
+						uint32_t srcX = blockX * 4 + x < width ? blockX * 4 + x : width - 1;
+						memcpy(texels + (y * 4 + x) * 4, srcRow + srcX * 4, 4);
+					}
+				}
+
+				EncodeBlock(texels, format, block);
+			}
+		}
+	});
+}
@@ -0,0 +1,30 @@
+/* system include */
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+
+#include "CacheFile.hpp"
+
+bool CacheFile::Write(const std::string& filePath, const void* data, size_t size)
+{
+	std::string tmpPath = filePath + ".tmp";
+
+	FILE* file = fopen(tmpPath.c_str(), "wb");
+	if (!file)
+		return false;
+
+	bool isWritten = fwrite(data, 1, size, file) == size;
+	isWritten &= fclose(file) == 0;
+
+	std::error_code error;
+	if (isWritten)
+		std::filesystem::rename(tmpPath, filePath, error);
+
+	if (!isWritten || error)
+	{
+		std::filesystem::remove(tmpPath, error);
+		return false;
+	}
+
+	return true;
+}
@@ -15,10 +15,9 @@ void Camera::UpdateFreeFly(const CameraInputs& inputs)
     float inclination = pitch;
 
     // Spheric coordinates
-    float cosAzimuth     = std::cos(azimuth);
-    float sinAzimuth     = std::sin(azimuth);
-    float cosInclination = std::cos(inclination);
-    float sinInclination = std::sin(inclination);
+    float cosAzimuth, sinAzimuth, cosInclination, sinInclination;
+    GPM::fastSinCos(azimuth, sinAzimuth, cosAzimuth);
+    GPM::fastSinCos(inclination, sinInclination, cosInclination);
 
     // Compute speed
     float speed = 4.f;
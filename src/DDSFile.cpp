@@ -0,0 +1,347 @@
+/* system include */
+#include <cstdio>
+#include <cstring>
+
+#include "DDSFile.hpp"
+
+/* the flags read in the legacy header */
+#define DDS_HEADER_FLAGS_VOLUME		0x800000u	/* DDSD_DEPTH */
+#define DDS_PIXEL_FORMAT_FOURCC		0x4u
+#define DDS_PIXEL_FORMAT_RGB		0x40u
+#define DDS_PIXEL_FORMAT_LUMINANCE	0x20000u
+#define DDS_PIXEL_FORMAT_ALPHA		0x2u
+#define DDS_CAPS2_CUBEMAP			0x200u
+#define DDS_CAPS2_CUBEMAP_ALLFACES	0xFC00u
+
+/* D3D12_RESOURCE_MISC_TEXTURECUBE in the DX10 header */
+#define DDS_MISC_TEXTURECUBE		0x4u
+
+#define DDS_MAKE_FOURCC(a, b, c, d) (uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24))
+
+static_assert(sizeof(DDSFile::Header) == 124, "the dds header is 124 bytes");
+static_assert(sizeof(DDSFile::HeaderDX10) == 20, "the dx10 header is 20 bytes");
+
+/*===== FORMATS =====*/
+
+bool DDSFile::GetFormatSize(uint32_t dxgiFormat, uint32_t& size, bool& isBlock)
+{
+	isBlock = false;
+
+	/* ranges of DXGI_FORMAT */
+	if (dxgiFormat >= 1 && dxgiFormat <= 4)			size = 128;	/* R32G32B32A32 */
+	else if (dxgiFormat >= 5 && dxgiFormat <= 8)	size = 96;	/* R32G32B32 */
+	else if (dxgiFormat >= 9 && dxgiFormat <= 22)	size = 64;	/* R16G16B16A16, R32G32, R32G8X24 */
+	else if (dxgiFormat >= 23 && dxgiFormat <= 47)	size = 32;	/* R10G10B10A2, R11G11B10, R8G8B8A8, R16G16, R32, R24G8 */
+	else if (dxgiFormat >= 48 && dxgiFormat <= 59)	size = 16;	/* R8G8, R16 */
+	else if (dxgiFormat >= 60 && dxgiFormat <= 65)	size = 8;	/* R8, A8 */
+	else if (dxgiFormat == 67)						size = 32;	/* R9G9B9E5 */
+	else if (dxgiFormat == 85 || dxgiFormat == 86)	size = 16;	/* B5G6R5, B5G5R5A1 */
+	else if (dxgiFormat >= 87 && dxgiFormat <= 93)	size = 32;	/* B8G8R8A8, B8G8R8X8, R10G10B10_XR_BIAS_A2 */
+	else if (dxgiFormat == 115)						size = 16;	/* B4G4R4A4 */
+	else if ((dxgiFormat >= 70 && dxgiFormat <= 72) || (dxgiFormat >= 79 && dxgiFormat <= 81))
+	{
+		/* BC1, BC4 */
+		size	= 8;
+		isBlock	= true;
+	}
+	else if ((dxgiFormat >= 73 && dxgiFormat <= 78) || (dxgiFormat >= 82 && dxgiFormat <= 84) || (dxgiFormat >= 94 && dxgiFormat <= 99))
+	{
+		/* BC2, BC3, BC5, BC6H, BC7 */
+		size	= 16;
+		isBlock	= true;
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+bool DDSFile::GetSurfaceSize(uint32_t dxgiFormat, uint32_t width, uint32_t height, size_t& rowSize, uint32_t& rowCount)
+{
+	uint32_t	size;
+	bool		isBlock;
+	if (!GetFormatSize(dxgiFormat, size, isBlock))
+		return false;
+
+	if (isBlock)
+	{
+		rowSize		= size_t((width + 3) / 4) * size;
+		rowCount	= (height + 3) / 4;
+	}
+	else
+	{
+		rowSize		= (size_t(width) * size + 7) / 8;
+		rowCount	= height;
+	}
+
+	return true;
+}
+
+static bool IsMask(const DDSFile::PixelFormat& pixelFormat, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+	return pixelFormat.masks[0] == r && pixelFormat.masks[1] == g && pixelFormat.masks[2] == b && pixelFormat.masks[3] == a;
+}
+
+/* the DXGI_FORMAT of a legacy header, the common subset of what the dds writers produce */
+static uint32_t GetLegacyFormat(const DDSFile::PixelFormat& pixelFormat)
+{
+	if (pixelFormat.flags & DDS_PIXEL_FORMAT_FOURCC)
+	{
+		switch (pixelFormat.fourCC)
+		{
+			case DDS_MAKE_FOURCC('D', 'X', 'T', '1'):	return 71;	/* BC1_UNORM */
+			case DDS_MAKE_FOURCC('D', 'X', 'T', '2'):
+			case DDS_MAKE_FOURCC('D', 'X', 'T', '3'):	return 74;	/* BC2_UNORM */
+			case DDS_MAKE_FOURCC('D', 'X', 'T', '4'):
+			case DDS_MAKE_FOURCC('D', 'X', 'T', '5'):	return 77;	/* BC3_UNORM */
+			case DDS_MAKE_FOURCC('A', 'T', 'I', '1'):
+			case DDS_MAKE_FOURCC('B', 'C', '4', 'U'):	return 80;	/* BC4_UNORM */
+			case DDS_MAKE_FOURCC('B', 'C', '4', 'S'):	return 81;	/* BC4_SNORM */
+			case DDS_MAKE_FOURCC('A', 'T', 'I', '2'):
+			case DDS_MAKE_FOURCC('B', 'C', '5', 'U'):	return 83;	/* BC5_UNORM */
+			case DDS_MAKE_FOURCC('B', 'C', '5', 'S'):	return 84;	/* BC5_SNORM */
+
+			/* D3DFORMAT numbers */
+			case 36:	return 11;	/* A16B16G16R16 : R16G16B16A16_UNORM */
+			case 110:	return 13;	/* Q16W16V16U16 : R16G16B16A16_SNORM */
+			case 111:	return 54;	/* R16F : R16_FLOAT */
+			case 112:	return 34;	/* G16R16F : R16G16_FLOAT */
+			case 113:	return 10;	/* A16B16G16R16F : R16G16B16A16_FLOAT */
+			case 114:	return 41;	/* R32F : R32_FLOAT */
+			case 115:	return 16;	/* G32R32F : R32G32_FLOAT */
+			case 116:	return 2;	/* A32B32G32R32F : R32G32B32A32_FLOAT */
+			default:	return 0;
+		}
+	}
+
+	if (pixelFormat.flags & DDS_PIXEL_FORMAT_RGB)
+	{
+		switch (pixelFormat.rgbBitCount)
+		{
+			case 32:
+				if (IsMask(pixelFormat, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))	return 28;	/* R8G8B8A8_UNORM */
+				if (IsMask(pixelFormat, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000))	return 87;	/* B8G8R8A8_UNORM */
+				if (IsMask(pixelFormat, 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000))	return 88;	/* B8G8R8X8_UNORM */
+				if (IsMask(pixelFormat, 0x0000ffff, 0xffff0000, 0x00000000, 0x00000000))	return 35;	/* R16G16_UNORM */
+				if (IsMask(pixelFormat, 0xffffffff, 0x00000000, 0x00000000, 0x00000000))	return 41;	/* R32_FLOAT, as the D3DX writers */
+				return 0;
+			case 16:
+				if (IsMask(pixelFormat, 0xf800, 0x07e0, 0x001f, 0x0000))	return 85;	/* B5G6R5_UNORM */
+				if (IsMask(pixelFormat, 0x7c00, 0x03e0, 0x001f, 0x8000))	return 86;	/* B5G5R5A1_UNORM */
+				if (IsMask(pixelFormat, 0x0f00, 0x00f0, 0x000f, 0xf000))	return 115;	/* B4G4R4A4_UNORM */
+				return 0;
+			default:
+				return 0;
+		}
+	}
+
+	if (pixelFormat.flags & DDS_PIXEL_FORMAT_LUMINANCE)
+	{
+		if (pixelFormat.rgbBitCount == 8 && pixelFormat.masks[0] == 0xff)		return 61;	/* R8_UNORM */
+		if (pixelFormat.rgbBitCount == 16 && pixelFormat.masks[0] == 0xffff)	return 56;	/* R16_UNORM */
+		if (pixelFormat.rgbBitCount == 16 && pixelFormat.masks[0] == 0x00ff && pixelFormat.masks[3] == 0xff00)
+			return 49;	/* R8G8_UNORM */
+		return 0;
+	}
+
+	if ((pixelFormat.flags & DDS_PIXEL_FORMAT_ALPHA) && pixelFormat.rgbBitCount == 8)
+		return 65;	/* A8_UNORM */
+
+	return 0;
+}
+
+static uint32_t GetLevelSize(uint32_t size, uint32_t level)
+{
+	uint32_t levelSize = size >> level;
+	return levelSize > 0 ? levelSize : 1;
+}
+
+/*===== PARSE =====*/
+
+bool DDSFile::Parse(const uint8_t* data, size_t size, Desc& desc, std::vector<Surface>& surfaces)
+{
+	uint32_t magic = 0;
+	Header header;
+	if (!data || size < sizeof(magic) + sizeof(Header))
+		return false;
+
+	memcpy(&magic, data, sizeof(magic));
+	memcpy(&header, data + sizeof(magic), sizeof(header));
+	if (magic != DDS_MAGIC || header.size != sizeof(Header) || header.pixelFormat.size != sizeof(PixelFormat))
+		return false;
+
+	size_t offset = sizeof(magic) + sizeof(Header);
+
+	desc			= Desc();
+	desc.width		= header.width;
+	desc.height		= header.height > 0 ? header.height : 1;
+	desc.mipCount	= header.mipMapCount > 0 ? header.mipMapCount : 1;
+
+	if ((header.pixelFormat.flags & DDS_PIXEL_FORMAT_FOURCC) && header.pixelFormat.fourCC == DDS_FOURCC_DX10)
+	{
+		HeaderDX10 headerDX10;
+		if (size < offset + sizeof(HeaderDX10))
+			return false;
+
+		memcpy(&headerDX10, data + offset, sizeof(headerDX10));
+		offset += sizeof(HeaderDX10);
+
+		desc.dxgiFormat	= headerDX10.dxgiFormat;
+		desc.dimension	= headerDX10.resourceDimension;
+		desc.arraySize	= headerDX10.arraySize;
+
+		if (desc.dimension == DDS_DIMENSION_TEXTURE1D)
+		{
+			desc.height = 1;
+		}
+		else if (desc.dimension == DDS_DIMENSION_TEXTURE2D)
+		{
+			desc.isCube = (headerDX10.miscFlag & DDS_MISC_TEXTURECUBE) != 0;
+			if (desc.isCube)
+				desc.arraySize *= 6;
+		}
+		else if (desc.dimension == DDS_DIMENSION_TEXTURE3D)
+		{
+			desc.depth = header.depth > 0 ? header.depth : 1;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	else
+	{
+		desc.dxgiFormat = GetLegacyFormat(header.pixelFormat);
+
+		if (header.flags & DDS_HEADER_FLAGS_VOLUME)
+		{
+			desc.dimension	= DDS_DIMENSION_TEXTURE3D;
+			desc.depth		= header.depth > 0 ? header.depth : 1;
+		}
+		else if (header.caps[1] & DDS_CAPS2_CUBEMAP)
+		{
+			/* d3d12 has no partial cubes */
+			if ((header.caps[1] & DDS_CAPS2_CUBEMAP_ALLFACES) != DDS_CAPS2_CUBEMAP_ALLFACES)
+				return false;
+
+			desc.isCube		= true;
+			desc.arraySize	= 6;
+		}
+	}
+
+	/* a volume is a single array slice */
+	if (desc.width == 0 || desc.arraySize == 0 || (desc.dimension == DDS_DIMENSION_TEXTURE3D && desc.arraySize != 1) || desc.mipCount > 32)
+		return false;
+
+	/* the mips stop at 1x1(x1) */
+	uint32_t largest	= desc.width > desc.height ? desc.width : desc.height;
+	largest				= largest > desc.depth ? largest : desc.depth;
+	uint32_t levelCount = 1;
+	while ((largest >> levelCount) > 0)
+		levelCount++;
+	if (desc.mipCount > levelCount)
+		return false;
+
+	uint32_t formatSize;
+	bool	 isBlock;
+	if (!GetFormatSize(desc.dxgiFormat, formatSize, isBlock))
+	{
+		printf("DDS file: format %u is not read\n", desc.dxgiFormat);
+		return false;
+	}
+
+	surfaces.clear();
+	surfaces.reserve(size_t(desc.arraySize) * desc.mipCount);
+	for (uint32_t slice = 0; slice < desc.arraySize; slice++)
+	{
+		for (uint32_t mip = 0; mip < desc.mipCount; mip++)
+		{
+			Surface surface;
+			surface.offset	= offset;
+			surface.depth	= GetLevelSize(desc.depth, mip);
+			GetSurfaceSize(desc.dxgiFormat, GetLevelSize(desc.width, mip), GetLevelSize(desc.height, mip), surface.rowSize, surface.rowCount);
+
+			/* a truncated file would only fail in the middle of the upload */
+			uint64_t surfaceSize = uint64_t(surface.rowSize) * surface.rowCount * surface.depth;
+			if (surfaceSize > size - offset)
+				return false;
+
+			offset += static_cast<size_t>(surfaceSize);
+			surfaces.push_back(surface);
+		}
+	}
+
+	return true;
+}
+
+/*===== UPLOAD =====*/
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+uint64_t DDSFile::GetFootprints(const Desc& desc, std::vector<Footprint>& footprints)
+{
+	uint32_t formatSize;
+	bool	 isBlock;
+	if (!GetFormatSize(desc.dxgiFormat, formatSize, isBlock))
+		return 0;
+
+	footprints.clear();
+	footprints.reserve(size_t(desc.arraySize) * desc.mipCount);
+
+	uint64_t offset		= 0;
+	uint64_t totalSize	= 0;
+	for (uint32_t slice = 0; slice < desc.arraySize; slice++)
+	{
+		for (uint32_t mip = 0; mip < desc.mipCount; mip++)
+		{
+			uint32_t width	= GetLevelSize(desc.width, mip);
+			uint32_t height	= GetLevelSize(desc.height, mip);
+
+			size_t		rowSize;
+			uint32_t	rowCount;
+			GetSurfaceSize(desc.dxgiFormat, width, height, rowSize, rowCount);
+
+			Footprint footprint;
+			footprint.offset	= AlignUp(offset, DDS_FOOTPRINT_PLACEMENT_ALIGNMENT);
+			footprint.width		= isBlock ? static_cast<uint32_t>(AlignUp(width, 4)) : width;
+			footprint.height	= isBlock ? static_cast<uint32_t>(AlignUp(height, 4)) : height;
+			footprint.depth		= GetLevelSize(desc.depth, mip);
+			footprint.rowPitch	= static_cast<uint32_t>(AlignUp(rowSize, DDS_FOOTPRINT_PITCH_ALIGNMENT));
+			footprints.push_back(footprint);
+
+			/* as GetCopyableFootprints, the last row of a subresource is not padded */
+			totalSize	= footprint.offset + uint64_t(footprint.rowPitch) * (uint64_t(rowCount) * footprint.depth - 1) + rowSize;
+			offset		= totalSize;
+		}
+	}
+
+	return totalSize;
+}
+
+void DDSFile::CopySurface(const uint8_t* data, const Surface& surface, const Footprint& footprint, uint8_t* dst)
+{
+	const uint8_t*	src			= data + surface.offset;
+	uint8_t*		dstSurface	= dst + footprint.offset;
+
+	/* the rows already fall on the pitch */
+	if (surface.rowSize == footprint.rowPitch)
+	{
+		memcpy(dstSurface, src, surface.rowSize * surface.rowCount * surface.depth);
+		return;
+	}
+
+	for (uint32_t slice = 0; slice < surface.depth; slice++)
+	{
+		for (uint32_t row = 0; row < surface.rowCount; row++)
+		{
+			memcpy(dstSurface, src, surface.rowSize);
+			src			+= surface.rowSize;
+			dstSurface	+= footprint.rowPitch;
+		}
+	}
+}
@@ -8,11 +8,17 @@
 #include <GLFW/glfw3native.h>
 
 #include "DX12Handle.hpp"
+#include "DX12Helper.hpp"
+
+/* the driver blobs of the pipelines, beside the compiled shaders */
+#define PIPELINE_CACHE_PATH "media/shadercache/pipelines" PIPELINE_CACHE_EXT
 
 
 /*==== CONSTRUCTORS =====*/
 DX12Handle::~DX12Handle()
 {
+	/* writes the blobs of the pipelines and releases them, before the device */
+	_pipelineCache.reset();
 
 	if (_factory)
 		_factory->Release();
@@ -56,7 +62,8 @@ bool DX12Handle::Init(GLFWwindow* window, unsigned int windowWidth, unsigned int
 		&& CreateBackBuffer(bufferCount) 
 		&& MakeDepthBuffer(windowWidth, windowHeight)
 		&& CreateCmdObjects(bufferCount)
-		&& CreateFenceObjects(bufferCount);
+		&& CreateFenceObjects(bufferCount)
+		&& CreatePipelineCache();
 }
 
 bool DX12Handle::CreateDevice()
@@ -295,6 +302,13 @@ bool DX12Handle::CreateFenceObjects(unsigned int bufferCount)
 	return true;
 }
 
+bool DX12Handle::CreatePipelineCache()
+{
+	_pipelineCache = std::make_unique<DX12Helper::PipelineStateCache>(_device, PIPELINE_CACHE_PATH);
+
+	return true;
+}
+
 /*===== Setup Methods =====*/
 
 bool DX12Handle::ResizeBuffer(unsigned int windowWidth, unsigned int windowHeight)
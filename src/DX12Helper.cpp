@@ -1,24 +1,40 @@
 /* system include */
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <system_error>
 #include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <filesystem>
 
 /* shader include */
 #include <d3dcompiler.h>
 
-/* activate shader debug */
-#if 1
+/* shader debug in the debug builds, the flags are part of the cache key so both builds keep their own files */
+#ifdef DEBUG
 	#define SHADER_DEBUG
 #endif
 
+/* the compiled shaders, beside the other caches of the media */
+#define SHADER_CACHE_DIR "media/shadercache"
+
 #include "DX12Handle.hpp"
 #include "DX12Helper.hpp"
+#include "BlockCompress.hpp"
+#include "DDSFile.hpp"
+#include "MeshCache.hpp"
+#include "PixelConvert.hpp"
+#include "ShaderCache.hpp"
+#include "StartupProfile.hpp"
+#include "StaticBatch.hpp"
+#include "VertexLayout.hpp"
 
 /* texture/model loading */
 #define TINYGLTF_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "tiny_loader/tiny_gltf.h"
-#include "DDSTextureLoader12.h"
 
 /* math */
 using namespace GPM;
@@ -27,38 +43,295 @@ using namespace GPM;
 
 /*===== SHADER =====*/
 
-bool DX12Helper::CompileVertex(const std::string& shaderSource_, ID3DBlob** VS_, D3D12_SHADER_BYTECODE& shader_)
+/* D3DCompile behind the interface of the cache */
+class D3DShaderCompiler : public ShaderCache::Compiler
 {
-	ID3DBlob* VSErr = nullptr;
+public:
+
+	bool Compile(const std::string& source, const char* entryPoint, const char* target, uint32_t flags,
+				 std::vector<uint8_t>& bytecode, std::string& errors) override
+	{
+		ID3DBlob* blob		= nullptr;
+		ID3DBlob* errorBlob	= nullptr;
+
+		if (FAILED(D3DCompile(source.c_str(), source.length(), nullptr, nullptr, nullptr, entryPoint, target, flags, 0, &blob, &errorBlob)))
+		{
+			if (errorBlob)
+			{
+				errors.assign((const char*)errorBlob->GetBufferPointer(), errorBlob->GetBufferSize());
+				errorBlob->Release();
+			}
+			return false;
+		}
+
+		const uint8_t* data = (const uint8_t*)blob->GetBufferPointer();
+		bytecode.assign(data, data + blob->GetBufferSize());
+
+		blob->Release();
+		if (errorBlob)
+			errorBlob->Release();
+
+		return true;
+	}
+};
+
+/* read from the cache or compiled, then given back in a blob as D3DCompile would */
+static bool CompileShader(const std::string& shaderSource_, const char* entryPoint_, const char* target_, const char* stageName_,
+						  ID3DBlob** blob_, D3D12_SHADER_BYTECODE& shader_)
+{
+	StartupProfile::Scope scope(StartupProfile::PHASE_SHADER);
+
+	static D3DShaderCompiler compiler;
+
+	std::vector<uint8_t>	bytecode;
+	std::string				errors;
+
+	if (!ShaderCache::Compile(compiler, SHADER_CACHE_DIR, shaderSource_, entryPoint_, target_, SHADER_FLAG, bytecode, errors))
+	{
+		printf("Failed To Compile %s Shader %s\n", stageName_, errors.c_str());
+		return false;
+	}
 
-	if (FAILED(D3DCompile(shaderSource_.c_str(), shaderSource_.length(), nullptr, nullptr, nullptr, "vert", "vs_5_0", SHADER_FLAG, 0, VS_, &VSErr)))
+	if (FAILED(D3DCreateBlob(bytecode.size(), blob_)))
 	{
-		printf("Failed To Compile Vertex Shader %s\n", (const char*)(VSErr->GetBufferPointer()));
-		VSErr->Release();
+		printf("Failed To Create The Blob Of The %s Shader\n", stageName_);
 		return false;
 	}
 
-	shader_.pShaderBytecode = (*VS_)->GetBufferPointer();
-	shader_.BytecodeLength = (*VS_)->GetBufferSize();
+	memcpy((*blob_)->GetBufferPointer(), bytecode.data(), bytecode.size());
+
+	shader_.pShaderBytecode = (*blob_)->GetBufferPointer();
+	shader_.BytecodeLength = (*blob_)->GetBufferSize();
 
 	return true;
 }
 
+bool DX12Helper::CompileVertex(const std::string& shaderSource_, ID3DBlob** VS_, D3D12_SHADER_BYTECODE& shader_)
+{
+	return CompileShader(shaderSource_, "vert", "vs_5_0", "Vertex", VS_, shader_);
+}
+
 bool DX12Helper::CompilePixel(const std::string& shaderSource_, ID3DBlob** PS_, D3D12_SHADER_BYTECODE& shader_)
 {
-	ID3DBlob* PSErr = nullptr;
+	return CompileShader(shaderSource_, "frag", "ps_5_0", "Pixel", PS_, shader_);
+}
+
+/*===== PIPELINE =====*/
+
+void* DX12Helper::RootSignatureDevice::Create(const void* desc, const std::vector<uint8_t>& blob, std::vector<uint8_t>& createdBlob)
+{
+	ID3DBlob*				serialized		= (ID3DBlob*)desc;
+	ID3D12RootSignature*	rootSignature	= nullptr;
 
-	if (FAILED(D3DCompile(shaderSource_.c_str(), shaderSource_.length(), nullptr, nullptr, nullptr, "frag", "ps_5_0", SHADER_FLAG, 0, PS_, &PSErr)))
+	lastResult = device->CreateRootSignature(0, serialized->GetBufferPointer(), serialized->GetBufferSize(), IID_PPV_ARGS(&rootSignature));
+
+	return SUCCEEDED(lastResult) ? rootSignature : nullptr;
+}
+
+void DX12Helper::RootSignatureDevice::Release(void* object)
+{
+	((ID3D12RootSignature*)object)->Release();
+}
+
+void* DX12Helper::PipelineStateDevice::Create(const void* desc, const std::vector<uint8_t>& blob, std::vector<uint8_t>& createdBlob)
+{
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC	psoDesc = *(const D3D12_GRAPHICS_PIPELINE_STATE_DESC*)desc;
+	ID3D12PipelineState*				pso		= nullptr;
+
+	/* a blob of another driver or adapter is refused, the pipeline is then compiled again */
+	if (!blob.empty())
 	{
-		printf("Failed To Compile Vertex Shader %s\n", (const char*)(PSErr->GetBufferPointer()));
-		PSErr->Release();
-		return false;
+		psoDesc.CachedPSO.pCachedBlob			= blob.data();
+		psoDesc.CachedPSO.CachedBlobSizeInBytes	= blob.size();
+
+		lastResult = device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pso));
+		if (SUCCEEDED(lastResult))
+			return pso;
+
+		psoDesc.CachedPSO = {};
 	}
 
-	shader_.pShaderBytecode = (*PS_)->GetBufferPointer();
-	shader_.BytecodeLength = (*PS_)->GetBufferSize();
+	lastResult = device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pso));
+	if (FAILED(lastResult))
+		return nullptr;
 
-	return true;
+	/* a pipeline without blob is only compiled again on the next run */
+	ID3DBlob* cachedBlob = nullptr;
+	if (SUCCEEDED(pso->GetCachedBlob(&cachedBlob)))
+	{
+		const uint8_t* data = (const uint8_t*)cachedBlob->GetBufferPointer();
+		createdBlob.assign(data, data + cachedBlob->GetBufferSize());
+		cachedBlob->Release();
+	}
+
+	return pso;
+}
+
+void DX12Helper::PipelineStateDevice::Release(void* object)
+{
+	((ID3D12PipelineState*)object)->Release();
+}
+
+/* everything of the desc the pipeline depends on, field by field, the cached blob aside */
+static uint64_t GetPipelineHash(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc_, uint64_t rootSignatureHash_)
+{
+	PipelineCache::Hasher hasher;
+	hasher.AddValue(rootSignatureHash_);
+
+	/* the shaders by their bytecode, the same source compiled with other flags is another pipeline */
+	auto AddShader = [&](const D3D12_SHADER_BYTECODE& shader)
+	{
+		hasher.AddValue(shader.BytecodeLength);
+		if (shader.pShaderBytecode)
+			hasher.Add(shader.pShaderBytecode, shader.BytecodeLength);
+	};
+
+	AddShader(desc_.VS);
+	AddShader(desc_.PS);
+	AddShader(desc_.DS);
+	AddShader(desc_.HS);
+	AddShader(desc_.GS);
+
+	const D3D12_STREAM_OUTPUT_DESC& streamOutput = desc_.StreamOutput;
+	hasher.AddValue(streamOutput.NumEntries);
+	for (UINT i = 0; streamOutput.pSODeclaration && i < streamOutput.NumEntries; i++)
+	{
+		const D3D12_SO_DECLARATION_ENTRY& entry = streamOutput.pSODeclaration[i];
+		hasher.AddValue(entry.Stream);
+		hasher.AddString(entry.SemanticName);
+		hasher.AddValue(entry.SemanticIndex);
+		hasher.AddValue(entry.StartComponent);
+		hasher.AddValue(entry.ComponentCount);
+		hasher.AddValue(entry.OutputSlot);
+	}
+	hasher.AddValue(streamOutput.NumStrides);
+	for (UINT i = 0; streamOutput.pBufferStrides && i < streamOutput.NumStrides; i++)
+		hasher.AddValue(streamOutput.pBufferStrides[i]);
+	hasher.AddValue(streamOutput.RasterizedStream);
+
+	const D3D12_BLEND_DESC& blend = desc_.BlendState;
+	hasher.AddValue(blend.AlphaToCoverageEnable);
+	hasher.AddValue(blend.IndependentBlendEnable);
+	for (const D3D12_RENDER_TARGET_BLEND_DESC& target : blend.RenderTarget)
+	{
+		hasher.AddValue(target.BlendEnable);
+		hasher.AddValue(target.LogicOpEnable);
+		hasher.AddValue(target.SrcBlend);
+		hasher.AddValue(target.DestBlend);
+		hasher.AddValue(target.BlendOp);
+		hasher.AddValue(target.SrcBlendAlpha);
+		hasher.AddValue(target.DestBlendAlpha);
+		hasher.AddValue(target.BlendOpAlpha);
+		hasher.AddValue(target.LogicOp);
+		hasher.AddValue(target.RenderTargetWriteMask);
+	}
+	hasher.AddValue(desc_.SampleMask);
+
+	const D3D12_RASTERIZER_DESC& raster = desc_.RasterizerState;
+	hasher.AddValue(raster.FillMode);
+	hasher.AddValue(raster.CullMode);
+	hasher.AddValue(raster.FrontCounterClockwise);
+	hasher.AddValue(raster.DepthBias);
+	hasher.AddValue(raster.DepthBiasClamp);
+	hasher.AddValue(raster.SlopeScaledDepthBias);
+	hasher.AddValue(raster.DepthClipEnable);
+	hasher.AddValue(raster.MultisampleEnable);
+	hasher.AddValue(raster.AntialiasedLineEnable);
+	hasher.AddValue(raster.ForcedSampleCount);
+	hasher.AddValue(raster.ConservativeRaster);
+
+	auto AddStencilOp = [&](const D3D12_DEPTH_STENCILOP_DESC& face)
+	{
+		hasher.AddValue(face.StencilFailOp);
+		hasher.AddValue(face.StencilDepthFailOp);
+		hasher.AddValue(face.StencilPassOp);
+		hasher.AddValue(face.StencilFunc);
+	};
+
+	const D3D12_DEPTH_STENCIL_DESC& depthStencil = desc_.DepthStencilState;
+	hasher.AddValue(depthStencil.DepthEnable);
+	hasher.AddValue(depthStencil.DepthWriteMask);
+	hasher.AddValue(depthStencil.DepthFunc);
+	hasher.AddValue(depthStencil.StencilEnable);
+	hasher.AddValue(depthStencil.StencilReadMask);
+	hasher.AddValue(depthStencil.StencilWriteMask);
+	AddStencilOp(depthStencil.FrontFace);
+	AddStencilOp(depthStencil.BackFace);
+
+	const D3D12_INPUT_LAYOUT_DESC& inputLayout = desc_.InputLayout;
+	hasher.AddValue(inputLayout.NumElements);
+	for (UINT i = 0; inputLayout.pInputElementDescs && i < inputLayout.NumElements; i++)
+	{
+		const D3D12_INPUT_ELEMENT_DESC& element = inputLayout.pInputElementDescs[i];
+		hasher.AddString(element.SemanticName);
+		hasher.AddValue(element.SemanticIndex);
+		hasher.AddValue(element.Format);
+		hasher.AddValue(element.InputSlot);
+		hasher.AddValue(element.AlignedByteOffset);
+		hasher.AddValue(element.InputSlotClass);
+		hasher.AddValue(element.InstanceDataStepRate);
+	}
+
+	hasher.AddValue(desc_.IBStripCutValue);
+	hasher.AddValue(desc_.PrimitiveTopologyType);
+	hasher.AddValue(desc_.NumRenderTargets);
+	for (DXGI_FORMAT format : desc_.RTVFormats)
+		hasher.AddValue(format);
+	hasher.AddValue(desc_.DSVFormat);
+	hasher.AddValue(desc_.SampleDesc.Count);
+	hasher.AddValue(desc_.SampleDesc.Quality);
+	hasher.AddValue(desc_.NodeMask);
+	hasher.AddValue(desc_.Flags);
+
+	return hasher.Get();
+}
+
+DX12Helper::PipelineStateCache::PipelineStateCache(ID3D12Device* device_, const std::string& filePath_) :
+	filePath { filePath_ },
+	rootSignatures { rootSignatureDevice },
+	pipelineStates { pipelineStateDevice }
+{
+	rootSignatureDevice.device = device_;
+	pipelineStateDevice.device = device_;
+
+	pipelineStates.Read(filePath);
+}
+
+DX12Helper::PipelineStateCache::~PipelineStateCache()
+{
+	printf("Pipeline cache: %u pipeline states created, %u shared between the demos\n", pipelineStates.GetCreatedCount(), pipelineStates.GetSharedCount());
+
+	std::error_code error;
+	std::filesystem::create_directories(std::filesystem::path(filePath).parent_path(), error);
+	pipelineStates.Write(filePath);
+}
+
+HRESULT DX12Helper::PipelineStateCache::CreateRootSignature(ID3DBlob* serialized_, ID3D12RootSignature** rootSignature_)
+{
+	PipelineCache::Hasher hasher;
+	hasher.Add(serialized_->GetBufferPointer(), serialized_->GetBufferSize());
+
+	*rootSignature_ = (ID3D12RootSignature*)rootSignatures.Get(hasher.Get(), serialized_);
+	if (!*rootSignature_)
+		return rootSignatureDevice.lastResult;
+
+	(*rootSignature_)->AddRef();
+	return S_OK;
+}
+
+HRESULT DX12Helper::PipelineStateCache::CreatePipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc_, ID3D12PipelineState** pso_)
+{
+	/* a root signature made outside of the cache has no content to key on */
+	uint64_t rootSignatureHash = 0;
+	if (!rootSignatures.GetHash(desc_.pRootSignature, rootSignatureHash))
+		return E_INVALIDARG;
+
+	*pso_ = (ID3D12PipelineState*)pipelineStates.Get(GetPipelineHash(desc_, rootSignatureHash), &desc_);
+	if (!*pso_)
+		return pipelineStateDevice.lastResult;
+
+	(*pso_)->AddRef();
+	return S_OK;
 }
 
 /*===== RESOURCES =====*/
@@ -73,25 +346,39 @@ DX12Helper::DefaultResourceUploader::~DefaultResourceUploader()
 }
 
 bool DX12Helper::MakeUploader(DefaultResourceUploader& uploader_, const DX12Handle& dx12Handle_)
+{
+	return MakeUploader(uploader_, dx12Handle_._device, dx12Handle_._queue, dx12Handle_._cmdAllocators[dx12Handle_._context.currFrameIndex], &dx12Handle_._fenceEvent);
+}
+
+bool DX12Helper::MakeUploader(DefaultResourceUploader& uploader_, ID3D12Device* device_, ID3D12CommandQueue* queue_, ID3D12CommandAllocator* allocator_,
+							  HANDLE const* fenceEvent_)
 {
 	HRESULT hr;
 
-	hr = dx12Handle_._device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, dx12Handle_._cmdAllocators[dx12Handle_._context.currFrameIndex], NULL, IID_PPV_ARGS(&uploader_.copyList));
+	hr = device_->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, allocator_, NULL, IID_PPV_ARGS(&uploader_.copyList));
 	if (FAILED(hr))
 	{
 		printf("Failing creating DX12 upload command List: %s\n", std::system_category().message(hr).c_str());
 		return false;
 	}
 
-	uploader_.device		= dx12Handle_._device;
-	uploader_.queue			= dx12Handle_._queue;
-	uploader_.fenceEvent	= &dx12Handle_._fenceEvent;
+	uploader_.device		= device_;
+	uploader_.queue			= queue_;
+	uploader_.fenceEvent	= fenceEvent_;
 
 	return true;
 }
 
 bool DX12Helper::CreateDefaultBuffer(D3D12_SUBRESOURCE_DATA* bufferData_, DefaultResource& resourceData_, DefaultResourceUploader& uploader_)
 {
+	BufferPiece piece = { bufferData_->pData, static_cast<UINT64>(bufferData_->SlicePitch), 0 };
+	return CreateDefaultBuffer(&piece, 1, piece.size, resourceData_, uploader_);
+}
+
+bool DX12Helper::CreateDefaultBuffer(const BufferPiece* pieces_, UINT pieceCount_, UINT64 size_, DefaultResource& resourceData_, DefaultResourceUploader& uploader_)
+{
+	StartupProfile::Scope scope(StartupProfile::PHASE_UPLOAD);
+
 	HRESULT hr;
 
 	D3D12_HEAP_PROPERTIES heapProp = {};
@@ -101,7 +388,7 @@ bool DX12Helper::CreateDefaultBuffer(D3D12_SUBRESOURCE_DATA* bufferData_, Defaul
 
 	resDesc.Dimension			= D3D12_RESOURCE_DIMENSION_BUFFER;
 	resDesc.SampleDesc.Count	= 1;
-	resDesc.Width				= bufferData_->SlicePitch;
+	resDesc.Width				= size_;
 	resDesc.Height				= 1;
 	resDesc.DepthOrArraySize	= 1;
 	resDesc.MipLevels			= 1;
@@ -126,7 +413,22 @@ bool DX12Helper::CreateDefaultBuffer(D3D12_SUBRESOURCE_DATA* bufferData_, Defaul
 		return false;
 	}
 
-	UpdateSubresources(uploader_.copyList, *resourceData_.buffer, uploader_.uploadBuffers.back(), 0, 0, 1, bufferData_);
+	/* the pieces straight to the upload heap, the cpu never reads it back */
+	uint8_t*		mapped		= nullptr;
+	D3D12_RANGE		readRange	= { 0, 0 };
+	hr = uploader_.uploadBuffers.back()->Map(0, &readRange, reinterpret_cast<void**>(&mapped));
+
+	if (FAILED(hr))
+	{
+		printf("Failing mapping default buffer upload heap: %s\n", std::system_category().message(hr).c_str());
+		return false;
+	}
+
+	for (UINT piece = 0; piece < pieceCount_; piece++)
+		memcpy(mapped + pieces_[piece].offset, pieces_[piece].data, pieces_[piece].size);
+	uploader_.uploadBuffers.back()->Unmap(0, nullptr);
+
+	uploader_.copyList->CopyBufferRegion(*resourceData_.buffer, 0, uploader_.uploadBuffers.back(), 0, size_);
 
 	D3D12_RESOURCE_BARRIER barrier = {};
 	barrier.Type					= D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
@@ -142,6 +444,8 @@ bool DX12Helper::CreateDefaultBuffer(D3D12_SUBRESOURCE_DATA* bufferData_, Defaul
 
 bool DX12Helper::UploadResources(const DefaultResourceUploader& uploader_)
 {
+	StartupProfile::Scope scope(StartupProfile::PHASE_UPLOAD);
+
 	HRESULT hr;
 
 	uploader_.copyList->Close();
@@ -266,12 +570,13 @@ void DX12Helper::UploadCBuffer(void* bufferData, UINT bufferSize, ConstantResour
 
 DX12Helper::TextureResource::~TextureResource()
 {
+	/* only LoadTexture leaves data there, the other users reset it once uploaded */
 	if (texData.pData)
 		stbi_image_free((void*)texData.pData);
 }
 
 
-void DX12Helper::LoadTexture(const std::string& filePath_, D3D12_SUBRESOURCE_DATA& texData_, D3D12_RESOURCE_DESC& texDesc_)
+void DX12Helper::LoadTexture(const std::string& filePath_, D3D12_SUBRESOURCE_DATA& texData_, D3D12_RESOURCE_DESC& texDesc_, UINT& srcChannels_)
 {
 	int width = 0;
 	int height = 0;
@@ -279,33 +584,18 @@ void DX12Helper::LoadTexture(const std::string& filePath_, D3D12_SUBRESOURCE_DAT
 
 	stbi_set_flip_vertically_on_load(1);
 
+	/* kept as decoded (owned by stb), the conversion is done while copying to the upload heap */
 	BYTE* tex = stbi_load(filePath_.c_str(), &width, &height, &channels, 0);
 
 	DXGI_FORMAT dxgiFormat = DXGI_FORMAT_UNKNOWN;
+	srcChannels_ = 0;
 
 	switch (channels)
 	{
 		case 1: { dxgiFormat = DXGI_FORMAT_R8_UNORM; break; }
 		case 2: { dxgiFormat = DXGI_FORMAT_R8G8_UNORM; break; }
 			/* there is no 3-bytes dxgi type in d3d12 (gpu does not support anymore), expanding to 4 */
-		case 3:
-		{
-			int arraySize = width * height * 4;
-			BYTE* old = tex;
-			tex = (BYTE*)malloc(arraySize);
-			BYTE max = std::numeric_limits<BYTE>().max();
-
-			for (int i = 0, j = 0; i < arraySize; i += 4, j += 3)
-			{
-				tex[i]		= old[j];
-				tex[i + 1]	= old[j + 1];
-				tex[i + 2]	= old[j + 2];
-				tex[i + 3]	= max;
-			}
-
-			stbi_image_free(old);
-			channels = 4;
-		}
+		case 3: { srcChannels_ = 3; dxgiFormat = DXGI_FORMAT_R8G8B8A8_UNORM; break; }
 		default: { dxgiFormat = DXGI_FORMAT_R8G8B8A8_UNORM; break; }
 	};
 
@@ -319,7 +609,7 @@ void DX12Helper::LoadTexture(const std::string& filePath_, D3D12_SUBRESOURCE_DAT
 	texDesc_.Width				= width;	// width of the texture
 	texDesc_.Height				= height;	// height of the texture
 	texDesc_.DepthOrArraySize	= 1;		// if 3d image, depth of 3d image. Otherwise an array of 1D or 2D textures (we only have one image, so we set 1)
-	texDesc_.MipLevels			= 1;		// Number of mipmaps. We are not generating mipmaps for this texture, so we have only one level
+	texDesc_.MipLevels			= MipChain::GetLevelCount(width, height);	// Number of mipmaps, generated when uploading (see CreateRawTexture)
 	texDesc_.Format				= dxgiFormat; // This is the dxgi format of the image (format of the pixels)
 	texDesc_.SampleDesc.Count	= 1;		// This is the number of samples per pixel, we just want 1 sample
 	texDesc_.SampleDesc.Quality = 0;		// The quality level of the samples. Higher is better quality, but worse performance
@@ -331,7 +621,7 @@ bool DX12Helper::CreateTexture(const std::string& filePath_, TextureResource& re
 {
 	/* load texture Data */
 	D3D12_RESOURCE_DESC texDesc = {};
-	LoadTexture(filePath_, resourceData_.texData, texDesc);
+	LoadTexture(filePath_, resourceData_.texData, texDesc, resourceData_.srcChannels);
 
 	if (!CreateRawTexture(texDesc, resourceData_, uploader_))
 		return false;
@@ -341,15 +631,28 @@ bool DX12Helper::CreateTexture(const std::string& filePath_, TextureResource& re
 	srvDesc.Shader4ComponentMapping			= D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 	srvDesc.Format							= texDesc.Format;
 	srvDesc.ViewDimension					= D3D12_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Texture2D.MipLevels				= 1;
+	srvDesc.Texture2D.MipLevels				= texDesc.MipLevels;
 
 	uploader_.device->CreateShaderResourceView(*resourceData_.buffer, &srvDesc, resourceData_.srvHandle);
 
 	return true;
 }
 
+/* channels of the 8 bits formats a texture can be converted to */
+static UINT GetFormatChannels(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+		case DXGI_FORMAT_R8_UNORM:		return 1;
+		case DXGI_FORMAT_R8G8_UNORM:	return 2;
+		default:						return 4;
+	}
+}
+
 bool DX12Helper::CreateRawTexture(const D3D12_RESOURCE_DESC& texDesc_, TextureResource& resourceData_, DefaultResourceUploader& uploader_)
 {
+	StartupProfile::Scope scope(StartupProfile::PHASE_UPLOAD);
+
 	HRESULT hr;
 
 	/* create upload heap to send texture info to default */
@@ -358,9 +661,15 @@ bool DX12Helper::CreateRawTexture(const D3D12_RESOURCE_DESC& texDesc_, TextureRe
 
 	D3D12_RESOURCE_DESC uploadDesc = {};
 
+	/* every mip of the texture is uploaded */
+	UINT mipCount = texDesc_.MipLevels > 0 ? texDesc_.MipLevels : 1;
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>	footprints(mipCount);
+	std::vector<UINT>								rowCounts(mipCount);
+	std::vector<UINT64>								rowSizes(mipCount);
+
 	uploadDesc.Dimension		= D3D12_RESOURCE_DIMENSION_BUFFER;
 	uploadDesc.SampleDesc.Count = 1;
-	uploader_.device->GetCopyableFootprints(&texDesc_, 0, 1, 0, nullptr, nullptr, nullptr, &uploadDesc.Width);
+	uploader_.device->GetCopyableFootprints(&texDesc_, 0, mipCount, 0, footprints.data(), rowCounts.data(), rowSizes.data(), &uploadDesc.Width);
 	uploadDesc.Height			= 1;
 	uploadDesc.DepthOrArraySize = 1;
 	uploadDesc.MipLevels		= 1;
@@ -386,8 +695,61 @@ bool DX12Helper::CreateRawTexture(const D3D12_RESOURCE_DESC& texDesc_, TextureRe
 		return false;
 	}
 
+	/* the mips are written straight into the upload heap : copied or converted when given, generated otherwise */
+	BYTE* mapped = nullptr;
+	CD3DX12_RANGE readRange(0, 0);
+	hr = uploader_.uploadBuffers.back()->Map(0, &readRange, (void**)&mapped);
+
+	if (FAILED(hr))
+	{
+		printf("Failing mapping texture upload heap: %s\n", std::system_category().message(hr).c_str());
+		return false;
+	}
+
+	UINT dstChannels = GetFormatChannels(texDesc_.Format);
+	UINT srcChannels = resourceData_.srcChannels != 0 ? resourceData_.srcChannels : dstChannels;
+
+	if (mipCount > 1 && resourceData_.mipData.empty())
+	{
+		std::vector<MipChain::Level> levels(mipCount);
+		for (UINT mip = 0; mip < mipCount; mip++)
+		{
+			levels[mip].data		= mapped + footprints[mip].Offset;
+			levels[mip].rowPitch	= footprints[mip].Footprint.RowPitch;
+		}
+
+		MipChain::Generate((const uint8_t*)resourceData_.texData.pData, resourceData_.texData.RowPitch, srcChannels,
+						   footprints[0].Footprint.Width, footprints[0].Footprint.Height, dstChannels,
+						   resourceData_.mipUsage, MipChain::FILTER_BOX, levels.data(), mipCount);
+	}
+	else
+	{
+		for (UINT mip = 0; mip < mipCount && mip <= resourceData_.mipData.size(); mip++)
+		{
+			const D3D12_SUBRESOURCE_DATA& data = mip == 0 ? resourceData_.texData : resourceData_.mipData[mip - 1];
+
+			for (UINT row = 0; row < rowCounts[mip]; row++)
+			{
+				const BYTE* srcRow	= (const BYTE*)data.pData + row * data.RowPitch;
+				BYTE*		dstRow	= mapped + footprints[mip].Offset + row * footprints[mip].Footprint.RowPitch;
+
+				if (resourceData_.srcChannels != 0)
+					PixelConvert::ConvertChannels(srcRow, srcChannels, dstRow, dstChannels, footprints[mip].Footprint.Width);
+				else
+					memcpy(dstRow, srcRow, static_cast<size_t>(rowSizes[mip]));
+			}
+		}
+	}
+
+	uploader_.uploadBuffers.back()->Unmap(0, nullptr);
+
 	/* uploading and barrier for making the application wait for the ressource to be uploaded on gpu */
-	UpdateSubresources(uploader_.copyList, *resourceData_.buffer, uploader_.uploadBuffers.back(), 0, 0, 1, &resourceData_.texData);
+	for (UINT mip = 0; mip < mipCount; mip++)
+	{
+		CD3DX12_TEXTURE_COPY_LOCATION dst(*resourceData_.buffer, mip);
+		CD3DX12_TEXTURE_COPY_LOCATION src(uploader_.uploadBuffers.back(), footprints[mip]);
+		uploader_.copyList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+	}
 
 	D3D12_RESOURCE_BARRIER barrier = {};
 	barrier.Type					= D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
@@ -401,16 +763,65 @@ bool DX12Helper::CreateRawTexture(const D3D12_RESOURCE_DESC& texDesc_, TextureRe
 	return true;
 }
 
-bool DX12Helper::CreateDDSTexture(const std::string& filePath_, TextureResource& resourceData_, DefaultResourceUploader& uploader_)
+/* the d3d12 dimension and size of what a dds file holds */
+static D3D12_RESOURCE_DESC GetDDSResourceDesc(const DDSFile::Desc& desc)
+{
+	D3D12_RESOURCE_DESC resourceDesc = {};
+	resourceDesc.Width				= desc.width;
+	resourceDesc.Height				= desc.height;
+	resourceDesc.MipLevels			= static_cast<UINT16>(desc.mipCount);
+	resourceDesc.Format				= static_cast<DXGI_FORMAT>(desc.dxgiFormat);
+	resourceDesc.SampleDesc.Count	= 1;
+	resourceDesc.Layout				= D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+	switch (desc.dimension)
+	{
+		case DDS_DIMENSION_TEXTURE1D:
+			resourceDesc.Dimension			= D3D12_RESOURCE_DIMENSION_TEXTURE1D;
+			resourceDesc.DepthOrArraySize	= static_cast<UINT16>(desc.arraySize);
+			break;
+		case DDS_DIMENSION_TEXTURE3D:
+			resourceDesc.Dimension			= D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+			resourceDesc.DepthOrArraySize	= static_cast<UINT16>(desc.depth);
+			break;
+		default:
+			resourceDesc.Dimension			= D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+			resourceDesc.DepthOrArraySize	= static_cast<UINT16>(desc.arraySize);
+			break;
+	}
+
+	return resourceDesc;
+}
+
+bool DX12Helper::UploadDDSTexture(const std::string& filePath_, TextureResource& resourceData_, DefaultResourceUploader& uploader_, bool* isCube_)
 {
 	HRESULT hr;
-	std::unique_ptr<uint8_t[]> ddsData;
-	std::vector<D3D12_SUBRESOURCE_DATA> subresources;
-	bool isCube = false;
 
-	std::wstring wString = std::wstring(filePath_.begin(), filePath_.end());
+	/* the file is mapped and read in place, each subresource is copied once : from the mapping to its footprint */
+	MeshCache::MappedFile		file;
+	DDSFile::Desc				desc;
+	std::vector<DDSFile::Surface>	surfaces;
+	{
+		StartupProfile::Scope scope(StartupProfile::PHASE_ASSET_IO);
+
+		if (!file.Open(filePath_) || !DDSFile::Parse(file.Data(), file.Size(), desc, surfaces))
+		{
+			printf("Failing reading dds texture %s\n", filePath_.c_str());
+			return false;
+		}
+	}
+
+	StartupProfile::Scope scope(StartupProfile::PHASE_UPLOAD);
+
+	if (isCube_)
+		*isCube_ = desc.isCube;
+
+	/* create default heap, technically the last place where the texture will be sent */
+	D3D12_HEAP_PROPERTIES heapProp = {};
+	heapProp.Type = D3D12_HEAP_TYPE_DEFAULT;
 
-	hr = DirectX::LoadDDSTextureFromFile(uploader_.device, wString.c_str(), resourceData_.buffer, ddsData, subresources, 0ULL, nullptr, &isCube);
+	D3D12_RESOURCE_DESC resourceDesc = GetDDSResourceDesc(desc);
+	hr = uploader_.device->CreateCommittedResource(&heapProp, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(resourceData_.buffer));
 
 	if (FAILED(hr))
 	{
@@ -418,17 +829,17 @@ bool DX12Helper::CreateDDSTexture(const std::string& filePath_, TextureResource&
 		return false;
 	}
 
-	D3D12_RESOURCE_DESC resourceDesc = (*resourceData_.buffer)->GetDesc();
+	/* every subresource is copied at the footprint the device gives for it */
+	UINT subresourceCount = static_cast<UINT>(surfaces.size());
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>	placedFootprints(subresourceCount);
+	std::vector<DDSFile::Footprint>					footprints(subresourceCount);
 
-	/* create upload heap to send texture info to default */
-	D3D12_HEAP_PROPERTIES heapProp = {};
 	heapProp.Type = D3D12_HEAP_TYPE_UPLOAD;
 
 	D3D12_RESOURCE_DESC uploadDesc = {};
-
 	uploadDesc.Dimension		= D3D12_RESOURCE_DIMENSION_BUFFER;
 	uploadDesc.SampleDesc.Count = 1;
-	uploader_.device->GetCopyableFootprints(&resourceDesc, 0, subresources.size(), 0, nullptr, nullptr, nullptr, &uploadDesc.Width);
+	uploader_.device->GetCopyableFootprints(&resourceDesc, 0, subresourceCount, 0, placedFootprints.data(), nullptr, nullptr, &uploadDesc.Width);
 	uploadDesc.Height			= 1;
 	uploadDesc.DepthOrArraySize = 1;
 	uploadDesc.MipLevels		= 1;
@@ -443,8 +854,45 @@ bool DX12Helper::CreateDDSTexture(const std::string& filePath_, TextureResource&
 		return false;
 	}
 
+	BYTE* mapped = nullptr;
+	CD3DX12_RANGE readRange(0, 0);
+	hr = uploader_.uploadBuffers.back()->Map(0, &readRange, (void**)&mapped);
+
+	if (FAILED(hr))
+	{
+		printf("Failing mapping dds upload heap: %s\n", std::system_category().message(hr).c_str());
+		return false;
+	}
+
+	for (UINT i = 0; i < subresourceCount; i++)
+	{
+		const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& placed = placedFootprints[i];
+		footprints[i] = { placed.Offset, placed.Footprint.Width, placed.Footprint.Height, placed.Footprint.Depth, placed.Footprint.RowPitch };
+		DDSFile::CopySurface(file.Data(), surfaces[i], footprints[i], mapped);
+	}
+
+#ifdef DEBUG
+	/* DDSFile lays the subresources out by the same rules, its tests run without a device */
+	std::vector<DDSFile::Footprint> fileFootprints;
+	UINT64 fileSize = DDSFile::GetFootprints(desc, fileFootprints);
+	assert(fileSize == uploadDesc.Width && fileFootprints.size() == footprints.size());
+	for (UINT i = 0; i < subresourceCount; i++)
+	{
+		const DDSFile::Footprint& fileFootprint = fileFootprints[i];
+		assert(fileFootprint.offset == footprints[i].offset && fileFootprint.rowPitch == footprints[i].rowPitch &&
+			   fileFootprint.width == footprints[i].width && fileFootprint.height == footprints[i].height && fileFootprint.depth == footprints[i].depth);
+	}
+#endif
+
+	uploader_.uploadBuffers.back()->Unmap(0, nullptr);
+
 	/* uploading and barrier for making the application wait for the ressource to be uploaded on gpu */
-	UpdateSubresources(uploader_.copyList, *resourceData_.buffer, uploader_.uploadBuffers.back(), 0, 0, subresources.size(), subresources.data());
+	for (UINT i = 0; i < subresourceCount; i++)
+	{
+		CD3DX12_TEXTURE_COPY_LOCATION dst(*resourceData_.buffer, i);
+		CD3DX12_TEXTURE_COPY_LOCATION src(uploader_.uploadBuffers.back(), placedFootprints[i]);
+		uploader_.copyList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+	}
 
 	D3D12_RESOURCE_BARRIER barrier = {};
 	barrier.Type					= D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
@@ -455,6 +903,17 @@ bool DX12Helper::CreateDDSTexture(const std::string& filePath_, TextureResource&
 
 	uploader_.copyList->ResourceBarrier(1, &barrier);
 
+	return true;
+}
+
+bool DX12Helper::CreateDDSTexture(const std::string& filePath_, TextureResource& resourceData_, DefaultResourceUploader& uploader_)
+{
+	bool isCube = false;
+	if (!UploadDDSTexture(filePath_, resourceData_, uploader_, &isCube))
+		return false;
+
+	D3D12_RESOURCE_DESC resourceDesc = (*resourceData_.buffer)->GetDesc();
+
 	/* make the shader resource view from buffer and texDesc to make it available to use */
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
@@ -499,173 +958,452 @@ bool DX12Helper::CreateDDSTexture(const std::string& filePath_, TextureResource&
 
 /*===== MODEL  =====*/
 
-bool DX12Helper::UploadModel(const std::string& filePath, ModelResource& modelResource, DefaultResourceUploader& uploader_)
+/* the buffers of a ModelResource */
+enum EModelBuffer
 {
-	tinygltf::Model		model;
-	tinygltf::TinyGLTF	loader;
-	std::string			err;
-	std::string			warn;
+	MODEL_BUFFER_RANGES = 0,	/* the ranges of the cache buffers drawn, see MeshCache::GetUploadRanges */
+	MODEL_BUFFER_INSTANCES,
+	MODEL_BUFFER_BATCH,			/* see UploadBatchBuffer */
+	MODEL_BUFFER_COUNT
+};
 
-	if (!loader.LoadASCIIFromFile(&model, &err, &warn, filePath.c_str()))
-	{
-		printf("Error Loading model: %s", err.c_str());
+/* the offsets of the ranges keep this alignment, more than the index and vertex buffer views need */
+#define MODEL_RANGE_ALIGNMENT 16u
+
+static const std::vector<char> noneBatched;
+
+bool DX12Helper::UploadModel(const std::string& filePath, ModelResource& modelResource, DefaultResourceUploader& uploader_, bool staticBatching)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	/* the cached model keeps the mapping alive until every upload is recorded and executed */
+	MeshCache::CachedModel model;
+	if (!MeshCache::Load(filePath, model))
 		return false;
-	}
 
-	if (!warn.empty())
-		printf("Warning Loading model: %s", warn.c_str());
+	StaticBatch::Arena arena;
+	if (staticBatching)
+		StaticBatch::Build(model.view, arena);
 
-	if (!UploadMeshBuffer(model, modelResource, uploader_) || !UploadTextureBuffer(model, modelResource, uploader_))
+	if (!UploadMeshBuffer(model.view, modelResource, uploader_, &arena) || !UploadBatchBuffer(model.view, arena, modelResource, uploader_) ||
+		!UploadPlaceholderTexture(model.view, modelResource, uploader_) || !UploadTextureBuffer(model.view, modelResource, uploader_))
 		return false;
 
 	/* upload all created resources */
 	if (!UploadResources(uploader_))
 		return false;
 
-	if (!UploadMesh(model,modelResource,uploader_) || !UploadTexture(model, modelResource, uploader_))
+	if (!UploadMesh(model.view, modelResource, uploader_, &arena) || !UploadBatch(model.view, arena, modelResource) ||
+		!UploadTexture(model.view, modelResource, uploader_))
 		return false;
 
+	double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	printf("Loaded %s from %s in %.2f ms\n", filePath.c_str(), model.isFromCache ? "baked cache" : "glTF", loadMs);
+
 	return true;
 }
 
-bool DX12Helper::UploadMesh(const tinygltf::Model& gltfModel, ModelResource& modelResource, DefaultResourceUploader& uploader_)
+bool DX12Helper::UploadMesh(const MeshCache::View& view, ModelResource& modelResource, DefaultResourceUploader& uploader_, const StaticBatch::Arena* arena)
 {
-	const tinygltf::Scene& dftScene = gltfModel.scenes[gltfModel.defaultScene];
-	for (int node = 0; node < dftScene.nodes.size(); node++)
+	/* the ranges as UploadMeshBuffer packed them */
+	std::vector<MeshCache::UploadRange> ranges;
+	MeshCache::GetUploadRanges(view, arena ? arena->isBatched : noneBatched, MODEL_RANGE_ALIGNMENT, ranges);
+
+	ID3D12Resource*				rangeBuffer		= (*modelResource.vertexBuffers)[MODEL_BUFFER_RANGES];
+	D3D12_GPU_VIRTUAL_ADDRESS	rangeAddress	= rangeBuffer ? rangeBuffer->GetGPUVirtualAddress() : 0;
+	auto GetAddress = [&](const MeshCache::BufferRange& range)
+	{
+		return rangeAddress + MeshCache::GetArenaOffset(ranges, range.buffer, range.offset);
+	};
+
+	for (uint32_t primitive = 0; primitive < view.header->primitiveCount; primitive++)
 	{
-		const tinygltf::Node& currNode	= gltfModel.nodes[node];
-		const tinygltf::Mesh& mesh		= gltfModel.meshes[currNode.mesh];
+		if (arena && !arena->isBatched.empty() && arena->isBatched[primitive])
+			continue;
+
+		const MeshCache::Primitive& currPrimitive = view.primitives[primitive];
 		Model currModel;
-		currModel.name					= currNode.name;
+		currModel.name		= currPrimitive.name;
+		currModel.material	= currPrimitive.material;
 
-		if (!currNode.scale.empty())
-		{
-			currModel.trs.scaleX(static_cast<f32>(currNode.scale[0]));
-			currModel.trs.scaleY(static_cast<f32>(currNode.scale[1]));
-			currModel.trs.scaleZ(static_cast<f32>(currNode.scale[2]));
-		}
+		/* the interleaved vertices, then the instances */
+		currModel.vBufferViews.resize(MODEL_SLOT_COUNT);
+		currModel.vertexBuffers.resize(MODEL_SLOT_COUNT);
 
-		if (!currNode.rotation.empty())
+		const MeshCache::BufferRange& range = currPrimitive.vertices;
+		if (range.size > 0)
 		{
-			currModel.trs.rotateX(static_cast<f32>(currNode.rotation[0]));
-			currModel.trs.rotateY(static_cast<f32>(currNode.rotation[1]));
-			currModel.trs.rotateZ(static_cast<f32>(currNode.rotation[2]));
+			currModel.vBufferViews[MODEL_SLOT_VERTICES].BufferLocation	= GetAddress(range);
+			currModel.vBufferViews[MODEL_SLOT_VERTICES].SizeInBytes		= range.size;
+			currModel.vBufferViews[MODEL_SLOT_VERTICES].StrideInBytes	= range.stride;
+
+			currModel.vertexBuffers[MODEL_SLOT_VERTICES] = rangeBuffer;
 		}
 
-		if (!currNode.translation.empty())
+		/* the world transforms of the nodes, uploaded with the buffers of the cache (see UploadMeshBuffer) */
+		if (currPrimitive.instanceCount > 0)
 		{
-			currModel.trs.translateX(static_cast<f32>(currNode.translation[0]));
-			currModel.trs.translateY(static_cast<f32>(currNode.translation[1]));
-			currModel.trs.translateZ(static_cast<f32>(currNode.translation[2]));
+			ID3D12Resource* buffer = (*modelResource.vertexBuffers)[MODEL_BUFFER_INSTANCES];
+
+			currModel.vBufferViews[MODEL_SLOT_INSTANCES].BufferLocation	= buffer->GetGPUVirtualAddress() + currPrimitive.instanceOffset * sizeof(MeshCache::Instance);
+			currModel.vBufferViews[MODEL_SLOT_INSTANCES].SizeInBytes	= currPrimitive.instanceCount * sizeof(MeshCache::Instance);
+			currModel.vBufferViews[MODEL_SLOT_INSTANCES].StrideInBytes	= sizeof(MeshCache::Instance);
+
+			currModel.vertexBuffers[MODEL_SLOT_INSTANCES] = buffer;
+
+			for (uint32_t instance = 0; instance < currPrimitive.instanceCount; instance++)
+			{
+				GPM::Mat4 transform;
+				memcpy(transform.e, view.instances[currPrimitive.instanceOffset + instance].transform, sizeof(transform.e));
+				currModel.instances.push_back(transform);
+			}
 		}
 
+		/* vertex count, or index count when indexed */
+		currModel.count = currPrimitive.count;
 
-		for (int primitive = 0; primitive < mesh.primitives.size(); primitive++)
+		if (currPrimitive.indexComponentType != 0)
 		{
-			const tinygltf::Primitive& currPrimitives = mesh.primitives[primitive];
-			currModel.vBufferViews.resize(3);
-			currModel.vertexBuffers.resize(3);
+			currModel.iBufferView.BufferLocation	= GetAddress(currPrimitive.indices);
+			currModel.iBufferView.SizeInBytes		= currPrimitive.indices.size;
 
-			for (const std::pair<const std::string, int>& attribute : currPrimitives.attributes)
+			switch (currPrimitive.indexComponentType)
 			{
-				const tinygltf::Accessor&	access		= gltfModel.accessors[attribute.second];
-				const tinygltf::BufferView& bufferView	= gltfModel.bufferViews[access.bufferView];
-
-				UINT size	= static_cast<UINT>(bufferView.byteLength - access.byteOffset);
-				UINT stride	= access.ByteStride(bufferView);
-				D3D12_GPU_VIRTUAL_ADDRESS loc = (*modelResource.vertexBuffers)[bufferView.buffer]->GetGPUVirtualAddress() + bufferView.byteOffset + access.byteOffset;
-
-				int ind = -1;
-				if (attribute.first == "NORMAL")
-					ind = 2;
-				else if (attribute.first == "POSITION")
-					ind = 0;
-				else if (attribute.first == "TEXCOORD_0")
-					ind = 1;
-				else
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+					currModel.iBufferView.Format = DXGI_FORMAT_R8_UINT;
+					break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+					currModel.iBufferView.Format = DXGI_FORMAT_R16_UINT;
 					break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+					currModel.iBufferView.Format = DXGI_FORMAT_R32_UINT;
+					break;
+			}
 
-				currModel.vBufferViews[ind].BufferLocation	= loc;
-				currModel.vBufferViews[ind].SizeInBytes		= size;
-				currModel.vBufferViews[ind].StrideInBytes	= stride;
+			currModel.indexBuffer = rangeBuffer;
 
-				currModel.vertexBuffers[ind] = (*modelResource.vertexBuffers)[bufferView.buffer];
+			for (uint32_t level = 0; level < currPrimitive.lodCount; level++)
+			{
+				const MeshCache::Lod& lod = currPrimitive.lods[level];
+
+				Model::Lod currLod;
+				currLod.iBufferView.BufferLocation	= GetAddress(lod.indices);
+				currLod.iBufferView.SizeInBytes		= lod.indices.size;
+				currLod.iBufferView.Format			= currModel.iBufferView.Format;
+				currLod.count						= lod.count;
+				currLod.error						= lod.error;
+				currModel.lods.push_back(currLod);
 			}
+		}
+
+		currModel.positionScale		= { currPrimitive.positionScale[0], currPrimitive.positionScale[1], currPrimitive.positionScale[2] };
+		currModel.positionOffset	= { currPrimitive.positionOffset[0], currPrimitive.positionOffset[1], currPrimitive.positionOffset[2] };
+		currModel.uvScaleOffset		= { currPrimitive.uvScale[0], currPrimitive.uvScale[1], currPrimitive.uvOffset[0], currPrimitive.uvOffset[1] };
 
-			/* count should not change for a single primitive (info per vertex )*/
-			currModel.count = gltfModel.accessors[currPrimitives.attributes.begin()->second].count;
+		currModel.center = { currPrimitive.center[0], currPrimitive.center[1], currPrimitive.center[2] };
+		currModel.radius = currPrimitive.radius;
 
-			if (currPrimitives.indices >= 0)
+		/* the meshlets of a primitive are contiguous in the cache, as their vertices and triangles */
+		if (currPrimitive.meshletCount > 0)
+		{
+			const Meshlets::Meshlet* first	= view.meshlets + currPrimitive.meshletOffset;
+			const Meshlets::Meshlet& last	= first[currPrimitive.meshletCount - 1];
+			uint32_t vertexOffset	= first->vertexOffset;
+			uint32_t triangleOffset	= first->triangleOffset;
+
+			currModel.meshlets.assign(first, first + currPrimitive.meshletCount);
+			currModel.meshletVertices.assign(view.meshletVertices + vertexOffset, view.meshletVertices + last.vertexOffset + last.vertexCount);
+			currModel.meshletTriangles.assign(view.meshletTriangles + size_t(triangleOffset) * 3, view.meshletTriangles + (size_t(last.triangleOffset) + last.triangleCount) * 3);
+			for (Meshlets::Meshlet& meshlet : currModel.meshlets)
 			{
-				const tinygltf::Accessor& access		= gltfModel.accessors[currPrimitives.indices];
-				currModel.count							= access.count;
-				const tinygltf::BufferView& bufferView	= gltfModel.bufferViews[access.bufferView];
-
-				UINT size	= static_cast<UINT>(bufferView.byteLength - access.byteOffset);
-				D3D12_GPU_VIRTUAL_ADDRESS loc = (*modelResource.vertexBuffers)[bufferView.buffer]->GetGPUVirtualAddress() + bufferView.byteOffset + access.byteOffset;
-
-				currModel.iBufferView.BufferLocation	= loc;
-				currModel.iBufferView.SizeInBytes		= size;
-
-				switch (access.componentType)
-				{
-					case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-						currModel.iBufferView.Format = DXGI_FORMAT_R8_UINT;
-						break;
-					case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-						currModel.iBufferView.Format = DXGI_FORMAT_R16_UINT;
-						break;
-					case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
-						currModel.iBufferView.Format = DXGI_FORMAT_R32_UINT;
-						break;
-				}
-
-				currModel.indexBuffer = (*modelResource.vertexBuffers)[bufferView.buffer];
+				meshlet.vertexOffset	-= vertexOffset;
+				meshlet.triangleOffset	-= triangleOffset;
 			}
+		}
+
+		/* we want copy constructor */
+		modelResource.models.push_back(currModel);
+	}
+
+	return true;
+}
+
+/* the sections of the buffer of the static batches, their offsets are in the order of the enum */
+enum EBatchSection
+{
+	BATCH_SECTION_VERTICES = 0,
+	BATCH_SECTION_INDICES,
+	BATCH_SECTION_INSTANCE,	/* the identity, the batches are in world space */
+	BATCH_SECTION_COUNT
+};
+
+static UINT64 GetBatchLayout(const StaticBatch::Arena& arena, UINT64 offsets[BATCH_SECTION_COUNT])
+{
+	const UINT64 sizes[BATCH_SECTION_COUNT] =
+	{
+		arena.vertices.size(),
+		arena.indices.size() * sizeof(uint32_t),
+		sizeof(MeshCache::Instance)
+	};
+
+	UINT64 size = 0;
+	for (int section = 0; section < BATCH_SECTION_COUNT; section++)
+	{
+		offsets[section] = size;
+		size += (sizes[section] + 15) & ~UINT64(15);
+	}
+
+	return size;
+}
+
+bool DX12Helper::UploadBatch(const MeshCache::View& view, const StaticBatch::Arena& arena, ModelResource& modelResource)
+{
+	if (arena.batches.empty())
+		return true;
+
+	ID3D12Resource*				buffer	= (*modelResource.vertexBuffers)[MODEL_BUFFER_BATCH];
+	D3D12_GPU_VIRTUAL_ADDRESS	address	= buffer->GetGPUVirtualAddress();
+
+	UINT64 offsets[BATCH_SECTION_COUNT];
+	GetBatchLayout(arena, offsets);
+
+	for (const StaticBatch::Batch& batch : arena.batches)
+	{
+		Model currModel;
+		currModel.name		= std::string("batch ") + std::to_string(batch.material);
+		currModel.material	= batch.material;
+
+		currModel.vBufferViews.resize(MODEL_SLOT_COUNT);
+		currModel.vertexBuffers.resize(MODEL_SLOT_COUNT, buffer);
+
+		currModel.vBufferViews[MODEL_SLOT_VERTICES].BufferLocation	= address + offsets[BATCH_SECTION_VERTICES] + UINT64(batch.vertexOffset) * arena.layout.stride;
+		currModel.vBufferViews[MODEL_SLOT_VERTICES].SizeInBytes		= batch.vertexCount * arena.layout.stride;
+		currModel.vBufferViews[MODEL_SLOT_VERTICES].StrideInBytes	= arena.layout.stride;
+
+		currModel.vBufferViews[MODEL_SLOT_INSTANCES].BufferLocation	= address + offsets[BATCH_SECTION_INSTANCE];
+		currModel.vBufferViews[MODEL_SLOT_INSTANCES].SizeInBytes	= sizeof(MeshCache::Instance);
+		currModel.vBufferViews[MODEL_SLOT_INSTANCES].StrideInBytes	= sizeof(MeshCache::Instance);
+		currModel.instances.push_back(GPM::Mat4::identity());
+
+		currModel.count							= batch.indexCount;
+		currModel.indexBuffer					= buffer;
+		currModel.iBufferView.BufferLocation	= address + offsets[BATCH_SECTION_INDICES] + UINT64(batch.indexOffset) * sizeof(uint32_t);
+		currModel.iBufferView.SizeInBytes		= batch.indexCount * sizeof(uint32_t);
+		currModel.iBufferView.Format			= DXGI_FORMAT_R32_UINT;
 
-			/* we want copy constructor */
-			modelResource.models.push_back(currModel);
+		for (uint32_t level = 0; level < batch.lodCount; level++)
+		{
+			Model::Lod currLod;
+			currLod.iBufferView.BufferLocation	= address + offsets[BATCH_SECTION_INDICES] + UINT64(batch.lods[level].indexOffset) * sizeof(uint32_t);
+			currLod.iBufferView.SizeInBytes		= batch.lods[level].indexCount * sizeof(uint32_t);
+			currLod.iBufferView.Format			= DXGI_FORMAT_R32_UINT;
+			currLod.count						= batch.lods[level].indexCount;
+			currLod.error						= batch.lods[level].error;
+			currModel.lods.push_back(currLod);
 		}
+
+		currModel.positionScale		= { batch.positionScale[0], batch.positionScale[1], batch.positionScale[2] };
+		currModel.positionOffset	= { batch.positionOffset[0], batch.positionOffset[1], batch.positionOffset[2] };
+		currModel.uvScaleOffset		= { batch.uvScale[0], batch.uvScale[1], batch.uvOffset[0], batch.uvOffset[1] };
+
+		currModel.center = { batch.center[0], batch.center[1], batch.center[2] };
+		currModel.radius = batch.radius;
+
+		/* rebased on the model as for the primitives */
+		if (batch.meshletCount > 0)
+		{
+			const Meshlets::Meshlet*	first	= arena.meshlets.data() + batch.meshletOffset;
+			const Meshlets::Meshlet&	last	= first[batch.meshletCount - 1];
+			uint32_t vertexOffset	= first->vertexOffset;
+			uint32_t triangleOffset	= first->triangleOffset;
+
+			currModel.meshlets.assign(first, first + batch.meshletCount);
+			currModel.meshletVertices.assign(arena.meshletVertices.begin() + vertexOffset, arena.meshletVertices.begin() + last.vertexOffset + last.vertexCount);
+			currModel.meshletTriangles.assign(arena.meshletTriangles.begin() + size_t(triangleOffset) * 3, arena.meshletTriangles.begin() + (size_t(last.triangleOffset) + last.triangleCount) * 3);
+			for (Meshlets::Meshlet& meshlet : currModel.meshlets)
+			{
+				meshlet.vertexOffset	-= vertexOffset;
+				meshlet.triangleOffset	-= triangleOffset;
+			}
+		}
+
+		modelResource.models.push_back(currModel);
 	}
 
 	return true;
 }
 
-bool DX12Helper::UploadMeshBuffer(const tinygltf::Model& gltfModel, ModelResource& modelResource, DefaultResourceUploader& uploader_)
+D3D12_INPUT_LAYOUT_DESC DX12Helper::GetModelInputLayout(const VertexLayout::Layout& layout, std::vector<D3D12_INPUT_ELEMENT_DESC>& elements)
+{
+	/* by VertexLayout::EAttribute, the formats of VertexQuantize */
+	static const D3D12_INPUT_ELEMENT_DESC attributeElements[VertexLayout::ATTRIBUTE_COUNT] =
+	{
+		{ "POSITION",	0, DXGI_FORMAT_R16G16B16A16_UNORM,	MODEL_SLOT_VERTICES, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "UV",			0, DXGI_FORMAT_R16G16_UNORM,		MODEL_SLOT_VERTICES, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "NORMAL",		0, DXGI_FORMAT_R16G16_SNORM,		MODEL_SLOT_VERTICES, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "TANGENT",	0, DXGI_FORMAT_R8G8B8A8_SNORM,		MODEL_SLOT_VERTICES, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "COLOR",		0, DXGI_FORMAT_R8G8B8A8_UNORM,		MODEL_SLOT_VERTICES, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "UV",			1, DXGI_FORMAT_R16G16_FLOAT,		MODEL_SLOT_VERTICES, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+	};
+
+	elements.clear();
+	for (uint32_t attribute = 0; attribute < VertexLayout::ATTRIBUTE_COUNT; attribute++)
+	{
+		if (!VertexLayout::Has(layout, static_cast<VertexLayout::EAttribute>(attribute)))
+			continue;
+
+		elements.push_back(attributeElements[attribute]);
+		elements.back().AlignedByteOffset = layout.offsets[attribute];
+	}
+
+	for (UINT row = 0; row < 4; row++)
+		elements.push_back({ "WORLD", row, DXGI_FORMAT_R32G32B32A32_FLOAT, MODEL_SLOT_INSTANCES, row * 16, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+
+	D3D12_INPUT_LAYOUT_DESC inputLayoutDesc = {};
+	inputLayoutDesc.NumElements			= static_cast<UINT>(elements.size());
+	inputLayoutDesc.pInputElementDescs	= elements.data();
+
+	return inputLayoutDesc;
+}
+
+GPM::Mat4 DX12Helper::GetInstanceWorld(const Model& model, UINT instance)
 {
-	modelResource.vertexBuffers->resize(gltfModel.buffers.size());
-	for (int i = 0; i < gltfModel.buffers.size(); i++)
+	/* the GPM products are in the order of the shader, that is trs * instance */
+	return model.instances[instance] * model.trs.model;
+}
+
+UINT DX12Helper::SelectLod(const Model& model, const GPM::Mat4& world, const GPM::Vec3& eyePos, float projectionScale, float maxPixelError)
+{
+	if (model.lods.empty())
+		return 0;
+
+	/* the sphere in world space, the errors grow with the largest scale of the transform */
+	float		maxScale	= 0.f;
+	for (int column = 0; column < 3; column++)
+		maxScale = std::max(maxScale, GPM::Vec3(world.e[column], world.e[4 + column], world.e[8 + column]).length());
+	GPM::Vec3	center		= (world * GPM::Vec4(model.center, 1.f)).xyz;
+
+	/* from the closest point of the sphere, nothing is simplified inside it */
+	float distance = (center - eyePos).length() - model.radius * maxScale;
+	if (distance <= 0.f)
+		return 0;
+
+	UINT lod = 0;
+	for (UINT level = 0; level < model.lods.size(); level++)
 	{
-		const tinygltf::Buffer& buffer = gltfModel.buffers[i];
+		if (model.lods[level].error * maxScale * projectionScale / distance > maxPixelError)
+			break;
+
+		lod = level + 1;
+	}
+
+	return lod;
+}
+
+bool DX12Helper::UploadMeshBuffer(const MeshCache::View& view, ModelResource& modelResource, DefaultResourceUploader& uploader_, const StaticBatch::Arena* arena)
+{
+	modelResource.vertexBuffers->resize(MODEL_BUFFER_BATCH);
+
+	/* the ranges read by the draws, straight from the mapped cache or source files, the only copy is the one to the upload heap */
+	std::vector<MeshCache::UploadRange> ranges;
+	UINT64 size = MeshCache::GetUploadRanges(view, arena ? arena->isBatched : noneBatched, MODEL_RANGE_ALIGNMENT, ranges);
+	if (size > 0)
+	{
+		UINT64 bufferSize = 0;
+		for (uint32_t i = 0; i < view.header->bufferCount; i++)
+			bufferSize += view.buffers[i].data.size;
+
+		UINT64						rangeSize = 0;
+		std::vector<BufferPiece>	pieces;
+		for (const MeshCache::UploadRange& range : ranges)
+		{
+			pieces.push_back({ (const uint8_t*)view.GetBufferData(range.buffer) + range.offset, range.size, range.arenaOffset });
+			rangeSize += range.size;
+		}
 
 		DefaultResource dftResource = {};
-		dftResource.buffer = modelResource.vertexBuffers->data() + i;
+		dftResource.buffer = modelResource.vertexBuffers->data() + MODEL_BUFFER_RANGES;
+
+		if (!CreateDefaultBuffer(pieces.data(), static_cast<UINT>(pieces.size()), size, dftResource, uploader_))
+			return false;
+
+		printf("Uploaded %llu of the %llu bytes of the model buffers, in %zu ranges\n", rangeSize, bufferSize, ranges.size());
+	}
+
+	if (view.header->instanceCount > 0)
+	{
+		DefaultResource dftResource = {};
+		dftResource.buffer = modelResource.vertexBuffers->data() + MODEL_BUFFER_INSTANCES;
 
 		D3D12_SUBRESOURCE_DATA data = {};
-		data.pData		= buffer.data.data();
-		data.RowPitch	= buffer.data.size();
-		data.SlicePitch = buffer.data.size();
+		data.pData		= view.instances;
+		data.RowPitch	= static_cast<LONG_PTR>(view.header->instanceCount * sizeof(MeshCache::Instance));
+		data.SlicePitch = data.RowPitch;
 
-		CreateDefaultBuffer(&data, dftResource, uploader_);
+		if (!CreateDefaultBuffer(&data, dftResource, uploader_))
+			return false;
 	}
 
 	return true;
 }
 
-bool DX12Helper::UploadTextureBuffer(const tinygltf::Model& gltfModel, ModelResource& modelResource, DefaultResourceUploader& uploader_)
+bool DX12Helper::UploadBatchBuffer(const MeshCache::View& view, const StaticBatch::Arena& arena, ModelResource& modelResource, DefaultResourceUploader& uploader_)
 {
-	modelResource.textures->resize(gltfModel.images.size() + 1);
+	if (arena.batches.empty())
+		return true;
+
+	/* the whole arena in one buffer */
+	UINT64 offsets[BATCH_SECTION_COUNT];
+	std::vector<uint8_t> bytes(GetBatchLayout(arena, offsets), 0);
+	memcpy(bytes.data() + offsets[BATCH_SECTION_VERTICES], arena.vertices.data(), arena.vertices.size());
+	memcpy(bytes.data() + offsets[BATCH_SECTION_INDICES], arena.indices.data(), arena.indices.size() * sizeof(uint32_t));
+	memcpy(bytes.data() + offsets[BATCH_SECTION_INSTANCE], GPM::Mat4::identity().e, sizeof(MeshCache::Instance));
+
+	modelResource.vertexBuffers->resize(MODEL_BUFFER_COUNT);
+
+	DefaultResource dftResource = {};
+	dftResource.buffer = modelResource.vertexBuffers->data() + MODEL_BUFFER_BATCH;
 
+	D3D12_SUBRESOURCE_DATA data = {};
+	data.pData		= bytes.data();
+	data.RowPitch	= static_cast<LONG_PTR>(bytes.size());
+	data.SlicePitch = data.RowPitch;
+
+	return CreateDefaultBuffer(&data, dftResource, uploader_);
+}
+
+static DXGI_FORMAT GetImageFormat(uint32_t channels)
+{
+	switch (channels)
+	{
+		case 1: return DXGI_FORMAT_R8_UNORM;
+		case 2: return DXGI_FORMAT_R8G8_UNORM;
+		/* 3 channels images are expanded to 4 when baking */
+		default: return DXGI_FORMAT_R8G8B8A8_UNORM;
+	}
+}
+
+static D3D12_RESOURCE_DESC GetTextureDesc()
+{
 	D3D12_RESOURCE_DESC texDesc = {};
 	texDesc.Dimension			= D3D12_RESOURCE_DIMENSION_TEXTURE2D;
 	texDesc.Alignment			= 0;		// may be 0, 4KB, 64KB, or 4MB. 0 will let runtime decide between 64KB and 4MB (4MB for multi-sampled textures)
 	texDesc.DepthOrArraySize	= 1;		// if 3d image, depth of 3d image. Otherwise an array of 1D or 2D textures (we only have one image, so we set 1)
-	texDesc.MipLevels			= 1;		// Number of mipmaps. We are not generating mipmaps for this texture, so we have only one level
+	texDesc.MipLevels			= 1;		// Number of mipmaps, the baked images come with theirs
 	texDesc.SampleDesc.Count	= 1;		// This is the number of samples per pixel, we just want 1 sample
 	texDesc.SampleDesc.Quality	= 0;		// The quality level of the samples. Higher is better quality, but worse performance
 	texDesc.Layout				= D3D12_TEXTURE_LAYOUT_UNKNOWN; // The arrangement of the pixels. Setting to unknown lets the driver choose the most efficient one
 	texDesc.Flags				= D3D12_RESOURCE_FLAG_NONE; // no flags
 
+	return texDesc;
+}
+
+bool DX12Helper::UploadPlaceholderTexture(const MeshCache::View& view, ModelResource& modelResource, DefaultResourceUploader& uploader_)
+{
+	modelResource.textures->resize(view.header->imageCount + 1);
+
+	D3D12_RESOURCE_DESC texDesc = GetTextureDesc();
+
 	/* upload black texture to gpu */
 	{
 	
@@ -688,50 +1426,48 @@ bool DX12Helper::UploadTextureBuffer(const tinygltf::Model& gltfModel, ModelReso
 		textureResource.texData.pData = nullptr;
 	}
 
-	for (int images = 0; images < gltfModel.images.size(); images++)
+	return true;
+}
+
+bool DX12Helper::UploadTextureBuffer(const MeshCache::View& view, ModelResource& modelResource, DefaultResourceUploader& uploader_)
+{
+	modelResource.textures->resize(view.header->imageCount + 1);
+
+	D3D12_RESOURCE_DESC texDesc = GetTextureDesc();
+
+	for (uint32_t images = 0; images < view.header->imageCount; images++)
 	{
-		const tinygltf::Image& currImage = gltfModel.images[images];
+		const MeshCache::Image& currImage = view.images[images];
 
 		TextureResource textureResource = {};
 
 		/* the gpu resource we will fill up in */
 		textureResource.buffer			= modelResource.textures->data() + images + 1;
 
-		BYTE* tex		= (BYTE*)currImage.image.data();
-		int channels	= currImage.component;
-		switch (channels)
+		/* block compressed, the dds file has the whole chain */
+		if (currImage.format != BlockCompress::FORMAT_NONE)
 		{
-			case 1: { texDesc.Format = DXGI_FORMAT_R8_UNORM; break; }
-			case 2: { texDesc.Format = DXGI_FORMAT_R8G8_UNORM; break; }
-				  /* there is no 3-bytes dxgi type in d3d12 (gpu does not support anymore), expanding to 4 */
-			case 3:
-			{
-				int arraySize = currImage.width * currImage.height * 4;
-				BYTE* old = tex;
-				tex = (BYTE*)malloc(arraySize);
-				BYTE max = std::numeric_limits<BYTE>().max();
-
-				for (int i = 0, j = 0; i < arraySize; i += 4, j += 3)
-				{
-					tex[i] = old[j];
-					tex[i + 1] = old[j + 1];
-					tex[i + 2] = old[j + 2];
-					tex[i + 3] = max;
-				}
-
-				stbi_image_free(old);
-				channels = 4;
-			}
-			default: { texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM; break; }
-		};
+			if (!UploadDDSTexture(currImage.cachePath, textureResource, uploader_))
+				return false;
+			continue;
+		}
 
-		/* the actual data to send */
-		textureResource.texData.pData		= tex;
-		textureResource.texData.RowPitch	= currImage.width * channels * sizeof(BYTE);
-		textureResource.texData.SlicePitch	= textureResource.texData.RowPitch * currImage.height;
+		/* the actual data to send, already decoded in the mapped file with the mips following the first level */
+		const BYTE* pixels = (const BYTE*)view.GetData(currImage.pixels);
+		textureResource.mipData.resize(currImage.mipCount - 1);
+		for (uint32_t mip = 0; mip < currImage.mipCount; mip++)
+		{
+			D3D12_SUBRESOURCE_DATA& mipData = mip == 0 ? textureResource.texData : textureResource.mipData[mip - 1];
+			mipData.pData		= pixels;
+			mipData.RowPitch	= MipChain::GetLevelSize(currImage.width, mip) * currImage.channels;
+			mipData.SlicePitch	= mipData.RowPitch * MipChain::GetLevelSize(currImage.height, mip);
+			pixels += mipData.SlicePitch;
+		}
 
-		texDesc.Width	= currImage.width;	// width of the texture
-		texDesc.Height	= currImage.height;	// height of the texture
+		texDesc.Width		= currImage.width;	// width of the texture
+		texDesc.Height		= currImage.height;	// height of the texture
+		texDesc.MipLevels	= currImage.mipCount;
+		texDesc.Format		= GetImageFormat(currImage.channels);
 
 		if (!CreateRawTexture(texDesc, textureResource, uploader_))
 			return false;
@@ -741,7 +1477,7 @@ bool DX12Helper::UploadTextureBuffer(const tinygltf::Model& gltfModel, ModelReso
 	return true;
 }
 
-bool DX12Helper::UploadTexture(const tinygltf::Model& gltfModel, ModelResource& modelResource, DefaultResourceUploader& uploader_)
+bool DX12Helper::UploadTexture(const MeshCache::View& view, ModelResource& modelResource, DefaultResourceUploader& uploader_)
 {
 	HRESULT hr;
 
@@ -758,19 +1494,19 @@ bool DX12Helper::UploadTexture(const tinygltf::Model& gltfModel, ModelResource&
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Texture2D.MipLevels = 1;
+	srvDesc.Texture2D.MipLevels = (UINT)-1;	// every mip of the texture
 
-	modelResource.descHeaps->resize(gltfModel.materials.size());
-	for (int i = 0; i < gltfModel.materials.size(); i++)
+	modelResource.descHeaps->resize(view.header->materialCount);
+	for (uint32_t i = 0; i < view.header->materialCount; i++)
 	{
-		const tinygltf::Material& currMat = gltfModel.materials[i];
+		const MeshCache::Material& currMat = view.materials[i];
 
 		ID3D12DescriptorHeap** currDescHeap = &(*modelResource.descHeaps)[i];
 		hr = uploader_.device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(currDescHeap));
 
 		if (FAILED(hr))
 		{
-			printf("Failing creating main descriptor heap for %s: %s\n", currMat.name.c_str(), std::system_category().message(hr).c_str());
+			printf("Failing creating main descriptor heap for material %u: %s\n", i, std::system_category().message(hr).c_str());
 			return false;
 		}
 
@@ -778,59 +1514,44 @@ bool DX12Helper::UploadTexture(const tinygltf::Model& gltfModel, ModelResource&
 
 		/* when mat does not have it makes index -1, as everything is offseted by one in our array,
 		 * a -1 texture points to the default black texture. */
-		const int currImages[3] = { currMat.pbrMetallicRoughness.baseColorTexture.index + 1,
-												currMat.normalTexture.index + 1,
-												currMat.pbrMetallicRoughness.metallicRoughnessTexture.index + 1};
+		const int currImages[3] = { currMat.baseColor + 1, currMat.normal + 1, currMat.metallicRoughness + 1 };
 
 		for (int i = 0; i < _countof(currImages); i++)
 		{
-			if (currImages[i] == 0)
+			/* the images not uploaded yet are the black texture too (see UploadPlaceholderTexture) */
+			ID3D12Resource* texture = (*modelResource.textures)[currImages[i]];
+			if (!texture)
+				texture = (*modelResource.textures)[0];
+
+			/* the block compressed images may keep their channels elsewhere than where the shaders read them */
+			srvDesc.Format					= texture->GetDesc().Format;
+			srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+			if (texture != (*modelResource.textures)[0])
 			{
-				srvDesc.Format = DXGI_FORMAT_R8_UNORM;
-			}
-			else
-			{
-				switch (gltfModel.images[currImages[i] - 1].component)
-				{
-				case 1: { srvDesc.Format = DXGI_FORMAT_R8_UNORM; break; }
-				case 2: { srvDesc.Format = DXGI_FORMAT_R8G8_UNORM; break; }
-					  /* there is no 3-bytes dxgi type in d3d12 (gpu does not support anymore), expanding to 4 */
-				case 3:
-				default: { srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM; break; }
-				};
+				const uint8_t* mapping = view.images[currImages[i] - 1].componentMapping;
+				srvDesc.Shader4ComponentMapping = D3D12_ENCODE_SHADER_4_COMPONENT_MAPPING(mapping[0], mapping[1], mapping[2], mapping[3]);
 			}
 
-			uploader_.device->CreateShaderResourceView((*modelResource.textures)[currImages[i]], &srvDesc, handle);
+			uploader_.device->CreateShaderResourceView(texture, &srvDesc, handle);
 
 			handle.ptr += offset;
 		}
 	}
 
-	const tinygltf::Scene& dftScene = gltfModel.scenes[gltfModel.defaultScene];
-	int modelIndex = 0;
-	for (int node = 0; node < dftScene.nodes.size(); node++)
+	for (Model& currModel : modelResource.models)
 	{
-		const tinygltf::Node&	currNode	= gltfModel.nodes[node];
-		const tinygltf::Mesh&	mesh		= gltfModel.meshes[currNode.mesh];
-
-		for (int primitive = 0; primitive < mesh.primitives.size(); primitive++)
-		{
-			const tinygltf::Primitive&	currPrimitive	= mesh.primitives[primitive];
-			const tinygltf::Material&	currMat			= gltfModel.materials[currPrimitive.material];
-			ID3D12DescriptorHeap* currDescHeap			= (*modelResource.descHeaps)[currPrimitive.material];
-			Model& currModel							= modelResource.models[modelIndex++];
+		const MeshCache::Material& currMat = view.materials[currModel.material];
 
-			/* set desc heap */
-			currModel.descHeap = currDescHeap;
+		/* set desc heap */
+		currModel.descHeap = (*modelResource.descHeaps)[currModel.material];
 
-			const int currImages[3] = { currMat.pbrMetallicRoughness.baseColorTexture.index + 1, 
-													currMat.normalTexture.index + 1,
-													currMat.pbrMetallicRoughness.metallicRoughnessTexture.index + 1};
+		const int currImages[3] = { currMat.baseColor + 1, currMat.normal + 1, currMat.metallicRoughness + 1 };
 
-			for (int i = 0; i < _countof(currImages); i++)
-			{
-				currModel.textures.push_back((*modelResource.textures)[currImages[i]]);
-			}
+		currModel.textures.clear();
+		for (int i = 0; i < _countof(currImages); i++)
+		{
+			ID3D12Resource* texture = (*modelResource.textures)[currImages[i]];
+			currModel.textures.push_back(texture ? texture : (*modelResource.textures)[0]);
 		}
 	}
 	return true;
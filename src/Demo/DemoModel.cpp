@@ -4,8 +4,10 @@
 
 /* d3d */
 #include <d3dcompiler.h>
+#include "AssetStreamer.hpp"
 #include "DX12Helper.hpp"
 #include "DX12Handle.hpp"
+#include "MeshCache.hpp"
 
 /* math*/
 #include "GPM/Vector3.hpp"
@@ -17,6 +19,8 @@
 
 #include "Demo/DemoModel.hpp"
 
+#define DEMO_MODEL_PATH "media/AntiqueCamera/AntiqueCamera.gltf"
+
 struct DemoModelVertex
 {
 	GPM::vec3 pos;
@@ -29,6 +33,11 @@ struct DemoModelConstantBuffer
 	GPM::mat4 perspective;
 	GPM::mat4 view;
 	GPM::mat4 model;
+
+	/* dequantization of the vertex streams, w unused */
+	GPM::Vec4 positionScale;
+	GPM::Vec4 positionOffset;
+	GPM::Vec4 uvScaleOffset;
 };
 
 struct DemoModelLightBuffer
@@ -47,24 +56,6 @@ DemoModel::~DemoModel()
 	if (_pso)
 		_pso->Release();
 
-	for (int i = 0; i < _vBuffers.size(); i++)
-	{
-		if (_vBuffers[i])
-			_vBuffers[i]->Release();
-	}
-
-	for (int i = 0; i < _texDescriptorHeap.size(); i++)
-	{
-		if (_texDescriptorHeap[i])
-			_texDescriptorHeap[i]->Release();
-	}
-
-	for (int i = 0; i < _textureResources.size(); i++)
-	{
-		if (_textureResources[i])
-			_textureResources[i]->Release();
-	}
-
 	for (int i = 0; i < _descHeaps.size(); i++)
 	{
 		if (_descHeaps[i])
@@ -75,32 +66,13 @@ DemoModel::~DemoModel()
 DemoModel::DemoModel(const DemoInputs& inputs_, const DX12Handle& dx12Handle_)
 {
 	mainCamera.position.z = 1.0f;
+	_device = dx12Handle_._device;
+	_descHeaps.fill(nullptr);
 
-	/* make resources */
+	/* make resources, the constant buffers wait for the model to know how many there are */
 	if (!MakeModel(dx12Handle_))
 		return;
 
-	_constantBuffers.resize(_descHeaps.size() * (_models.size() + 1));
-	/* making constant buffer */
-	for (int i = 0; i < _descHeaps.size(); i++)
-	{
-		DX12Helper::ConstantResourceUploader cbUploader;
-		cbUploader.device	= dx12Handle_._device;
-		cbUploader.descHeap = &_descHeaps[i];
-
-		if (!DX12Helper::CreateCBufferHeap(_models.size() + 1, cbUploader))
-			break;
-
-		for (int j = 0; j < _models.size(); j++)
-		{
-			if (!DX12Helper::CreateCBuffer(sizeof(DemoModelConstantBuffer), _constantBuffers[(i * (_models.size() + 1)) + j], cbUploader))
-				break;
-		}
-
-		if (!DX12Helper::CreateCBuffer(sizeof(DemoModelLightBuffer), _constantBuffers[(i * (_models.size() + 1)) + _models.size()], cbUploader))
-			break;
-	}
-
 	/* make shader and pipeline */
 	D3D12_SHADER_BYTECODE vertex;
 	D3D12_SHADER_BYTECODE pixel;
@@ -128,6 +100,10 @@ bool DemoModel::MakeShader(D3D12_SHADER_BYTECODE& vertex, D3D12_SHADER_BYTECODE&
 		float4x4 proj;
 		float4x4 view;
 		float4x4 model;
+
+		float4 positionScale;
+		float4 positionOffset;
+		float4 uvScaleOffset;
 	};
 
 	cbuffer LightBuffer : register(b1)
@@ -139,10 +115,27 @@ bool DemoModel::MakeShader(D3D12_SHADER_BYTECODE& vertex, D3D12_SHADER_BYTECODE&
 		float4	lightColor;
 	};	
 
-	VOut vert(float3 position : POSITION, float2 uv : UV, float3 normal : NORMAL)
+	/* octahedral mapping of the unit sphere, the lower half folded over the diagonals */
+	float3 decode_octahedral(float2 octahedral)
+	{
+		float3 normal	= float3(octahedral, 1.0 - abs(octahedral.x) - abs(octahedral.y));
+		float t			= saturate(-normal.z);
+		normal.xy		+= normal.xy >= 0.0 ? -t : t;
+		return normalize(normal);
+	}
+
+	VOut vert(float4 quantizedPosition : POSITION, float2 quantizedUv : UV, float2 octahedralNormal : NORMAL,
+			  float4 world0 : WORLD0, float4 world1 : WORLD1, float4 world2 : WORLD2, float4 world3 : WORLD3)
 	{
 		VOut output;
 
+		/* the node of the instance, before the model */
+		float4x4 world	= float4x4(world0, world1, world2, world3);
+
+		float3 position	= mul(world, float4(quantizedPosition.xyz * positionScale.xyz + positionOffset.xyz, 1.0)).xyz;
+		float2 uv		= quantizedUv * uvScaleOffset.xy + uvScaleOffset.zw;
+		float3 normal	= mul((float3x3)world, decode_octahedral(octahedralNormal));
+
         output.fragPos  = mul(float4(position,1.0),model).xyz;
         output.view     = mul(float4(output.fragPos,1.0),view);
         output.position = mul(output.view, proj);
@@ -185,6 +178,8 @@ bool DemoModel::MakeShader(D3D12_SHADER_BYTECODE& vertex, D3D12_SHADER_BYTECODE&
         // assume N, the interpolated vertex normal and 
         // V, the view vector (vertex to eye)
         texNormal = (texNormal * 2.0 - 1.0);
+        // z rebuilt from x and y, the BC5 normal maps only keep these two
+        texNormal.z = sqrt(saturate(1.0 - dot(texNormal.xy, texNormal.xy)));
         float3x3 TBN = cotangent_frame(normal, viewEye, uv);
         return normalize(mul(texNormal,TBN));
     }
@@ -288,25 +283,77 @@ bool DemoModel::MakeShader(D3D12_SHADER_BYTECODE& vertex, D3D12_SHADER_BYTECODE&
 
 bool DemoModel::MakeModel(const DX12Handle& dx12Handle_)
 {
-	/* create resource uploader */
-	DX12Helper::DefaultResourceUploader uploader;
-	if (!DX12Helper::MakeUploader(uploader, dx12Handle_))
-		return false;
-	
+	/* returns at once, the model shows up in a later frame (see ApplyStreamedModel) */
+	_streamer		= std::make_unique<AssetStreamer>(dx12Handle_);
+	_streamedModel	= _streamer->LoadModel(DEMO_MODEL_PATH);
 
-	DX12Helper::ModelResource modelResources = {};
-	modelResources.descHeaps		= &_texDescriptorHeap;
-	modelResources.textures			= &_textureResources;
-	modelResources.vertexBuffers	= &_vBuffers;
+	return true;
+}
 
-	if (!DX12Helper::UploadModel("media/AntiqueCamera/AntiqueCamera.gltf", modelResources, uploader))
-		return false;
+void DemoModel::WarmUp()
+{
+	/* the mapping is dropped at once, the baked files stay for the stream of the demo */
+	MeshCache::CachedModel model;
+	MeshCache::Load(DEMO_MODEL_PATH, model);
+}
 
-	_models = std::move(modelResources.models);
+bool DemoModel::MakeConstantBuffers()
+{
+	_constantBuffers.resize(_descHeaps.size() * (_models.size() + 1));
+	/* making constant buffer */
+	for (int i = 0; i < _descHeaps.size(); i++)
+	{
+		DX12Helper::ConstantResourceUploader cbUploader;
+		cbUploader.device	= _device;
+		cbUploader.descHeap = &_descHeaps[i];
+
+		if (!DX12Helper::CreateCBufferHeap(_models.size() + 1, cbUploader))
+			return false;
+
+		for (int j = 0; j < _models.size(); j++)
+		{
+			if (!DX12Helper::CreateCBuffer(sizeof(DemoModelConstantBuffer), _constantBuffers[(i * (_models.size() + 1)) + j], cbUploader))
+				return false;
+		}
+
+		if (!DX12Helper::CreateCBuffer(sizeof(DemoModelLightBuffer), _constantBuffers[(i * (_models.size() + 1)) + _models.size()], cbUploader))
+			return false;
+	}
 
 	return true;
 }
 
+void DemoModel::ApplyStreamedModel()
+{
+	switch (_streamedModel->state)
+	{
+		/* the meshes arrived, the transforms edited from now on are kept when the textures come */
+		case StreamedModel::STATE_PLACEHOLDER:
+			if (_models.empty())
+			{
+				_models = _streamedModel->models;
+				if (!MakeConstantBuffers())
+					_models.clear();
+			}
+			break;
+
+		case StreamedModel::STATE_READY:
+			for (size_t i = 0; i < _models.size(); i++)
+			{
+				_models[i].descHeap	= _streamedModel->models[i].descHeap;
+				_models[i].textures	= _streamedModel->models[i].textures;
+			}
+			break;
+
+		case StreamedModel::STATE_FAILED:
+			printf("Failing streaming %s in demo %s\n", _streamedModel->filePath.c_str(), Name());
+			break;
+
+		default:
+			break;
+	}
+}
+
 bool DemoModel::MakePipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_BYTECODE& vertex, D3D12_SHADER_BYTECODE& pixel)
 {
 	HRESULT hr;
@@ -373,7 +420,7 @@ bool DemoModel::MakePipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_BYTECOD
 	}
 
 
-	hr = dx12Handle_._device->CreateRootSignature(0, tmp->GetBufferPointer(), tmp->GetBufferSize(), IID_PPV_ARGS(&_rootSignature));
+	hr = dx12Handle_._pipelineCache->CreateRootSignature(tmp, &_rootSignature);
 	if (FAILED(hr))
 	{
 		printf("Failing creating root signature of demo %s: %s\n", Name(), std::system_category().message(hr).c_str());
@@ -381,19 +428,9 @@ bool DemoModel::MakePipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_BYTECOD
 		return false;
 	}
 
-	D3D12_INPUT_ELEMENT_DESC inputLayout[] =
-	{
-		{ "POSITION",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "UV",			0, DXGI_FORMAT_R32G32_FLOAT,	1, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "NORMAL",		0, DXGI_FORMAT_R32G32B32_FLOAT,	2, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-	};
-
-	// fill out an input layout description structure
-	D3D12_INPUT_LAYOUT_DESC inputLayoutDesc = {};
-
-	// we can get the number of elements in an array by "sizeof(array) / sizeof(arrayElementType)"
-	inputLayoutDesc.NumElements			= sizeof(inputLayout) / sizeof(D3D12_INPUT_ELEMENT_DESC);
-	inputLayoutDesc.pInputElementDescs	= inputLayout;
+	/* the interleaved vertices of the model cache, as baked with the default options */
+	std::vector<D3D12_INPUT_ELEMENT_DESC>	inputElements;
+	D3D12_INPUT_LAYOUT_DESC					inputLayoutDesc = DX12Helper::GetModelInputLayout(MeshCache::GetVertexLayout(MeshCache::Options()), inputElements);
 
 	D3D12_RASTERIZER_DESC rasterDesc	= {};
 	rasterDesc.FillMode					= D3D12_FILL_MODE_SOLID;
@@ -426,7 +463,7 @@ bool DemoModel::MakePipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_BYTECOD
 	psoDesc.DSVFormat				= DXGI_FORMAT_D32_FLOAT;
 
 	// create the pso
-	hr = dx12Handle_._device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&_pso));
+	hr = dx12Handle_._pipelineCache->CreatePipelineState(psoDesc, &_pso);
 	if (FAILED(hr))
 	{
 		printf("Failing creating PSO of %s: %s\n", Name(), std::system_category().message(hr).c_str());
@@ -442,6 +479,9 @@ bool DemoModel::MakePipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_BYTECOD
 
 void DemoModel::UpdateAndRender(const DemoInputs& inputs_)
 {
+	if (_streamer && _streamer->Update())
+		ApplyStreamedModel();
+
 	Update(inputs_);
 	Render(inputs_);
 }
@@ -455,6 +495,13 @@ void DemoModel::Update(const DemoInputs& inputs_)
 	scissorRect.right	= inputs_.renderContext.width;
 	scissorRect.bottom	= inputs_.renderContext.height;
 
+	/* the frames go on while loading, there is nothing to edit yet */
+	if (_models.empty())
+	{
+		ImGui::Text("Loading %s ...", _streamedModel ? _streamedModel->filePath.c_str() : "");
+		return;
+	}
+
 	for (int i = 0; i < _models.size(); i++)
 	{
 		InspectTransform(_models[i]);
@@ -503,10 +550,14 @@ void DemoModel::Render(const DemoInputs& inputs_)
 	cmdList->ClearRenderTargetView(inputs_.renderContext.currBackBufferHandle, clearColor, 0, nullptr);
 	cmdList->ClearDepthStencilView(inputs_.renderContext.depthBufferHandle, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
 
+	if (_models.empty())
+		return;
+
 	cmdList->SetGraphicsRootSignature(_rootSignature); // set the root signature
 	cmdList->SetPipelineState(_pso);
 	cmdList->RSSetViewports(1, &viewport); // set the viewports
 	cmdList->RSSetScissorRects(1, &scissorRect); // set the scissor rects
+	_boundDescHeap = nullptr;
 
 	/* update CBuffer */
 	DemoModelConstantBuffer cBuffer = {};
@@ -519,7 +570,10 @@ void DemoModel::Render(const DemoInputs& inputs_)
 	{
 		cmdList->SetGraphicsRootConstantBufferView(0, _constantBuffers[(inputs_.renderContext.currFrameIndex * (FRAME_BUFFER_COUNT - 1)) + i].buffer->GetGPUVirtualAddress());
 
-		cBuffer.model = _models[i].trs.model;
+		cBuffer.model			= _models[i].trs.model;
+		cBuffer.positionScale	= GPM::Vec4(_models[i].positionScale, 0.f);
+		cBuffer.positionOffset	= GPM::Vec4(_models[i].positionOffset, 0.f);
+		cBuffer.uvScaleOffset	= _models[i].uvScaleOffset;
 		DX12Helper::UploadCBuffer((void*)&cBuffer, sizeof(cBuffer), _constantBuffers[(inputs_.renderContext.currFrameIndex * (FRAME_BUFFER_COUNT - 1)) + i]);
 
 		DrawModel(cmdList, _models[i]);
@@ -528,24 +582,28 @@ void DemoModel::Render(const DemoInputs& inputs_)
 
 void DemoModel::DrawModel(ID3D12GraphicsCommandList4* cmdList, const DX12Helper::Model& model)
 {
-	if (model.textures.size() > 0)
+	if (model.textures.size() > 0 && model.descHeap != _boundDescHeap)
 	{
 		cmdList->SetDescriptorHeaps(1, &model.descHeap); // set the descriptor heap
 		// set the descriptor table to the descriptor heap (parameter 1, as constant buffer root descriptor is parameter index 0)
 
 		cmdList->SetGraphicsRootDescriptorTable(1, model.descHeap->GetGPUDescriptorHandleForHeapStart());
+		_boundDescHeap = model.descHeap;
 	}
 
 	cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST); // set the primitive topology
 	cmdList->IASetVertexBuffers(0, model.vBufferViews.size(), model.vBufferViews.data()); // set the vertex buffer (using the vertex buffer view)
 
+	/* once per node using the mesh */
+	UINT instanceCount = static_cast<UINT>(model.instances.size());
+
 	if (model.indexBuffer)
 	{
 		cmdList->IASetIndexBuffer(&model.iBufferView); // set the index buffer (using the index buffer view)
-		cmdList->DrawIndexedInstanced(model.count, 1, 0, 0, 0); // finally draw 6 indices (draw the quad)
+		cmdList->DrawIndexedInstanced(model.count, instanceCount, 0, 0, 0); // finally draw 6 indices (draw the quad)
 	}
 	else
 	{
-		cmdList->DrawInstanced(model.count, 1, 0, 0); // finally draw 6 indices (draw the quad)
+		cmdList->DrawInstanced(model.count, instanceCount, 0, 0); // finally draw 6 indices (draw the quad)
 	}
 }
\ No newline at end of file
@@ -285,7 +285,7 @@ bool DemoQuad::MakePipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_BYTECODE
 	}
 
 
-	hr = dx12Handle_._device->CreateRootSignature(0, tmp->GetBufferPointer(), tmp->GetBufferSize(), IID_PPV_ARGS(&_rootSignature));
+	hr = dx12Handle_._pipelineCache->CreateRootSignature(tmp, &_rootSignature);
 	if (FAILED(hr))
 	{
 		printf("Failing creating root signature of demo %s: %s\n", Name(), std::system_category().message(hr).c_str());
@@ -337,7 +337,7 @@ bool DemoQuad::MakePipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_BYTECODE
 	psoDesc.DSVFormat				= DXGI_FORMAT_D32_FLOAT;
 
 	// create the pso
-	hr = dx12Handle_._device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&_pso));
+	hr = dx12Handle_._pipelineCache->CreatePipelineState(psoDesc, &_pso);
 	if (FAILED(hr))
 	{
 		printf("Failing creating PSO of %s: %s\n", Name(), std::system_category().message(hr).c_str());
@@ -141,7 +141,7 @@ bool DemoRayCPUGradiant::MakePipeline(const DX12Handle& dx12Handle_, D3D12_SHADE
 	}
 
 
-	hr = dx12Handle_._device->CreateRootSignature(0, tmp->GetBufferPointer(), tmp->GetBufferSize(), IID_PPV_ARGS(&_rootSignature));
+	hr = dx12Handle_._pipelineCache->CreateRootSignature(tmp, &_rootSignature);
 	if (FAILED(hr))
 	{
 		printf("Failing creating root signature of demo %s: %s\n", Name(), std::system_category().message(hr).c_str());
@@ -170,7 +170,7 @@ bool DemoRayCPUGradiant::MakePipeline(const DX12Handle& dx12Handle_, D3D12_SHADE
 	psoDesc.NumRenderTargets = 1;										// we are only binding one render target
 
 	// create the pso
-	hr = dx12Handle_._device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&_pso));
+	hr = dx12Handle_._pipelineCache->CreatePipelineState(psoDesc, &_pso);
 	if (FAILED(hr))
 	{
 		printf("Failing creating PSO of %s: %s\n", Name(), std::system_category().message(hr).c_str());
@@ -1,11 +1,15 @@
 /* system include */
+#include <algorithm>
 #include <system_error>
 #include <cstdio>
+#include <cmath>
 
 /* d3d */
 #include <d3dcompiler.h>
+#include "AssetStreamer.hpp"
 #include "DX12Helper.hpp"
 #include "DX12Handle.hpp"
+#include "MeshCache.hpp"
 
 /* math*/
 #include "GPM/Vector3.hpp"
@@ -17,6 +21,8 @@
 
 #include "Demo/DemoScene.hpp"
 
+#define DEMO_SCENE_PATH "media/AntiqueCamera/AntiqueCamera.gltf"
+
 struct DemoSceneVertex
 {
 	GPM::vec3 pos;
@@ -28,6 +34,11 @@ struct DemoSceneConstantBuffer
 	GPM::mat4 perspective;
 	GPM::mat4 view;
 	GPM::mat4 model;
+
+	/* dequantization of the vertex streams, w unused */
+	GPM::Vec4 positionScale;
+	GPM::Vec4 positionOffset;
+	GPM::Vec4 uvScaleOffset;
 };
 
 struct DemoSceneLightBuffer
@@ -46,24 +57,6 @@ DemoScene::~DemoScene()
 	if (_pso)
 		_pso->Release();
 
-	for (int i = 0; i < _vBuffers.size(); i++)
-	{
-		if (_vBuffers[i])
-			_vBuffers[i]->Release();
-	}
-
-	for (int i = 0; i < _texDescriptorHeap.size(); i++)
-	{
-		if (_texDescriptorHeap[i])
-			_texDescriptorHeap[i]->Release();
-	}
-
-	for (int i = 0; i < _textureResources.size(); i++)
-	{
-		if (_textureResources[i])
-			_textureResources[i]->Release();
-	}
-
 	for (int i = 0; i < _descHeaps.size(); i++)
 	{
 		if (_descHeaps[i])
@@ -82,37 +75,24 @@ DemoScene::~DemoScene()
 
 	if (_boxVertexBuffer)
 		_boxVertexBuffer->Release();
+
+	for (int i = 0; i < _culledIndexBuffers.size(); i++)
+	{
+		if (_culledIndexBuffers[i])
+			_culledIndexBuffers[i]->Release();
+	}
 }
 
 DemoScene::DemoScene(const DemoInputs& inputs_, const DX12Handle& dx12Handle_)
 {
 	mainCamera.position.z = 1.0f;
+	_device = dx12Handle_._device;
+	_descHeaps.fill(nullptr);
 
-	/* make resources */
+	/* make resources, the buffers sized by the model wait for it (see ApplyStreamedModel) */
 	if (!MakeModel(dx12Handle_) || !MakeSkyBox(dx12Handle_))
 		return;
 
-	_constantBuffers.resize(_descHeaps.size() * (_models.size() + 1));
-	/* making constant buffer */
-	for (int i = 0; i < _descHeaps.size(); i++)
-	{
-		DX12Helper::ConstantResourceUploader cbUploader;
-		cbUploader.device = dx12Handle_._device;
-		cbUploader.descHeap = &_descHeaps[i];
-
-		if (!DX12Helper::CreateCBufferHeap(_models.size() + 1, cbUploader))
-			break;
-
-		for (int j = 0; j < _models.size(); j++)
-		{
-			if (!DX12Helper::CreateCBuffer(sizeof(DemoSceneConstantBuffer), _constantBuffers[(i * (_models.size() + 1)) + j], cbUploader))
-				break;
-		}
-
-		if (!DX12Helper::CreateCBuffer(sizeof(DemoSceneLightBuffer), _constantBuffers[(i * (_models.size() + 1)) + _models.size()], cbUploader))
-			break;
-	}
-
 	/* make shader and pipeline */
 	D3D12_SHADER_BYTECODE vertex;
 	D3D12_SHADER_BYTECODE pixel;
@@ -143,6 +123,10 @@ bool DemoScene::MakeModelShader(D3D12_SHADER_BYTECODE& vertex, D3D12_SHADER_BYTE
 		float4x4 proj;
 		float4x4 view;
 		float4x4 model;
+
+		float4 positionScale;
+		float4 positionOffset;
+		float4 uvScaleOffset;
 	};
 
 	cbuffer LightBuffer : register(b1)
@@ -154,10 +138,27 @@ bool DemoScene::MakeModelShader(D3D12_SHADER_BYTECODE& vertex, D3D12_SHADER_BYTE
 		float4	lightColor;
 	};	
 
-	VOut vert(float3 position : POSITION, float2 uv : UV, float3 normal : NORMAL)
+	/* octahedral mapping of the unit sphere, the lower half folded over the diagonals */
+	float3 decode_octahedral(float2 octahedral)
+	{
+		float3 normal	= float3(octahedral, 1.0 - abs(octahedral.x) - abs(octahedral.y));
+		float t			= saturate(-normal.z);
+		normal.xy		+= normal.xy >= 0.0 ? -t : t;
+		return normalize(normal);
+	}
+
+	VOut vert(float4 quantizedPosition : POSITION, float2 quantizedUv : UV, float2 octahedralNormal : NORMAL,
+			  float4 world0 : WORLD0, float4 world1 : WORLD1, float4 world2 : WORLD2, float4 world3 : WORLD3)
 	{
 		VOut output;
 
+		/* the node of the instance, before the model */
+		float4x4 world	= float4x4(world0, world1, world2, world3);
+
+		float3 position	= mul(world, float4(quantizedPosition.xyz * positionScale.xyz + positionOffset.xyz, 1.0)).xyz;
+		float2 uv		= quantizedUv * uvScaleOffset.xy + uvScaleOffset.zw;
+		float3 normal	= mul((float3x3)world, decode_octahedral(octahedralNormal));
+
 		output.fragPos  = mul(float4(position,1.0),model).xyz;
 		output.view     = mul(float4(output.fragPos,1.0),view);
 		output.position = mul(output.view, proj);
@@ -200,6 +201,8 @@ bool DemoScene::MakeModelShader(D3D12_SHADER_BYTECODE& vertex, D3D12_SHADER_BYTE
 		// assume N, the interpolated vertex normal and 
 		// V, the view vector (vertex to eye)
 		texNormal = (texNormal * 2.0 - 1.0);
+		// z rebuilt from x and y, the BC5 normal maps only keep these two
+		texNormal.z = sqrt(saturate(1.0 - dot(texNormal.xy, texNormal.xy)));
 		float3x3 TBN = cotangent_frame(normal, viewEye, uv);
 		return normalize(mul(texNormal,TBN));
 	}
@@ -303,21 +306,121 @@ bool DemoScene::MakeModelShader(D3D12_SHADER_BYTECODE& vertex, D3D12_SHADER_BYTE
 
 bool DemoScene::MakeModel(const DX12Handle& dx12Handle_)
 {
-	/* create resource uploader */
-	DX12Helper::DefaultResourceUploader uploader;
-	if (!DX12Helper::MakeUploader(uploader, dx12Handle_))
-		return false;
+	/* returns at once, the model shows up in a later frame.
+	 * The scene does not move, its primitives are merged per material (see StaticBatch) */
+	_streamer		= std::make_unique<AssetStreamer>(dx12Handle_);
+	_streamedModel	= _streamer->LoadModel(DEMO_SCENE_PATH, true);
 
+	return true;
+}
 
-	DX12Helper::ModelResource modelResources = {};
-	modelResources.descHeaps = &_texDescriptorHeap;
-	modelResources.textures = &_textureResources;
-	modelResources.vertexBuffers = &_vBuffers;
+void DemoScene::WarmUp()
+{
+	/* the mapping is dropped at once, the baked files stay for the stream of the demo */
+	MeshCache::CachedModel model;
+	MeshCache::Load(DEMO_SCENE_PATH, model);
+}
 
-	if (!DX12Helper::UploadModel("media/AntiqueCamera/AntiqueCamera.gltf", modelResources, uploader))
-		return false;
+bool DemoScene::MakeConstantBuffers()
+{
+	_constantBuffers.resize(_descHeaps.size() * (_models.size() + 1));
+	/* making constant buffer */
+	for (int i = 0; i < _descHeaps.size(); i++)
+	{
+		DX12Helper::ConstantResourceUploader cbUploader;
+		cbUploader.device = _device;
+		cbUploader.descHeap = &_descHeaps[i];
+
+		if (!DX12Helper::CreateCBufferHeap(_models.size() + 1, cbUploader))
+			return false;
+
+		for (int j = 0; j < _models.size(); j++)
+		{
+			if (!DX12Helper::CreateCBuffer(sizeof(DemoSceneConstantBuffer), _constantBuffers[(i * (_models.size() + 1)) + j], cbUploader))
+				return false;
+		}
+
+		if (!DX12Helper::CreateCBuffer(sizeof(DemoSceneLightBuffer), _constantBuffers[(i * (_models.size() + 1)) + _models.size()], cbUploader))
+			return false;
+	}
+
+	return true;
+}
 
-	_models = std::move(modelResources.models);
+void DemoScene::ApplyStreamedModel()
+{
+	switch (_streamedModel->state)
+	{
+		/* the meshes arrived, the transforms edited from now on are kept when the textures come */
+		case StreamedModel::STATE_PLACEHOLDER:
+			if (_models.empty())
+			{
+				_models = _streamedModel->models;
+				if (!MakeConstantBuffers() || !MakeCulledIndexBuffers())
+					_models.clear();
+			}
+			break;
+
+		case StreamedModel::STATE_READY:
+			for (size_t i = 0; i < _models.size(); i++)
+			{
+				_models[i].descHeap	= _streamedModel->models[i].descHeap;
+				_models[i].textures	= _streamedModel->models[i].textures;
+			}
+			break;
+
+		case StreamedModel::STATE_FAILED:
+			printf("Failing streaming %s in demo %s\n", _streamedModel->filePath.c_str(), Name());
+			break;
+
+		default:
+			break;
+	}
+}
+
+bool DemoScene::MakeCulledIndexBuffers()
+{
+	/* the worst case is every triangle of the full meshes, for each of their instances */
+	UINT64 indexCount = 0;
+	for (int i = 0; i < _models.size(); i++)
+	{
+		if (!_models[i].meshlets.empty())
+			indexCount += UINT64(_models[i].count) * _models[i].instances.size();
+	}
+
+	if (indexCount == 0)
+		return true;
+
+	D3D12_HEAP_PROPERTIES heapProp = {};
+	heapProp.Type = D3D12_HEAP_TYPE_UPLOAD;
+
+	D3D12_RESOURCE_DESC resDesc = {};
+	resDesc.Dimension			= D3D12_RESOURCE_DIMENSION_BUFFER;
+	resDesc.SampleDesc.Count	= 1;
+	resDesc.Width				= indexCount * sizeof(uint32_t);
+	resDesc.Height				= 1;
+	resDesc.DepthOrArraySize	= 1;
+	resDesc.MipLevels			= 1;
+	resDesc.Layout				= D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	for (int i = 0; i < _culledIndexBuffers.size(); i++)
+	{
+		HRESULT hr = _device->CreateCommittedResource(&heapProp, D3D12_HEAP_FLAG_NONE, &resDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+													  IID_PPV_ARGS(&_culledIndexBuffers[i]));
+		if (FAILED(hr))
+		{
+			printf("Failing creating culled index buffer of demo %s: %s\n", Name(), std::system_category().message(hr).c_str());
+			return false;
+		}
+
+		CD3DX12_RANGE readRange(0, 0);        // We do not intend to read from this resource on the CPU.
+		hr = _culledIndexBuffers[i]->Map(0, &readRange, (void**)&_culledIndices[i]);
+		if (FAILED(hr))
+		{
+			printf("Failing mapping culled index buffer of demo %s: %s\n", Name(), std::system_category().message(hr).c_str());
+			return false;
+		}
+	}
 
 	return true;
 }
@@ -388,7 +491,7 @@ bool DemoScene::MakeModelPipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_BY
 	}
 
 
-	hr = dx12Handle_._device->CreateRootSignature(0, tmp->GetBufferPointer(), tmp->GetBufferSize(), IID_PPV_ARGS(&_rootSignature));
+	hr = dx12Handle_._pipelineCache->CreateRootSignature(tmp, &_rootSignature);
 	if (FAILED(hr))
 	{
 		printf("Failing creating root signature of demo %s: %s\n", Name(), std::system_category().message(hr).c_str());
@@ -396,19 +499,9 @@ bool DemoScene::MakeModelPipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_BY
 		return false;
 	}
 
-	D3D12_INPUT_ELEMENT_DESC inputLayout[] =
-	{
-		{ "POSITION",   0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "UV",			0, DXGI_FORMAT_R32G32_FLOAT,	1, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "NORMAL",		0, DXGI_FORMAT_R32G32B32_FLOAT,	2, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-	};
-
-	// fill out an input layout description structure
-	D3D12_INPUT_LAYOUT_DESC inputLayoutDesc = {};
-
-	// we can get the number of elements in an array by "sizeof(array) / sizeof(arrayElementType)"
-	inputLayoutDesc.NumElements			= sizeof(inputLayout) / sizeof(D3D12_INPUT_ELEMENT_DESC);
-	inputLayoutDesc.pInputElementDescs	= inputLayout;
+	/* the interleaved vertices of the model cache, as baked with the default options */
+	std::vector<D3D12_INPUT_ELEMENT_DESC>	inputElements;
+	D3D12_INPUT_LAYOUT_DESC					inputLayoutDesc = DX12Helper::GetModelInputLayout(MeshCache::GetVertexLayout(MeshCache::Options()), inputElements);
 
 	D3D12_RASTERIZER_DESC rasterDesc = {};
 	rasterDesc.FillMode			= D3D12_FILL_MODE_SOLID;
@@ -441,7 +534,7 @@ bool DemoScene::MakeModelPipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_BY
 	psoDesc.DSVFormat				= DXGI_FORMAT_D32_FLOAT;
 
 	// create the pso
-	hr = dx12Handle_._device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&_pso));
+	hr = dx12Handle_._pipelineCache->CreatePipelineState(psoDesc, &_pso);
 	if (FAILED(hr))
 	{
 		printf("Failing creating PSO of %s: %s\n", Name(), std::system_category().message(hr).c_str());
@@ -658,7 +751,7 @@ bool DemoScene::MakeSkyBoxPipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_B
 	}
 
 
-	hr = dx12Handle_._device->CreateRootSignature(0, tmp->GetBufferPointer(), tmp->GetBufferSize(), IID_PPV_ARGS(&_skyBoxRootSignature));
+	hr = dx12Handle_._pipelineCache->CreateRootSignature(tmp, &_skyBoxRootSignature);
 	if (FAILED(hr))
 	{
 		printf("Failing creating root signature of demo %s: %s\n", Name(), std::system_category().message(hr).c_str());
@@ -710,7 +803,7 @@ bool DemoScene::MakeSkyBoxPipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_B
 	psoDesc.DSVFormat				= DXGI_FORMAT_D32_FLOAT;
 
 	// create the pso
-	hr = dx12Handle_._device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&_skyBoxPso));
+	hr = dx12Handle_._pipelineCache->CreatePipelineState(psoDesc, &_skyBoxPso);
 	if (FAILED(hr))
 	{
 		printf("Failing creating skybox PSO of %s: %s\n", Name(), std::system_category().message(hr).c_str());
@@ -725,6 +818,9 @@ bool DemoScene::MakeSkyBoxPipeline(const DX12Handle& dx12Handle_, D3D12_SHADER_B
 
 void DemoScene::UpdateAndRender(const DemoInputs& inputs_)
 {
+	if (_streamer && _streamer->Update())
+		ApplyStreamedModel();
+
 	Update(inputs_);
 	Render(inputs_);
 }
@@ -738,11 +834,25 @@ void DemoScene::Update(const DemoInputs& inputs_)
 	scissorRect.right = inputs_.renderContext.width;
 	scissorRect.bottom = inputs_.renderContext.height;
 
+	/* the frames go on while loading, there is nothing to edit yet */
+	if (_models.empty())
+	{
+		ImGui::Text("Loading %s ...", _streamedModel ? _streamedModel->filePath.c_str() : "");
+		return;
+	}
+
 	for (int i = 0; i < _models.size(); i++)
 	{
 		InspectTransform(_models[i]);
 	}
 
+	ImGui::DragFloat("LodPixelError", &_lodPixelError, 0.1f, 0.0f, 100.0f, "%.1f", 0);
+
+	/* of the last frame */
+	ImGui::Checkbox("ClusterCulling", &_clusterCulling);
+	ImGui::Text("Meshlets: %u drawn, %u out of the frustum, %u facing away, %u triangles", _cullStatistics.visible, _cullStatistics.frustumCulled,
+				_cullStatistics.backfaceCulled, _cullStatistics.triangles);
+
 	ImGui::Text("LightParams");
 
 	/* random init value */
@@ -786,52 +896,136 @@ void DemoScene::Render(const DemoInputs& inputs_)
 	cmdList->ClearRenderTargetView(inputs_.renderContext.currBackBufferHandle, clearColor, 0, nullptr);
 	cmdList->ClearDepthStencilView(inputs_.renderContext.depthBufferHandle, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 0, nullptr);
 
+	/* the skybox reads the constant buffers of the models too */
+	if (_models.empty())
+		return;
+
 	cmdList->SetGraphicsRootSignature(_rootSignature); // set the root signature
 	cmdList->SetPipelineState(_pso);
 	cmdList->RSSetViewports(1, &viewport); // set the viewports
 	cmdList->RSSetScissorRects(1, &scissorRect); // set the scissor rects
+	_boundDescHeap = nullptr;
 
 	/* update CBuffer */
 	DemoSceneConstantBuffer cBuffer = {};
-	cBuffer.perspective = GPM::Transform::perspective(60.0f * TO_RADIANS, viewport.Width / viewport.Height, 0.001f, 1000.0f);
+	float fovY = 60.0f * TO_RADIANS;
+	cBuffer.perspective = GPM::Transform::perspective(fovY, viewport.Width / viewport.Height, 0.001f, 1000.0f);
 	cBuffer.view		= mainCamera.GetViewMatrix();
 
+	/* pixels covered by one unit at a distance of one, for the level of detail selection */
+	float projectionScale = viewport.Height / (2.0f * std::tan(fovY * 0.5f));
+
 	cmdList->SetGraphicsRootConstantBufferView(2, _constantBuffers[(inputs_.renderContext.currFrameIndex * (_models.size() + 1)) + _models.size()].buffer->GetGPUVirtualAddress());
 
+	/* the full meshes are culled by meshlets, the indices left are appended in the buffer of the frame */
+	ID3D12Resource*	culledIndexBuffer	= _culledIndexBuffers[inputs_.renderContext.currFrameIndex];
+	uint32_t*		culledIndices		= _culledIndices[inputs_.renderContext.currFrameIndex];
+	UINT			culledOffset		= 0;
+	_cullStatistics = {};
+
 	for (int i = 0; i < _models.size(); i++)
 	{
 		cmdList->SetGraphicsRootConstantBufferView(0, _constantBuffers[(inputs_.renderContext.currFrameIndex * (FRAME_BUFFER_COUNT - 1)) + i].buffer->GetGPUVirtualAddress());
 
-		cBuffer.model = _models[i].trs.model;
+		cBuffer.model			= _models[i].trs.model;
+		cBuffer.positionScale	= GPM::Vec4(_models[i].positionScale, 0.f);
+		cBuffer.positionOffset	= GPM::Vec4(_models[i].positionOffset, 0.f);
+		cBuffer.uvScaleOffset	= _models[i].uvScaleOffset;
 		DX12Helper::UploadCBuffer((void*)&cBuffer, sizeof(cBuffer), _constantBuffers[(inputs_.renderContext.currFrameIndex * (FRAME_BUFFER_COUNT - 1)) + i]);
 
-		DrawModel(cmdList, _models[i]);
+		const DX12Helper::Model& model = _models[i];
+		UINT instanceCount = static_cast<UINT>(model.instances.size());
+
+		/* without culling every node is drawn in one call, at the finest level any of them needs */
+		if (!_clusterCulling || model.meshlets.empty() || !culledIndices)
+		{
+			UINT lod = static_cast<UINT>(model.lods.size());
+			for (UINT instance = 0; instance < instanceCount; instance++)
+				lod = std::min(lod, DX12Helper::SelectLod(model, DX12Helper::GetInstanceWorld(model, instance), mainCamera.position, projectionScale, _lodPixelError));
+
+			DrawModel(cmdList, model, lod, 0, instanceCount);
+			continue;
+		}
+
+		/* the culled indices are in the space of one node, so each instance is drawn on its own */
+		for (UINT instance = 0; instance < instanceCount; instance++)
+		{
+			GPM::Mat4 world = DX12Helper::GetInstanceWorld(model, instance);
+
+			UINT lod = DX12Helper::SelectLod(model, world, mainCamera.position, projectionScale, _lodPixelError);
+			if (lod > 0)
+			{
+				DrawModel(cmdList, model, lod, instance, 1);
+				continue;
+			}
+
+			/* in the space of the mesh : the GPM products are in the order of the shader, that is perspective * view * world */
+			GPM::Mat4	clip	= world * cBuffer.view * cBuffer.perspective;
+			GPM::Vec3	eye		= (world.inversed() * GPM::Vec4(mainCamera.position, 1.f)).xyz;
+
+			Meshlets::CullStatistics statistics;
+			UINT count = static_cast<UINT>(Meshlets::Cull(model.meshlets.data(), model.meshlets.size(), model.meshletVertices.data(), model.meshletTriangles.data(),
+														 Meshlets::MakeFrustum(clip.e), eye.e, culledIndices + culledOffset, &statistics));
+
+			D3D12_INDEX_BUFFER_VIEW culledView;
+			culledView.BufferLocation	= culledIndexBuffer->GetGPUVirtualAddress() + culledOffset * sizeof(uint32_t);
+			culledView.SizeInBytes		= count * sizeof(uint32_t);
+			culledView.Format			= DXGI_FORMAT_R32_UINT;
+			culledOffset += count;
+
+			_cullStatistics.visible			+= statistics.visible;
+			_cullStatistics.frustumCulled	+= statistics.frustumCulled;
+			_cullStatistics.backfaceCulled	+= statistics.backfaceCulled;
+			_cullStatistics.triangles		+= statistics.triangles;
+
+			DrawModel(cmdList, model, lod, instance, 1, &culledView, count);
+		}
 	}
 
 	DrawSkyBox(cmdList, inputs_.renderContext.currFrameIndex);
 }
 
-void DemoScene::DrawModel(ID3D12GraphicsCommandList4* cmdList, const DX12Helper::Model& model)
+void DemoScene::DrawModel(ID3D12GraphicsCommandList4* cmdList, const DX12Helper::Model& model, UINT lod, UINT firstInstance, UINT instanceCount,
+						  const D3D12_INDEX_BUFFER_VIEW* culledIndices, UINT culledCount)
 {
-	if (model.textures.size() > 0)
+	if (model.textures.size() > 0 && model.descHeap != _boundDescHeap)
 	{
 		cmdList->SetDescriptorHeaps(1, &model.descHeap); // set the descriptor heap
 		// set the descriptor table to the descriptor heap (parameter 1, as constant buffer root descriptor is parameter index 0)
 
 		cmdList->SetGraphicsRootDescriptorTable(1, model.descHeap->GetGPUDescriptorHandleForHeapStart());
+		_boundDescHeap = model.descHeap;
 	}
 
 	cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST); // set the primitive topology
 	cmdList->IASetVertexBuffers(0, model.vBufferViews.size(), model.vBufferViews.data()); // set the vertex buffer (using the vertex buffer view)
 
-	if (model.indexBuffer)
+	if (culledIndices)
 	{
-		cmdList->IASetIndexBuffer(&model.iBufferView); // set the index buffer (using the index buffer view)
-		cmdList->DrawIndexedInstanced(model.count, 1, 0, 0, 0); // finally draw 6 indices (draw the quad)
+		/* every meshlet may have been culled */
+		if (culledCount > 0)
+		{
+			cmdList->IASetIndexBuffer(culledIndices);
+			cmdList->DrawIndexedInstanced(culledCount, instanceCount, 0, 0, firstInstance);
+		}
+	}
+	else if (model.indexBuffer)
+	{
+		/* the levels of detail only change the indices */
+		if (lod > 0)
+		{
+			cmdList->IASetIndexBuffer(&model.lods[lod - 1].iBufferView);
+			cmdList->DrawIndexedInstanced(model.lods[lod - 1].count, instanceCount, 0, 0, firstInstance);
+		}
+		else
+		{
+			cmdList->IASetIndexBuffer(&model.iBufferView); // set the index buffer (using the index buffer view)
+			cmdList->DrawIndexedInstanced(model.count, instanceCount, 0, 0, firstInstance); // finally draw 6 indices (draw the quad)
+		}
 	}
 	else
 	{
-		cmdList->DrawInstanced(model.count, 1, 0, 0); // finally draw 6 indices (draw the quad)
+		cmdList->DrawInstanced(model.count, instanceCount, 0, firstInstance); // finally draw 6 indices (draw the quad)
 	}
 }
 
@@ -0,0 +1,90 @@
+/* system include */
+#include <chrono>
+#include <cstdio>
+
+#include "DemoRegistry.hpp"
+#include "WorkerPool.hpp"
+
+DemoRegistry::DemoRegistry(const DemoInputs& inputs_, const DX12Handle& dx12Handle_) :
+	inputs		{ inputs_ },
+	dx12Handle	{ dx12Handle_ }
+{
+
+}
+
+DemoRegistry::~DemoRegistry()
+{
+	for (Entry& entry : entries)
+		WaitWarmUp(entry);
+}
+
+void DemoRegistry::Add(const char* name, Factory factory, Warmer warmUp)
+{
+	Entry entry;
+	entry.name		= name;
+	entry.factory	= std::move(factory);
+	entry.warmUp	= std::move(warmUp);
+
+	entries.push_back(std::move(entry));
+}
+
+void DemoRegistry::WarmUp()
+{
+	if (isWarmingUp)
+		return;
+
+	isWarmingUp = true;
+	for (Entry& entry : entries)
+	{
+		if (entry.demo || !entry.warmUp)
+			continue;
+
+		/* the pool gives no way to wait for a job, the packaged task does */
+		std::shared_ptr<std::packaged_task<void()>> task = std::make_shared<std::packaged_task<void()>>(entry.warmUp);
+		entry.warmedUp = task->get_future().share();
+
+		WorkerPool::Get().Submit([task]() { (*task)(); });
+	}
+}
+
+const char* DemoRegistry::GetName(int id) const
+{
+	return id >= 0 && id < Size() ? entries[id].name : "";
+}
+
+bool DemoRegistry::IsBuilt(int id) const
+{
+	return id >= 0 && id < Size() && entries[id].demo;
+}
+
+Demo* DemoRegistry::Get(int id)
+{
+	if (id < 0 || id >= Size())
+		return nullptr;
+
+	Entry& entry = entries[id];
+	if (!entry.demo)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		/* not waiting for a warm up in flight, MeshCache::Load makes the loads of a same model take turns */
+		entry.demo = entry.factory(inputs, dx12Handle);
+
+		double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		printf("Built demo %s in %.2f ms\n", entry.name, buildMs);
+	}
+
+	return entry.demo.get();
+}
+
+void DemoRegistry::Clear()
+{
+	for (Entry& entry : entries)
+		entry.demo.reset();
+}
+
+void DemoRegistry::WaitWarmUp(Entry& entry)
+{
+	if (entry.warmedUp.valid())
+		entry.warmedUp.wait();
+}
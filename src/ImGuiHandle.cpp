@@ -10,7 +10,7 @@
 #include <GLFW/glfw3.h>
 
 /* Demos */
-#include "Demo.hpp"
+#include "DemoRegistry.hpp"
 
 #include "DX12Handle.hpp"
 #include "ImGuiHandle.hpp"
@@ -96,19 +96,20 @@ void ImGuiHandle::NewFrame()
     ImGui::NewFrame();
 }
 
-void ImGuiHandle::ChooseDemo(const std::vector<std::unique_ptr<Demo>>& demos_, int& demoId_)
+void ImGuiHandle::ChooseDemo(const DemoRegistry& demos_, int& demoId_)
 {
     {
         if (ImGui::Button("<"))
-            demoId_ = demoId_ > 0 ? (demoId_ - 1) % (int)demos_.size() : (int)demos_.size() - 1;
+            demoId_ = demoId_ > 0 ? (demoId_ - 1) % demos_.Size() : demos_.Size() - 1;
         ImGui::SameLine();
-        ImGui::Text("%d/%d", demoId_ + 1, (int)demos_.size());
+        ImGui::Text("%d/%d", demoId_ + 1, demos_.Size());
         ImGui::SameLine();
         if (ImGui::Button(">"))
-            demoId_ = (demoId_ + 1) % (int)demos_.size();
+            demoId_ = (demoId_ + 1) % demos_.Size();
         ImGui::SameLine();
-        if (demos_.size() > 0)
-            ImGui::Text("[%s]", demos_[demoId_]->Name());
+        /* the demo chosen is built at the start of the next frame */
+        if (demos_.Size() > 0)
+            ImGui::Text(demos_.IsBuilt(demoId_) ? "[%s]" : "[%s] loading", demos_.GetName(demoId_));
 
         ImGui::Checkbox("ImGui demo window", &_demo_window);
         if (_demo_window)
@@ -0,0 +1,1867 @@
+/* system include */
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <system_error>
+
+#ifdef _WIN32
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include "MeshCache.hpp"
+#include "CacheFile.hpp"
+#include "MeshOptimizer.hpp"
+#include "MipChain.hpp"
+#include "StartupProfile.hpp"
+#include "TextureAtlas.hpp"
+#include "TextureCache.hpp"
+#include "VertexLayout.hpp"
+#include "VertexQuantize.hpp"
+#include "WorkerPool.hpp"
+
+/* model loading, the implementation is in DX12Helper.cpp */
+#include "tiny_loader/tiny_gltf.h"
+
+/* the tables and the payloads of the file start on this alignment */
+#define MESH_CACHE_ALIGNMENT 16u
+
+/* baking is done once, the sharper filter is worth its cost there */
+#define MESH_CACHE_MIP_FILTER MipChain::FILTER_KAISER
+
+/* the glb container, see the glTF binary file format */
+#define GLB_MAGIC		0x46546C67u /* "glTF" */
+#define GLB_CHUNK_JSON	0x4E4F534Au /* "JSON" */
+#define GLB_CHUNK_BIN	0x004E4942u /* "BIN\0" */
+
+/* a level of detail keeps at most this part of the triangles of the level before it */
+#define MESH_CACHE_LOD_MIN_REDUCTION 0.8
+
+/* size of a dependency that did not exist when baking */
+#define MESH_CACHE_MISSING_FILE ~uint64_t(0)
+
+/*===== MAPPED FILE =====*/
+
+MeshCache::MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MeshCache::MappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+	file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		file = nullptr;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize = {};
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		Close();
+		return false;
+	}
+
+	data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	size = static_cast<size_t>(fileSize.QuadPart);
+	if (!data)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MeshCache::MappedFile::Close()
+{
+	if (data)
+		UnmapViewOfFile(data);
+	if (mapping)
+		CloseHandle(mapping);
+	if (file)
+		CloseHandle(file);
+
+	data	= nullptr;
+	size	= 0;
+	mapping	= nullptr;
+	file	= nullptr;
+}
+
+#else
+
+bool MeshCache::MappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+	int fd = open(filePath.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat fileStat = {};
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	/* the mapping stays valid once the descriptor is closed */
+	void* mapped = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (mapped == MAP_FAILED)
+		return false;
+
+	data = (const uint8_t*)mapped;
+	size = static_cast<size_t>(fileStat.st_size);
+
+	return true;
+}
+
+void MeshCache::MappedFile::Close()
+{
+	if (data)
+		munmap((void*)data, size);
+
+	data = nullptr;
+	size = 0;
+}
+
+#endif
+
+/*===== VIEW =====*/
+
+std::string MeshCache::GetCachePath(const std::string& assetPath)
+{
+	return assetPath + MESH_CACHE_EXT;
+}
+
+VertexLayout::Layout MeshCache::GetVertexLayout(const Options& options)
+{
+	return VertexLayout::Build(options.vertexAttributes | VERTEX_LAYOUT_DEFAULT);
+}
+
+static bool IsInFile(uint64_t offset, uint64_t size, size_t fileSize)
+{
+	return offset <= fileSize && size <= fileSize - offset;
+}
+
+/* bytes of an index of TINYGLTF_COMPONENT_TYPE_*, 0 for the types the draws do not take */
+static uint32_t GetIndexSize(uint32_t indexComponentType)
+{
+	switch (indexComponentType)
+	{
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:		return sizeof(uint8_t);
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:	return sizeof(uint16_t);
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:		return sizeof(uint32_t);
+		default:										return 0;
+	}
+}
+
+bool MeshCache::MakeView(const uint8_t* data, size_t size, View& view)
+{
+	view = {};
+	if (!data || size < sizeof(Header))
+		return false;
+
+	const Header* header = (const Header*)data;
+	if (header->magic != MESH_CACHE_MAGIC || header->version != MESH_CACHE_VERSION || header->fileSize != size)
+		return false;
+
+	/* the draws trust the stride and the offsets of the layout */
+	VertexLayout::Layout vertexLayout = VertexLayout::Build(header->vertexLayout.attributes);
+	if (memcmp(&vertexLayout, &header->vertexLayout, sizeof(vertexLayout)) != 0)
+		return false;
+
+	if (!IsInFile(header->dependencies,	uint64_t(header->dependencyCount)	* sizeof(Dependency),	size) ||
+		!IsInFile(header->buffers,		uint64_t(header->bufferCount)		* sizeof(Buffer),		size) ||
+		!IsInFile(header->primitives,	uint64_t(header->primitiveCount)	* sizeof(Primitive),	size) ||
+		!IsInFile(header->materials,	uint64_t(header->materialCount)		* sizeof(Material),		size) ||
+		!IsInFile(header->images,		uint64_t(header->imageCount)		* sizeof(Image),		size) ||
+		!IsInFile(header->instances,	uint64_t(header->instanceCount)		* sizeof(Instance),		size) ||
+		!IsInFile(header->meshlets,			uint64_t(header->meshletCount)			* sizeof(Meshlets::Meshlet),	size) ||
+		!IsInFile(header->meshletVertices,	uint64_t(header->meshletVertexCount)	* sizeof(uint32_t),				size) ||
+		!IsInFile(header->meshletTriangles,	uint64_t(header->meshletTriangleCount)	* 3,							size))
+		return false;
+
+	view.base			= data;
+	view.header			= header;
+	view.dependencies	= (const Dependency*)(data + header->dependencies);
+	view.buffers		= (const Buffer*)(data + header->buffers);
+	view.primitives		= (const Primitive*)(data + header->primitives);
+	view.materials		= (const Material*)(data + header->materials);
+	view.images			= (const Image*)(data + header->images);
+	view.instances		= (const Instance*)(data + header->instances);
+
+	view.meshlets			= (const Meshlets::Meshlet*)(data + header->meshlets);
+	view.meshletVertices	= (const uint32_t*)(data + header->meshletVertices);
+	view.meshletTriangles	= data + header->meshletTriangles;
+
+	/* the payloads are checked once here so that the upload can trust them */
+	view.bufferData.assign(header->bufferCount, nullptr);
+	for (uint32_t i = 0; i < header->bufferCount; i++)
+	{
+		const Buffer& buffer = view.buffers[i];
+		if (buffer.dependency >= (int32_t)header->dependencyCount)
+			return false;
+
+		if (buffer.dependency < 0)
+		{
+			if (!IsInFile(buffer.data.offset, buffer.data.size, size))
+				return false;
+			view.bufferData[i] = data + buffer.data.offset;
+		}
+	}
+
+	for (uint32_t i = 0; i < header->imageCount; i++)
+	{
+		const Image& image = view.images[i];
+		if (image.mipCount == 0 || image.mipCount > MipChain::GetLevelCount(image.width, image.height))
+			return false;
+
+		if (image.format != BlockCompress::FORMAT_NONE)
+		{
+			if (image.format > BlockCompress::FORMAT_BC7 || !TextureCache::IsCompressible(image.width, image.height) ||
+				memchr(image.cachePath, '\0', sizeof(image.cachePath)) == nullptr)
+				return false;
+			continue;
+		}
+
+		if (!IsInFile(image.pixels.offset, image.pixels.size, size) || image.rowPitch != image.width * image.channels ||
+			MipChain::GetChainSize(image.width, image.height, image.channels, image.mipCount) > image.pixels.size)
+			return false;
+	}
+
+	for (uint32_t i = 0; i < header->materialCount; i++)
+	{
+		const Material& material = view.materials[i];
+		if (material.baseColor >= (int32_t)header->imageCount || material.normal >= (int32_t)header->imageCount ||
+			material.metallicRoughness >= (int32_t)header->imageCount)
+			return false;
+	}
+
+	/* a range of a buffer, offset and size within the bytes of the buffer */
+	auto IsInBuffer = [&](const BufferRange& range)
+	{
+		return range.buffer < header->bufferCount && IsInFile(range.offset, range.size, view.buffers[range.buffer].data.size);
+	};
+
+	/* count indices of indexSize bytes, tightly packed, within the range */
+	auto IsIndexRange = [&](const BufferRange& range, uint32_t count, uint32_t indexSize)
+	{
+		return IsInBuffer(range) && (range.stride == 0 || range.stride == indexSize) && range.size % indexSize == 0 &&
+			   uint64_t(count) * indexSize <= range.size;
+	};
+
+	for (uint32_t i = 0; i < header->primitiveCount; i++)
+	{
+		const Primitive& primitive = view.primitives[i];
+		if (primitive.vertices.size > 0 && (!IsInBuffer(primitive.vertices) || primitive.vertices.stride != header->vertexLayout.stride ||
+											primitive.vertices.size % primitive.vertices.stride != 0))
+			return false;
+
+		/* lods is a fixed array, the draws loop on lodCount */
+		if (primitive.lodCount > MESH_CACHE_MAX_LODS)
+			return false;
+
+		uint32_t vertexCount = primitive.vertices.stride > 0 ? primitive.vertices.size / primitive.vertices.stride : 0;
+		if (primitive.indexComponentType == 0)
+		{
+			if (primitive.count > vertexCount)
+				return false;
+		}
+		else
+		{
+			uint32_t indexSize = GetIndexSize(primitive.indexComponentType);
+			if (indexSize == 0 || !IsIndexRange(primitive.indices, primitive.count, indexSize))
+				return false;
+
+			for (uint32_t level = 0; level < primitive.lodCount; level++)
+			{
+				if (!IsIndexRange(primitive.lods[level].indices, primitive.lods[level].count, indexSize))
+					return false;
+			}
+		}
+
+		if (primitive.material < 0 || primitive.material >= (int32_t)header->materialCount ||
+			uint64_t(primitive.instanceOffset) + primitive.instanceCount > header->instanceCount)
+			return false;
+
+		/* the culling reads the meshlets on the cpu and its indices go to the draw */
+		if (uint64_t(primitive.meshletOffset) + primitive.meshletCount > header->meshletCount)
+			return false;
+
+		for (uint32_t j = primitive.meshletOffset; j < primitive.meshletOffset + primitive.meshletCount; j++)
+		{
+			const Meshlets::Meshlet& meshlet = view.meshlets[j];
+			if (meshlet.vertexCount > MESHLET_MAX_VERTICES || meshlet.triangleCount > MESHLET_MAX_TRIANGLES ||
+				uint64_t(meshlet.vertexOffset) + meshlet.vertexCount > header->meshletVertexCount ||
+				uint64_t(meshlet.triangleOffset) + meshlet.triangleCount > header->meshletTriangleCount)
+				return false;
+
+			for (uint32_t vertex = 0; vertex < meshlet.vertexCount; vertex++)
+			{
+				if (view.meshletVertices[meshlet.vertexOffset + vertex] >= vertexCount)
+					return false;
+			}
+
+			for (uint32_t corner = 0; corner < meshlet.triangleCount * 3; corner++)
+			{
+				if (view.meshletTriangles[size_t(meshlet.triangleOffset) * 3 + corner] >= meshlet.vertexCount)
+					return false;
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < header->dependencyCount; i++)
+	{
+		if (memchr(view.dependencies[i].path, '\0', sizeof(view.dependencies[i].path)) == nullptr)
+			return false;
+	}
+
+	return true;
+}
+
+bool MeshCache::MapBuffers(CachedModel& model)
+{
+	View& view = model.view;
+
+	/* a file is mapped once, whatever the number of buffers in it */
+	std::vector<MappedFile*> files(view.header->dependencyCount, nullptr);
+	model.bufferFiles.clear();
+
+	for (uint32_t i = 0; i < view.header->bufferCount; i++)
+	{
+		const Buffer& buffer = view.buffers[i];
+		if (buffer.dependency < 0)
+			continue;
+
+		MappedFile*& file = files[buffer.dependency];
+		if (!file)
+		{
+			model.bufferFiles.push_back(std::make_unique<MappedFile>());
+			file = model.bufferFiles.back().get();
+
+			if (!file->Open(view.dependencies[buffer.dependency].path))
+				return false;
+		}
+
+		if (!IsInFile(buffer.data.offset, buffer.data.size, file->Size()))
+			return false;
+
+		view.bufferData[i] = file->Data() + buffer.data.offset;
+	}
+
+	return true;
+}
+
+static bool GetFileStamp(const std::string& filePath, uint64_t& size_, int64_t& writeTime_)
+{
+	std::error_code error;
+	size_ = std::filesystem::file_size(filePath, error);
+	if (error)
+		return false;
+
+	std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(filePath, error);
+	if (error)
+		return false;
+
+	writeTime_ = static_cast<int64_t>(writeTime.time_since_epoch().count());
+	return true;
+}
+
+bool MeshCache::IsUpToDate(const View& view)
+{
+	for (uint32_t i = 0; i < view.header->dependencyCount; i++)
+	{
+		const Dependency& dependency = view.dependencies[i];
+
+		uint64_t size;
+		int64_t writeTime;
+		if (!GetFileStamp(dependency.path, size, writeTime))
+		{
+			size		= MESH_CACHE_MISSING_FILE;
+			writeTime	= 0;
+		}
+
+		if (size != dependency.size || writeTime != dependency.writeTime)
+			return false;
+	}
+
+	return true;
+}
+
+/*===== UPLOAD RANGES =====*/
+
+uint64_t MeshCache::GetUploadRanges(const View& view, const std::vector<char>& isSkipped, uint64_t alignment, std::vector<UploadRange>& ranges)
+{
+	ranges.clear();
+
+	/* widened to the alignment, so that every offset keeps its alignment in the arena */
+	auto AddRange = [&](const BufferRange& range)
+	{
+		if (range.size == 0 || range.buffer >= view.header->bufferCount)
+			return;
+
+		uint64_t bufferSize	= view.buffers[range.buffer].data.size;
+		uint64_t start		= range.offset / alignment * alignment;
+		uint64_t end		= std::min((uint64_t(range.offset) + range.size + alignment - 1) / alignment * alignment, bufferSize);
+		if (start < end)
+			ranges.push_back({ range.buffer, start, end - start, 0 });
+	};
+
+	for (uint32_t i = 0; i < view.header->primitiveCount; i++)
+	{
+		if (i < isSkipped.size() && isSkipped[i])
+			continue;
+
+		const Primitive& primitive = view.primitives[i];
+		AddRange(primitive.vertices);
+		if (primitive.indexComponentType == 0)
+			continue;
+
+		AddRange(primitive.indices);
+		for (uint32_t level = 0; level < primitive.lodCount && level < MESH_CACHE_MAX_LODS; level++)
+			AddRange(primitive.lods[level].indices);
+	}
+
+	/* the ranges of a buffer that overlap or touch are one */
+	std::sort(ranges.begin(), ranges.end(), [](const UploadRange& a, const UploadRange& b)
+	{
+		return a.buffer != b.buffer ? a.buffer < b.buffer : a.offset < b.offset;
+	});
+
+	size_t merged = 0;
+	for (size_t i = 0; i < ranges.size(); i++)
+	{
+		UploadRange& last = ranges[merged > 0 ? merged - 1 : 0];
+		if (merged > 0 && last.buffer == ranges[i].buffer && ranges[i].offset <= last.offset + last.size)
+		{
+			last.size = std::max(last.offset + last.size, ranges[i].offset + ranges[i].size) - last.offset;
+			continue;
+		}
+
+		ranges[merged++] = ranges[i];
+	}
+	ranges.resize(merged);
+
+	uint64_t size = 0;
+	for (UploadRange& range : ranges)
+	{
+		range.arenaOffset	= size;
+		size				+= (range.size + alignment - 1) / alignment * alignment;
+	}
+
+	return size;
+}
+
+uint64_t MeshCache::GetArenaOffset(const std::vector<UploadRange>& ranges, uint32_t buffer, uint64_t offset)
+{
+	/* the last range starting at or before offset */
+	std::vector<UploadRange>::const_iterator range = std::upper_bound(ranges.begin(), ranges.end(), std::make_pair(buffer, offset),
+																	  [](const std::pair<uint32_t, uint64_t>& key, const UploadRange& currRange)
+	{
+		return key.first != currRange.buffer ? key.first < currRange.buffer : key.second < currRange.offset;
+	});
+
+	if (range == ranges.begin() || (range - 1)->buffer != buffer || offset >= (range - 1)->offset + (range - 1)->size)
+		return ~uint64_t(0);
+
+	--range;
+	return range->arenaOffset + (offset - range->offset);
+}
+
+/*===== BAKE =====*/
+
+static uint64_t AlignUp(uint64_t offset)
+{
+	return (offset + (MESH_CACHE_ALIGNMENT - 1)) & ~uint64_t(MESH_CACHE_ALIGNMENT - 1);
+}
+
+static void CopyName(char* dst, size_t dstSize, const std::string& src)
+{
+	size_t length = src.size() < dstSize - 1 ? src.size() : dstSize - 1;
+	memcpy(dst, src.c_str(), length);
+	dst[length] = '\0';
+}
+
+static bool AddDependency(std::vector<MeshCache::Dependency>& dependencies, const std::string& filePath)
+{
+	MeshCache::Dependency dependency = {};
+	if (filePath.size() >= sizeof(dependency.path))
+	{
+		printf("Mesh cache: path too long to be tracked %s\n", filePath.c_str());
+		return false;
+	}
+
+	/* a missing file is tracked too, the cache is rebaked when it appears */
+	if (!GetFileStamp(filePath, dependency.size, dependency.writeTime))
+	{
+		dependency.size			= MESH_CACHE_MISSING_FILE;
+		dependency.writeTime	= 0;
+	}
+
+	CopyName(dependency.path, sizeof(dependency.path), filePath);
+	dependencies.push_back(dependency);
+	return true;
+}
+
+static bool IsBinaryAsset(const std::string& assetPath)
+{
+	return std::filesystem::path(assetPath).extension() == ".glb";
+}
+
+/* where the bytes of the binary chunk of a .glb start, 0 when it has none */
+static uint64_t GetBinaryChunkOffset(const std::string& assetPath)
+{
+	FILE* file = fopen(assetPath.c_str(), "rb");
+	if (!file)
+		return 0;
+
+	/* glb header (magic, version, length), then the json chunk (length, type) */
+	uint32_t header[5] = {};
+	uint32_t binaryChunk[2] = {};
+	uint64_t offset = 0;
+	if (fread(header, sizeof(header), 1, file) == 1 && header[0] == GLB_MAGIC && header[4] == GLB_CHUNK_JSON)
+	{
+		offset = sizeof(header) + uint64_t(header[3]);
+		if (fseek(file, static_cast<long>(offset), SEEK_SET) != 0 || fread(binaryChunk, sizeof(binaryChunk), 1, file) != 1 || binaryChunk[1] != GLB_CHUNK_BIN)
+			offset = 0;
+		else
+			offset += sizeof(binaryChunk);
+	}
+
+	fclose(file);
+	return offset;
+}
+
+/* a node with a mesh and its world transform, row major (position = world * p) */
+struct FlatNode
+{
+	int		node;
+	double	world[16];
+};
+
+/* the matrix of the node, or its translation * rotation * scale, each part being optional */
+static void GetLocalTransform(const tinygltf::Node& node, double local[16])
+{
+	/* glTF matrices are column major */
+	if (node.matrix.size() == 16)
+	{
+		for (int row = 0; row < 4; row++)
+		{
+			for (int column = 0; column < 4; column++)
+				local[row * 4 + column] = node.matrix[column * 4 + row];
+		}
+		return;
+	}
+
+	double t[3] = { 0.0, 0.0, 0.0 };
+	double q[4] = { 0.0, 0.0, 0.0, 1.0 };
+	double s[3] = { 1.0, 1.0, 1.0 };
+	if (node.translation.size() == 3)
+		std::copy(node.translation.begin(), node.translation.end(), t);
+	if (node.rotation.size() == 4)
+		std::copy(node.rotation.begin(), node.rotation.end(), q);
+	if (node.scale.size() == 3)
+		std::copy(node.scale.begin(), node.scale.end(), s);
+
+	/* unit quaternion (x, y, z, w) to a rotation, its columns scaled */
+	double r[9] =
+	{
+		1.0 - 2.0 * (q[1] * q[1] + q[2] * q[2]),	2.0 * (q[0] * q[1] - q[2] * q[3]),			2.0 * (q[0] * q[2] + q[1] * q[3]),
+		2.0 * (q[0] * q[1] + q[2] * q[3]),			1.0 - 2.0 * (q[0] * q[0] + q[2] * q[2]),	2.0 * (q[1] * q[2] - q[0] * q[3]),
+		2.0 * (q[0] * q[2] - q[1] * q[3]),			2.0 * (q[1] * q[2] + q[0] * q[3]),			1.0 - 2.0 * (q[0] * q[0] + q[1] * q[1])
+	};
+
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 3; column++)
+			local[row * 4 + column] = r[row * 3 + column] * s[column];
+		local[row * 4 + 3] = t[row];
+	}
+	local[12] = local[13] = local[14] = 0.0;
+	local[15] = 1.0;
+}
+
+/* the nodes of the default scene drawing a mesh, the tree is walked once from its roots and each world transform
+ * is its parent one times its local one. Without scene, every node that is not a child is a root. */
+static std::vector<FlatNode> FlattenScene(const tinygltf::Model& gltfModel)
+{
+	std::vector<int> roots;
+	if (!gltfModel.scenes.empty())
+	{
+		int scene = gltfModel.defaultScene >= 0 && gltfModel.defaultScene < (int)gltfModel.scenes.size() ? gltfModel.defaultScene : 0;
+		roots = gltfModel.scenes[scene].nodes;
+	}
+	else
+	{
+		std::vector<char> isChild(gltfModel.nodes.size(), 0);
+		for (const tinygltf::Node& node : gltfModel.nodes)
+		{
+			for (int child : node.children)
+			{
+				if (child >= 0 && child < (int)isChild.size())
+					isChild[child] = 1;
+			}
+		}
+
+		for (size_t node = 0; node < isChild.size(); node++)
+		{
+			if (!isChild[node])
+				roots.push_back(static_cast<int>(node));
+		}
+	}
+
+	const double identity[16] = { 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0 };
+
+	/* a node is only walked once, a malformed file with cycles or shared children can not loop */
+	std::vector<FlatNode>	flatNodes;
+	std::vector<FlatNode>	stack;
+	std::vector<char>		isVisited(gltfModel.nodes.size(), 0);
+	for (std::vector<int>::const_reverse_iterator root = roots.rbegin(); root != roots.rend(); ++root)
+	{
+		FlatNode rootNode = { *root, {} };
+		std::copy(identity, identity + 16, rootNode.world);
+		stack.push_back(rootNode);
+	}
+
+	while (!stack.empty())
+	{
+		FlatNode parent = stack.back();
+		stack.pop_back();
+		if (parent.node < 0 || parent.node >= (int)gltfModel.nodes.size() || isVisited[parent.node])
+			continue;
+		isVisited[parent.node] = 1;
+
+		/* the stack holds the transform of the parent until the node is reached */
+		const tinygltf::Node&	node = gltfModel.nodes[parent.node];
+		double					local[16];
+		FlatNode				flatNode = { parent.node, {} };
+		GetLocalTransform(node, local);
+		for (int row = 0; row < 4; row++)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				double value = 0.0;
+				for (int k = 0; k < 4; k++)
+					value += parent.world[row * 4 + k] * local[k * 4 + column];
+				flatNode.world[row * 4 + column] = value;
+			}
+		}
+
+		if (node.mesh >= 0 && node.mesh < (int)gltfModel.meshes.size())
+			flatNodes.push_back(flatNode);
+
+		for (std::vector<int>::const_reverse_iterator child = node.children.rbegin(); child != node.children.rend(); ++child)
+		{
+			FlatNode childNode = flatNode;
+			childNode.node = *child;
+			stack.push_back(childNode);
+		}
+	}
+
+	return flatNodes;
+}
+
+/* images are given by texture index in the materials, -1 stays -1 */
+static int32_t GetMaterialImage(const tinygltf::Model& gltfModel, int textureIndex)
+{
+	if (textureIndex < 0 || textureIndex >= (int)gltfModel.textures.size())
+		return -1;
+
+	return gltfModel.textures[textureIndex].source;
+}
+
+/* the usage of an image is given by the first material slot it is found in */
+static std::vector<MipChain::EUsage> GetImageUsages(const tinygltf::Model& gltfModel)
+{
+	std::vector<MipChain::EUsage>	imageUsages(gltfModel.images.size(), MipChain::USAGE_DATA);
+	std::vector<char>				isUsageSet(gltfModel.images.size(), 0);
+	for (const tinygltf::Material& currMat : gltfModel.materials)
+	{
+		const std::pair<int32_t, MipChain::EUsage> slots[3] = { { GetMaterialImage(gltfModel, currMat.pbrMetallicRoughness.baseColorTexture.index),			MipChain::USAGE_COLOR },
+																{ GetMaterialImage(gltfModel, currMat.normalTexture.index),										MipChain::USAGE_NORMAL },
+																{ GetMaterialImage(gltfModel, currMat.pbrMetallicRoughness.metallicRoughnessTexture.index),	MipChain::USAGE_DATA } };
+		for (const std::pair<int32_t, MipChain::EUsage>& slot : slots)
+		{
+			if (slot.first >= 0 && slot.first < (int32_t)imageUsages.size() && !isUsageSet[slot.first])
+			{
+				imageUsages[slot.first] = slot.second;
+				isUsageSet[slot.first]	= 1;
+			}
+		}
+	}
+
+	return imageUsages;
+}
+
+/* the file an image is read from, and where its block compressed copy goes */
+struct ImageFiles
+{
+	std::string sourcePath;
+	std::string cachePath;
+	uint64_t	sourceSize		= MESH_CACHE_MISSING_FILE;
+	int64_t		sourceWriteTime	= 0;
+};
+
+static ImageFiles GetImageFiles(const tinygltf::Model& gltfModel, const std::string& assetPath, size_t imageIndex)
+{
+	const tinygltf::Image& image = gltfModel.images[imageIndex];
+	std::string directory = std::filesystem::path(assetPath).parent_path().string();
+	if (!directory.empty())
+		directory += '/';
+
+	/* the embedded images are cached beside the asset, they change with the file holding them */
+	ImageFiles files;
+	if (!image.uri.empty() && !tinygltf::IsDataURI(image.uri))
+	{
+		files.sourcePath	= directory + image.uri;
+		files.cachePath		= TextureCache::GetCachePath(files.sourcePath);
+	}
+	else
+	{
+		files.sourcePath	= assetPath;
+		files.cachePath		= TextureCache::GetCachePath(assetPath + ".image" + std::to_string(imageIndex));
+
+		if (image.bufferView >= 0 && image.bufferView < (int)gltfModel.bufferViews.size())
+		{
+			const tinygltf::Buffer& buffer = gltfModel.buffers[gltfModel.bufferViews[image.bufferView].buffer];
+			if (!buffer.uri.empty() && !tinygltf::IsDataURI(buffer.uri))
+				files.sourcePath = directory + buffer.uri;
+		}
+	}
+
+	if (!GetFileStamp(files.sourcePath, files.sourceSize, files.sourceWriteTime))
+	{
+		files.sourceSize		= MESH_CACHE_MISSING_FILE;
+		files.sourceWriteTime	= 0;
+	}
+
+	return files;
+}
+
+/* vertex and index streams rewritten by the mesh optimizer, all in one buffer of the cache after the glTF ones */
+struct OptimizedStreams
+{
+	uint32_t				buffer = 0;
+	std::vector<uint8_t>	bytes;
+	VertexLayout::Layout	layout;
+
+	/* the clusters of the primitives, for the header tables */
+	std::vector<Meshlets::Meshlet>	meshlets;
+	std::vector<uint32_t>			meshletVertices;
+	std::vector<uint8_t>			meshletTriangles;
+
+	/* by the accessors of a primitive, the nodes drawing the same mesh share the streams */
+	std::map<std::vector<int>, MeshCache::Primitive> primitives;
+};
+
+/* bytes of an accessor in its buffer, null when it is sparse, without buffer view or out of the buffer */
+static const uint8_t* GetAccessorData(const tinygltf::Model& gltfModel, const tinygltf::Accessor& accessor, size_t& stride_, size_t& elementSize_)
+{
+	if (accessor.sparse.isSparse || accessor.bufferView < 0 || accessor.bufferView >= (int)gltfModel.bufferViews.size() || accessor.count == 0)
+		return nullptr;
+
+	const tinygltf::BufferView& bufferView	= gltfModel.bufferViews[accessor.bufferView];
+	const tinygltf::Buffer&		buffer		= gltfModel.buffers[bufferView.buffer];
+
+	int stride = accessor.ByteStride(bufferView);
+	if (stride <= 0)
+		return nullptr;
+
+	elementSize_	= size_t(tinygltf::GetComponentSizeInBytes(accessor.componentType)) * tinygltf::GetNumComponentsInType(accessor.type);
+	stride_			= static_cast<size_t>(stride);
+
+	size_t offset = bufferView.byteOffset + accessor.byteOffset;
+	if (offset + (accessor.count - 1) * stride_ + elementSize_ > buffer.data.size())
+		return nullptr;
+
+	return buffer.data.data() + offset;
+}
+
+/* append indices to the streams on 16 or 32 bits */
+static void WriteIndices(const std::vector<uint32_t>& indices, bool isShort, OptimizedStreams& streams, MeshCache::BufferRange& range)
+{
+	range.buffer	= streams.buffer;
+	range.offset	= static_cast<uint32_t>(AlignUp(streams.bytes.size()));
+	range.size		= static_cast<uint32_t>(indices.size() * (isShort ? sizeof(uint16_t) : sizeof(uint32_t)));
+	range.stride	= 0;
+
+	streams.bytes.resize(range.offset + range.size);
+	uint8_t* dst = streams.bytes.data() + range.offset;
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		if (isShort)
+		{
+			uint16_t value = static_cast<uint16_t>(indices[i]);
+			memcpy(dst + i * sizeof(uint16_t), &value, sizeof(uint16_t));
+		}
+		else
+		{
+			memcpy(dst + i * sizeof(uint32_t), &indices[i], sizeof(uint32_t));
+		}
+	}
+}
+
+/* the elements of a vertex accessor as floats, the normalized integers are converted as glTF defines them */
+static bool ReadAttribute(const tinygltf::Model& gltfModel, const tinygltf::Accessor& accessor, uint32_t components, std::vector<float>& values)
+{
+	size_t			stride		= 0;
+	size_t			elementSize	= 0;
+	const uint8_t*	data		= GetAccessorData(gltfModel, accessor, stride, elementSize);
+	if (!data || tinygltf::GetNumComponentsInType(accessor.type) != static_cast<int>(components))
+		return false;
+
+	size_t componentSize = static_cast<size_t>(tinygltf::GetComponentSizeInBytes(accessor.componentType));
+	values.resize(accessor.count * components);
+	for (size_t i = 0; i < accessor.count; i++)
+	{
+		for (uint32_t c = 0; c < components; c++)
+		{
+			const uint8_t*	src		= data + i * stride + c * componentSize;
+			float&			value	= values[i * components + c];
+			switch (accessor.componentType)
+			{
+				case TINYGLTF_COMPONENT_TYPE_FLOAT:				memcpy(&value, src, sizeof(float)); break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:		value = accessor.normalized ? *src / 255.f : *src; break;
+				case TINYGLTF_COMPONENT_TYPE_BYTE:				value = accessor.normalized ? std::max(int8_t(*src) / 127.f, -1.f) : int8_t(*src); break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:	{ uint16_t unorm; memcpy(&unorm, src, sizeof(unorm)); value = accessor.normalized ? unorm / 65535.f : unorm; break; }
+				case TINYGLTF_COMPONENT_TYPE_SHORT:				{ int16_t snorm; memcpy(&snorm, src, sizeof(snorm)); value = accessor.normalized ? std::max(snorm / 32767.f, -1.f) : snorm; break; }
+				default:										return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/* reorder the triangles of a triangle list for the vertex cache and the overdraw, then its vertices in the order
+ * they are fetched, simplify it into its levels of detail, split it into meshlets and interleave its quantized attributes
+ * in the layout of streams (see VertexLayout), the other attributes of the glTF are ignored.
+ * The primitive is pointed to the new vertices, that are always indexed. false when the streams can not be read. */
+static bool OptimizePrimitive(const tinygltf::Model& gltfModel, const tinygltf::Primitive& gltfPrimitive, MeshCache::Primitive& primitive, OptimizedStreams& streams)
+{
+	if (gltfPrimitive.mode != TINYGLTF_MODE_TRIANGLES && gltfPrimitive.mode != -1)
+		return false;
+
+	/* the accessors of the attributes of the layout, in the order of the layout */
+	const VertexLayout::Layout& layout = streams.layout;
+	std::vector<int> key = { gltfPrimitive.indices };
+	primitive.attributes = 0;
+	for (uint32_t attribute = 0; attribute < VertexLayout::ATTRIBUTE_COUNT; attribute++)
+	{
+		VertexLayout::EAttribute					currAttribute	= static_cast<VertexLayout::EAttribute>(attribute);
+		std::map<std::string, int>::const_iterator	accessor		= gltfPrimitive.attributes.find(VertexLayout::GetName(currAttribute));
+		bool										isRead			= VertexLayout::Has(layout, currAttribute) && accessor != gltfPrimitive.attributes.end() &&
+																	  accessor->second >= 0 && accessor->second < (int)gltfModel.accessors.size();
+
+		key.push_back(isRead ? accessor->second : -1);
+		primitive.attributes |= isRead ? VERTEX_LAYOUT_BIT(attribute) : 0u;
+	}
+
+	std::map<std::vector<int>, MeshCache::Primitive>::const_iterator done = streams.primitives.find(key);
+	if (done != streams.primitives.end())
+	{
+		memcpy(primitive.center, done->second.center, sizeof(primitive.center));
+		memcpy(primitive.lods, done->second.lods, sizeof(primitive.lods));
+		memcpy(primitive.positionOffset, done->second.positionOffset, sizeof(primitive.positionOffset));
+		memcpy(primitive.positionScale, done->second.positionScale, sizeof(primitive.positionScale));
+		memcpy(primitive.uvOffset, done->second.uvOffset, sizeof(primitive.uvOffset));
+		memcpy(primitive.uvScale, done->second.uvScale, sizeof(primitive.uvScale));
+		primitive.vertices				= done->second.vertices;
+		primitive.indices				= done->second.indices;
+		primitive.indexComponentType	= done->second.indexComponentType;
+		primitive.count					= done->second.count;
+		primitive.radius				= done->second.radius;
+		primitive.lodCount				= done->second.lodCount;
+		primitive.meshletOffset			= done->second.meshletOffset;
+		primitive.meshletCount			= done->second.meshletCount;
+		return true;
+	}
+
+	if (key[1 + VertexLayout::ATTRIBUTE_POSITION] < 0)
+		return false;
+
+	size_t vertexCount = gltfModel.accessors[key[1 + VertexLayout::ATTRIBUTE_POSITION]].count;
+
+	std::vector<float> vertexValues[VertexLayout::ATTRIBUTE_COUNT];
+	for (uint32_t attribute = 0; attribute < VertexLayout::ATTRIBUTE_COUNT; attribute++)
+	{
+		if (key[1 + attribute] < 0)
+			continue;
+
+		/* the rgb colors get an opaque alpha */
+		const tinygltf::Accessor&	accessor	= gltfModel.accessors[key[1 + attribute]];
+		uint32_t					components	= VertexLayout::GetComponentCount(static_cast<VertexLayout::EAttribute>(attribute));
+		bool						isRgb		= attribute == VertexLayout::ATTRIBUTE_COLOR_0 && accessor.type == TINYGLTF_TYPE_VEC3;
+		if (accessor.count != vertexCount || !ReadAttribute(gltfModel, accessor, isRgb ? 3 : components, vertexValues[attribute]))
+			return false;
+
+		if (isRgb)
+		{
+			std::vector<float> rgba(vertexCount * 4, 1.f);
+			for (size_t i = 0; i < vertexCount; i++)
+				memcpy(&rgba[i * 4], &vertexValues[attribute][i * 3], sizeof(float) * 3);
+			vertexValues[attribute].swap(rgba);
+		}
+	}
+
+	/* indices widened to 32 bits for the optimizer, the vertices in order when the primitive has none */
+	std::vector<uint32_t> indices;
+	if (gltfPrimitive.indices >= 0)
+	{
+		const tinygltf::Accessor&	indexAccessor	= gltfModel.accessors[gltfPrimitive.indices];
+		size_t						indexStride		= 0;
+		size_t						indexSize		= 0;
+		const uint8_t*				indexData		= GetAccessorData(gltfModel, indexAccessor, indexStride, indexSize);
+		if (!indexData || indexAccessor.count % 3 != 0)
+			return false;
+
+		indices.resize(indexAccessor.count);
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			const uint8_t* index = indexData + i * indexStride;
+			switch (indexAccessor.componentType)
+			{
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:		indices[i] = *index; break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:	{ uint16_t value; memcpy(&value, index, sizeof(value)); indices[i] = value; break; }
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:		{ uint32_t value; memcpy(&value, index, sizeof(value)); indices[i] = value; break; }
+				default:										return false;
+			}
+
+			if (indices[i] >= vertexCount)
+				return false;
+		}
+	}
+	else
+	{
+		if (vertexCount % 3 != 0)
+			return false;
+
+		indices.resize(vertexCount);
+		for (size_t i = 0; i < indices.size(); i++)
+			indices[i] = static_cast<uint32_t>(i);
+	}
+
+	MeshOptimizer::VertexCacheStatistics before = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+	std::vector<uint32_t> clusters;
+	MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size(), vertexCount, &clusters);
+	MeshOptimizer::OptimizeOverdraw(indices.data(), indices.size(), (const uint8_t*)vertexValues[VertexLayout::ATTRIBUTE_POSITION].data(), sizeof(float) * 3,
+									vertexCount, clusters);
+
+	std::vector<uint32_t> remap(vertexCount);
+	size_t usedCount = MeshOptimizer::OptimizeVertexFetch(indices.data(), indices.size(), vertexCount, remap.data());
+
+	MeshOptimizer::VertexCacheStatistics after = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), usedCount);
+
+	/* the float streams in their new order, for what is left to compute before quantizing them */
+	std::vector<float> remapped[VertexLayout::ATTRIBUTE_COUNT];
+	for (uint32_t attribute = 0; attribute < VertexLayout::ATTRIBUTE_COUNT; attribute++)
+	{
+		if (vertexValues[attribute].empty())
+			continue;
+
+		uint32_t	components	= VertexLayout::GetComponentCount(static_cast<VertexLayout::EAttribute>(attribute));
+		size_t		elementSize	= sizeof(float) * components;
+		remapped[attribute].resize(usedCount * components);
+		MeshOptimizer::RemapVertices((const uint8_t*)vertexValues[attribute].data(), elementSize, vertexCount, remap.data(), (uint8_t*)remapped[attribute].data(),
+									 elementSize, elementSize);
+	}
+
+	/* bounding sphere, centered on the box of the positions */
+	const float* positions = remapped[VertexLayout::ATTRIBUTE_POSITION].data();
+	VertexQuantize::GetRange(positions, usedCount, 3, primitive.positionOffset, primitive.positionScale);
+
+	float radius = 0.f;
+	for (int c = 0; c < 3; c++)
+		primitive.center[c] = primitive.positionOffset[c] + primitive.positionScale[c] * 0.5f;
+	for (size_t vertex = 0; vertex < usedCount; vertex++)
+	{
+		const float* position = positions + vertex * 3;
+		float offset[3] = { position[0] - primitive.center[0], position[1] - primitive.center[1], position[2] - primitive.center[2] };
+		radius = std::max(radius, offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]);
+	}
+	primitive.radius = std::sqrt(radius);
+
+	/* the levels of detail are all simplified from the full mesh, one per thread, and reordered for the vertex cache */
+	std::vector<uint32_t>	lodIndices[MESH_CACHE_MAX_LODS];
+	float					lodErrors[MESH_CACHE_MAX_LODS] = {};
+	WorkerPool::Get().ParallelFor(MESH_CACHE_MAX_LODS, [&](size_t level)
+	{
+		size_t targetCount = (indices.size() / 3 >> (level + 1)) * 3;
+		lodIndices[level].resize(indices.size());
+		lodIndices[level].resize(MeshOptimizer::Simplify(lodIndices[level].data(), indices.data(), indices.size(), (const uint8_t*)positions, sizeof(float) * 3,
+														 usedCount, targetCount, &lodErrors[level]));
+		MeshOptimizer::OptimizeVertexCache(lodIndices[level].data(), lodIndices[level].size(), usedCount);
+	});
+
+	/* the quantized vertices, interleaved, then the indices on 16 bits when they fit */
+	float quantizeErrors[VertexLayout::ATTRIBUTE_COUNT] = {};
+	primitive.uvOffset[0]	= primitive.uvOffset[1]	= 0.f;
+	primitive.uvScale[0]	= primitive.uvScale[1]	= 1.f;
+	if (!remapped[VertexLayout::ATTRIBUTE_TEXCOORD_0].empty())
+		VertexQuantize::GetRange(remapped[VertexLayout::ATTRIBUTE_TEXCOORD_0].data(), usedCount, 2, primitive.uvOffset, primitive.uvScale);
+
+	MeshCache::BufferRange& range = primitive.vertices;
+	range.buffer	= streams.buffer;
+	range.offset	= static_cast<uint32_t>(AlignUp(streams.bytes.size()));
+	range.size		= static_cast<uint32_t>(usedCount * layout.stride);
+	range.stride	= layout.stride;
+	streams.bytes.resize(range.offset + range.size, 0);
+
+	uint8_t* vertices = streams.bytes.data() + range.offset;
+	for (uint32_t attribute = 0; attribute < VertexLayout::ATTRIBUTE_COUNT; attribute++)
+	{
+		VertexLayout::EAttribute	currAttribute	= static_cast<VertexLayout::EAttribute>(attribute);
+		const float*				offset			= attribute == VertexLayout::ATTRIBUTE_POSITION ? primitive.positionOffset : primitive.uvOffset;
+		const float*				scale			= attribute == VertexLayout::ATTRIBUTE_POSITION ? primitive.positionScale : primitive.uvScale;
+		quantizeErrors[attribute] = VertexLayout::Write(layout, currAttribute, remapped[attribute].empty() ? nullptr : remapped[attribute].data(), usedCount,
+														offset, scale, vertices);
+	}
+
+	/* the clusters of the full mesh, culled on the cpu when drawing it. Their cones come from the positions as the gpu
+	 * reads them back, so that the small triangles seen edge on are not culled because of the rounding */
+	std::vector<float> decoded(usedCount * 3);
+	VertexLayout::Read(layout, VertexLayout::ATTRIBUTE_POSITION, vertices, usedCount, primitive.positionOffset, primitive.positionScale, decoded.data());
+
+	primitive.meshletOffset	= static_cast<uint32_t>(streams.meshlets.size());
+	primitive.meshletCount	= static_cast<uint32_t>(Meshlets::Build(indices.data(), indices.size(), (const uint8_t*)decoded.data(), sizeof(float) * 3, usedCount,
+																	streams.meshlets, streams.meshletVertices, streams.meshletTriangles));
+
+	bool isShort = usedCount <= 0xFFFF;
+	primitive.indexComponentType	= isShort ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT : TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
+	primitive.count					= static_cast<uint32_t>(indices.size());
+	WriteIndices(indices, isShort, streams, primitive.indices);
+
+	/* a level that did not lose enough triangles is not worth its memory, nor the ones after it */
+	primitive.lodCount = 0;
+	size_t	previousCount	= indices.size();
+	float	previousError	= 0.f;
+	for (uint32_t level = 0; level < MESH_CACHE_MAX_LODS; level++)
+	{
+		if (lodIndices[level].empty() || lodIndices[level].size() > previousCount * MESH_CACHE_LOD_MIN_REDUCTION)
+			break;
+
+		MeshCache::Lod& lod = primitive.lods[primitive.lodCount++];
+		lod.count = static_cast<uint32_t>(lodIndices[level].size());
+		lod.error = std::max(lodErrors[level], previousError);
+		WriteIndices(lodIndices[level], isShort, streams, lod.indices);
+
+		previousCount = lodIndices[level].size();
+		previousError = lod.error;
+	}
+
+	size_t floatSize = 0;
+	for (uint32_t attribute = 0; attribute < VertexLayout::ATTRIBUTE_COUNT; attribute++)
+		floatSize += remapped[attribute].empty() ? 0 : sizeof(float) * VertexLayout::GetComponentCount(static_cast<VertexLayout::EAttribute>(attribute));
+
+	printf("Mesh cache: %s optimized, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, %zu overdraw clusters\n",
+		   primitive.name, before.acmr, after.acmr, before.atvr, after.atvr, clusters.size());
+	printf("Mesh cache: %s quantized, %zu -> %u bytes per vertex, position error %g, uv error %g, normal error %.3f degrees, tangent error %.3f degrees, "
+		   "color error %g, uv1 error %g\n", primitive.name, floatSize, layout.stride, quantizeErrors[VertexLayout::ATTRIBUTE_POSITION],
+		   quantizeErrors[VertexLayout::ATTRIBUTE_TEXCOORD_0], quantizeErrors[VertexLayout::ATTRIBUTE_NORMAL] * 180.f / 3.14159265f,
+		   quantizeErrors[VertexLayout::ATTRIBUTE_TANGENT] * 180.f / 3.14159265f, quantizeErrors[VertexLayout::ATTRIBUTE_COLOR_0],
+		   quantizeErrors[VertexLayout::ATTRIBUTE_TEXCOORD_1]);
+	printf("Mesh cache: %s split into %u meshlets, %.1f triangles and %.1f vertices per meshlet\n", primitive.name, primitive.meshletCount,
+		   primitive.meshletCount > 0 ? float(indices.size() / 3) / primitive.meshletCount : 0.f,
+		   primitive.meshletCount > 0 ? float(streams.meshletVertices.size() - streams.meshlets[primitive.meshletOffset].vertexOffset) / primitive.meshletCount : 0.f);
+	for (uint32_t level = 0; level < primitive.lodCount; level++)
+		printf("Mesh cache: %s lod %u, %u triangles, error %g\n", primitive.name, level + 1, primitive.lods[level].count / 3, primitive.lods[level].error);
+
+	streams.primitives[key] = primitive;
+	return true;
+}
+
+/* the material slots, in the order of the descriptors of a material */
+static const MipChain::EUsage slotUsages[3] = { MipChain::USAGE_COLOR, MipChain::USAGE_NORMAL, MipChain::USAGE_DATA };
+
+/* the small images of the materials packed in pages (see TextureAtlas), one rect per set of images of a material */
+struct AtlasImages
+{
+	std::vector<TextureAtlas::Size>		pages;
+	std::vector<TextureAtlas::Rect>		rects;
+	std::vector<std::array<int32_t, 3>>	rectImages;		/* the glTF images of each rect by slot, -1 when the material does not have it */
+	std::vector<int32_t>				materialRects;	/* by material, -1 when its images are not packed */
+
+	/* each page is one image per slot its materials have, by page and slot */
+	std::vector<std::pair<uint32_t, uint32_t>> pageImages;
+};
+
+static std::array<int32_t, 3> GetSlotImages(const MeshCache::Material& material)
+{
+	return { material.baseColor, material.normal, material.metallicRoughness };
+}
+
+/* a material is packed when all its images have the same small size, and its primitives read them within [0, 1] */
+static void PackMaterialImages(const tinygltf::Model& gltfModel, const std::vector<MeshCache::Primitive>& primitives,
+							   const std::vector<MeshCache::Material>& materials, uint32_t maxSize, AtlasImages& atlas)
+{
+	atlas.materialRects.assign(materials.size(), -1);
+	if (maxSize == 0)
+		return;
+
+	std::vector<char> isPackable(materials.size(), 0);
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		int32_t width	= -1;
+		int32_t height	= -1;
+		bool	isSame	= true;
+		for (int32_t image : GetSlotImages(materials[i]))
+		{
+			if (image < 0 || image >= (int32_t)gltfModel.images.size())
+				continue;
+
+			/* the 1 and 2 channels images would read differently once expanded in the rgba pages */
+			const tinygltf::Image& currImage = gltfModel.images[image];
+			isSame &= !currImage.image.empty() && currImage.bits == 8 && (currImage.component == 3 || currImage.component == 4) &&
+					  (width < 0 || (currImage.width == width && currImage.height == height));
+
+			width	= currImage.width;
+			height	= currImage.height;
+		}
+
+		isPackable[i] = isSame && width > 0 && TextureAtlas::IsPackable(static_cast<uint32_t>(width), static_cast<uint32_t>(height), maxSize);
+	}
+
+	/* a page does not repeat, the uvs wrapping the image keep it in its own texture */
+	const float uvEpsilon = 1e-3f;
+	for (const MeshCache::Primitive& primitive : primitives)
+	{
+		if (primitive.material < 0 || primitive.material >= (int32_t)materials.size() || !(primitive.attributes & VERTEX_LAYOUT_BIT(VertexLayout::ATTRIBUTE_TEXCOORD_0)))
+			continue;
+
+		for (int c = 0; c < 2; c++)
+		{
+			if (primitive.uvOffset[c] < -uvEpsilon || primitive.uvOffset[c] + primitive.uvScale[c] > 1.f + uvEpsilon)
+				isPackable[primitive.material] = 0;
+		}
+	}
+
+	/* the materials reading the same images share their rect */
+	std::map<std::array<int32_t, 3>, int32_t>	imageRects;
+	std::vector<TextureAtlas::Size>				sizes;
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		if (!isPackable[i])
+			continue;
+
+		std::array<int32_t, 3> slotImages = GetSlotImages(materials[i]);
+		std::map<std::array<int32_t, 3>, int32_t>::const_iterator done = imageRects.find(slotImages);
+		if (done != imageRects.end())
+		{
+			atlas.materialRects[i] = done->second;
+			continue;
+		}
+
+		int32_t image = slotImages[0] >= 0 ? slotImages[0] : slotImages[1] >= 0 ? slotImages[1] : slotImages[2];
+		atlas.materialRects[i] = static_cast<int32_t>(sizes.size());
+		imageRects[slotImages] = atlas.materialRects[i];
+		atlas.rectImages.push_back(slotImages);
+		sizes.push_back({ static_cast<uint32_t>(gltfModel.images[image].width), static_cast<uint32_t>(gltfModel.images[image].height) });
+	}
+
+	/* a single image would only get a gutter */
+	if (sizes.size() < 2 || !TextureAtlas::Pack(sizes, atlas.rects, atlas.pages))
+	{
+		atlas = AtlasImages();
+		atlas.materialRects.assign(materials.size(), -1);
+		return;
+	}
+
+	for (uint32_t page = 0; page < atlas.pages.size(); page++)
+	{
+		for (uint32_t slot = 0; slot < 3; slot++)
+		{
+			for (size_t rect = 0; rect < atlas.rects.size(); rect++)
+			{
+				if (atlas.rects[rect].page == page && atlas.rectImages[rect][slot] >= 0)
+				{
+					atlas.pageImages.push_back({ page, slot });
+					break;
+				}
+			}
+		}
+	}
+
+	printf("Mesh cache: %zu material image sets packed in %zu atlas pages\n", sizes.size(), atlas.pages.size());
+}
+
+/* the chain of one slot of a page, the images generate their levels in place then repeat their borders in the gutters */
+static void BakeAtlasPage(const tinygltf::Model& gltfModel, const AtlasImages& atlas, uint32_t page, uint32_t slot, uint8_t* dst)
+{
+	const uint8_t	black[4] = { 0, 0, 0, 0xFF };
+	MipChain::Level	pageLevels[TEXTURE_ATLAS_MIP_COUNT];
+	TextureAtlas::GetPageLevels(atlas.pages[page], 4, dst, pageLevels);
+
+	for (size_t rect = 0; rect < atlas.rects.size(); rect++)
+	{
+		const TextureAtlas::Rect& currRect = atlas.rects[rect];
+		if (currRect.page != page)
+			continue;
+
+		/* as the black texture of the materials without this image */
+		int32_t image = atlas.rectImages[rect][slot];
+		if (image < 0)
+		{
+			TextureAtlas::Fill(currRect, 4, black, pageLevels);
+			continue;
+		}
+
+		const tinygltf::Image&	currImage = gltfModel.images[image];
+		MipChain::Level			imageLevels[TEXTURE_ATLAS_MIP_COUNT];
+		TextureAtlas::GetImageLevels(currRect, 4, pageLevels, imageLevels);
+		MipChain::Generate(currImage.image.data(), size_t(currImage.width) * currImage.component, currImage.component, currRect.width, currRect.height, 4,
+						   slotUsages[slot], MESH_CACHE_MIP_FILTER, imageLevels, TEXTURE_ATLAS_MIP_COUNT);
+		TextureAtlas::FillGutter(currRect, 4, pageLevels);
+	}
+}
+
+bool MeshCache::Bake(const tinygltf::Model& gltfModel, const std::string& assetPath, const Options& options, std::vector<uint8_t>& bytes)
+{
+	Header header = {};
+	header.magic	= MESH_CACHE_MAGIC;
+	header.version	= MESH_CACHE_VERSION;
+
+	/* loading with other options bakes again (see OpenCache) */
+	header.atlasMaxSize	= options.atlasMaxSize;
+	header.vertexLayout	= GetVertexLayout(options);
+
+	/* source files */
+	std::vector<Dependency> dependencies;
+	std::string directory = std::filesystem::path(assetPath).parent_path().string();
+	if (!directory.empty())
+		directory += '/';
+
+	if (!AddDependency(dependencies, assetPath))
+		return false;
+
+	/* the buffers in a file are read from there, only the data uri ones are copied in the cache */
+	std::vector<Buffer> buffers(gltfModel.buffers.size());
+	uint64_t binaryChunk = IsBinaryAsset(assetPath) ? GetBinaryChunkOffset(assetPath) : 0;
+	for (size_t i = 0; i < buffers.size(); i++)
+	{
+		const tinygltf::Buffer& buffer = gltfModel.buffers[i];
+		buffers[i].dependency	= -1;
+		buffers[i].data.size	= buffer.data.size();
+
+		if (!buffer.uri.empty() && !tinygltf::IsDataURI(buffer.uri))
+		{
+			buffers[i].dependency = static_cast<int32_t>(dependencies.size());
+			if (!AddDependency(dependencies, directory + buffer.uri))
+				return false;
+		}
+		else if (i == 0 && buffer.uri.empty() && binaryChunk > 0)
+		{
+			buffers[i].dependency	= 0;
+			buffers[i].data.offset	= binaryChunk;
+		}
+	}
+
+	for (const tinygltf::Image& image : gltfModel.images)
+	{
+		if (!image.uri.empty() && !tinygltf::IsDataURI(image.uri) && !AddDependency(dependencies, directory + image.uri))
+			return false;
+	}
+
+	/* one primitive per primitive of the meshes the scene draws, the nodes drawing a mesh are instances of its primitives */
+	std::vector<Primitive>				primitives;
+	std::vector<std::vector<Instance>>	primitiveInstances;
+	std::map<std::pair<int, int>, int>	meshPrimitives;	/* by mesh and primitive in the mesh, -1 when skipped */
+	OptimizedStreams optimizedStreams;
+	optimizedStreams.buffer = static_cast<uint32_t>(buffers.size());
+	optimizedStreams.layout = header.vertexLayout;
+	for (const FlatNode& flatNode : FlattenScene(gltfModel))
+	{
+		const tinygltf::Node& currNode	= gltfModel.nodes[flatNode.node];
+		const tinygltf::Mesh& mesh		= gltfModel.meshes[currNode.mesh];
+
+		Instance instance;
+		for (int i = 0; i < 16; i++)
+			instance.transform[i] = static_cast<float>(flatNode.world[i]);
+
+		for (int primitive = 0; primitive < (int)mesh.primitives.size(); primitive++)
+		{
+			std::pair<int, int> key(currNode.mesh, primitive);
+			std::map<std::pair<int, int>, int>::const_iterator done = meshPrimitives.find(key);
+			if (done != meshPrimitives.end())
+			{
+				if (done->second >= 0)
+					primitiveInstances[done->second].push_back(instance);
+				continue;
+			}
+
+			const tinygltf::Primitive& currPrimitive = mesh.primitives[primitive];
+			Primitive bakedPrimitive = {};
+			CopyName(bakedPrimitive.name, sizeof(bakedPrimitive.name), mesh.name.empty() ? currNode.name : mesh.name);
+			bakedPrimitive.material = currPrimitive.material;
+
+			/* the draws only know the interleaved quantized vertices, the optimizer writes them with the indices.
+			 * The glTF attributes out of the layout are ignored */
+			if (!OptimizePrimitive(gltfModel, currPrimitive, bakedPrimitive, optimizedStreams))
+			{
+				printf("Mesh cache: %s primitive %d skipped, its vertex streams can not be read as a triangle list\n", bakedPrimitive.name, primitive);
+				meshPrimitives[key] = -1;
+				continue;
+			}
+
+			meshPrimitives[key] = static_cast<int>(primitives.size());
+			primitives.push_back(bakedPrimitive);
+			primitiveInstances.push_back({ instance });
+		}
+	}
+
+	/* the instances of a primitive are contiguous, so that one draw takes all of them */
+	std::vector<Instance> instances;
+	for (size_t i = 0; i < primitives.size(); i++)
+	{
+		primitives[i].instanceOffset	= static_cast<uint32_t>(instances.size());
+		primitives[i].instanceCount		= static_cast<uint32_t>(primitiveInstances[i].size());
+		instances.insert(instances.end(), primitiveInstances[i].begin(), primitiveInstances[i].end());
+	}
+
+	/* the optimized streams are one more buffer, the glTF buffers no draw reads anymore are dropped */
+	if (!optimizedStreams.bytes.empty())
+	{
+		Buffer optimizedBuffer = {};
+		optimizedBuffer.dependency	= -1;
+		optimizedBuffer.data.size	= optimizedStreams.bytes.size();
+		buffers.push_back(optimizedBuffer);
+	}
+
+	std::vector<char> isBufferUsed(buffers.size(), 0);
+	for (const Primitive& primitive : primitives)
+	{
+		if (primitive.vertices.size > 0)
+			isBufferUsed[primitive.vertices.buffer] = 1;
+
+		if (primitive.indexComponentType != 0)
+			isBufferUsed[primitive.indices.buffer] = 1;
+	}
+
+	for (size_t i = 0; i < buffers.size(); i++)
+	{
+		if (!isBufferUsed[i])
+			buffers[i] = { -1, 0, { 0, 0 } };
+	}
+
+	std::vector<Material> materials;
+	for (const tinygltf::Material& currMat : gltfModel.materials)
+	{
+		Material material = {};
+		material.baseColor			= GetMaterialImage(gltfModel, currMat.pbrMetallicRoughness.baseColorTexture.index);
+		material.normal				= GetMaterialImage(gltfModel, currMat.normalTexture.index);
+		material.metallicRoughness	= GetMaterialImage(gltfModel, currMat.pbrMetallicRoughness.metallicRoughnessTexture.index);
+		materials.push_back(material);
+	}
+
+	/* the small images go to the atlas pages, the ones only read by packed materials are not kept on their own */
+	AtlasImages atlas;
+	PackMaterialImages(gltfModel, primitives, materials, options.atlasMaxSize, atlas);
+
+	std::vector<char> isReadPacked(gltfModel.images.size(), 0);
+	std::vector<char> isReadAlone(gltfModel.images.size(), 0);
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		for (int32_t image : GetSlotImages(materials[i]))
+		{
+			if (image >= 0 && image < (int32_t)gltfModel.images.size())
+				(atlas.materialRects[i] >= 0 ? isReadPacked : isReadAlone)[image] = 1;
+		}
+	}
+
+	/* the table holds the kept images, then the pages */
+	std::vector<uint32_t>	keptImages;
+	std::vector<int32_t>	imageIndices(gltfModel.images.size(), -1);
+	for (size_t i = 0; i < gltfModel.images.size(); i++)
+	{
+		if (!isReadPacked[i] || isReadAlone[i])
+		{
+			imageIndices[i] = static_cast<int32_t>(keptImages.size());
+			keptImages.push_back(static_cast<uint32_t>(i));
+		}
+	}
+
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		std::array<int32_t, 3>	slotImages	= GetSlotImages(materials[i]);
+		int32_t					rect		= atlas.materialRects[i];
+		for (uint32_t slot = 0; slot < 3; slot++)
+		{
+			int32_t image = slotImages[slot];
+			slotImages[slot] = rect < 0 && image >= 0 && image < (int32_t)gltfModel.images.size() ? imageIndices[image] : -1;
+
+			/* a rect without this image is black in the page */
+			for (size_t page = 0; rect >= 0 && page < atlas.pageImages.size(); page++)
+			{
+				if (atlas.pageImages[page].first == atlas.rects[rect].page && atlas.pageImages[page].second == slot)
+					slotImages[slot] = static_cast<int32_t>(keptImages.size() + page);
+			}
+		}
+
+		materials[i] = { slotImages[0], slotImages[1], slotImages[2] };
+	}
+
+	for (Primitive& primitive : primitives)
+	{
+		if (primitive.material < 0 || primitive.material >= (int32_t)materials.size() || atlas.materialRects[primitive.material] < 0)
+			continue;
+
+		const TextureAtlas::Rect& rect = atlas.rects[atlas.materialRects[primitive.material]];
+		float scale[2];
+		float offset[2];
+		TextureAtlas::GetUvTransform(rect, atlas.pages[rect.page], scale, offset);
+		for (int c = 0; c < 2; c++)
+		{
+			primitive.uvOffset[c]	= primitive.uvOffset[c] * scale[c] + offset[c];
+			primitive.uvScale[c]	*= scale[c];
+		}
+	}
+
+	/* the materials reading the same images are one, their primitives use the same descriptors (and static batches) */
+	std::map<std::array<int32_t, 3>, int32_t>	materialIndices;
+	std::vector<int32_t>						materialRemap(materials.size());
+	std::vector<Material>						uniqueMaterials;
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		std::pair<std::map<std::array<int32_t, 3>, int32_t>::iterator, bool> unique = materialIndices.insert({ GetSlotImages(materials[i]), static_cast<int32_t>(uniqueMaterials.size()) });
+		if (unique.second)
+			uniqueMaterials.push_back(materials[i]);
+
+		materialRemap[i] = unique.first->second;
+	}
+
+	for (Primitive& primitive : primitives)
+	{
+		if (primitive.material >= 0 && primitive.material < (int32_t)materials.size())
+			primitive.material = materialRemap[primitive.material];
+	}
+
+	materials.swap(uniqueMaterials);
+
+	/* block compressed images : the up to date dds files are kept, the others are compressed on the worker pool */
+	std::vector<MipChain::EUsage>		imageUsages = GetImageUsages(gltfModel);
+	std::vector<ImageFiles>				imageFiles(gltfModel.images.size());
+	std::vector<TextureCache::Info>		compressedImages(gltfModel.images.size());
+	WorkerPool::Get().ParallelFor(gltfModel.images.size(), [&](size_t i)
+	{
+		/* packed, the pages are baked with the payloads */
+		if (imageIndices[i] < 0)
+			return;
+
+		const tinygltf::Image& currImage = gltfModel.images[i];
+		imageFiles[i] = GetImageFiles(gltfModel, assetPath, i);
+
+		const ImageFiles& files = imageFiles[i];
+		if (files.cachePath.size() >= sizeof(Image::cachePath) ||
+			TextureCache::ReadInfo(files.cachePath, imageUsages[i], files.sourceSize, files.sourceWriteTime, compressedImages[i]))
+			return;
+
+		compressedImages[i] = {};
+		if (currImage.image.empty() || currImage.bits != 8 || currImage.component < 1 || currImage.component > 4 ||
+			!TextureCache::IsCompressible(static_cast<uint32_t>(currImage.width), static_cast<uint32_t>(currImage.height)))
+			return;
+
+		/* not fatal, the image stays in the mesh cache */
+		if (!TextureCache::Write(files.cachePath, currImage.image.data(), size_t(currImage.width) * currImage.component, currImage.component,
+								 currImage.width, currImage.height, imageUsages[i], files.sourceSize, files.sourceWriteTime, compressedImages[i]))
+			compressedImages[i] = {};
+	});
+
+	/* a dds file removed or changed by hand rebakes the model */
+	for (size_t i = 0; i < compressedImages.size(); i++)
+	{
+		if (compressedImages[i].format != BlockCompress::FORMAT_NONE && !AddDependency(dependencies, imageFiles[i].cachePath))
+			return false;
+	}
+
+	const uint8_t identityMapping[4] = { 0, 1, 2, 3 };
+
+	/* layout : header, tables, then the payloads */
+	header.dependencyCount	= static_cast<uint32_t>(dependencies.size());
+	header.bufferCount		= static_cast<uint32_t>(buffers.size());
+	header.primitiveCount	= static_cast<uint32_t>(primitives.size());
+	header.materialCount	= static_cast<uint32_t>(materials.size());
+	header.imageCount		= static_cast<uint32_t>(keptImages.size() + atlas.pageImages.size());
+	header.instanceCount	= static_cast<uint32_t>(instances.size());
+
+	header.meshletCount			= static_cast<uint32_t>(optimizedStreams.meshlets.size());
+	header.meshletVertexCount	= static_cast<uint32_t>(optimizedStreams.meshletVertices.size());
+	header.meshletTriangleCount	= static_cast<uint32_t>(optimizedStreams.meshletTriangles.size() / 3);
+
+	uint64_t offset = AlignUp(sizeof(Header));
+	header.dependencies	= offset; offset = AlignUp(offset + dependencies.size() * sizeof(Dependency));
+	header.buffers		= offset; offset = AlignUp(offset + buffers.size() * sizeof(Buffer));
+	header.primitives	= offset; offset = AlignUp(offset + primitives.size() * sizeof(Primitive));
+	header.materials	= offset; offset = AlignUp(offset + materials.size() * sizeof(Material));
+	header.images		= offset; offset = AlignUp(offset + header.imageCount * sizeof(Image));
+	header.instances	= offset; offset = AlignUp(offset + instances.size() * sizeof(Instance));
+
+	header.meshlets			= offset; offset = AlignUp(offset + optimizedStreams.meshlets.size() * sizeof(Meshlets::Meshlet));
+	header.meshletVertices	= offset; offset = AlignUp(offset + optimizedStreams.meshletVertices.size() * sizeof(uint32_t));
+	header.meshletTriangles	= offset; offset = AlignUp(offset + optimizedStreams.meshletTriangles.size());
+
+	for (size_t i = 0; i < buffers.size(); i++)
+	{
+		if (buffers[i].dependency < 0)
+		{
+			buffers[i].data.offset = offset;
+			offset = AlignUp(offset + buffers[i].data.size);
+		}
+	}
+
+	std::vector<Image> images(header.imageCount);
+	for (size_t t = 0; t < keptImages.size(); t++)
+	{
+		size_t					i			= keptImages[t];
+		const tinygltf::Image&	currImage	= gltfModel.images[i];
+		Image&					image		= images[t];
+
+		/* the chain is in the dds file */
+		if (compressedImages[i].format != BlockCompress::FORMAT_NONE)
+		{
+			image.width		= compressedImages[i].width;
+			image.height	= compressedImages[i].height;
+			image.mipCount	= compressedImages[i].mipCount;
+			image.usage		= imageUsages[i];
+			image.format	= compressedImages[i].format;
+			memcpy(image.componentMapping, compressedImages[i].componentMapping, sizeof(image.componentMapping));
+			CopyName(image.cachePath, sizeof(image.cachePath), imageFiles[i].cachePath);
+			continue;
+		}
+
+		/* an image that could not be loaded becomes a black pixel, as the materials without texture */
+		if (currImage.image.empty())
+		{
+			printf("Mesh cache: image %s not loaded, using a black texture\n", currImage.uri.c_str());
+			image.width			= 1;
+			image.height		= 1;
+			image.channels		= 1;
+			image.rowPitch		= 1;
+			image.mipCount		= 1;
+			image.usage			= MipChain::USAGE_DATA;
+			memcpy(image.componentMapping, identityMapping, sizeof(identityMapping));
+			image.pixels.offset	= offset;
+			image.pixels.size	= 1;
+			offset = AlignUp(offset + 1);
+			continue;
+		}
+
+		if (currImage.bits != 8 || currImage.component < 1 || currImage.component > 4)
+		{
+			printf("Mesh cache: unsupported image format for %s (%d channels of %d bits)\n", currImage.uri.c_str(), currImage.component, currImage.bits);
+			return false;
+		}
+
+		/* there is no 3-bytes dxgi type in d3d12 (gpu does not support anymore), expanding to 4 */
+		image.width			= static_cast<uint32_t>(currImage.width);
+		image.height		= static_cast<uint32_t>(currImage.height);
+		image.channels		= currImage.component == 3 ? 4u : static_cast<uint32_t>(currImage.component);
+		image.rowPitch		= image.width * image.channels;
+		image.mipCount		= MipChain::GetLevelCount(image.width, image.height);
+		image.usage			= imageUsages[i];
+		memcpy(image.componentMapping, identityMapping, sizeof(identityMapping));
+		image.pixels.offset	= offset;
+		image.pixels.size	= MipChain::GetChainSize(image.width, image.height, image.channels, image.mipCount);
+		offset = AlignUp(offset + image.pixels.size);
+	}
+
+	/* the pages, rgba as the images packed in them */
+	for (size_t t = keptImages.size(); t < images.size(); t++)
+	{
+		const std::pair<uint32_t, uint32_t>&	pageImage	= atlas.pageImages[t - keptImages.size()];
+		const TextureAtlas::Size&				page		= atlas.pages[pageImage.first];
+		Image&									image		= images[t];
+
+		image.width			= page.width;
+		image.height		= page.height;
+		image.channels		= 4;
+		image.rowPitch		= image.width * image.channels;
+		image.mipCount		= TEXTURE_ATLAS_MIP_COUNT;
+		image.usage			= slotUsages[pageImage.second];
+		memcpy(image.componentMapping, identityMapping, sizeof(identityMapping));
+		image.pixels.offset	= offset;
+		image.pixels.size	= MipChain::GetChainSize(image.width, image.height, image.channels, image.mipCount);
+		offset = AlignUp(offset + image.pixels.size);
+	}
+
+	header.fileSize = offset;
+
+	/* write everything */
+	bytes.assign(static_cast<size_t>(offset), 0u);
+	uint8_t* base = bytes.data();
+
+	memcpy(base, &header, sizeof(Header));
+	if (!dependencies.empty())
+		memcpy(base + header.dependencies, dependencies.data(), dependencies.size() * sizeof(Dependency));
+	if (!buffers.empty())
+		memcpy(base + header.buffers, buffers.data(), buffers.size() * sizeof(Buffer));
+	if (!primitives.empty())
+		memcpy(base + header.primitives, primitives.data(), primitives.size() * sizeof(Primitive));
+	if (!materials.empty())
+		memcpy(base + header.materials, materials.data(), materials.size() * sizeof(Material));
+	if (!images.empty())
+		memcpy(base + header.images, images.data(), images.size() * sizeof(Image));
+	if (!instances.empty())
+		memcpy(base + header.instances, instances.data(), instances.size() * sizeof(Instance));
+	if (!optimizedStreams.meshlets.empty())
+	{
+		memcpy(base + header.meshlets, optimizedStreams.meshlets.data(), optimizedStreams.meshlets.size() * sizeof(Meshlets::Meshlet));
+		memcpy(base + header.meshletVertices, optimizedStreams.meshletVertices.data(), optimizedStreams.meshletVertices.size() * sizeof(uint32_t));
+		memcpy(base + header.meshletTriangles, optimizedStreams.meshletTriangles.data(), optimizedStreams.meshletTriangles.size());
+	}
+
+	/* the payloads are independent, copied and converted on the worker pool */
+	WorkerPool::Get().ParallelFor(buffers.size() + images.size(), [&](size_t item)
+	{
+		if (item < buffers.size())
+		{
+			const uint8_t* src = item < gltfModel.buffers.size() ? gltfModel.buffers[item].data.data() : optimizedStreams.bytes.data();
+			if (buffers[item].dependency < 0 && buffers[item].data.size > 0)
+				memcpy(base + buffers[item].data.offset, src, buffers[item].data.size);
+			return;
+		}
+
+		size_t		t	= item - buffers.size();
+		uint8_t*	dst	= base + images[t].pixels.offset;
+		if (t >= keptImages.size())
+		{
+			const std::pair<uint32_t, uint32_t>& pageImage = atlas.pageImages[t - keptImages.size()];
+			BakeAtlasPage(gltfModel, atlas, pageImage.first, pageImage.second, dst);
+			return;
+		}
+
+		const tinygltf::Image&	currImage	= gltfModel.images[keptImages[t]];
+		const uint8_t*			src			= currImage.image.data();
+
+		/* already zeroed, or in the dds file */
+		if (currImage.image.empty() || images[t].format != BlockCompress::FORMAT_NONE)
+			return;
+
+		/* the whole chain, the levels are generated on the pool too */
+		const Image&					image = images[t];
+		std::vector<MipChain::Level>	levels(image.mipCount);
+		for (uint32_t level = 0; level < image.mipCount; level++)
+		{
+			levels[level].data		= dst;
+			levels[level].rowPitch	= MipChain::GetLevelSize(image.width, level) * image.channels;
+			dst += levels[level].rowPitch * MipChain::GetLevelSize(image.height, level);
+		}
+
+		MipChain::Generate(src, size_t(currImage.width) * currImage.component, currImage.component, image.width, image.height, image.channels,
+						   (MipChain::EUsage)image.usage, MESH_CACHE_MIP_FILTER, levels.data(), image.mipCount);
+	});
+
+	return true;
+}
+
+/*===== LOAD =====*/
+
+/* an image as read from its file or buffer view, before decoding */
+struct EncodedImage
+{
+	std::vector<unsigned char>	bytes;
+	int							reqWidth	= 0;
+	int							reqHeight	= 0;
+};
+
+/* tinygltf image callback: the parsing only keeps the encoded bytes, see DecodeImages */
+static bool KeepEncodedImage(tinygltf::Image*, const int imageIndex, std::string*, std::string*,
+							 int reqWidth, int reqHeight, const unsigned char* bytes, int size, void* userData)
+{
+	std::vector<EncodedImage>& encodedImages = *(std::vector<EncodedImage>*)userData;
+	if (imageIndex >= (int)encodedImages.size())
+		encodedImages.resize(imageIndex + 1);
+
+	EncodedImage& encodedImage = encodedImages[imageIndex];
+	encodedImage.bytes.assign(bytes, bytes + size);
+	encodedImage.reqWidth	= reqWidth;
+	encodedImage.reqHeight	= reqHeight;
+
+	return true;
+}
+
+/* tinygltf would decode the images one after another while parsing,
+ * they are decoded there on the worker pool with its own stb loader and options */
+static bool DecodeImages(tinygltf::Model& gltfModel, std::vector<EncodedImage>& encodedImages, std::string& err)
+{
+	size_t imageCount = encodedImages.size() < gltfModel.images.size() ? encodedImages.size() : gltfModel.images.size();
+	std::vector<std::string>	errors(imageCount);
+	std::vector<char>			isDecoded(imageCount, 1);
+
+	WorkerPool::Get().ParallelFor(imageCount, [&](size_t i)
+	{
+		EncodedImage& encodedImage = encodedImages[i];
+		if (encodedImage.bytes.empty())
+			return;
+
+		std::string warn;
+		isDecoded[i] = tinygltf::LoadImageData(&gltfModel.images[i], static_cast<int>(i), &errors[i], &warn, encodedImage.reqWidth, encodedImage.reqHeight,
+											   encodedImage.bytes.data(), static_cast<int>(encodedImage.bytes.size()), nullptr);
+
+		encodedImage.bytes = std::vector<unsigned char>();
+	});
+
+	bool isSuccess = true;
+	for (size_t i = 0; i < imageCount; i++)
+	{
+		err += errors[i];
+		isSuccess &= isDecoded[i] != 0;
+	}
+
+	return isSuccess;
+}
+
+/* an up to date cache baked with these options, mapped with the files of its buffers */
+static bool OpenCache(const std::string& cachePath, const MeshCache::Options& options, MeshCache::CachedModel& model, bool& isStale_)
+{
+	StartupProfile::Scope scope(StartupProfile::PHASE_ASSET_IO);
+
+	isStale_ = false;
+	if (!model.file.Open(cachePath))
+		return false;
+
+	if (MeshCache::MakeView(model.file.Data(), model.file.Size(), model.view) && model.view.header->atlasMaxSize == options.atlasMaxSize &&
+		model.view.header->vertexLayout.attributes == GetVertexLayout(options).attributes &&
+		MeshCache::IsUpToDate(model.view) && MeshCache::MapBuffers(model))
+	{
+		model.isFromCache = true;
+		return true;
+	}
+
+	isStale_ = true;
+	model.file.Close();
+	return false;
+}
+
+bool MeshCache::Load(const std::string& assetPath, CachedModel& model, const Options& options)
+{
+	std::string cachePath = GetCachePath(assetPath);
+
+	bool isStale = false;
+	if (OpenCache(cachePath, options, model, isStale))
+		return true;
+
+	/* the loads missing the same cache would write the same files, the bakes take turns and
+	 * the ones waiting find the cache written by the first (see DemoRegistry::WarmUp) */
+	static std::mutex bakeMutex;
+	std::lock_guard<std::mutex> bakeLock(bakeMutex);
+
+	bool isWaitedStale = false;
+	if (OpenCache(cachePath, options, model, isWaitedStale))
+		return true;
+
+	if (isStale)
+		printf("Mesh cache %s is stale, loading the glTF\n", cachePath.c_str());
+
+	tinygltf::Model		gltfModel;
+	tinygltf::TinyGLTF	loader;
+	std::string			err;
+	std::string			warn;
+
+	std::vector<EncodedImage> encodedImages;
+	loader.SetImageLoader(KeepEncodedImage, &encodedImages);
+
+	/* the .glb is mapped instead of read in a copy, tinygltf still copies its buffers out of it */
+	bool isLoaded = false;
+	{
+		StartupProfile::Scope scope(StartupProfile::PHASE_ASSET_IO);
+
+		if (IsBinaryAsset(assetPath))
+		{
+			MappedFile binaryFile;
+			if (!binaryFile.Open(assetPath))
+			{
+				printf("Error Loading model: can not open %s\n", assetPath.c_str());
+				return false;
+			}
+
+			isLoaded = loader.LoadBinaryFromMemory(&gltfModel, &err, &warn, binaryFile.Data(), static_cast<unsigned int>(binaryFile.Size()),
+												   std::filesystem::path(assetPath).parent_path().string());
+		}
+		else
+		{
+			isLoaded = loader.LoadASCIIFromFile(&gltfModel, &err, &warn, assetPath.c_str());
+		}
+	}
+
+	if (!isLoaded)
+	{
+		printf("Error Loading model: %s", err.c_str());
+		return false;
+	}
+
+	bool isDecoded = false;
+	bool isBaked = false;
+	{
+		StartupProfile::Scope scope(StartupProfile::PHASE_DECODE);
+
+		/* the images with an up to date dds file are not decoded, the bake takes them from there.
+		 * The small ones may be packed in the atlas pages instead, they need their pixels */
+		std::vector<MipChain::EUsage> imageUsages = GetImageUsages(gltfModel);
+		for (size_t i = 0; i < encodedImages.size() && i < gltfModel.images.size(); i++)
+		{
+			ImageFiles			files = GetImageFiles(gltfModel, assetPath, i);
+			TextureCache::Info	info;
+			if (TextureCache::ReadInfo(files.cachePath, imageUsages[i], files.sourceSize, files.sourceWriteTime, info) &&
+				!(options.atlasMaxSize > 0 && TextureAtlas::IsPackable(info.width, info.height, options.atlasMaxSize)))
+				encodedImages[i].bytes = std::vector<unsigned char>();
+		}
+
+		isDecoded	= DecodeImages(gltfModel, encodedImages, err);
+		isBaked		= isDecoded && Bake(gltfModel, assetPath, options, model.bakedBytes) && MakeView(model.bakedBytes.data(), model.bakedBytes.size(), model.view) &&
+					  MapBuffers(model);
+	}
+
+	if (!isDecoded)
+	{
+		printf("Error Loading model: %s", err.c_str());
+		return false;
+	}
+
+	if (!warn.empty())
+		printf("Warning Loading model: %s", warn.c_str());
+
+	if (!isBaked)
+	{
+		printf("Failed baking %s\n", assetPath.c_str());
+		return false;
+	}
+
+	StartupProfile::Scope writeScope(StartupProfile::PHASE_ASSET_IO);
+
+	/* not fatal, the next launch will parse the glTF again */
+	if (!CacheFile::Write(cachePath, model.bakedBytes.data(), model.bakedBytes.size()))
+		printf("Failed writing mesh cache %s\n", cachePath.c_str());
+
+	model.isFromCache = false;
+	return true;
+}
@@ -0,0 +1,807 @@
+/* system include */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "MeshOptimizer.hpp"
+
+/*===== VERTEX CACHE =====*/
+
+MeshOptimizer::VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+	VertexCacheStatistics statistics;
+	if (indexCount < 3 || vertexCount == 0)
+		return statistics;
+
+	/* a vertex is in the FIFO while less than cacheSize misses happened since it was loaded */
+	std::vector<uint32_t>	loadTime(vertexCount, 0);
+	std::vector<char>		isUsed(vertexCount, 0);
+	uint32_t				time = cacheSize + 1;
+	size_t					usedCount = 0;
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		uint32_t vertex = indices[i];
+		if (time - loadTime[vertex] > cacheSize)
+		{
+			loadTime[vertex] = time++;
+			statistics.misses++;
+		}
+
+		if (!isUsed[vertex])
+		{
+			isUsed[vertex] = 1;
+			usedCount++;
+		}
+	}
+
+	statistics.acmr = static_cast<float>(statistics.misses) / static_cast<float>(indexCount / 3);
+	statistics.atvr = static_cast<float>(statistics.misses) / static_cast<float>(usedCount);
+	return statistics;
+}
+
+/* triangles using each vertex, in one array */
+struct VertexTriangles
+{
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> triangles;
+
+	VertexTriangles(const uint32_t* indices, size_t indexCount, size_t vertexCount)
+		: offsets(vertexCount + 1, 0), triangles(indexCount)
+	{
+		for (size_t i = 0; i < indexCount; i++)
+			offsets[indices[i] + 1]++;
+
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+			offsets[vertex + 1] += offsets[vertex];
+
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < indexCount; i++)
+			triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+};
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>* clusters, uint32_t cacheSize)
+{
+	if (clusters)
+		clusters->clear();
+
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+		return;
+
+	VertexTriangles adjacency(indices, triangleCount * 3, vertexCount);
+
+	/* live : triangles of the vertex not emitted yet */
+	std::vector<uint32_t> live(vertexCount);
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		live[vertex] = adjacency.offsets[vertex + 1] - adjacency.offsets[vertex];
+
+	std::vector<uint32_t>	cacheTime(vertexCount, 0);
+	std::vector<char>		isEmitted(triangleCount, 0);
+	std::vector<uint32_t>	deadEnd;
+	std::vector<uint32_t>	candidates;
+	std::vector<uint32_t>	output;
+	output.reserve(triangleCount * 3);
+
+	uint32_t	time		= cacheSize + 1;
+	size_t		cursor		= 0;
+	int64_t		fanning		= indices[0];
+	bool		isMiss		= true;
+
+	while (fanning >= 0)
+	{
+		if (isMiss && clusters)
+			clusters->push_back(static_cast<uint32_t>(output.size() / 3));
+
+		/* emit the remaining triangles around the fanning vertex */
+		candidates.clear();
+		for (uint32_t i = adjacency.offsets[fanning]; i < adjacency.offsets[fanning + 1]; i++)
+		{
+			uint32_t triangle = adjacency.triangles[i];
+			if (isEmitted[triangle])
+				continue;
+
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				uint32_t vertex = indices[triangle * 3 + corner];
+				output.push_back(vertex);
+				deadEnd.push_back(vertex);
+				candidates.push_back(vertex);
+				live[vertex]--;
+
+				if (time - cacheTime[vertex] > cacheSize)
+					cacheTime[vertex] = time++;
+			}
+
+			isEmitted[triangle] = 1;
+		}
+
+		/* the next fan is around the candidate staying the longest in the cache once its own triangles are emitted */
+		int64_t		next		= -1;
+		uint32_t	bestPriority = 0;
+		for (uint32_t vertex : candidates)
+		{
+			if (live[vertex] == 0)
+				continue;
+
+			uint32_t priority = 0;
+			uint32_t age = time - cacheTime[vertex];
+			if (age + 2 * live[vertex] <= cacheSize)
+				priority = age;
+
+			if (next < 0 || priority > bestPriority)
+			{
+				bestPriority	= priority;
+				next			= vertex;
+			}
+		}
+
+		/* dead end : the most recent vertex with triangles left, otherwise the next one in input order */
+		isMiss = next < 0;
+		while (next < 0 && !deadEnd.empty())
+		{
+			uint32_t vertex = deadEnd.back();
+			deadEnd.pop_back();
+			if (live[vertex] > 0)
+				next = vertex;
+		}
+
+		while (next < 0 && cursor < vertexCount)
+		{
+			if (live[cursor] > 0)
+				next = static_cast<int64_t>(cursor);
+			cursor++;
+		}
+
+		fanning = next;
+	}
+
+	memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+/*===== OVERDRAW =====*/
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t* indices, size_t indexCount, const uint8_t* positions, size_t positionStride, size_t vertexCount,
+									 const std::vector<uint32_t>& clusters)
+{
+	size_t triangleCount = indexCount / 3;
+	if (clusters.size() < 2 || triangleCount == 0 || vertexCount == 0)
+		return;
+
+	auto GetPosition = [&](uint32_t vertex, float position[3])
+	{
+		memcpy(position, positions + vertex * positionStride, sizeof(float) * 3);
+	};
+
+	/* area weighted centroid and normal of each cluster, and centroid of the mesh */
+	struct Cluster
+	{
+		uint32_t	start;
+		uint32_t	end;
+		float		centroid[3];
+		float		normal[3];
+		float		area;
+		float		sortKey;
+	};
+
+	std::vector<Cluster> sortedClusters(clusters.size());
+	float meshCentroid[3] = {};
+	float meshArea = 0.f;
+
+	for (size_t i = 0; i < clusters.size(); i++)
+	{
+		Cluster& cluster = sortedClusters[i];
+		cluster = {};
+		cluster.start	= clusters[i];
+		cluster.end		= i + 1 < clusters.size() ? clusters[i + 1] : static_cast<uint32_t>(triangleCount);
+
+		for (uint32_t triangle = cluster.start; triangle < cluster.end; triangle++)
+		{
+			float p0[3], p1[3], p2[3];
+			GetPosition(indices[triangle * 3 + 0], p0);
+			GetPosition(indices[triangle * 3 + 1], p1);
+			GetPosition(indices[triangle * 3 + 2], p2);
+
+			float edge0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float edge1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float cross[3] = { edge0[1] * edge1[2] - edge0[2] * edge1[1],
+							   edge0[2] * edge1[0] - edge0[0] * edge1[2],
+							   edge0[0] * edge1[1] - edge0[1] * edge1[0] };
+
+			/* twice the area, the factor is the same for every triangle */
+			float area = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+			for (int c = 0; c < 3; c++)
+			{
+				cluster.centroid[c]	+= (p0[c] + p1[c] + p2[c]) * (area / 3.f);
+				cluster.normal[c]	+= cross[c];
+			}
+			cluster.area += area;
+		}
+
+		for (int c = 0; c < 3; c++)
+			meshCentroid[c] += cluster.centroid[c];
+		meshArea += cluster.area;
+
+		if (cluster.area > 0.f)
+		{
+			for (int c = 0; c < 3; c++)
+				cluster.centroid[c] /= cluster.area;
+		}
+	}
+
+	if (meshArea <= 0.f)
+		return;
+
+	for (int c = 0; c < 3; c++)
+		meshCentroid[c] /= meshArea;
+
+	for (Cluster& cluster : sortedClusters)
+	{
+		float normalLength = std::sqrt(cluster.normal[0] * cluster.normal[0] + cluster.normal[1] * cluster.normal[1] + cluster.normal[2] * cluster.normal[2]);
+		cluster.sortKey = 0.f;
+		if (normalLength > 0.f)
+		{
+			for (int c = 0; c < 3; c++)
+				cluster.sortKey += (cluster.centroid[c] - meshCentroid[c]) * cluster.normal[c] / normalLength;
+		}
+	}
+
+	std::stable_sort(sortedClusters.begin(), sortedClusters.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+	std::vector<uint32_t> sorted;
+	sorted.reserve(triangleCount * 3);
+	for (const Cluster& cluster : sortedClusters)
+		sorted.insert(sorted.end(), indices + cluster.start * 3, indices + cluster.end * 3);
+
+	memcpy(indices, sorted.data(), sorted.size() * sizeof(uint32_t));
+}
+
+/*===== VERTEX FETCH =====*/
+
+size_t MeshOptimizer::OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t* remap)
+{
+	std::fill(remap, remap + vertexCount, ~0u);
+
+	uint32_t usedCount = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		uint32_t& newIndex = remap[indices[i]];
+		if (newIndex == ~0u)
+			newIndex = usedCount++;
+
+		indices[i] = newIndex;
+	}
+
+	return usedCount;
+}
+
+void MeshOptimizer::RemapVertices(const uint8_t* src, size_t srcStride, size_t vertexCount, const uint32_t* remap, uint8_t* dst, size_t dstStride, size_t elementSize)
+{
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		if (remap[vertex] != ~0u)
+			memcpy(dst + remap[vertex] * dstStride, src + vertex * srcStride, elementSize);
+	}
+}
+
+/*===== SIMPLIFICATION =====*/
+
+/* an open border or a seam weighs this much more than the surface around it, so they keep their shape */
+#define MESH_OPTIMIZER_EDGE_WEIGHT 10.0
+
+/* a collapse turning a triangle further than this (cosine of the angle between the normals) is refused */
+#define MESH_OPTIMIZER_FLIP_COSINE 0.25
+
+/* the collapses of a pass go up to this factor of the error needed to reach the target, keeping the order by error */
+#define MESH_OPTIMIZER_PASS_ERROR_FACTOR 1.5
+
+/* sum of the squared distances to weighted planes, the error of moving a vertex to p is its mean */
+struct Quadric
+{
+	double a00 = 0.0, a11 = 0.0, a22 = 0.0, a01 = 0.0, a02 = 0.0, a12 = 0.0;
+	double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+	double c = 0.0;
+	double weight = 0.0;
+
+	/* the plane of points x with dot(normal, x) + distance = 0, normal of length 1 */
+	void AddPlane(const double normal[3], double distance, double planeWeight)
+	{
+		a00 += planeWeight * normal[0] * normal[0];
+		a11 += planeWeight * normal[1] * normal[1];
+		a22 += planeWeight * normal[2] * normal[2];
+		a01 += planeWeight * normal[0] * normal[1];
+		a02 += planeWeight * normal[0] * normal[2];
+		a12 += planeWeight * normal[1] * normal[2];
+		b0	+= planeWeight * normal[0] * distance;
+		b1	+= planeWeight * normal[1] * distance;
+		b2	+= planeWeight * normal[2] * distance;
+		c	+= planeWeight * distance * distance;
+		weight += planeWeight;
+	}
+
+	void Add(const Quadric& other)
+	{
+		a00 += other.a00; a11 += other.a11; a22 += other.a22;
+		a01 += other.a01; a02 += other.a02; a12 += other.a12;
+		b0	+= other.b0; b1 += other.b1; b2 += other.b2;
+		c	+= other.c;
+		weight += other.weight;
+	}
+
+	/* weighted sum of the squared distances, not divided by the weight */
+	double Evaluate(const float p[3]) const
+	{
+		double x = p[0], y = p[1], z = p[2];
+		double error = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+					 + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+		return std::max(error, 0.0);
+	}
+};
+
+static void Cross(const double a[3], const double b[3], double result[3])
+{
+	result[0] = a[1] * b[2] - a[2] * b[1];
+	result[1] = a[2] * b[0] - a[0] * b[2];
+	result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static double Dot(const double a[3], const double b[3])
+{
+	return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static void TriangleNormal(const float* p0, const float* p1, const float* p2, double normal[3])
+{
+	double edge0[3] = { double(p1[0]) - p0[0], double(p1[1]) - p0[1], double(p1[2]) - p0[2] };
+	double edge1[3] = { double(p2[0]) - p0[0], double(p2[1]) - p0[1], double(p2[2]) - p0[2] };
+	Cross(edge0, edge1, normal);
+}
+
+/* closest point on the triangle by its voronoi regions, see Ericson, Real-Time Collision Detection 5.1.5 */
+static float PointTriangleDistance(const float* p, const float* a, const float* b, const float* c)
+{
+	double ab[3], ac[3], ap[3], bp[3], cp[3];
+	for (int i = 0; i < 3; i++)
+	{
+		ab[i] = double(b[i]) - a[i];
+		ac[i] = double(c[i]) - a[i];
+		ap[i] = double(p[i]) - a[i];
+		bp[i] = double(p[i]) - b[i];
+		cp[i] = double(p[i]) - c[i];
+	}
+
+	/* barycentric coordinates of the closest point along ab and ac */
+	double v = 0.0, w = 0.0;
+	double d1 = Dot(ab, ap), d2 = Dot(ac, ap);
+	double d3 = Dot(ab, bp), d4 = Dot(ac, bp);
+	double d5 = Dot(ab, cp), d6 = Dot(ac, cp);
+	double va = d3 * d6 - d5 * d4, vb = d5 * d2 - d1 * d6, vc = d1 * d4 - d3 * d2;
+
+	if (d1 <= 0.0 && d2 <= 0.0)
+		v = w = 0.0;
+	else if (d3 >= 0.0 && d4 <= d3)
+		v = 1.0;
+	else if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+		v = d1 / (d1 - d3);
+	else if (d6 >= 0.0 && d5 <= d6)
+		w = 1.0;
+	else if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+		w = d2 / (d2 - d6);
+	else if (va <= 0.0 && d4 - d3 >= 0.0 && d5 - d6 >= 0.0)
+	{
+		w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		v = 1.0 - w;
+	}
+	else
+	{
+		v = vb / (va + vb + vc);
+		w = vc / (va + vb + vc);
+	}
+
+	double offset[3];
+	for (int i = 0; i < 3; i++)
+		offset[i] = ap[i] - ab[i] * v - ac[i] * w;
+
+	return static_cast<float>(std::sqrt(Dot(offset, offset)));
+}
+
+static uint64_t EdgeKey(uint32_t a, uint32_t b)
+{
+	return (uint64_t(a) << 32) | b;
+}
+
+/* the vertices are bit exact copies of the positions, seams have the same position on both sides */
+struct PositionHash
+{
+	const float* positions;
+
+	size_t operator()(uint32_t vertex) const
+	{
+		uint32_t bits[3];
+		memcpy(bits, positions + vertex * 3, sizeof(bits));
+		return size_t((bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u));
+	}
+};
+
+struct PositionEqual
+{
+	const float* positions;
+
+	bool operator()(uint32_t a, uint32_t b) const
+	{
+		return memcmp(positions + a * 3, positions + b * 3, sizeof(float) * 3) == 0;
+	}
+};
+
+size_t MeshOptimizer::Simplify(uint32_t* dst, const uint32_t* indices, size_t indexCount, const uint8_t* positions, size_t positionStride, size_t vertexCount,
+							   size_t targetIndexCount, float* error_)
+{
+	if (error_)
+		*error_ = 0.f;
+
+	/* positions copied tightly, then every vertex points to the first vertex at its position :
+	 * the collapses are decided on the positions, the vertices at one position are its wedges */
+	std::vector<float> points(vertexCount * 3);
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		memcpy(&points[vertex * 3], positions + vertex * positionStride, sizeof(float) * 3);
+
+	std::vector<uint32_t> canonical(vertexCount);
+	{
+		std::unordered_map<uint32_t, uint32_t, PositionHash, PositionEqual> firstVertex(vertexCount, PositionHash{ points.data() }, PositionEqual{ points.data() });
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+			canonical[vertex] = firstVertex.emplace(vertex, vertex).first->second;
+	}
+
+	/* the triangles already degenerated on the positions have no area to keep */
+	std::vector<uint32_t> result;
+	result.reserve(indexCount);
+	for (size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		uint32_t c0 = canonical[indices[i + 0]], c1 = canonical[indices[i + 1]], c2 = canonical[indices[i + 2]];
+		if (c0 != c1 && c1 != c2 && c2 != c0)
+			result.insert(result.end(), indices + i, indices + i + 3);
+	}
+
+	/* planes of the triangles, weighted by their area */
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t i = 0; i < result.size(); i += 3)
+	{
+		const float* p0 = &points[result[i + 0] * 3];
+		double normal[3];
+		TriangleNormal(p0, &points[result[i + 1] * 3], &points[result[i + 2] * 3], normal);
+
+		double length = std::sqrt(Dot(normal, normal));
+		if (length <= 0.0)
+			continue;
+
+		for (int c = 0; c < 3; c++)
+			normal[c] /= length;
+
+		double p0d[3] = { p0[0], p0[1], p0[2] };
+		for (int corner = 0; corner < 3; corner++)
+			quadrics[canonical[result[i + corner]]].AddPlane(normal, -Dot(normal, p0d), length * 0.5);
+	}
+
+	/* the half edges without their opposite on the positions are open borders, without their opposite on the
+	 * vertices they are seams. Both get a plane through the edge and perpendicular to the triangle */
+	std::vector<char> isBorder(vertexCount, 0);
+	{
+		std::unordered_set<uint64_t> positionEdges, vertexEdges;
+		positionEdges.reserve(result.size());
+		vertexEdges.reserve(result.size());
+		for (size_t i = 0; i < result.size(); i++)
+		{
+			uint32_t a = result[i], b = result[i - i % 3 + (i + 1) % 3];
+			positionEdges.insert(EdgeKey(canonical[a], canonical[b]));
+			vertexEdges.insert(EdgeKey(a, b));
+		}
+
+		for (size_t i = 0; i < result.size(); i++)
+		{
+			size_t		triangle	= i - i % 3;
+			uint32_t	a			= result[i];
+			uint32_t	b			= result[triangle + (i + 1) % 3];
+
+			bool isOpen = positionEdges.count(EdgeKey(canonical[b], canonical[a])) == 0;
+			if (!isOpen && vertexEdges.count(EdgeKey(b, a)) > 0)
+				continue;
+
+			if (isOpen)
+				isBorder[canonical[a]] = isBorder[canonical[b]] = 1;
+
+			const float* pa = &points[a * 3];
+			const float* pb = &points[b * 3];
+			double normal[3], edgeNormal[3];
+			double edge[3] = { double(pb[0]) - pa[0], double(pb[1]) - pa[1], double(pb[2]) - pa[2] };
+			TriangleNormal(&points[result[triangle] * 3], &points[result[triangle + 1] * 3], &points[result[triangle + 2] * 3], normal);
+			Cross(edge, normal, edgeNormal);
+
+			double length = std::sqrt(Dot(edgeNormal, edgeNormal));
+			if (length <= 0.0)
+				continue;
+
+			for (int c = 0; c < 3; c++)
+				edgeNormal[c] /= length;
+
+			double pad[3] = { pa[0], pa[1], pa[2] };
+			double edgeWeight = Dot(edge, edge) * MESH_OPTIMIZER_EDGE_WEIGHT;
+			quadrics[canonical[a]].AddPlane(edgeNormal, -Dot(edgeNormal, pad), edgeWeight);
+			quadrics[canonical[b]].AddPlane(edgeNormal, -Dot(edgeNormal, pad), edgeWeight);
+		}
+	}
+
+	struct Collapse
+	{
+		uint32_t	from;
+		uint32_t	to;
+		double		error;
+	};
+
+	std::vector<uint32_t>	resultCanonical;
+	std::vector<Collapse>	collapses;
+	std::vector<uint32_t>	target(vertexCount);
+	std::vector<uint32_t>	collapsedTo(vertexCount);
+	std::vector<char>		isLocked(vertexCount);
+	std::vector<std::pair<uint32_t, uint32_t>>	wedges;
+	std::vector<uint32_t>						fromRing, toRing;
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+		collapsedTo[vertex] = vertex;
+
+	auto GetError = [&](uint32_t from, uint32_t to)
+	{
+		double weight = quadrics[from].weight + quadrics[to].weight;
+		return weight > 0.0 ? (quadrics[from].Evaluate(&points[to * 3]) + quadrics[to].Evaluate(&points[to * 3])) / weight : 0.0;
+	};
+
+	/* the topology and the shading allow moving from onto to, fills wedges and the rings of both ends */
+	auto CanCollapse = [&](const VertexTriangles& adjacency, uint32_t from, uint32_t to)
+	{
+		/* the wedges of from go to the wedge of to they share a triangle of the edge with, each one to
+		 * its own, and every wedge of from needs one : a seam only collapses along itself */
+		wedges.clear();
+		fromRing.clear();
+		toRing.clear();
+		uint32_t edgeTriangles = 0;
+		for (uint32_t k = adjacency.offsets[from]; k < adjacency.offsets[from + 1]; k++)
+		{
+			uint32_t	triangle	= adjacency.triangles[k];
+			uint32_t	fromWedge	= 0;
+			int64_t		toWedge		= -1;
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				uint32_t vertex = result[triangle * 3 + corner];
+				if (resultCanonical[triangle * 3 + corner] == from)
+					fromWedge = vertex;
+				else if (resultCanonical[triangle * 3 + corner] == to)
+					toWedge = vertex;
+				else
+					fromRing.push_back(resultCanonical[triangle * 3 + corner]);
+			}
+
+			if (toWedge >= 0)
+				edgeTriangles++;
+
+			bool isMapped = false;
+			for (std::pair<uint32_t, uint32_t>& wedge : wedges)
+			{
+				if (wedge.first != fromWedge)
+					continue;
+
+				if (toWedge >= 0 && wedge.second != ~0u && wedge.second != uint32_t(toWedge))
+					return false;
+				else if (toWedge >= 0)
+					wedge.second = uint32_t(toWedge);
+				isMapped = true;
+			}
+
+			if (!isMapped)
+				wedges.push_back({ fromWedge, toWedge >= 0 ? uint32_t(toWedge) : ~0u });
+		}
+
+		for (size_t i = 0; i < wedges.size(); i++)
+		{
+			if (wedges[i].second == ~0u)
+				return false;
+
+			for (size_t j = 0; j < i; j++)
+			{
+				if (wedges[j].second == wedges[i].second)
+					return false;
+			}
+		}
+
+		/* a border vertex stays on the border */
+		if (edgeTriangles == 0 || (isBorder[from] && edgeTriangles != 1))
+			return false;
+
+		/* the vertices around both ends of the edge are the ones of its triangles, otherwise the collapse pinches the surface */
+		for (uint32_t k = adjacency.offsets[to]; k < adjacency.offsets[to + 1]; k++)
+		{
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				uint32_t vertex = resultCanonical[adjacency.triangles[k] * 3 + corner];
+				if (vertex != from && vertex != to)
+					toRing.push_back(vertex);
+			}
+		}
+
+		std::sort(fromRing.begin(), fromRing.end());
+		fromRing.erase(std::unique(fromRing.begin(), fromRing.end()), fromRing.end());
+		std::sort(toRing.begin(), toRing.end());
+		toRing.erase(std::unique(toRing.begin(), toRing.end()), toRing.end());
+
+		uint32_t sharedCount = 0;
+		for (uint32_t vertex : fromRing)
+			sharedCount += std::binary_search(toRing.begin(), toRing.end(), vertex) ? 1 : 0;
+
+		if (sharedCount > edgeTriangles)
+			return false;
+
+		/* the triangles kept around from must not flip nor degenerate */
+		for (uint32_t k = adjacency.offsets[from]; k < adjacency.offsets[from + 1]; k++)
+		{
+			uint32_t triangle = adjacency.triangles[k];
+			const float* before[3];
+			const float* after[3];
+			bool isKept = true;
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				uint32_t vertex = resultCanonical[triangle * 3 + corner];
+				isKept &= vertex != to;
+				before[corner]	= &points[vertex * 3];
+				after[corner]	= vertex == from ? &points[to * 3] : before[corner];
+			}
+
+			if (!isKept)
+				continue;
+
+			double normalBefore[3], normalAfter[3];
+			TriangleNormal(before[0], before[1], before[2], normalBefore);
+			TriangleNormal(after[0], after[1], after[2], normalAfter);
+
+			double lengths = std::sqrt(Dot(normalBefore, normalBefore) * Dot(normalAfter, normalAfter));
+			if (lengths <= 0.0 || Dot(normalBefore, normalAfter) < MESH_OPTIMIZER_FLIP_COSINE * lengths)
+				return false;
+		}
+
+		return true;
+	};
+
+	while (result.size() > targetIndexCount)
+	{
+		resultCanonical.resize(result.size());
+		for (size_t i = 0; i < result.size(); i++)
+			resultCanonical[i] = canonical[result[i]];
+
+		VertexTriangles adjacency(resultCanonical.data(), resultCanonical.size(), vertexCount);
+
+		/* both directions of every edge that can collapse, by increasing error */
+		collapses.clear();
+		for (size_t i = 0; i < resultCanonical.size(); i++)
+		{
+			uint32_t a = resultCanonical[i], b = resultCanonical[i - i % 3 + (i + 1) % 3];
+			collapses.push_back({ a, b, 0.0 });
+			collapses.push_back({ b, a, 0.0 });
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.from < b.from || (a.from == b.from && a.to < b.to); });
+		collapses.erase(std::unique(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.from == b.from && a.to == b.to; }),
+						collapses.end());
+		collapses.erase(std::remove_if(collapses.begin(), collapses.end(), [&](const Collapse& collapse) { return !CanCollapse(adjacency, collapse.from, collapse.to); }),
+						collapses.end());
+
+		if (collapses.empty())
+			break;
+
+		for (Collapse& collapse : collapses)
+			collapse.error = GetError(collapse.from, collapse.to);
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+		/* a collapse removes two triangles in the middle of the mesh, about half of the candidates end up locked */
+		size_t neededCount	= (result.size() - targetIndexCount) / 6 + 1;
+		double errorLimit	= collapses[std::min(neededCount * 2, collapses.size() - 1)].error * MESH_OPTIMIZER_PASS_ERROR_FACTOR;
+
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+			target[vertex] = vertex;
+		std::fill(isLocked.begin(), isLocked.end(), 0);
+
+		size_t appliedCount = 0;
+		for (const Collapse& collapse : collapses)
+		{
+			if (appliedCount >= neededCount || (appliedCount > 0 && collapse.error > errorLimit))
+				break;
+
+			/* the triangles around an unlocked vertex did not change in this pass, the collapse is still possible */
+			uint32_t from = collapse.from, to = collapse.to;
+			if (isLocked[from] || isLocked[to])
+				continue;
+
+			CanCollapse(adjacency, from, to);
+			for (const std::pair<uint32_t, uint32_t>& wedge : wedges)
+				target[wedge.first] = wedge.second;
+
+			quadrics[to].Add(quadrics[from]);
+			appliedCount++;
+
+			isLocked[from] = isLocked[to] = 1;
+			for (uint32_t vertex : fromRing)
+				isLocked[vertex] = 1;
+			for (uint32_t vertex : toRing)
+				isLocked[vertex] = 1;
+		}
+
+		if (appliedCount == 0)
+			break;
+
+		size_t keptCount = 0;
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			uint32_t v0 = target[result[i + 0]], v1 = target[result[i + 1]], v2 = target[result[i + 2]];
+			uint32_t c0 = canonical[v0], c1 = canonical[v1], c2 = canonical[v2];
+			if (c0 == c1 || c1 == c2 || c2 == c0)
+				continue;
+
+			result[keptCount++] = v0;
+			result[keptCount++] = v1;
+			result[keptCount++] = v2;
+		}
+
+		result.resize(keptCount);
+
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+			collapsedTo[vertex] = target[collapsedTo[vertex]];
+	}
+
+	memcpy(dst, result.data(), result.size() * sizeof(uint32_t));
+
+	/* the quadrics only order the collapses, the error given back is measured : the distance of each vertex of the
+	 * full mesh to the closest triangle around the vertex it collapsed into */
+	if (error_)
+	{
+		resultCanonical.resize(result.size());
+		for (size_t i = 0; i < result.size(); i++)
+			resultCanonical[i] = canonical[result[i]];
+
+		VertexTriangles adjacency(resultCanonical.data(), resultCanonical.size(), vertexCount);
+
+		float maxDistance = 0.f;
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			uint32_t vertex		= indices[i];
+			uint32_t collapsed	= canonical[collapsedTo[vertex]];
+			if (collapsed == canonical[vertex])
+				continue;
+
+			/* chained collapses can move the vertex away from its closest triangles, the ring around is looked at too */
+			fromRing.clear();
+			for (uint32_t k = adjacency.offsets[collapsed]; k < adjacency.offsets[collapsed + 1]; k++)
+				fromRing.insert(fromRing.end(), &resultCanonical[adjacency.triangles[k] * 3], &resultCanonical[adjacency.triangles[k] * 3 + 3]);
+
+			std::sort(fromRing.begin(), fromRing.end());
+			fromRing.erase(std::unique(fromRing.begin(), fromRing.end()), fromRing.end());
+
+			float distance = -1.f;
+			for (uint32_t ringVertex : fromRing)
+			{
+				for (uint32_t k = adjacency.offsets[ringVertex]; k < adjacency.offsets[ringVertex + 1]; k++)
+				{
+					uint32_t triangle = adjacency.triangles[k];
+					float triangleDistance = PointTriangleDistance(&points[vertex * 3], &points[result[triangle * 3 + 0] * 3],
+																   &points[result[triangle * 3 + 1] * 3], &points[result[triangle * 3 + 2] * 3]);
+					if (distance < 0.f || triangleDistance < distance)
+						distance = triangleDistance;
+				}
+			}
+
+			maxDistance = std::max(maxDistance, distance);
+		}
+
+		*error_ = maxDistance;
+	}
+
+	return result.size();
+}
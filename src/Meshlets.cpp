@@ -0,0 +1,408 @@
+/* system include */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+#include "Meshlets.hpp"
+
+/* how much a triangle turning away from the normals of the cluster costs, against its distance to the cluster */
+#define MESHLETS_CONE_WEIGHT 1.f
+
+/* a triangle not connected to the cluster only joins it when its normal is this close to the ones of the cluster */
+#define MESHLETS_REGROUP_MIN_DOT 0.8f
+
+/* under this cosine between the axis and a normal, the cone is too wide to ever cull the cluster */
+#define MESHLETS_MIN_CONE_DOT 0.1f
+
+/*===== BUILD =====*/
+
+struct MeshletPositionHash
+{
+	const float* positions;
+
+	size_t operator()(uint32_t vertex) const
+	{
+		uint32_t bits[3];
+		memcpy(bits, positions + vertex * 3, sizeof(bits));
+		return size_t((bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u));
+	}
+};
+
+struct MeshletPositionEqual
+{
+	const float* positions;
+
+	bool operator()(uint32_t a, uint32_t b) const
+	{
+		return memcmp(positions + a * 3, positions + b * 3, sizeof(float) * 3) == 0;
+	}
+};
+
+static void ComputeBounds(Meshlets::Meshlet& meshlet, const uint32_t* vertices, const uint8_t* triangles, const float* points, const float* normals,
+						  const uint32_t* triangleIds)
+{
+	/* sphere centered on the box of the vertices */
+	float minPoint[3], maxPoint[3];
+	for (int c = 0; c < 3; c++)
+		minPoint[c] = maxPoint[c] = points[vertices[0] * 3 + c];
+	for (uint32_t i = 1; i < meshlet.vertexCount; i++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			minPoint[c] = std::min(minPoint[c], points[vertices[i] * 3 + c]);
+			maxPoint[c] = std::max(maxPoint[c], points[vertices[i] * 3 + c]);
+		}
+	}
+
+	float radius = 0.f;
+	for (int c = 0; c < 3; c++)
+		meshlet.center[c] = (minPoint[c] + maxPoint[c]) * 0.5f;
+	for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+	{
+		const float* point = points + vertices[i] * 3;
+		float offset[3] = { point[0] - meshlet.center[0], point[1] - meshlet.center[1], point[2] - meshlet.center[2] };
+		radius = std::max(radius, offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]);
+	}
+	meshlet.radius = std::sqrt(radius);
+
+	/* the axis is the mean of the normals, the degenerated triangles have none */
+	float axis[3] = {};
+	for (uint32_t i = 0; i < meshlet.triangleCount; i++)
+	{
+		for (int c = 0; c < 3; c++)
+			axis[c] += normals[triangleIds[i] * 3 + c];
+	}
+
+	float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	meshlet.coneCutoff = 1.f;
+	memcpy(meshlet.coneApex, meshlet.center, sizeof(meshlet.coneApex));
+	if (axisLength <= 0.f)
+	{
+		meshlet.coneAxis[0] = meshlet.coneAxis[1] = 0.f;
+		meshlet.coneAxis[2] = 1.f;
+		return;
+	}
+
+	for (int c = 0; c < 3; c++)
+		meshlet.coneAxis[c] = axis[c] / axisLength;
+
+	float minDot = 1.f;
+	for (uint32_t i = 0; i < meshlet.triangleCount; i++)
+	{
+		const float* normal = normals + triangleIds[i] * 3;
+		if (normal[0] != 0.f || normal[1] != 0.f || normal[2] != 0.f)
+			minDot = std::min(minDot, normal[0] * meshlet.coneAxis[0] + normal[1] * meshlet.coneAxis[1] + normal[2] * meshlet.coneAxis[2]);
+	}
+
+	if (minDot <= MESHLETS_MIN_CONE_DOT)
+		return;
+
+	/* the apex goes back along the axis until it is behind the plane of every triangle, an eye in the cone
+	 * is then behind all of them (Zeux, meshoptimizer) */
+	float maxDistance = 0.f;
+	for (uint32_t i = 0; i < meshlet.triangleCount; i++)
+	{
+		const float* normal = normals + triangleIds[i] * 3;
+		const float* point	= points + vertices[triangles[i * 3]] * 3;
+
+		float centerDot	= (meshlet.center[0] - point[0]) * normal[0] + (meshlet.center[1] - point[1]) * normal[1] + (meshlet.center[2] - point[2]) * normal[2];
+		float axisDot	= meshlet.coneAxis[0] * normal[0] + meshlet.coneAxis[1] * normal[1] + meshlet.coneAxis[2] * normal[2];
+		if (axisDot > 0.f)
+			maxDistance = std::max(maxDistance, centerDot / axisDot);
+	}
+
+	for (int c = 0; c < 3; c++)
+		meshlet.coneApex[c] = meshlet.center[c] - meshlet.coneAxis[c] * maxDistance;
+	meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+}
+
+size_t Meshlets::Build(const uint32_t* indices, size_t indexCount, const uint8_t* positions, size_t positionStride, size_t vertexCount,
+					   std::vector<Meshlet>& meshlets, std::vector<uint32_t>& meshletVertices, std::vector<uint8_t>& meshletTriangles)
+{
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+		return 0;
+
+	std::vector<float> points(vertexCount * 3);
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		memcpy(&points[vertex * 3], positions + vertex * positionStride, sizeof(float) * 3);
+
+	/* the clusters grow across the uv and normal seams, the neighbours are found on the positions */
+	std::vector<uint32_t> canonical(vertexCount);
+	{
+		std::unordered_map<uint32_t, uint32_t, MeshletPositionHash, MeshletPositionEqual> firstVertex(vertexCount, MeshletPositionHash{ points.data() },
+																									 MeshletPositionEqual{ points.data() });
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+			canonical[vertex] = firstVertex.emplace(vertex, vertex).first->second;
+	}
+
+	/* triangles around each position, in one array */
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		offsets[canonical[indices[i]] + 1]++;
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		offsets[vertex + 1] += offsets[vertex];
+	{
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++)
+			adjacency[fill[canonical[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+	}
+
+	/* unit normal and centroid of the triangles */
+	std::vector<float> normals(triangleCount * 3);
+	std::vector<float> centroids(triangleCount * 3);
+	for (size_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		const float* p0 = &points[indices[triangle * 3 + 0] * 3];
+		const float* p1 = &points[indices[triangle * 3 + 1] * 3];
+		const float* p2 = &points[indices[triangle * 3 + 2] * 3];
+
+		float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		float n[3]	= { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+
+		float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		for (int c = 0; c < 3; c++)
+		{
+			normals[triangle * 3 + c]	= length > 0.f ? n[c] / length : 0.f;
+			centroids[triangle * 3 + c]	= (p0[c] + p1[c] + p2[c]) / 3.f;
+		}
+	}
+
+	size_t					firstMeshlet = meshlets.size();
+	std::vector<char>		isEmitted(triangleCount, 0);
+	std::vector<uint8_t>	localIndex(vertexCount, 0xFF);
+
+	/* the meshlet being filled */
+	Meshlet					meshlet = {};
+	std::vector<uint32_t>	triangleIds;
+	float					centroidSum[3]	= {};
+	float					normalSum[3]	= {};
+
+	auto Flush = [&]()
+	{
+		if (meshlet.triangleCount == 0)
+			return;
+
+		ComputeBounds(meshlet, &meshletVertices[meshlet.vertexOffset], &meshletTriangles[meshlet.triangleOffset * 3], points.data(), normals.data(),
+					  triangleIds.data());
+		meshlets.push_back(meshlet);
+
+		for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+			localIndex[meshletVertices[meshlet.vertexOffset + i]] = 0xFF;
+
+		meshlet					= {};
+		meshlet.vertexOffset	= static_cast<uint32_t>(meshletVertices.size());
+		meshlet.triangleOffset	= static_cast<uint32_t>(meshletTriangles.size() / 3);
+		triangleIds.clear();
+		memset(centroidSum, 0, sizeof(centroidSum));
+		memset(normalSum, 0, sizeof(normalSum));
+	};
+
+	auto GetNewVertexCount = [&](uint32_t triangle)
+	{
+		const uint32_t* corners = indices + triangle * 3;
+		return uint32_t(localIndex[corners[0]] == 0xFF) + uint32_t(localIndex[corners[1]] == 0xFF && corners[1] != corners[0]) +
+			   uint32_t(localIndex[corners[2]] == 0xFF && corners[2] != corners[0] && corners[2] != corners[1]);
+	};
+
+	auto Add = [&](uint32_t triangle)
+	{
+		for (int corner = 0; corner < 3; corner++)
+		{
+			uint32_t vertex = indices[triangle * 3 + corner];
+			if (localIndex[vertex] == 0xFF)
+			{
+				localIndex[vertex] = static_cast<uint8_t>(meshlet.vertexCount++);
+				meshletVertices.push_back(vertex);
+			}
+			meshletTriangles.push_back(localIndex[vertex]);
+		}
+
+		for (int c = 0; c < 3; c++)
+		{
+			centroidSum[c]	+= centroids[triangle * 3 + c];
+			normalSum[c]	+= normals[triangle * 3 + c];
+		}
+
+		isEmitted[triangle] = 1;
+		triangleIds.push_back(triangle);
+		meshlet.triangleCount++;
+	};
+
+	meshlet.vertexOffset	= static_cast<uint32_t>(meshletVertices.size());
+	meshlet.triangleOffset	= static_cast<uint32_t>(meshletTriangles.size() / 3);
+
+	/* the indices come reordered for the vertex cache, the seeds are taken in their order to keep that locality */
+	size_t cursor = 0;
+	while (true)
+	{
+		if (meshlet.triangleCount == 0)
+		{
+			while (cursor < triangleCount && isEmitted[cursor])
+				cursor++;
+			if (cursor == triangleCount)
+				break;
+
+			Add(static_cast<uint32_t>(cursor));
+		}
+
+		float center[3], axis[3];
+		float axisLength = std::sqrt(normalSum[0] * normalSum[0] + normalSum[1] * normalSum[1] + normalSum[2] * normalSum[2]);
+		for (int c = 0; c < 3; c++)
+		{
+			center[c]	= centroidSum[c] / meshlet.triangleCount;
+			axis[c]		= axisLength > 0.f ? normalSum[c] / axisLength : 0.f;
+		}
+
+		/* the neighbours of the cluster : the least new vertices, then the closest and the most aligned with its normals */
+		uint32_t	bestTriangle	= ~0u;
+		uint32_t	bestNewCount	= 4;
+		float		bestCost		= 0.f;
+		for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+		{
+			uint32_t position = canonical[meshletVertices[meshlet.vertexOffset + i]];
+			for (uint32_t j = offsets[position]; j < offsets[position + 1]; j++)
+			{
+				uint32_t triangle = adjacency[j];
+				if (isEmitted[triangle])
+					continue;
+
+				uint32_t newCount = GetNewVertexCount(triangle);
+				if (meshlet.vertexCount + newCount > MESHLET_MAX_VERTICES || newCount > bestNewCount)
+					continue;
+
+				const float* centroid	= &centroids[triangle * 3];
+				const float* normal		= &normals[triangle * 3];
+				float offset[3]			= { centroid[0] - center[0], centroid[1] - center[1], centroid[2] - center[2] };
+				float distance			= std::sqrt(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]);
+				float spread			= 1.f - (normal[0] * axis[0] + normal[1] * axis[1] + normal[2] * axis[2]);
+				float cost				= distance * (1.f + MESHLETS_CONE_WEIGHT * spread);
+
+				if (newCount < bestNewCount || cost < bestCost)
+				{
+					bestTriangle	= triangle;
+					bestNewCount	= newCount;
+					bestCost		= cost;
+				}
+			}
+		}
+
+		/* nothing connected left, the small parts (screws, handles...) are grouped with the closest triangle facing the same way */
+		if (bestTriangle == ~0u && meshlet.vertexCount + 3 <= MESHLET_MAX_VERTICES)
+		{
+			for (size_t triangle = cursor; triangle < triangleCount; triangle++)
+			{
+				const float* normal = &normals[triangle * 3];
+				if (isEmitted[triangle] || normal[0] * axis[0] + normal[1] * axis[1] + normal[2] * axis[2] < MESHLETS_REGROUP_MIN_DOT)
+					continue;
+
+				const float* centroid	= &centroids[triangle * 3];
+				float offset[3]			= { centroid[0] - center[0], centroid[1] - center[1], centroid[2] - center[2] };
+				float cost				= offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2];
+				if (bestTriangle == ~0u || cost < bestCost)
+				{
+					bestTriangle	= static_cast<uint32_t>(triangle);
+					bestCost		= cost;
+				}
+			}
+		}
+
+		if (bestTriangle == ~0u)
+		{
+			Flush();
+			continue;
+		}
+
+		Add(bestTriangle);
+		if (meshlet.triangleCount == MESHLET_MAX_TRIANGLES)
+			Flush();
+	}
+
+	Flush();
+	return meshlets.size() - firstMeshlet;
+}
+
+/*===== CULL =====*/
+
+Meshlets::Frustum Meshlets::MakeFrustum(const float clip[16])
+{
+	/* Gribb and Hartmann, the rows of the matrix give the planes of the clip space box */
+	const float* x = clip + 0;
+	const float* y = clip + 4;
+	const float* z = clip + 8;
+	const float* w = clip + 12;
+
+	Frustum frustum;
+	for (int c = 0; c < 4; c++)
+	{
+		frustum.planes[0][c] = w[c] + x[c];
+		frustum.planes[1][c] = w[c] - x[c];
+		frustum.planes[2][c] = w[c] + y[c];
+		frustum.planes[3][c] = w[c] - y[c];
+		frustum.planes[4][c] = w[c] + z[c];
+		frustum.planes[5][c] = w[c] - z[c];
+	}
+
+	/* normalized so that the plane equation is a distance, to compare with the radius of the spheres */
+	for (int plane = 0; plane < 6; plane++)
+	{
+		float* p = frustum.planes[plane];
+		float length = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+		if (length > 0.f)
+		{
+			for (int c = 0; c < 4; c++)
+				p[c] /= length;
+		}
+	}
+
+	return frustum;
+}
+
+size_t Meshlets::Cull(const Meshlet* meshlets, size_t meshletCount, const uint32_t* meshletVertices, const uint8_t* meshletTriangles,
+					  const Frustum& frustum, const float eye[3], uint32_t* dst, CullStatistics* statistics)
+{
+	CullStatistics	culled;
+	size_t			count = 0;
+	for (size_t i = 0; i < meshletCount; i++)
+	{
+		const Meshlet& meshlet = meshlets[i];
+
+		bool isInside = true;
+		for (int plane = 0; plane < 6 && isInside; plane++)
+		{
+			const float* p = frustum.planes[plane];
+			isInside = p[0] * meshlet.center[0] + p[1] * meshlet.center[1] + p[2] * meshlet.center[2] + p[3] >= -meshlet.radius;
+		}
+
+		if (!isInside)
+		{
+			culled.frustumCulled++;
+			continue;
+		}
+
+		/* the eye is in the cone behind every triangle */
+		float toApex[3]	= { meshlet.coneApex[0] - eye[0], meshlet.coneApex[1] - eye[1], meshlet.coneApex[2] - eye[2] };
+		float distance	= std::sqrt(toApex[0] * toApex[0] + toApex[1] * toApex[1] + toApex[2] * toApex[2]);
+		if (toApex[0] * meshlet.coneAxis[0] + toApex[1] * meshlet.coneAxis[1] + toApex[2] * meshlet.coneAxis[2] > meshlet.coneCutoff * distance)
+		{
+			culled.backfaceCulled++;
+			continue;
+		}
+
+		const uint32_t*	vertices	= meshletVertices + meshlet.vertexOffset;
+		const uint8_t*	triangles	= meshletTriangles + size_t(meshlet.triangleOffset) * 3;
+		for (uint32_t j = 0; j < meshlet.triangleCount * 3; j++)
+			dst[count++] = vertices[triangles[j]];
+
+		culled.visible++;
+		culled.triangles += meshlet.triangleCount;
+	}
+
+	if (statistics)
+		*statistics = culled;
+
+	return count;
+}
@@ -0,0 +1,340 @@
+/* system include */
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "MipChain.hpp"
+#include "PixelConvert.hpp"
+#include "WorkerPool.hpp"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+	#define MIP_CHAIN_SSE2
+	#include <emmintrin.h>
+#endif
+
+/* the Kaiser kernel covers 4 source texels on each side of the destination texel center */
+#define MIP_CHAIN_KAISER_TAPS	8
+#define MIP_CHAIN_KAISER_ALPHA	4.0
+
+/* output rows of a level done by one job, the bands are made small enough to balance the workers */
+#define MIP_CHAIN_MIN_BAND_ROWS	4
+
+/*===== FILTERS =====*/
+
+static double BesselI0(double x)
+{
+	double sum	= 1.0;
+	double term	= 1.0;
+	for (int k = 1; k < 32; k++)
+	{
+		term *= (x * 0.5 / k) * (x * 0.5 / k);
+		sum += term;
+	}
+	return sum;
+}
+
+/* 2:1 kernel, tap k reads the source texel 2 * x + k - 3 */
+struct KaiserWeights
+{
+	float weights[MIP_CHAIN_KAISER_TAPS];
+
+	KaiserWeights()
+	{
+		const double pi = 3.14159265358979323846;
+
+		double sum = 0.0;
+		double raw[MIP_CHAIN_KAISER_TAPS];
+		for (int k = 0; k < MIP_CHAIN_KAISER_TAPS; k++)
+		{
+			/* distance in source texels to the center of the destination texel, between the two middle taps */
+			double distance	= k - 3.5;
+			double sincX	= pi * distance * 0.5;
+			double sinc		= std::sin(sincX) / sincX;
+			double window	= distance / 4.0;
+			double kaiser	= BesselI0(MIP_CHAIN_KAISER_ALPHA * std::sqrt(1.0 - window * window)) / BesselI0(MIP_CHAIN_KAISER_ALPHA);
+
+			raw[k] = sinc * kaiser;
+			sum += raw[k];
+		}
+
+		for (int k = 0; k < MIP_CHAIN_KAISER_TAPS; k++)
+			weights[k] = static_cast<float>(raw[k] / sum);
+	}
+};
+
+static const KaiserWeights& GetKaiserWeights()
+{
+	static const KaiserWeights weights;
+	return weights;
+}
+
+static const float boxWeights[2] = { 0.5f, 0.5f };
+
+static inline uint32_t Clamp(int64_t index, uint32_t size)
+{
+	return index < 0 ? 0 : (index >= size ? size - 1 : static_cast<uint32_t>(index));
+}
+
+/* dst[x] = sum weights[k] * src[2x + k - offset], clamped to the row */
+static void FilterRow(const float* src, uint32_t srcWidth, float* dst, uint32_t dstWidth, uint32_t channels,
+					  const float* weights, uint32_t tapCount, int32_t offset)
+{
+	for (uint32_t x = 0; x < dstWidth; x++)
+	{
+		int64_t first = int64_t(x) * 2 - offset;
+		float*	out = dst + x * channels;
+
+#ifdef MIP_CHAIN_SSE2
+		if (channels == 4)
+		{
+			__m128 sum = _mm_setzero_ps();
+			for (uint32_t k = 0; k < tapCount; k++)
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(src + Clamp(first + k, srcWidth) * 4)));
+
+			_mm_storeu_ps(out, sum);
+			continue;
+		}
+#endif
+
+		for (uint32_t c = 0; c < channels; c++)
+			out[c] = 0.f;
+
+		for (uint32_t k = 0; k < tapCount; k++)
+		{
+			const float* in = src + Clamp(first + k, srcWidth) * channels;
+			for (uint32_t c = 0; c < channels; c++)
+				out[c] += weights[k] * in[c];
+		}
+	}
+}
+
+/* dst = sum weights[k] * rows[k] over count floats */
+static void CombineRows(const float* const* rows, const float* weights, uint32_t tapCount, float* dst, size_t count)
+{
+	size_t i = 0;
+#ifdef MIP_CHAIN_SSE2
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 sum = _mm_setzero_ps();
+		for (uint32_t k = 0; k < tapCount; k++)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + i)));
+
+		_mm_storeu_ps(dst + i, sum);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		float sum = 0.f;
+		for (uint32_t k = 0; k < tapCount; k++)
+			sum += weights[k] * rows[k][i];
+		dst[i] = sum;
+	}
+}
+
+/*===== ENCODING =====*/
+
+static void DecodeRow(const uint8_t* texels, float* row, uint32_t width, uint32_t channels, MipChain::EUsage usage)
+{
+	if (usage == MipChain::USAGE_COLOR)
+	{
+		PixelConvert::SrgbToLinear(texels, row, width, channels);
+		return;
+	}
+
+	PixelConvert::Unorm8ToFloat(texels, row, size_t(width) * channels);
+
+	if (usage == MipChain::USAGE_NORMAL)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			for (uint32_t c = 0; c < 3; c++)
+				row[x * channels + c] = row[x * channels + c] * 2.f - 1.f;
+		}
+	}
+}
+
+/* scratch is width * channels floats */
+static void EncodeRow(const float* row, uint8_t* texels, float* scratch, uint32_t width, uint32_t channels, MipChain::EUsage usage)
+{
+	if (usage == MipChain::USAGE_COLOR)
+	{
+		PixelConvert::LinearToSrgb(row, texels, width, channels);
+		return;
+	}
+
+	if (usage == MipChain::USAGE_NORMAL)
+	{
+		memcpy(scratch, row, size_t(width) * channels * sizeof(float));
+		for (uint32_t x = 0; x < width; x++)
+		{
+			float*	normal	= scratch + x * channels;
+			float	length	= std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			float	scale	= length > 1e-12f ? 0.5f / length : 0.f;
+
+			/* a null normal (opposite normals averaged) becomes +z */
+			normal[0] = normal[0] * scale + 0.5f;
+			normal[1] = normal[1] * scale + 0.5f;
+			normal[2] = length > 1e-12f ? normal[2] * scale + 0.5f : 1.f;
+		}
+		row = scratch;
+	}
+
+	PixelConvert::FloatToUnorm8(row, texels, size_t(width) * channels);
+}
+
+/*===== LEVELS =====*/
+
+/* where the rows of the level being downsampled come from : the 8 bits source or the previous float level */
+struct SourceLevel
+{
+	const uint8_t*		texels			= nullptr;
+	size_t				texelsRowPitch	= 0;
+	uint32_t			texelsChannels	= 0;
+
+	const float*		floats			= nullptr;
+
+	uint32_t			width			= 0;
+	uint32_t			height			= 0;
+	uint32_t			channels		= 0;
+	MipChain::EUsage	usage			= MipChain::USAGE_DATA;
+
+	/* row points into floats, or is decoded into buffer (width * channels floats) using scratch (width * channels bytes) */
+	const float* GetRow(uint32_t y, float* buffer, uint8_t* scratch) const
+	{
+		if (floats)
+			return floats + size_t(y) * width * channels;
+
+		const uint8_t* rowTexels = texels + y * texelsRowPitch;
+		if (texelsChannels != channels)
+		{
+			PixelConvert::ConvertChannels(rowTexels, texelsChannels, scratch, channels, width);
+			rowTexels = scratch;
+		}
+
+		DecodeRow(rowTexels, buffer, width, channels, usage);
+		return buffer;
+	}
+};
+
+static void DownsampleBand(const SourceLevel& source, float* dst, uint32_t dstWidth, const MipChain::Level& level,
+						   MipChain::EFilter filter, uint32_t rowBegin, uint32_t rowEnd)
+{
+	const uint32_t	channels	= source.channels;
+	const float*	weights		= filter == MipChain::FILTER_KAISER ? GetKaiserWeights().weights : boxWeights;
+	const uint32_t	tapCount	= filter == MipChain::FILTER_KAISER ? MIP_CHAIN_KAISER_TAPS : 2;
+	const int32_t	tapOffset	= filter == MipChain::FILTER_KAISER ? MIP_CHAIN_KAISER_TAPS / 2 - 1 : 0;
+
+	/* the source rows under the band, filtered horizontally once */
+	uint32_t firstRow	= Clamp(int64_t(rowBegin) * 2 - tapOffset, source.height);
+	uint32_t lastRow	= Clamp(int64_t(rowEnd - 1) * 2 - tapOffset + tapCount - 1, source.height);
+
+	size_t					dstRowSize = size_t(dstWidth) * channels;
+	std::vector<float>		filteredRows((lastRow - firstRow + 1) * dstRowSize);
+	std::vector<float>		rowBuffer(size_t(source.width) * channels);
+	std::vector<uint8_t>	rowScratch(size_t(source.width) * channels);
+
+	for (uint32_t y = firstRow; y <= lastRow; y++)
+	{
+		const float* row = source.GetRow(y, rowBuffer.data(), rowScratch.data());
+		FilterRow(row, source.width, filteredRows.data() + (y - firstRow) * dstRowSize, dstWidth, channels, weights, tapCount, tapOffset);
+	}
+
+	const float* rows[MIP_CHAIN_KAISER_TAPS];
+	for (uint32_t y = rowBegin; y < rowEnd; y++)
+	{
+		for (uint32_t k = 0; k < tapCount; k++)
+			rows[k] = filteredRows.data() + (Clamp(int64_t(y) * 2 - tapOffset + k, source.height) - firstRow) * dstRowSize;
+
+		float* dstRow = dst + y * dstRowSize;
+		CombineRows(rows, weights, tapCount, dstRow, dstRowSize);
+
+		if (level.data)
+			EncodeRow(dstRow, level.data + y * level.rowPitch, rowBuffer.data(), dstWidth, channels, source.usage);
+	}
+}
+
+uint32_t MipChain::GetLevelCount(uint32_t width, uint32_t height)
+{
+	uint32_t size	= width > height ? width : height;
+	uint32_t count	= 1;
+	while (size > 1)
+	{
+		size >>= 1;
+		count++;
+	}
+	return count;
+}
+
+size_t MipChain::GetChainSize(uint32_t width, uint32_t height, uint32_t channels, uint32_t levelCount)
+{
+	size_t size = 0;
+	for (uint32_t level = 0; level < levelCount; level++)
+		size += size_t(GetLevelSize(width, level)) * GetLevelSize(height, level) * channels;
+	return size;
+}
+
+static uint32_t GetBandRows(uint32_t height)
+{
+	uint32_t jobCount	= WorkerPool::Get().GetConcurrency() * 4;
+	uint32_t rows		= (height + jobCount - 1) / jobCount;
+	return rows > MIP_CHAIN_MIN_BAND_ROWS ? rows : MIP_CHAIN_MIN_BAND_ROWS;
+}
+
+void MipChain::Generate(const uint8_t* src, size_t srcRowPitch, uint32_t srcChannels, uint32_t width, uint32_t height, uint32_t channels,
+						EUsage usage, EFilter filter, const Level* levels, uint32_t levelCount)
+{
+	WorkerPool& pool = WorkerPool::Get();
+
+	uint32_t maxLevelCount = GetLevelCount(width, height);
+	levelCount = levelCount < maxLevelCount ? levelCount : maxLevelCount;
+
+	/* a normal needs its 3 components */
+	if (usage == USAGE_NORMAL && channels < 3)
+		usage = USAGE_DATA;
+
+	/* level 0 is the source in the destination channels */
+	if (levelCount > 0 && levels[0].data)
+	{
+		uint32_t bandRows = GetBandRows(height);
+		pool.ParallelFor((height + bandRows - 1) / bandRows, [&](size_t band)
+		{
+			uint32_t rowEnd = static_cast<uint32_t>((band + 1) * bandRows < height ? (band + 1) * bandRows : height);
+			for (uint32_t y = static_cast<uint32_t>(band * bandRows); y < rowEnd; y++)
+				PixelConvert::ConvertChannels(src + y * srcRowPitch, srcChannels, levels[0].data + y * levels[0].rowPitch, channels, width);
+		});
+	}
+
+	SourceLevel source;
+	source.texels			= src;
+	source.texelsRowPitch	= srcRowPitch;
+	source.texelsChannels	= srcChannels;
+	source.width			= width;
+	source.height			= height;
+	source.channels			= channels;
+	source.usage			= usage;
+
+	/* only the level being read and the one being written are kept in float */
+	std::vector<float> previous;
+	std::vector<float> current;
+
+	for (uint32_t level = 1; level < levelCount; level++)
+	{
+		uint32_t dstWidth	= GetLevelSize(width, level);
+		uint32_t dstHeight	= GetLevelSize(height, level);
+		current.resize(size_t(dstWidth) * dstHeight * channels);
+
+		uint32_t bandRows = GetBandRows(dstHeight);
+		pool.ParallelFor((dstHeight + bandRows - 1) / bandRows, [&](size_t band)
+		{
+			uint32_t rowBegin	= static_cast<uint32_t>(band * bandRows);
+			uint32_t rowEnd		= rowBegin + bandRows < dstHeight ? rowBegin + bandRows : dstHeight;
+			DownsampleBand(source, current.data(), dstWidth, levels[level], filter, rowBegin, rowEnd);
+		});
+
+		previous.swap(current);
+		source.floats	= previous.data();
+		source.width	= dstWidth;
+		source.height	= dstHeight;
+	}
+}
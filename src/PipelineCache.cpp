@@ -0,0 +1,181 @@
+/* system include */
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#include "PipelineCache.hpp"
+#include "CacheFile.hpp"
+
+/* the start of the file, count blobs follow, each after its BlobHeader */
+struct CacheFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t count;
+};
+
+struct BlobHeader
+{
+	uint64_t hash;
+	uint64_t size;
+};
+
+/*===== HASHER =====*/
+
+void PipelineCache::Hasher::Add(const void* data, size_t size)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+}
+
+void PipelineCache::Hasher::AddString(const char* string)
+{
+	AddValue(string != nullptr);
+	if (string)
+		Add(string, strlen(string) + 1);
+}
+
+/*===== CACHE =====*/
+
+PipelineCache::Cache::Cache(Device& device_) :
+	device { device_ }
+{
+
+}
+
+PipelineCache::Cache::~Cache()
+{
+	for (auto& entry : entries)
+	{
+		if (entry.second.object)
+			device.Release(entry.second.object);
+	}
+}
+
+void* PipelineCache::Cache::Get(uint64_t hash, const void* desc)
+{
+	Entry& entry = entries[hash];
+	if (entry.object)
+	{
+		sharedCount++;
+		return entry.object;
+	}
+
+	std::vector<uint8_t> createdBlob;
+	entry.object = device.Create(desc, entry.blob, createdBlob);
+	if (!entry.object)
+		return nullptr;
+
+	createdCount++;
+
+	/* the driver gives a new blob when it refused the old one, or when there was none */
+	if (!createdBlob.empty() && createdBlob != entry.blob)
+	{
+		entry.blob.swap(createdBlob);
+		isDirty = true;
+	}
+
+	return entry.object;
+}
+
+bool PipelineCache::Cache::GetHash(const void* object, uint64_t& hash) const
+{
+	for (const auto& entry : entries)
+	{
+		if (object && entry.second.object == object)
+		{
+			hash = entry.first;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*===== FILE =====*/
+
+bool PipelineCache::Cache::Read(const std::string& path)
+{
+	FILE* file = fopen(path.c_str(), "rb");
+	if (!file)
+		return false;
+
+	std::error_code error;
+	uint64_t fileSize = std::filesystem::file_size(path, error);
+
+	CacheFileHeader header = {};
+	bool isRead = !error && fread(&header, sizeof(header), 1, file) == 1 &&
+				  header.magic == PIPELINE_CACHE_MAGIC && header.version == PIPELINE_CACHE_VERSION;
+
+	/* read aside, a file cut in the middle of a blob leaves the cache as it was */
+	std::unordered_map<uint64_t, std::vector<uint8_t>> blobs;
+	uint64_t readSize = sizeof(header);
+	for (uint64_t i = 0; isRead && i < header.count; i++)
+	{
+		BlobHeader blobHeader = {};
+		isRead = fread(&blobHeader, sizeof(blobHeader), 1, file) == 1;
+		readSize += sizeof(blobHeader);
+
+		isRead = isRead && blobHeader.size > 0 && blobHeader.size <= fileSize - readSize;
+		if (!isRead)
+			break;
+
+		std::vector<uint8_t>& blob = blobs[blobHeader.hash];
+		blob.resize(blobHeader.size);
+		isRead = fread(blob.data(), 1, blob.size(), file) == blob.size();
+		readSize += blobHeader.size;
+	}
+
+	fclose(file);
+
+	if (!isRead || readSize != fileSize)
+	{
+		printf("Pipeline cache: ignoring %s, it is invalid or of another version\n", path.c_str());
+		return false;
+	}
+
+	/* the objects created before keep their blob */
+	for (auto& blob : blobs)
+	{
+		Entry& entry = entries[blob.first];
+		if (entry.blob.empty())
+			entry.blob.swap(blob.second);
+	}
+
+	return true;
+}
+
+bool PipelineCache::Cache::Write(const std::string& path)
+{
+	if (!isDirty)
+		return true;
+
+	std::vector<uint8_t> bytes(sizeof(CacheFileHeader));
+	CacheFileHeader header = { PIPELINE_CACHE_MAGIC, PIPELINE_CACHE_VERSION, 0 };
+	for (const auto& entry : entries)
+	{
+		if (entry.second.blob.empty())
+			continue;
+
+		BlobHeader blobHeader = { entry.first, entry.second.blob.size() };
+		const uint8_t* blobHeaderBytes = reinterpret_cast<const uint8_t*>(&blobHeader);
+		bytes.insert(bytes.end(), blobHeaderBytes, blobHeaderBytes + sizeof(blobHeader));
+		bytes.insert(bytes.end(), entry.second.blob.begin(), entry.second.blob.end());
+		header.count++;
+	}
+	memcpy(bytes.data(), &header, sizeof(header));
+
+	if (!CacheFile::Write(path, bytes.data(), bytes.size()))
+	{
+		printf("Pipeline cache: failed writing %s\n", path.c_str());
+		return false;
+	}
+
+	isDirty = false;
+	return true;
+}
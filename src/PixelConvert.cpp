@@ -0,0 +1,594 @@
+/* system include */
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "PixelConvert.hpp"
+
+/* SSE2 is part of x64, SSSE3 (byte shuffles) is checked at runtime */
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+	#define PIXEL_CONVERT_SSE2
+	#include <emmintrin.h>
+	#include <tmmintrin.h>
+
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define PIXEL_CONVERT_TARGET_SSSE3
+	#else
+		#define PIXEL_CONVERT_TARGET_SSSE3 __attribute__((target("ssse3")))
+	#endif
+#endif
+
+/*===== HELPERS =====*/
+
+#ifdef PIXEL_CONVERT_SSE2
+
+static bool HasSSSE3()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 9)) != 0;
+#else
+	return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+static const bool hasSSSE3 = HasSSSE3();
+
+#endif
+
+static inline uint32_t FloatBits(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static inline float BitsFloat(uint32_t bits)
+{
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+/* same weights as stb_image */
+static inline uint8_t Luma(uint8_t r, uint8_t g, uint8_t b)
+{
+	return static_cast<uint8_t>((r * 77 + g * 150 + b * 29) >> 8);
+}
+
+/* a NaN fails both comparisons and gives 0 */
+static inline float Saturate(float value)
+{
+	value = value > 0.f ? value : 0.f;
+	return value < 1.f ? value : 1.f;
+}
+
+/*===== CHANNELS =====*/
+
+#ifdef PIXEL_CONVERT_SSE2
+
+static size_t GreyToRgbaSSE2(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	const __m128i alpha = _mm_set1_epi8(-1);
+
+	size_t i = 0;
+	for (; i + 16 <= pixelCount; i += 16)
+	{
+		__m128i grey	= _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i ggLo	= _mm_unpacklo_epi8(grey, grey);
+		__m128i ggHi	= _mm_unpackhi_epi8(grey, grey);
+		__m128i gaLo	= _mm_unpacklo_epi8(grey, alpha);
+		__m128i gaHi	= _mm_unpackhi_epi8(grey, alpha);
+
+		_mm_storeu_si128((__m128i*)(dst + i * 4),		_mm_unpacklo_epi16(ggLo, gaLo));
+		_mm_storeu_si128((__m128i*)(dst + i * 4 + 16),	_mm_unpackhi_epi16(ggLo, gaLo));
+		_mm_storeu_si128((__m128i*)(dst + i * 4 + 32),	_mm_unpacklo_epi16(ggHi, gaHi));
+		_mm_storeu_si128((__m128i*)(dst + i * 4 + 48),	_mm_unpackhi_epi16(ggHi, gaHi));
+	}
+
+	return i;
+}
+
+static size_t GreyAlphaToRgbaSSE2(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	const __m128i greyMask = _mm_set1_epi16(0x00FF);
+
+	size_t i = 0;
+	for (; i + 8 <= pixelCount; i += 8)
+	{
+		/* 16 bits lanes of grey | alpha << 8 */
+		__m128i greyAlpha	= _mm_loadu_si128((const __m128i*)(src + i * 2));
+		__m128i grey		= _mm_and_si128(greyAlpha, greyMask);
+		__m128i greyGrey	= _mm_or_si128(grey, _mm_slli_epi16(grey, 8));
+
+		_mm_storeu_si128((__m128i*)(dst + i * 4),		_mm_unpacklo_epi16(greyGrey, greyAlpha));
+		_mm_storeu_si128((__m128i*)(dst + i * 4 + 16),	_mm_unpackhi_epi16(greyGrey, greyAlpha));
+	}
+
+	return i;
+}
+
+PIXEL_CONVERT_TARGET_SSSE3 static size_t RgbToRgbaSSSE3(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	const __m128i shuffle	= _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha		= _mm_set1_epi32(0xFF000000);
+
+	/* 4 pixels are 12 bytes but 16 are read, stop early enough to stay in src */
+	size_t i = 0;
+	for (; i + 6 <= pixelCount; i += 4)
+	{
+		__m128i rgb = _mm_loadu_si128((const __m128i*)(src + i * 3));
+		_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+	}
+
+	return i;
+}
+
+PIXEL_CONVERT_TARGET_SSSE3 static size_t RgbaToRgbSSSE3(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+	/* 12 bytes are produced but 16 written, the next iteration overwrites the 4 extra bytes */
+	size_t i = 0;
+	for (; i + 6 <= pixelCount; i += 4)
+	{
+		__m128i rgba = _mm_loadu_si128((const __m128i*)(src + i * 4));
+		_mm_storeu_si128((__m128i*)(dst + i * 3), _mm_shuffle_epi8(rgba, shuffle));
+	}
+
+	return i;
+}
+
+#endif
+
+void PixelConvert::ConvertChannels(const uint8_t* src, uint32_t srcChannels, uint8_t* dst, uint32_t dstChannels, size_t pixelCount)
+{
+	assert(srcChannels >= 1 && srcChannels <= 4 && dstChannels >= 1 && dstChannels <= 4);
+
+	if (srcChannels == dstChannels)
+	{
+		memcpy(dst, src, pixelCount * srcChannels);
+		return;
+	}
+
+	/* the simd kernels do the bulk, the scalar loops below finish from "i" */
+	size_t i = 0;
+#ifdef PIXEL_CONVERT_SSE2
+	if (srcChannels == 1 && dstChannels == 4)
+		i = GreyToRgbaSSE2(src, dst, pixelCount);
+	else if (srcChannels == 2 && dstChannels == 4)
+		i = GreyAlphaToRgbaSSE2(src, dst, pixelCount);
+	else if (srcChannels == 3 && dstChannels == 4 && hasSSSE3)
+		i = RgbToRgbaSSSE3(src, dst, pixelCount);
+	else if (srcChannels == 4 && dstChannels == 3 && hasSSSE3)
+		i = RgbaToRgbSSSE3(src, dst, pixelCount);
+#endif
+
+	src += i * srcChannels;
+	dst += i * dstChannels;
+	pixelCount -= i;
+
+	switch (srcChannels * 8 + dstChannels)
+	{
+		case 1 * 8 + 2:
+			for (size_t p = 0; p < pixelCount; p++, src += 1, dst += 2) { dst[0] = src[0]; dst[1] = 0xFF; }
+			break;
+		case 1 * 8 + 3:
+			for (size_t p = 0; p < pixelCount; p++, src += 1, dst += 3) { dst[0] = dst[1] = dst[2] = src[0]; }
+			break;
+		case 1 * 8 + 4:
+			for (size_t p = 0; p < pixelCount; p++, src += 1, dst += 4) { dst[0] = dst[1] = dst[2] = src[0]; dst[3] = 0xFF; }
+			break;
+		case 2 * 8 + 1:
+			for (size_t p = 0; p < pixelCount; p++, src += 2, dst += 1) { dst[0] = src[0]; }
+			break;
+		case 2 * 8 + 3:
+			for (size_t p = 0; p < pixelCount; p++, src += 2, dst += 3) { dst[0] = dst[1] = dst[2] = src[0]; }
+			break;
+		case 2 * 8 + 4:
+			for (size_t p = 0; p < pixelCount; p++, src += 2, dst += 4) { dst[0] = dst[1] = dst[2] = src[0]; dst[3] = src[1]; }
+			break;
+		case 3 * 8 + 1:
+			for (size_t p = 0; p < pixelCount; p++, src += 3, dst += 1) { dst[0] = Luma(src[0], src[1], src[2]); }
+			break;
+		case 3 * 8 + 2:
+			for (size_t p = 0; p < pixelCount; p++, src += 3, dst += 2) { dst[0] = Luma(src[0], src[1], src[2]); dst[1] = 0xFF; }
+			break;
+		case 3 * 8 + 4:
+			for (size_t p = 0; p < pixelCount; p++, src += 3, dst += 4) { dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = 0xFF; }
+			break;
+		case 4 * 8 + 1:
+			for (size_t p = 0; p < pixelCount; p++, src += 4, dst += 1) { dst[0] = Luma(src[0], src[1], src[2]); }
+			break;
+		case 4 * 8 + 2:
+			for (size_t p = 0; p < pixelCount; p++, src += 4, dst += 2) { dst[0] = Luma(src[0], src[1], src[2]); dst[1] = src[3]; }
+			break;
+		case 4 * 8 + 3:
+			for (size_t p = 0; p < pixelCount; p++, src += 4, dst += 3) { dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; }
+			break;
+	}
+}
+
+/*===== SWIZZLE =====*/
+
+#ifdef PIXEL_CONVERT_SSE2
+
+PIXEL_CONVERT_TARGET_SSSE3 static size_t Swizzle4SSSE3(const uint8_t* src, uint8_t* dst, size_t pixelCount, const uint8_t order[4])
+{
+	alignas(16) uint8_t indices[16];
+	for (int i = 0; i < 16; i++)
+		indices[i] = static_cast<uint8_t>((i & ~3) + (order[i & 3] & 3));
+
+	const __m128i shuffle = _mm_load_si128((const __m128i*)indices);
+
+	size_t i = 0;
+	for (; i + 4 <= pixelCount; i += 4)
+	{
+		__m128i rgba = _mm_loadu_si128((const __m128i*)(src + i * 4));
+		_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_shuffle_epi8(rgba, shuffle));
+	}
+
+	return i;
+}
+
+static size_t SwapRedBlueSSE2(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	const __m128i greenAlphaMask	= _mm_set1_epi32(0xFF00FF00);
+	const __m128i redBlueMask		= _mm_set1_epi32(0x00FF00FF);
+
+	size_t i = 0;
+	for (; i + 4 <= pixelCount; i += 4)
+	{
+		__m128i rgba		= _mm_loadu_si128((const __m128i*)(src + i * 4));
+		__m128i greenAlpha	= _mm_and_si128(rgba, greenAlphaMask);
+		__m128i redBlue		= _mm_and_si128(rgba, redBlueMask);
+		__m128i blueRed		= _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16));
+
+		_mm_storeu_si128((__m128i*)(dst + i * 4), _mm_or_si128(greenAlpha, blueRed));
+	}
+
+	return i;
+}
+
+#endif
+
+void PixelConvert::Swizzle4(const uint8_t* src, uint8_t* dst, size_t pixelCount, const uint8_t order[4])
+{
+	size_t i = 0;
+#ifdef PIXEL_CONVERT_SSE2
+	if (hasSSSE3)
+		i = Swizzle4SSSE3(src, dst, pixelCount, order);
+#endif
+
+	for (; i < pixelCount; i++)
+	{
+		/* read the whole pixel first, src and dst may be the same */
+		uint8_t pixel[4] = { src[i * 4], src[i * 4 + 1], src[i * 4 + 2], src[i * 4 + 3] };
+		for (int c = 0; c < 4; c++)
+			dst[i * 4 + c] = pixel[order[c] & 3];
+	}
+}
+
+void PixelConvert::SwapRedBlue(const uint8_t* src, uint8_t* dst, size_t pixelCount)
+{
+	size_t i = 0;
+#ifdef PIXEL_CONVERT_SSE2
+	i = SwapRedBlueSSE2(src, dst, pixelCount);
+#endif
+
+	for (; i < pixelCount; i++)
+	{
+		uint8_t red = src[i * 4];
+		dst[i * 4]		= src[i * 4 + 2];
+		dst[i * 4 + 1]	= src[i * 4 + 1];
+		dst[i * 4 + 2]	= red;
+		dst[i * 4 + 3]	= src[i * 4 + 3];
+	}
+}
+
+/*===== SRGB =====*/
+
+float PixelConvert::SrgbToLinear(float value)
+{
+	return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+float PixelConvert::LinearToSrgb(float value)
+{
+	return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
+}
+
+/* linear values under 2^-13 all give 0, above the table is indexed by the exponent and the 10 high mantissa bits */
+#define SRGB_TABLE_MIN_BITS	0x39000000u
+#define SRGB_TABLE_SHIFT	13
+#define SRGB_TABLE_SIZE		(((0x3F800000u - SRGB_TABLE_MIN_BITS) >> SRGB_TABLE_SHIFT) + 1)
+
+struct SrgbTables
+{
+	float	toLinear[256];
+	uint8_t	toSrgb[SRGB_TABLE_SIZE];
+
+	SrgbTables()
+	{
+		for (int i = 0; i < 256; i++)
+			toLinear[i] = static_cast<float>(PixelConvert::SrgbToLinear(i / 255.f));
+
+		/* each entry is the value at the middle of its range */
+		for (uint32_t i = 0; i < SRGB_TABLE_SIZE; i++)
+		{
+			float linear	= BitsFloat(SRGB_TABLE_MIN_BITS + (i << SRGB_TABLE_SHIFT) + (1u << (SRGB_TABLE_SHIFT - 1)));
+			float srgb		= PixelConvert::LinearToSrgb(Saturate(linear)) * 255.f + 0.5f;
+			toSrgb[i]		= static_cast<uint8_t>(srgb < 255.f ? srgb : 255.f);
+		}
+	}
+};
+
+static const SrgbTables& GetSrgbTables()
+{
+	static const SrgbTables tables;
+	return tables;
+}
+
+static inline uint8_t LinearToSrgb8(const SrgbTables& tables, float value)
+{
+	uint32_t bits = FloatBits(Saturate(value));
+	return bits < SRGB_TABLE_MIN_BITS ? 0 : tables.toSrgb[(bits - SRGB_TABLE_MIN_BITS) >> SRGB_TABLE_SHIFT];
+}
+
+/* index of the alpha channel, one past the pixel when there is none */
+static inline uint32_t AlphaChannel(uint32_t channels)
+{
+	return channels == 2 || channels == 4 ? channels - 1 : channels;
+}
+
+void PixelConvert::SrgbToLinear(const uint8_t* src, float* dst, size_t pixelCount, uint32_t channels)
+{
+	const SrgbTables&	tables	= GetSrgbTables();
+	const uint32_t		alpha	= AlphaChannel(channels);
+
+	for (size_t i = 0; i < pixelCount; i++, src += channels, dst += channels)
+	{
+		for (uint32_t c = 0; c < channels; c++)
+			dst[c] = c == alpha ? src[c] * (1.f / 255.f) : tables.toLinear[src[c]];
+	}
+}
+
+void PixelConvert::LinearToSrgb(const float* src, uint8_t* dst, size_t pixelCount, uint32_t channels)
+{
+	const SrgbTables&	tables	= GetSrgbTables();
+	const uint32_t		alpha	= AlphaChannel(channels);
+
+	for (size_t i = 0; i < pixelCount; i++, src += channels, dst += channels)
+	{
+		for (uint32_t c = 0; c < channels; c++)
+			dst[c] = c == alpha ? static_cast<uint8_t>(Saturate(src[c]) * 255.f + 0.5f) : LinearToSrgb8(tables, src[c]);
+	}
+}
+
+/*===== HALF =====*/
+
+/* the scalar and the sse2 versions are the same bit manipulations, they give the same results */
+
+static inline uint16_t FloatToHalf1(float value)
+{
+	const uint32_t halfMax		= (127 + 16) << 23;				/* every float over it rounds to infinity */
+	const uint32_t minNormal	= (127 - 14) << 23;				/* smallest float giving a normal half */
+	const uint32_t denormMagic	= ((127 - 15) + (23 - 10) + 1) << 23;
+
+	uint32_t bits	= FloatBits(value);
+	uint32_t sign	= bits & 0x80000000u;
+	bits ^= sign;
+
+	uint32_t half;
+	if (bits >= halfMax)
+	{
+		/* infinity, NaN becomes a quiet NaN */
+		half = bits > 0x7F800000u ? 0x7E00u : 0x7C00u;
+	}
+	else if (bits < minNormal)
+	{
+		/* the addition rounds the mantissa at the subnormal half position */
+		half = FloatBits(BitsFloat(bits) + BitsFloat(denormMagic)) - denormMagic;
+	}
+	else
+	{
+		/* rebias the exponent and round to nearest even */
+		uint32_t mantissaOdd = (bits >> 13) & 1u;
+		bits += ((uint32_t)(15 - 127) << 23) + 0xFFFu + mantissaOdd;
+		half = bits >> 13;
+	}
+
+	return static_cast<uint16_t>(half | (sign >> 16));
+}
+
+static inline float HalfToFloat1(uint16_t half)
+{
+	const float magic		= BitsFloat((254 - 15) << 23);
+	const float wasInfNan	= BitsFloat((127 + 16) << 23);
+
+	/* shifting in place then scaling also normalizes the subnormals */
+	float value = BitsFloat((uint32_t)(half & 0x7FFFu) << 13) * magic;
+
+	uint32_t bits = FloatBits(value);
+	if (value >= wasInfNan)
+		bits |= 255u << 23;
+	bits |= (uint32_t)(half & 0x8000u) << 16;
+
+	return BitsFloat(bits);
+}
+
+#ifdef PIXEL_CONVERT_SSE2
+
+static inline __m128i FloatToHalfSSE2(__m128 value)
+{
+	const __m128i halfMax		= _mm_set1_epi32((127 + 16) << 23);
+	const __m128i minNormal		= _mm_set1_epi32((127 - 14) << 23);
+	const __m128i denormMagic	= _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+	const __m128i normalBias	= _mm_set1_epi32(0xFFF - ((127 - 15) << 23));
+	const __m128i nanBit		= _mm_set1_epi32(0x200);
+	const __m128i infinity		= _mm_set1_epi32(0x7C00);
+
+	__m128	sign		= _mm_and_ps(value, _mm_castsi128_ps(_mm_set1_epi32(0x80000000)));
+	__m128	absValue	= _mm_xor_ps(value, sign);
+	__m128i absBits		= _mm_castps_si128(absValue);
+
+	__m128i isNan		= _mm_castps_si128(_mm_cmpunord_ps(absValue, absValue));
+	__m128i isRegular	= _mm_cmpgt_epi32(halfMax, absBits);
+	__m128i isSubnormal	= _mm_cmpgt_epi32(minNormal, absBits);
+	__m128i infNan		= _mm_or_si128(_mm_and_si128(isNan, nanBit), infinity);
+
+	__m128i subnormal	= _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absValue, _mm_castsi128_ps(denormMagic))), denormMagic);
+
+	__m128i mantissaOdd	= _mm_srai_epi32(_mm_slli_epi32(absBits, 31 - 13), 31);
+	__m128i normal		= _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absBits, normalBias), mantissaOdd), 13);
+
+	__m128i finite		= _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+	__m128i half		= _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, infNan));
+
+	/* the arithmetic shift keeps the lanes of negative values negative, so the signed pack does not saturate them */
+	return _mm_or_si128(half, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+}
+
+static inline __m128 HalfToFloatSSE2(__m128i half)
+{
+	const __m128i	expMantissaMask	= _mm_set1_epi32(0x7FFF);
+	const __m128	magic			= _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+	const __m128i	wasInfNan		= _mm_set1_epi32(0x7BFF);
+	const __m128	infNanExponent	= _mm_castsi128_ps(_mm_set1_epi32(255 << 23));
+
+	__m128i expMantissa	= _mm_and_si128(half, expMantissaMask);
+	__m128i sign		= _mm_slli_epi32(_mm_xor_si128(half, expMantissa), 16);
+	__m128	scaled		= _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMantissa, 13)), magic);
+	__m128	infNan		= _mm_and_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(expMantissa, wasInfNan)), infNanExponent);
+
+	return _mm_or_ps(scaled, _mm_or_ps(_mm_castsi128_ps(sign), infNan));
+}
+
+#endif
+
+void PixelConvert::FloatToHalf(const float* src, uint16_t* dst, size_t count)
+{
+	size_t i = 0;
+#ifdef PIXEL_CONVERT_SSE2
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i lo = FloatToHalfSSE2(_mm_loadu_ps(src + i));
+		__m128i hi = FloatToHalfSSE2(_mm_loadu_ps(src + i + 4));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo, hi));
+	}
+#endif
+
+	for (; i < count; i++)
+		dst[i] = FloatToHalf1(src[i]);
+}
+
+void PixelConvert::HalfToFloat(const uint16_t* src, float* dst, size_t count)
+{
+	size_t i = 0;
+#ifdef PIXEL_CONVERT_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i half = _mm_loadu_si128((const __m128i*)(src + i));
+		_mm_storeu_ps(dst + i,		HalfToFloatSSE2(_mm_unpacklo_epi16(half, zero)));
+		_mm_storeu_ps(dst + i + 4,	HalfToFloatSSE2(_mm_unpackhi_epi16(half, zero)));
+	}
+#endif
+
+	for (; i < count; i++)
+		dst[i] = HalfToFloat1(src[i]);
+}
+
+/*===== UNORM =====*/
+
+#ifdef PIXEL_CONVERT_SSE2
+
+/* max first : it returns its second operand for a NaN */
+static inline __m128i FloatToUnormSSE2(__m128 value, __m128 scale)
+{
+	__m128 saturated = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.f));
+	return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(saturated, scale), _mm_set1_ps(0.5f)));
+}
+
+#endif
+
+void PixelConvert::FloatToUnorm8(const float* src, uint8_t* dst, size_t count)
+{
+	size_t i = 0;
+#ifdef PIXEL_CONVERT_SSE2
+	const __m128 scale = _mm_set1_ps(255.f);
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i a = FloatToUnormSSE2(_mm_loadu_ps(src + i), scale);
+		__m128i b = FloatToUnormSSE2(_mm_loadu_ps(src + i + 4), scale);
+		__m128i c = FloatToUnormSSE2(_mm_loadu_ps(src + i + 8), scale);
+		__m128i d = FloatToUnormSSE2(_mm_loadu_ps(src + i + 12), scale);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+	}
+#endif
+
+	for (; i < count; i++)
+		dst[i] = static_cast<uint8_t>(Saturate(src[i]) * 255.f + 0.5f);
+}
+
+void PixelConvert::Unorm8ToFloat(const uint8_t* src, float* dst, size_t count)
+{
+	size_t i = 0;
+#ifdef PIXEL_CONVERT_SSE2
+	const __m128i	zero	= _mm_setzero_si128();
+	const __m128	scale	= _mm_set1_ps(1.f / 255.f);
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i bytes	= _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i lo		= _mm_unpacklo_epi8(bytes, zero);
+		__m128i hi		= _mm_unpackhi_epi8(bytes, zero);
+		_mm_storeu_ps(dst + i,		_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+		_mm_storeu_ps(dst + i + 4,	_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+		_mm_storeu_ps(dst + i + 8,	_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+		_mm_storeu_ps(dst + i + 12,	_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+	}
+#endif
+
+	for (; i < count; i++)
+		dst[i] = src[i] * (1.f / 255.f);
+}
+
+void PixelConvert::FloatToUnorm16(const float* src, uint16_t* dst, size_t count)
+{
+	size_t i = 0;
+#ifdef PIXEL_CONVERT_SSE2
+	/* there is no unsigned 32 to 16 bits pack before sse4.1, the values are biased into the signed range */
+	const __m128	scale	= _mm_set1_ps(65535.f);
+	const __m128i	bias32	= _mm_set1_epi32(32768);
+	const __m128i	bias16	= _mm_set1_epi16(-32768);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i lo = _mm_sub_epi32(FloatToUnormSSE2(_mm_loadu_ps(src + i), scale), bias32);
+		__m128i hi = _mm_sub_epi32(FloatToUnormSSE2(_mm_loadu_ps(src + i + 4), scale), bias32);
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_xor_si128(_mm_packs_epi32(lo, hi), bias16));
+	}
+#endif
+
+	for (; i < count; i++)
+		dst[i] = static_cast<uint16_t>(Saturate(src[i]) * 65535.f + 0.5f);
+}
+
+void PixelConvert::Unorm16ToFloat(const uint16_t* src, float* dst, size_t count)
+{
+	size_t i = 0;
+#ifdef PIXEL_CONVERT_SSE2
+	const __m128i	zero	= _mm_setzero_si128();
+	const __m128	scale	= _mm_set1_ps(1.f / 65535.f);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i values = _mm_loadu_si128((const __m128i*)(src + i));
+		_mm_storeu_ps(dst + i,		_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(values, zero)), scale));
+		_mm_storeu_ps(dst + i + 4,	_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(values, zero)), scale));
+	}
+#endif
+
+	for (; i < count; i++)
+		dst[i] = src[i] * (1.f / 65535.f);
+}
@@ -0,0 +1,143 @@
+/* system include */
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#include "ShaderCache.hpp"
+#include "CacheFile.hpp"
+
+/* FNV-1a, stable across runs and platforms unlike std::hash */
+#define SHADER_CACHE_HASH_BASIS	0xcbf29ce484222325ull
+#define SHADER_CACHE_HASH_PRIME	0x100000001b3ull
+
+/* the start of a cached file, the bytecode follows. checksum is the FNV-1a of the bytecode, so that a damaged file is compiled again */
+struct CacheFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t hash;
+	uint64_t size;
+	uint64_t checksum;
+};
+
+static void AddToHash(uint64_t& hash, const void* data, size_t size)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= SHADER_CACHE_HASH_PRIME;
+	}
+}
+
+static uint64_t GetChecksum(const std::vector<uint8_t>& bytecode)
+{
+	uint64_t checksum = SHADER_CACHE_HASH_BASIS;
+	AddToHash(checksum, bytecode.data(), bytecode.size());
+	return checksum;
+}
+
+/*===== KEY =====*/
+
+uint64_t ShaderCache::GetHash(const std::string& source, const char* entryPoint, const char* target, uint32_t flags)
+{
+	uint64_t hash		= SHADER_CACHE_HASH_BASIS;
+	uint32_t version	= SHADER_CACHE_VERSION;
+
+	/* the strings keep their terminator, so that moving a character from one to the next changes the hash */
+	AddToHash(hash, &version, sizeof(version));
+	AddToHash(hash, source.c_str(), source.size() + 1);
+	AddToHash(hash, entryPoint, strlen(entryPoint) + 1);
+	AddToHash(hash, target, strlen(target) + 1);
+	AddToHash(hash, &flags, sizeof(flags));
+
+	return hash;
+}
+
+std::string ShaderCache::GetCachePath(const std::string& directory, uint64_t hash)
+{
+	char name[17];
+	snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+
+	return (std::filesystem::path(directory) / (std::string(name) + SHADER_CACHE_EXT)).string();
+}
+
+/*===== READ =====*/
+
+bool ShaderCache::Read(const std::string& cachePath, uint64_t hash, std::vector<uint8_t>& bytecode)
+{
+	FILE* file = fopen(cachePath.c_str(), "rb");
+	if (!file)
+		return false;
+
+	CacheFileHeader header = {};
+	bool isRead = fread(&header, sizeof(header), 1, file) == 1;
+
+	/* the size is checked against the file, a truncated one is compiled again */
+	std::error_code error;
+	uint64_t fileSize = std::filesystem::file_size(cachePath, error);
+
+	isRead = isRead && !error && header.magic == SHADER_CACHE_MAGIC && header.version == SHADER_CACHE_VERSION && header.hash == hash &&
+			 header.size > 0 && fileSize == sizeof(header) + header.size;
+
+	if (isRead)
+	{
+		bytecode.resize(header.size);
+		isRead = fread(bytecode.data(), 1, bytecode.size(), file) == bytecode.size() && GetChecksum(bytecode) == header.checksum;
+	}
+
+	fclose(file);
+
+	if (!isRead)
+		bytecode.clear();
+
+	return isRead;
+}
+
+/*===== WRITE =====*/
+
+bool ShaderCache::Write(const std::string& cachePath, uint64_t hash, const std::vector<uint8_t>& bytecode)
+{
+	CacheFileHeader header = { SHADER_CACHE_MAGIC, SHADER_CACHE_VERSION, hash, bytecode.size(), GetChecksum(bytecode) };
+
+	std::vector<uint8_t> bytes(sizeof(header) + bytecode.size());
+	memcpy(bytes.data(), &header, sizeof(header));
+	memcpy(bytes.data() + sizeof(header), bytecode.data(), bytecode.size());
+
+	if (!CacheFile::Write(cachePath, bytes.data(), bytes.size()))
+	{
+		printf("Shader cache: failed writing %s\n", cachePath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+/*===== COMPILE =====*/
+
+bool ShaderCache::Compile(Compiler& compiler, const std::string& directory, const std::string& source, const char* entryPoint, const char* target,
+						  uint32_t flags, std::vector<uint8_t>& bytecode, std::string& errors, bool* isHit)
+{
+	uint64_t	hash		= GetHash(source, entryPoint, target, flags);
+	std::string	cachePath	= GetCachePath(directory, hash);
+
+	errors.clear();
+
+	bool isRead = Read(cachePath, hash, bytecode);
+	if (isHit)
+		*isHit = isRead;
+
+	if (isRead)
+		return true;
+
+	if (!compiler.Compile(source, entryPoint, target, flags, bytecode, errors))
+		return false;
+
+	/* the shader is compiled, failing to keep it only costs the next run */
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	Write(cachePath, hash, bytecode);
+
+	return true;
+}
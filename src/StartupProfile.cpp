@@ -0,0 +1,64 @@
+/* system include */
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+#include "StartupProfile.hpp"
+
+/* in nanoseconds, an integer to be added atomically */
+static std::atomic<uint64_t> phaseTimes[StartupProfile::PHASE_COUNT] = {};
+
+const char* StartupProfile::GetName(EPhase phase)
+{
+	switch (phase)
+	{
+		case PHASE_WINDOW:		return "window";
+		case PHASE_DEVICE:		return "device";
+		case PHASE_SHADER:		return "shader compile";
+		case PHASE_ASSET_IO:	return "asset I/O";
+		case PHASE_DECODE:		return "decode";
+		case PHASE_UPLOAD:		return "upload";
+		default:				return "unknown";
+	}
+}
+
+void StartupProfile::Add(EPhase phase, double ms)
+{
+	if (phase < PHASE_COUNT && ms > 0.0)
+		phaseTimes[phase].fetch_add(static_cast<uint64_t>(ms * 1e6), std::memory_order_relaxed);
+}
+
+double StartupProfile::Get(EPhase phase)
+{
+	return phase < PHASE_COUNT ? phaseTimes[phase].load(std::memory_order_relaxed) * 1e-6 : 0.0;
+}
+
+void StartupProfile::Print(double totalMs)
+{
+	printf("Time to first frame: %.2f ms\n", totalMs);
+
+	double phasesMs = 0.0;
+	for (int i = 0; i < PHASE_COUNT; i++)
+	{
+		double ms = Get(static_cast<EPhase>(i));
+		phasesMs += ms;
+
+		printf("    %-16s %9.2f ms %5.1f%%\n", GetName(static_cast<EPhase>(i)), ms, totalMs > 0.0 ? 100.0 * ms / totalMs : 0.0);
+	}
+
+	/* the main loop, the demos setup out of the phases, or nothing when the phases overlapped on several threads */
+	double otherMs = totalMs > phasesMs ? totalMs - phasesMs : 0.0;
+	printf("    %-16s %9.2f ms %5.1f%%\n", "other", otherMs, totalMs > 0.0 ? 100.0 * otherMs / totalMs : 0.0);
+}
+
+StartupProfile::Scope::Scope(EPhase phase_) :
+	phase	{ phase_ },
+	start	{ std::chrono::steady_clock::now() }
+{
+
+}
+
+StartupProfile::Scope::~Scope()
+{
+	Add(phase, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+}
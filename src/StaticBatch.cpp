@@ -0,0 +1,380 @@
+/* system include */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "StaticBatch.hpp"
+#include "VertexQuantize.hpp"
+#include "tiny_loader/tiny_gltf.h"
+
+/* SSE2 is part of x64 */
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+	#define STATIC_BATCH_SSE2
+	#include <emmintrin.h>
+#endif
+
+/*===== TRANSFORM =====*/
+
+/* dst = matrix * (src, w), w being 1 for points and 0 for vectors */
+static void Transform(const float matrix[16], const float* src, float* dst, size_t count, float w)
+{
+	size_t i = 0;
+
+#ifdef STATIC_BATCH_SSE2
+	/* the columns of the matrix, the translation one already multiplied by w */
+	const __m128 column0 = _mm_setr_ps(matrix[0], matrix[4], matrix[8], 0.f);
+	const __m128 column1 = _mm_setr_ps(matrix[1], matrix[5], matrix[9], 0.f);
+	const __m128 column2 = _mm_setr_ps(matrix[2], matrix[6], matrix[10], 0.f);
+	const __m128 column3 = _mm_setr_ps(matrix[3] * w, matrix[7] * w, matrix[11] * w, 0.f);
+
+	/* stored as 2 + 1 floats so that nothing past the point is written, dst may be src */
+	for (; i < count; i++)
+	{
+		__m128 x		= _mm_mul_ps(column0, _mm_set1_ps(src[i * 3 + 0]));
+		__m128 y		= _mm_mul_ps(column1, _mm_set1_ps(src[i * 3 + 1]));
+		__m128 z		= _mm_mul_ps(column2, _mm_set1_ps(src[i * 3 + 2]));
+		__m128 result	= _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, column3));
+		_mm_storel_pi((__m64*)(dst + i * 3), result);
+		_mm_store_ss(dst + i * 3 + 2, _mm_movehl_ps(result, result));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		float x = src[i * 3 + 0];
+		float y = src[i * 3 + 1];
+		float z = src[i * 3 + 2];
+		for (int row = 0; row < 3; row++)
+			dst[i * 3 + row] = matrix[row * 4 + 0] * x + matrix[row * 4 + 1] * y + matrix[row * 4 + 2] * z + matrix[row * 4 + 3] * w;
+	}
+}
+
+void StaticBatch::TransformPoints(const float matrix[16], const float* src, float* dst, size_t count)
+{
+	Transform(matrix, src, dst, count, 1.f);
+}
+
+void StaticBatch::TransformVectors(const float matrix[16], const float* src, float* dst, size_t count)
+{
+	Transform(matrix, src, dst, count, 0.f);
+}
+
+/* the cofactors of the upper 3x3 of matrix, that is its inverse transpose times its determinant, returned */
+static float GetCofactors(const float matrix[16], float cofactors[16])
+{
+	std::fill(cofactors, cofactors + 16, 0.f);
+	for (int row = 0; row < 3; row++)
+	{
+		int row1 = (row + 1) % 3;
+		int row2 = (row + 2) % 3;
+		for (int column = 0; column < 3; column++)
+		{
+			int column1 = (column + 1) % 3;
+			int column2 = (column + 2) % 3;
+			cofactors[row * 4 + column] = matrix[row1 * 4 + column1] * matrix[row2 * 4 + column2] - matrix[row1 * 4 + column2] * matrix[row2 * 4 + column1];
+		}
+	}
+	cofactors[15] = 1.f;
+
+	return matrix[0] * cofactors[0] + matrix[1] * cofactors[1] + matrix[2] * cofactors[2];
+}
+
+/*===== STREAMS =====*/
+
+/* the attributes of the vertices of a primitive back to floats, as the shaders read them */
+struct Vertices
+{
+	std::vector<float> values[VertexLayout::ATTRIBUTE_COUNT];
+};
+
+static size_t ReadVertices(const MeshCache::View& view, const MeshCache::Primitive& primitive, Vertices& vertices)
+{
+	const VertexLayout::Layout&	layout		= view.header->vertexLayout;
+	const uint8_t*				data		= (const uint8_t*)view.GetBufferData(primitive.vertices.buffer) + primitive.vertices.offset;
+	size_t						vertexCount	= primitive.vertices.size / primitive.vertices.stride;
+
+	for (uint32_t attribute = 0; attribute < VertexLayout::ATTRIBUTE_COUNT; attribute++)
+	{
+		VertexLayout::EAttribute	currAttribute	= static_cast<VertexLayout::EAttribute>(attribute);
+		const float*				offset			= attribute == VertexLayout::ATTRIBUTE_POSITION ? primitive.positionOffset : primitive.uvOffset;
+		const float*				scale			= attribute == VertexLayout::ATTRIBUTE_POSITION ? primitive.positionScale : primitive.uvScale;
+
+		vertices.values[attribute].resize(VertexLayout::Has(layout, currAttribute) ? vertexCount * VertexLayout::GetComponentCount(currAttribute) : 0);
+		VertexLayout::Read(layout, currAttribute, data, vertexCount, offset, scale, vertices.values[attribute].data());
+	}
+
+	return vertexCount;
+}
+
+/* the indices of a range, 0 to count - 1 when the primitive is not indexed */
+static void ReadIndices(const MeshCache::View& view, const MeshCache::BufferRange& range, uint32_t componentType, uint32_t count,
+						std::vector<uint32_t>& indices)
+{
+	indices.resize(count);
+	if (componentType == 0)
+	{
+		for (uint32_t i = 0; i < count; i++)
+			indices[i] = i;
+		return;
+	}
+
+	const uint8_t* data = (const uint8_t*)view.GetBufferData(range.buffer) + range.offset;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		switch (componentType)
+		{
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+				indices[i] = data[i];
+				break;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+			{
+				uint16_t index;
+				memcpy(&index, data + i * sizeof(uint16_t), sizeof(uint16_t));
+				indices[i] = index;
+				break;
+			}
+			default:
+				memcpy(&indices[i], data + i * sizeof(uint32_t), sizeof(uint32_t));
+				break;
+		}
+	}
+}
+
+/* indices of the primitive moved after vertexBase, the triangles turned around when the transform is mirrored */
+static void AppendIndices(const std::vector<uint32_t>& indices, uint32_t vertexBase, bool isMirrored, std::vector<uint32_t>& dst)
+{
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		dst.push_back(vertexBase + indices[i]);
+		dst.push_back(vertexBase + indices[i + (isMirrored ? 2 : 1)]);
+		dst.push_back(vertexBase + indices[i + (isMirrored ? 1 : 2)]);
+	}
+}
+
+/*===== BATCHES =====*/
+
+size_t StaticBatch::Build(const MeshCache::View& view, Arena& arena)
+{
+	arena = Arena();
+	arena.isBatched.assign(view.header->primitiveCount, 0);
+
+	/* a batch per material, in the order of their first primitive */
+	std::vector<int32_t> materials;
+	for (uint32_t primitive = 0; primitive < view.header->primitiveCount; primitive++)
+	{
+		const MeshCache::Primitive& currPrimitive = view.primitives[primitive];
+		if (currPrimitive.instanceCount == 0 || currPrimitive.instanceCount > STATIC_BATCH_MAX_INSTANCES ||
+			currPrimitive.vertices.size == 0)
+			continue;
+
+		arena.isBatched[primitive] = 1;
+		if (std::find(materials.begin(), materials.end(), currPrimitive.material) == materials.end())
+			materials.push_back(currPrimitive.material);
+	}
+
+	arena.layout = view.header->vertexLayout;
+
+	Vertices				vertices;
+	std::vector<uint32_t>	indices;
+	for (int32_t material : materials)
+	{
+		Batch batch = {};
+		batch.material		= material;
+		batch.vertexOffset	= static_cast<uint32_t>(arena.vertices.size() / arena.layout.stride);
+		batch.meshletOffset	= static_cast<uint32_t>(arena.meshlets.size());
+
+		for (uint32_t primitive = 0; primitive < view.header->primitiveCount; primitive++)
+		{
+			if (arena.isBatched[primitive] && view.primitives[primitive].material == material)
+				batch.lodCount = std::max(batch.lodCount, view.primitives[primitive].lodCount);
+		}
+
+		/* world space vertices of the batch, and its indices per level from its first vertex */
+		Vertices				batchVertices;
+		std::vector<float>&		positions	= batchVertices.values[VertexLayout::ATTRIBUTE_POSITION];
+		std::vector<float>&		normals		= batchVertices.values[VertexLayout::ATTRIBUTE_NORMAL];
+		std::vector<float>&		tangents	= batchVertices.values[VertexLayout::ATTRIBUTE_TANGENT];
+		std::vector<uint32_t>	levels[MESH_CACHE_MAX_LODS + 1];
+		bool					hasMeshlets = true;
+
+		for (uint32_t primitive = 0; primitive < view.header->primitiveCount; primitive++)
+		{
+			const MeshCache::Primitive& currPrimitive = view.primitives[primitive];
+			if (!arena.isBatched[primitive] || currPrimitive.material != material)
+				continue;
+
+			size_t vertexCount = ReadVertices(view, currPrimitive, vertices);
+			hasMeshlets = hasMeshlets && currPrimitive.meshletCount > 0;
+
+			for (uint32_t instance = 0; instance < currPrimitive.instanceCount; instance++)
+			{
+				const float*	matrix		= view.instances[currPrimitive.instanceOffset + instance].transform;
+				uint32_t		vertexBase	= static_cast<uint32_t>(positions.size() / 3);
+
+				/* normals go through the inverse transpose, the cofactors are enough as they are normalized when quantized */
+				float	cofactors[16];
+				float	determinant = GetCofactors(matrix, cofactors);
+				bool	isMirrored	= determinant < 0.f;
+				if (isMirrored)
+				{
+					for (int i = 0; i < 16; i++)
+						cofactors[i] = -cofactors[i];
+				}
+
+				/* the other attributes do not depend on the transform */
+				for (uint32_t attribute = 0; attribute < VertexLayout::ATTRIBUTE_COUNT; attribute++)
+					batchVertices.values[attribute].insert(batchVertices.values[attribute].end(), vertices.values[attribute].begin(), vertices.values[attribute].end());
+
+				TransformPoints(matrix, &positions[size_t(vertexBase) * 3], &positions[size_t(vertexBase) * 3], vertexCount);
+				if (!normals.empty())
+					TransformVectors(cofactors, &normals[size_t(vertexBase) * 3], &normals[size_t(vertexBase) * 3], vertexCount);
+
+				/* tangents follow the surface as the positions do, a mirror flips their handedness */
+				for (size_t i = 0; i < vertexCount && !tangents.empty(); i++)
+				{
+					float* tangent = &tangents[(vertexBase + i) * 4];
+					TransformVectors(matrix, tangent, tangent, 1);
+					tangent[3] = isMirrored ? -tangent[3] : tangent[3];
+				}
+
+				/* the errors and the spheres grow with the largest scale, the cones only hold under a uniform one */
+				float minScale = INFINITY;
+				float maxScale = 0.f;
+				for (int column = 0; column < 3; column++)
+				{
+					float scale = std::sqrt(matrix[column] * matrix[column] + matrix[4 + column] * matrix[4 + column] + matrix[8 + column] * matrix[8 + column]);
+					minScale = std::min(minScale, scale);
+					maxScale = std::max(maxScale, scale);
+				}
+				bool isUniform = maxScale - minScale <= maxScale * 1e-3f;
+
+				ReadIndices(view, currPrimitive.indices, currPrimitive.indexComponentType, currPrimitive.count, indices);
+				AppendIndices(indices, vertexBase, isMirrored, levels[0]);
+				for (uint32_t level = 1; level <= batch.lodCount; level++)
+				{
+					/* the full mesh stands for all the levels of a primitive that was not simplified */
+					if (currPrimitive.lodCount > 0)
+					{
+						const MeshCache::Lod& lod = currPrimitive.lods[std::min(level, currPrimitive.lodCount) - 1];
+						ReadIndices(view, lod.indices, currPrimitive.indexComponentType, lod.count, indices);
+						batch.lods[level - 1].error = std::max(batch.lods[level - 1].error, lod.error * maxScale);
+					}
+					else
+					{
+						ReadIndices(view, currPrimitive.indices, currPrimitive.indexComponentType, currPrimitive.count, indices);
+					}
+					AppendIndices(indices, vertexBase, isMirrored, levels[level]);
+				}
+
+				for (uint32_t i = 0; i < currPrimitive.meshletCount; i++)
+				{
+					Meshlets::Meshlet meshlet = view.meshlets[currPrimitive.meshletOffset + i];
+
+					const uint32_t*	meshletVertices		= view.meshletVertices + meshlet.vertexOffset;
+					const uint8_t*	meshletTriangles	= view.meshletTriangles + size_t(meshlet.triangleOffset) * 3;
+					meshlet.vertexOffset	= static_cast<uint32_t>(arena.meshletVertices.size());
+					meshlet.triangleOffset	= static_cast<uint32_t>(arena.meshletTriangles.size() / 3);
+
+					for (uint32_t vertex = 0; vertex < meshlet.vertexCount; vertex++)
+						arena.meshletVertices.push_back(vertexBase + meshletVertices[vertex]);
+					for (uint32_t triangle = 0; triangle < meshlet.triangleCount; triangle++)
+					{
+						arena.meshletTriangles.push_back(meshletTriangles[triangle * 3]);
+						arena.meshletTriangles.push_back(meshletTriangles[triangle * 3 + (isMirrored ? 2 : 1)]);
+						arena.meshletTriangles.push_back(meshletTriangles[triangle * 3 + (isMirrored ? 1 : 2)]);
+					}
+
+					TransformPoints(matrix, meshlet.center, meshlet.center, 1);
+					meshlet.radius *= maxScale;
+
+					/* a mirror turns the triangles around as well, so the axis still follows the transform */
+					if (isUniform && meshlet.coneCutoff < 1.f)
+					{
+						float axis[3];
+						TransformPoints(matrix, meshlet.coneApex, meshlet.coneApex, 1);
+						TransformVectors(matrix, meshlet.coneAxis, axis, 1);
+
+						float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+						for (int c = 0; c < 3; c++)
+							meshlet.coneAxis[c] = length > 0.f ? axis[c] / length : 0.f;
+					}
+					else
+					{
+						meshlet.coneCutoff = 1.f;
+					}
+
+					arena.meshlets.push_back(meshlet);
+				}
+
+				batch.drawCount++;
+			}
+		}
+
+		/* the culling only draws the meshlets, they have to cover every merged primitive */
+		if (hasMeshlets)
+		{
+			batch.meshletCount = static_cast<uint32_t>(arena.meshlets.size()) - batch.meshletOffset;
+		}
+		else if (arena.meshlets.size() > batch.meshletOffset)
+		{
+			Meshlets::Meshlet first = arena.meshlets[batch.meshletOffset];
+			arena.meshletVertices.resize(first.vertexOffset);
+			arena.meshletTriangles.resize(size_t(first.triangleOffset) * 3);
+			arena.meshlets.resize(batch.meshletOffset);
+		}
+
+		/* the vertices again, in the box of the batch */
+		size_t vertexCount = positions.size() / 3;
+		batch.vertexCount = static_cast<uint32_t>(vertexCount);
+		arena.vertices.resize(arena.vertices.size() + vertexCount * arena.layout.stride, 0);
+
+		const std::vector<float>& uvs = batchVertices.values[VertexLayout::ATTRIBUTE_TEXCOORD_0];
+		VertexQuantize::GetRange(positions.data(), vertexCount, 3, batch.positionOffset, batch.positionScale);
+		batch.uvOffset[0]	= batch.uvOffset[1]	= 0.f;
+		batch.uvScale[0]	= batch.uvScale[1]	= 1.f;
+		if (!uvs.empty())
+			VertexQuantize::GetRange(uvs.data(), vertexCount, 2, batch.uvOffset, batch.uvScale);
+
+		float positionError = 0.f;
+		for (uint32_t attribute = 0; attribute < VertexLayout::ATTRIBUTE_COUNT; attribute++)
+		{
+			const float*	offset	= attribute == VertexLayout::ATTRIBUTE_POSITION ? batch.positionOffset : batch.uvOffset;
+			const float*	scale	= attribute == VertexLayout::ATTRIBUTE_POSITION ? batch.positionScale : batch.uvScale;
+			float			error	= VertexLayout::Write(arena.layout, static_cast<VertexLayout::EAttribute>(attribute),
+														  batchVertices.values[attribute].empty() ? nullptr : batchVertices.values[attribute].data(), vertexCount,
+														  offset, scale, &arena.vertices[size_t(batch.vertexOffset) * arena.layout.stride]);
+			if (attribute == VertexLayout::ATTRIBUTE_POSITION)
+				positionError = error;
+		}
+
+		/* sphere around the box */
+		batch.radius = 0.f;
+		for (int c = 0; c < 3; c++)
+			batch.center[c] = batch.positionOffset[c] + batch.positionScale[c] * 0.5f;
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			float dx = positions[i * 3 + 0] - batch.center[0];
+			float dy = positions[i * 3 + 1] - batch.center[1];
+			float dz = positions[i * 3 + 2] - batch.center[2];
+			batch.radius = std::max(batch.radius, std::sqrt(dx * dx + dy * dy + dz * dz));
+		}
+
+		batch.indexOffset	= static_cast<uint32_t>(arena.indices.size());
+		batch.indexCount	= static_cast<uint32_t>(levels[0].size());
+		arena.indices.insert(arena.indices.end(), levels[0].begin(), levels[0].end());
+		for (uint32_t level = 1; level <= batch.lodCount; level++)
+		{
+			batch.lods[level - 1].indexOffset	= static_cast<uint32_t>(arena.indices.size());
+			batch.lods[level - 1].indexCount	= static_cast<uint32_t>(levels[level].size());
+			arena.indices.insert(arena.indices.end(), levels[level].begin(), levels[level].end());
+		}
+
+		printf("Static batch: material %d, %u draws merged, %u vertices, %u triangles, %u meshlets, position error %g\n",
+			   batch.material, batch.drawCount, batch.vertexCount, batch.indexCount / 3, batch.meshletCount, positionError);
+
+		arena.batches.push_back(batch);
+	}
+
+	return arena.batches.size();
+}
@@ -0,0 +1,158 @@
+/* system include */
+#include <cstring>
+
+#include "TextureAtlas.hpp"
+
+/* the implementation is private to this file, imgui has its own */
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imstb_rectpack.h>
+
+bool TextureAtlas::IsPackable(uint32_t width, uint32_t height, uint32_t maxSize)
+{
+	/* whole gutters : the image stays on whole texels down to the last level */
+	return width >= TEXTURE_ATLAS_GUTTER && height >= TEXTURE_ATLAS_GUTTER && width % TEXTURE_ATLAS_GUTTER == 0 && height % TEXTURE_ATLAS_GUTTER == 0 &&
+		   width <= maxSize && height <= maxSize &&
+		   width + 2 * TEXTURE_ATLAS_GUTTER <= TEXTURE_ATLAS_MAX_PAGE_SIZE && height + 2 * TEXTURE_ATLAS_GUTTER <= TEXTURE_ATLAS_MAX_PAGE_SIZE;
+}
+
+bool TextureAtlas::Pack(const std::vector<Size>& sizes, std::vector<Rect>& rects, std::vector<Size>& pages)
+{
+	rects.assign(sizes.size(), {});
+	pages.clear();
+
+	/* packed in units of the gutter, so that every place stays aligned on the last level */
+	std::vector<stbrp_rect> pending(sizes.size());
+	for (size_t i = 0; i < sizes.size(); i++)
+	{
+		if (!IsPackable(sizes[i].width, sizes[i].height, TEXTURE_ATLAS_MAX_PAGE_SIZE))
+			return false;
+
+		pending[i]		= {};
+		pending[i].id	= static_cast<int>(i);
+		pending[i].w	= static_cast<stbrp_coord>(sizes[i].width / TEXTURE_ATLAS_GUTTER + 2);
+		pending[i].h	= static_cast<stbrp_coord>(sizes[i].height / TEXTURE_ATLAS_GUTTER + 2);
+	}
+
+	const int pageUnits = static_cast<int>(TEXTURE_ATLAS_MAX_PAGE_SIZE / TEXTURE_ATLAS_GUTTER);
+	std::vector<stbrp_node> nodes(pageUnits);
+
+	/* a new page for the images the previous ones could not take */
+	while (!pending.empty())
+	{
+		stbrp_context context;
+		stbrp_init_target(&context, pageUnits, pageUnits, nodes.data(), pageUnits);
+		stbrp_pack_rects(&context, pending.data(), static_cast<int>(pending.size()));
+
+		Size page = { 0, 0 };
+		std::vector<stbrp_rect> left;
+		for (const stbrp_rect& packed : pending)
+		{
+			if (!packed.was_packed)
+			{
+				left.push_back(packed);
+				continue;
+			}
+
+			Rect& rect	= rects[packed.id];
+			rect.page	= static_cast<uint32_t>(pages.size());
+			rect.x		= (packed.x + 1u) * TEXTURE_ATLAS_GUTTER;
+			rect.y		= (packed.y + 1u) * TEXTURE_ATLAS_GUTTER;
+			rect.width	= sizes[packed.id].width;
+			rect.height	= sizes[packed.id].height;
+
+			uint32_t right	= (packed.x + packed.w) * TEXTURE_ATLAS_GUTTER;
+			uint32_t bottom	= (packed.y + packed.h) * TEXTURE_ATLAS_GUTTER;
+			page.width	= right > page.width ? right : page.width;
+			page.height	= bottom > page.height ? bottom : page.height;
+		}
+
+		/* every image fits an empty page, this would not end otherwise */
+		if (left.size() == pending.size())
+			return false;
+
+		pages.push_back(page);
+		pending.swap(left);
+	}
+
+	return true;
+}
+
+void TextureAtlas::GetUvTransform(const Rect& rect, const Size& page, float scale[2], float offset[2])
+{
+	scale[0]	= static_cast<float>(rect.width) / page.width;
+	scale[1]	= static_cast<float>(rect.height) / page.height;
+	offset[0]	= static_cast<float>(rect.x) / page.width;
+	offset[1]	= static_cast<float>(rect.y) / page.height;
+}
+
+void TextureAtlas::GetPageLevels(const Size& page, uint32_t channels, uint8_t* pixels, MipChain::Level levels[TEXTURE_ATLAS_MIP_COUNT])
+{
+	for (uint32_t level = 0; level < TEXTURE_ATLAS_MIP_COUNT; level++)
+	{
+		levels[level].data		= pixels;
+		levels[level].rowPitch	= size_t(MipChain::GetLevelSize(page.width, level)) * channels;
+		pixels += levels[level].rowPitch * MipChain::GetLevelSize(page.height, level);
+	}
+}
+
+void TextureAtlas::GetImageLevels(const Rect& rect, uint32_t channels, const MipChain::Level pageLevels[TEXTURE_ATLAS_MIP_COUNT],
+								  MipChain::Level imageLevels[TEXTURE_ATLAS_MIP_COUNT])
+{
+	for (uint32_t level = 0; level < TEXTURE_ATLAS_MIP_COUNT; level++)
+	{
+		imageLevels[level].data		= pageLevels[level].data + (rect.y >> level) * pageLevels[level].rowPitch + size_t(rect.x >> level) * channels;
+		imageLevels[level].rowPitch	= pageLevels[level].rowPitch;
+	}
+}
+
+void TextureAtlas::FillGutter(const Rect& rect, uint32_t channels, const MipChain::Level pageLevels[TEXTURE_ATLAS_MIP_COUNT])
+{
+	for (uint32_t level = 0; level < TEXTURE_ATLAS_MIP_COUNT; level++)
+	{
+		const MipChain::Level& page = pageLevels[level];
+
+		uint32_t gutter	= TEXTURE_ATLAS_GUTTER >> level;
+		uint32_t x		= rect.x >> level;
+		uint32_t y		= rect.y >> level;
+		uint32_t width	= rect.width >> level;
+		uint32_t height	= rect.height >> level;
+
+		/* the first and last texels of each row, then the first and last rows with their gutter */
+		for (uint32_t row = y; row < y + height; row++)
+		{
+			uint8_t* first	= page.data + row * page.rowPitch + size_t(x) * channels;
+			uint8_t* last	= first + size_t(width - 1) * channels;
+			for (uint32_t i = 1; i <= gutter; i++)
+			{
+				memcpy(first - size_t(i) * channels, first, channels);
+				memcpy(last + size_t(i) * channels, last, channels);
+			}
+		}
+
+		size_t			rowSize		= size_t(width + 2 * gutter) * channels;
+		const uint8_t*	firstRow	= page.data + y * page.rowPitch + size_t(x - gutter) * channels;
+		const uint8_t*	lastRow		= firstRow + (height - 1) * page.rowPitch;
+		for (uint32_t i = 1; i <= gutter; i++)
+		{
+			memcpy(page.data + (y - i) * page.rowPitch + size_t(x - gutter) * channels, firstRow, rowSize);
+			memcpy(page.data + (y + height - 1 + i) * page.rowPitch + size_t(x - gutter) * channels, lastRow, rowSize);
+		}
+	}
+}
+
+void TextureAtlas::Fill(const Rect& rect, uint32_t channels, const uint8_t* texel, const MipChain::Level pageLevels[TEXTURE_ATLAS_MIP_COUNT])
+{
+	for (uint32_t level = 0; level < TEXTURE_ATLAS_MIP_COUNT; level++)
+	{
+		const MipChain::Level& page = pageLevels[level];
+
+		uint32_t gutter = TEXTURE_ATLAS_GUTTER >> level;
+		for (uint32_t row = (rect.y >> level) - gutter; row < ((rect.y + rect.height) >> level) + gutter; row++)
+		{
+			uint8_t* dst = page.data + row * page.rowPitch + size_t((rect.x >> level) - gutter) * channels;
+			for (uint32_t column = 0; column < (rect.width >> level) + 2 * gutter; column++, dst += channels)
+				memcpy(dst, texel, channels);
+		}
+	}
+}
@@ -0,0 +1,254 @@
+/* system include */
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+
+#include "TextureCache.hpp"
+#include "CacheFile.hpp"
+#include "DDSFile.hpp"
+#include "PixelConvert.hpp"
+
+/* compressed once, the sharper filter is worth its cost there */
+#define TEXTURE_CACHE_MIP_FILTER	MipChain::FILTER_KAISER
+
+/* BC1 would halve the color textures again, at a visible cost on gradients and without alpha levels */
+#define TEXTURE_CACHE_COLOR_FORMAT	BlockCompress::FORMAT_BC7
+
+/*===== DDS =====*/
+
+/* the dds layout, as read by DDSTextureLoader and DDSFile */
+#define DDS_HEADER_FLAGS		(0x1u | 0x2u | 0x4u | 0x1000u | 0x20000u | 0x80000u) /* caps, height, width, pixel format, mip count, linear size */
+#define DDS_PIXEL_FORMAT_FOURCC	0x4u
+#define DDS_CAPS				(0x8u | 0x1000u | 0x400000u) /* complex, texture, mipmap */
+
+/* the values of DXGI_FORMAT, the header is written without the d3d headers */
+#define DDS_DXGI_FORMAT_BC1_UNORM	71u
+#define DDS_DXGI_FORMAT_BC4_UNORM	80u
+#define DDS_DXGI_FORMAT_BC5_UNORM	83u
+#define DDS_DXGI_FORMAT_BC7_UNORM	98u
+
+/* what the cache keeps in the reserved words of the header, the dds readers ignore them */
+struct CacheStamp
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t usage;
+	uint32_t format;
+	uint64_t sourceSize;
+	int64_t	 sourceWriteTime;
+};
+
+/* the whole start of a cached file */
+struct CacheFileHeader
+{
+	uint32_t			magic;
+	DDSFile::Header		header;
+	DDSFile::HeaderDX10	headerDX10;
+};
+
+static_assert(sizeof(CacheFileHeader) == 148, "a dds file with the dx10 header starts with 148 bytes");
+static_assert(sizeof(CacheStamp) <= sizeof(DDSFile::Header::reserved1), "the stamp is kept in the reserved words of the dds header");
+
+static uint32_t GetDXGIFormat(BlockCompress::EFormat format)
+{
+	switch (format)
+	{
+		case BlockCompress::FORMAT_BC1: return DDS_DXGI_FORMAT_BC1_UNORM;
+		case BlockCompress::FORMAT_BC4: return DDS_DXGI_FORMAT_BC4_UNORM;
+		case BlockCompress::FORMAT_BC5: return DDS_DXGI_FORMAT_BC5_UNORM;
+		case BlockCompress::FORMAT_BC7: return DDS_DXGI_FORMAT_BC7_UNORM;
+		default:						return 0;
+	}
+}
+
+/*===== FORMATS =====*/
+
+std::string TextureCache::GetCachePath(const std::string& sourcePath)
+{
+	return sourcePath + TEXTURE_CACHE_EXT;
+}
+
+bool TextureCache::IsCompressible(uint32_t width, uint32_t height)
+{
+	return width > 0 && height > 0 && width % 4 == 0 && height % 4 == 0;
+}
+
+/* channels swapped before compressing, the component mapping of the view puts them back */
+static const uint8_t dataSwizzle[4] = { 1, 2, 0, 3 };
+
+static bool IsDataSwizzled(BlockCompress::EFormat format, MipChain::EUsage usage)
+{
+	return usage == MipChain::USAGE_DATA && format == BlockCompress::FORMAT_BC5;
+}
+
+static void SetComponentMapping(TextureCache::Info& info, MipChain::EUsage usage)
+{
+	const uint8_t identity[4]	= { 0, 1, 2, 3 };
+	const uint8_t grey[4]		= { 0, 0, 0, 5 };
+	const uint8_t normal[4]		= { 0, 1, 4, 5 };
+	const uint8_t data[4]		= { 4, 0, 1, 5 };	/* inverse of dataSwizzle, red is lost */
+
+	const uint8_t* mapping = identity;
+	if (info.format == BlockCompress::FORMAT_BC4)
+		mapping = grey;
+	else if (info.format == BlockCompress::FORMAT_BC5)
+		mapping = IsDataSwizzled(info.format, usage) ? data : normal;
+
+	memcpy(info.componentMapping, mapping, sizeof(info.componentMapping));
+}
+
+static bool IsGrey(const uint8_t* src, size_t srcRowPitch, uint32_t srcChannels, uint32_t width, uint32_t height)
+{
+	if (srcChannels < 3)
+		return true;
+
+	for (uint32_t y = 0; y < height; y++)
+	{
+		const uint8_t* texel = src + y * srcRowPitch;
+		for (uint32_t x = 0; x < width; x++, texel += srcChannels)
+		{
+			if (texel[0] != texel[1] || texel[0] != texel[2])
+				return false;
+		}
+	}
+
+	return true;
+}
+
+static BlockCompress::EFormat SelectFormat(const uint8_t* src, size_t srcRowPitch, uint32_t srcChannels, uint32_t width, uint32_t height, MipChain::EUsage usage)
+{
+	switch (usage)
+	{
+		case MipChain::USAGE_COLOR:		return TEXTURE_CACHE_COLOR_FORMAT;
+		case MipChain::USAGE_NORMAL:	return BlockCompress::FORMAT_BC5;
+		default:						return IsGrey(src, srcRowPitch, srcChannels, width, height) ? BlockCompress::FORMAT_BC4 : BlockCompress::FORMAT_BC5;
+	}
+}
+
+static size_t GetChainSize(uint32_t width, uint32_t height, uint32_t mipCount, BlockCompress::EFormat format)
+{
+	size_t size = 0;
+	for (uint32_t level = 0; level < mipCount; level++)
+		size += BlockCompress::GetLevelSize(MipChain::GetLevelSize(width, level), MipChain::GetLevelSize(height, level), format);
+	return size;
+}
+
+/*===== READ =====*/
+
+bool TextureCache::ReadInfo(const std::string& cachePath, MipChain::EUsage usage, uint64_t sourceSize, int64_t sourceWriteTime, Info& info)
+{
+	FILE* file = fopen(cachePath.c_str(), "rb");
+	if (!file)
+		return false;
+
+	CacheFileHeader fileHeader = {};
+	bool isRead = fread(&fileHeader, sizeof(fileHeader), 1, file) == 1;
+	fclose(file);
+
+	if (!isRead || fileHeader.magic != DDS_MAGIC || fileHeader.header.size != sizeof(DDSFile::Header) ||
+		fileHeader.header.pixelFormat.fourCC != DDS_FOURCC_DX10 || fileHeader.headerDX10.arraySize != 1)
+		return false;
+
+	CacheStamp stamp;
+	memcpy(&stamp, fileHeader.header.reserved1, sizeof(stamp));
+	if (stamp.magic != TEXTURE_CACHE_MAGIC || stamp.version != TEXTURE_CACHE_VERSION || stamp.usage != usage ||
+		stamp.sourceSize != sourceSize || stamp.sourceWriteTime != sourceWriteTime)
+		return false;
+
+	info.width		= fileHeader.header.width;
+	info.height		= fileHeader.header.height;
+	info.mipCount	= fileHeader.header.mipMapCount;
+	info.format		= (BlockCompress::EFormat)stamp.format;
+
+	if (GetDXGIFormat(info.format) == 0 || GetDXGIFormat(info.format) != fileHeader.headerDX10.dxgiFormat ||
+		!IsCompressible(info.width, info.height) || info.mipCount == 0 || info.mipCount > MipChain::GetLevelCount(info.width, info.height))
+		return false;
+
+	/* a truncated file would only fail in the middle of the upload */
+	std::error_code error;
+	uint64_t fileSize = std::filesystem::file_size(cachePath, error);
+	if (error || fileSize != sizeof(CacheFileHeader) + GetChainSize(info.width, info.height, info.mipCount, info.format))
+		return false;
+
+	SetComponentMapping(info, usage);
+	return true;
+}
+
+/*===== WRITE =====*/
+
+bool TextureCache::Write(const std::string& cachePath, const uint8_t* src, size_t srcRowPitch, uint32_t srcChannels, uint32_t width, uint32_t height,
+						 MipChain::EUsage usage, uint64_t sourceSize, int64_t sourceWriteTime, Info& info)
+{
+	if (!IsCompressible(width, height))
+		return false;
+
+	info.width		= width;
+	info.height		= height;
+	info.mipCount	= MipChain::GetLevelCount(width, height);
+	info.format		= SelectFormat(src, srcRowPitch, srcChannels, width, height, usage);
+	SetComponentMapping(info, usage);
+
+	/* the chain is generated in rgba then compressed level by level after the header */
+	std::vector<uint8_t>			chain(MipChain::GetChainSize(width, height, 4, info.mipCount));
+	std::vector<MipChain::Level>	levels(info.mipCount);
+	uint8_t* level = chain.data();
+	for (uint32_t i = 0; i < info.mipCount; i++)
+	{
+		levels[i].data		= level;
+		levels[i].rowPitch	= size_t(MipChain::GetLevelSize(width, i)) * 4;
+		level += levels[i].rowPitch * MipChain::GetLevelSize(height, i);
+	}
+
+	MipChain::Generate(src, srcRowPitch, srcChannels, width, height, 4, usage, TEXTURE_CACHE_MIP_FILTER, levels.data(), info.mipCount);
+
+	std::vector<uint8_t> bytes(sizeof(CacheFileHeader) + GetChainSize(width, height, info.mipCount, info.format));
+
+	CacheFileHeader fileHeader = {};
+	fileHeader.magic								= DDS_MAGIC;
+	fileHeader.header.size							= sizeof(DDSFile::Header);
+	fileHeader.header.flags							= DDS_HEADER_FLAGS;
+	fileHeader.header.height						= height;
+	fileHeader.header.width							= width;
+	fileHeader.header.pitchOrLinearSize				= static_cast<uint32_t>(BlockCompress::GetLevelSize(width, height, info.format));
+	fileHeader.header.mipMapCount					= info.mipCount;
+	fileHeader.header.pixelFormat.size				= sizeof(DDSFile::PixelFormat);
+	fileHeader.header.pixelFormat.flags				= DDS_PIXEL_FORMAT_FOURCC;
+	fileHeader.header.pixelFormat.fourCC			= DDS_FOURCC_DX10;
+	fileHeader.header.caps[0]						= DDS_CAPS;
+	fileHeader.headerDX10.dxgiFormat				= GetDXGIFormat(info.format);
+	fileHeader.headerDX10.resourceDimension			= DDS_DIMENSION_TEXTURE2D;
+	fileHeader.headerDX10.arraySize					= 1;
+
+	CacheStamp stamp = {};
+	stamp.magic				= TEXTURE_CACHE_MAGIC;
+	stamp.version			= TEXTURE_CACHE_VERSION;
+	stamp.usage				= usage;
+	stamp.format			= info.format;
+	stamp.sourceSize		= sourceSize;
+	stamp.sourceWriteTime	= sourceWriteTime;
+	memcpy(fileHeader.header.reserved1, &stamp, sizeof(stamp));
+	memcpy(bytes.data(), &fileHeader, sizeof(fileHeader));
+
+	uint8_t* dst = bytes.data() + sizeof(CacheFileHeader);
+	for (uint32_t i = 0; i < info.mipCount; i++)
+	{
+		uint32_t levelWidth		= MipChain::GetLevelSize(width, i);
+		uint32_t levelHeight	= MipChain::GetLevelSize(height, i);
+
+		if (IsDataSwizzled(info.format, usage))
+			PixelConvert::Swizzle4(levels[i].data, levels[i].data, size_t(levelWidth) * levelHeight, dataSwizzle);
+
+		BlockCompress::Encode(levels[i].data, levels[i].rowPitch, levelWidth, levelHeight, info.format, dst, BlockCompress::GetRowPitch(levelWidth, info.format));
+		dst += BlockCompress::GetLevelSize(levelWidth, levelHeight, info.format);
+	}
+
+	if (!CacheFile::Write(cachePath, bytes.data(), bytes.size()))
+	{
+		printf("Texture cache: failed writing %s\n", cachePath.c_str());
+		return false;
+	}
+
+	return true;
+}
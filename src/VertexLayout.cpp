@@ -0,0 +1,152 @@
+/* system include */
+#include <algorithm>
+#include <cstring>
+
+#include "VertexLayout.hpp"
+#include "PixelConvert.hpp"
+#include "VertexQuantize.hpp"
+
+static const char* attributeNames[VertexLayout::ATTRIBUTE_COUNT]		= { "POSITION", "TEXCOORD_0", "NORMAL", "TANGENT", "COLOR_0", "TEXCOORD_1" };
+static const uint32_t attributeComponents[VertexLayout::ATTRIBUTE_COUNT]	= { 3, 2, 3, 4, 4, 2 };
+static const uint32_t attributeSizes[VertexLayout::ATTRIBUTE_COUNT]			= { VERTEX_QUANTIZE_POSITION_SIZE, VERTEX_QUANTIZE_UV_SIZE, VERTEX_QUANTIZE_NORMAL_SIZE,
+																			VERTEX_QUANTIZE_TANGENT_SIZE, VERTEX_QUANTIZE_COLOR_SIZE, VERTEX_QUANTIZE_HALF_UV_SIZE };
+
+const char* VertexLayout::GetName(EAttribute attribute)
+{
+	return attributeNames[attribute];
+}
+
+uint32_t VertexLayout::GetComponentCount(EAttribute attribute)
+{
+	return attributeComponents[attribute];
+}
+
+uint32_t VertexLayout::GetSize(EAttribute attribute)
+{
+	return attributeSizes[attribute];
+}
+
+VertexLayout::Layout VertexLayout::Build(uint32_t attributes)
+{
+	Layout layout = {};
+	layout.attributes = (attributes | VERTEX_LAYOUT_BIT(ATTRIBUTE_POSITION)) & (VERTEX_LAYOUT_BIT(ATTRIBUTE_COUNT) - 1u);
+
+	uint32_t size = 0;
+	for (uint32_t attribute = 0; attribute < ATTRIBUTE_COUNT; attribute++)
+	{
+		if (!Has(layout, static_cast<EAttribute>(attribute)))
+			continue;
+
+		layout.offsets[attribute]	= size;
+		size						+= attributeSizes[attribute];
+	}
+
+	/* a power of two divides the cache line, the vertices never cross one */
+	layout.stride = 4u;
+	while (layout.stride < size && layout.stride < VERTEX_LAYOUT_CACHE_LINE)
+		layout.stride *= 2u;
+	if (layout.stride < size)
+		layout.stride = (size + 3u) & ~3u;
+
+	return layout;
+}
+
+float VertexLayout::Write(const Layout& layout, EAttribute attribute, const float* values, size_t count, const float* offset, const float* scale,
+						  uint8_t* vertices)
+{
+	if (!Has(layout, attribute))
+		return 0.f;
+
+	uint8_t* dst = vertices + layout.offsets[attribute];
+
+	/* the default of every vertex, quantized once then repeated */
+	if (!values)
+	{
+		static const float defaults[ATTRIBUTE_COUNT][4] = { { 0.f, 0.f, 0.f }, { 0.f, 0.f }, { 0.f, 0.f, 1.f }, { 1.f, 0.f, 0.f, 1.f }, { 1.f, 1.f, 1.f, 1.f }, { 0.f, 0.f } };
+		static const float unitOffset[3]	= { 0.f, 0.f, 0.f };
+		static const float unitScale[3]		= { 1.f, 1.f, 1.f };
+
+		uint8_t element[VERTEX_LAYOUT_CACHE_LINE];
+		Layout	single				= layout;
+		single.stride				= attributeSizes[attribute];
+		single.offsets[attribute]	= 0;
+		Write(single, attribute, defaults[attribute], 1, offset ? offset : unitOffset, scale ? scale : unitScale, element);
+
+		for (size_t i = 0; i < count; i++)
+			memcpy(dst + i * layout.stride, element, attributeSizes[attribute]);
+		return 0.f;
+	}
+
+	switch (attribute)
+	{
+		case ATTRIBUTE_POSITION:
+		{
+			/* w is unused, the whole element is written so that the padding is not left undefined */
+			for (size_t i = 0; i < count; i++)
+				memset(dst + i * layout.stride, 0, VERTEX_QUANTIZE_POSITION_SIZE);
+			return VertexQuantize::QuantizeUnorm16(values, count, 3, offset, scale, dst, layout.stride);
+		}
+		case ATTRIBUTE_TEXCOORD_0:	return VertexQuantize::QuantizeUnorm16(values, count, 2, offset, scale, dst, layout.stride);
+		case ATTRIBUTE_NORMAL:		return VertexQuantize::QuantizeNormals(values, count, dst, layout.stride);
+		case ATTRIBUTE_TANGENT:		return VertexQuantize::QuantizeTangents(values, count, dst, layout.stride);
+		case ATTRIBUTE_COLOR_0:		return VertexQuantize::QuantizeUnorm8(values, count, 4, dst, layout.stride);
+		case ATTRIBUTE_TEXCOORD_1:	return VertexQuantize::QuantizeHalf(values, count, 2, dst, layout.stride);
+		default:					return 0.f;
+	}
+}
+
+void VertexLayout::Read(const Layout& layout, EAttribute attribute, const uint8_t* vertices, size_t count, const float* offset, const float* scale,
+						float* values)
+{
+	if (!Has(layout, attribute))
+		return;
+
+	const uint8_t*	src			= vertices + layout.offsets[attribute];
+	uint32_t		components	= attributeComponents[attribute];
+	for (size_t i = 0; i < count; i++, src += layout.stride)
+	{
+		float* value = values + i * components;
+		switch (attribute)
+		{
+			case ATTRIBUTE_POSITION:
+			case ATTRIBUTE_TEXCOORD_0:
+			{
+				uint16_t unorm[3];
+				memcpy(unorm, src, components * sizeof(uint16_t));
+				for (uint32_t c = 0; c < components; c++)
+					value[c] = (unorm[c] / 65535.f) * scale[c] + offset[c];
+				break;
+			}
+			case ATTRIBUTE_NORMAL:
+			{
+				int16_t octahedral[2];
+				memcpy(octahedral, src, sizeof(octahedral));
+				VertexQuantize::DecodeOctahedral(octahedral, value);
+				break;
+			}
+			case ATTRIBUTE_TANGENT:
+			{
+				int8_t snorm[4];
+				memcpy(snorm, src, sizeof(snorm));
+				for (uint32_t c = 0; c < 4; c++)
+					value[c] = std::max(snorm[c] / 127.f, -1.f);
+				break;
+			}
+			case ATTRIBUTE_COLOR_0:
+			{
+				for (uint32_t c = 0; c < 4; c++)
+					value[c] = src[c] / 255.f;
+				break;
+			}
+			case ATTRIBUTE_TEXCOORD_1:
+			{
+				uint16_t half[2];
+				memcpy(half, src, sizeof(half));
+				PixelConvert::HalfToFloat(half, value, 2);
+				break;
+			}
+			default:
+				break;
+		}
+	}
+}
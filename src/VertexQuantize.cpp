@@ -0,0 +1,213 @@
+/* system include */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "VertexQuantize.hpp"
+#include "PixelConvert.hpp"
+
+/*===== UNORM =====*/
+
+void VertexQuantize::GetRange(const float* values, size_t count, uint32_t components, float* offset, float* scale)
+{
+	for (uint32_t c = 0; c < components; c++)
+	{
+		float minValue = count > 0 ? values[c] : 0.f;
+		float maxValue = minValue;
+		for (size_t i = 1; i < count; i++)
+		{
+			minValue = std::min(minValue, values[i * components + c]);
+			maxValue = std::max(maxValue, values[i * components + c]);
+		}
+
+		offset[c]	= minValue;
+		scale[c]	= maxValue > minValue ? maxValue - minValue : 1.f;
+	}
+}
+
+float VertexQuantize::QuantizeUnorm16(const float* values, size_t count, uint32_t components, const float* offset, const float* scale,
+									  uint8_t* dst, size_t dstStride)
+{
+	float maxError = 0.f;
+	for (size_t i = 0; i < count; i++)
+	{
+		for (uint32_t c = 0; c < components; c++)
+		{
+			float		value		= values[i * components + c];
+			float		normalized	= std::min(std::max((value - offset[c]) / scale[c], 0.f), 1.f);
+			uint16_t	unorm		= static_cast<uint16_t>(normalized * 65535.f + 0.5f);
+			memcpy(dst + i * dstStride + c * sizeof(uint16_t), &unorm, sizeof(uint16_t));
+
+			/* as the input assembler reads it back */
+			float decoded = (unorm / 65535.f) * scale[c] + offset[c];
+			maxError = std::max(maxError, std::fabs(decoded - value));
+		}
+	}
+
+	return maxError;
+}
+
+/*===== OCTAHEDRAL =====*/
+
+static int16_t ToSnorm16(float value)
+{
+	return static_cast<int16_t>(std::lround(std::min(std::max(value, -1.f), 1.f) * 32767.f));
+}
+
+static float FromSnorm16(int16_t value)
+{
+	/* -32768 and -32767 both read as -1 */
+	return std::max(value / 32767.f, -1.f);
+}
+
+void VertexQuantize::DecodeOctahedral(const int16_t octahedral[2], float normal[3])
+{
+	float x = FromSnorm16(octahedral[0]);
+	float y = FromSnorm16(octahedral[1]);
+	float z = 1.f - std::fabs(x) - std::fabs(y);
+
+	/* the lower half is folded over the diagonals */
+	float t = std::max(-z, 0.f);
+	x += x >= 0.f ? -t : t;
+	y += y >= 0.f ? -t : t;
+
+	float length = std::sqrt(x * x + y * y + z * z);
+	normal[0] = x / length;
+	normal[1] = y / length;
+	normal[2] = z / length;
+}
+
+void VertexQuantize::EncodeOctahedral(const float normal[3], int16_t octahedral[2])
+{
+	float sum = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+	if (sum <= 0.f)
+	{
+		octahedral[0] = octahedral[1] = 0;
+		return;
+	}
+
+	float x = normal[0] / sum;
+	float y = normal[1] / sum;
+	if (normal[2] < 0.f)
+	{
+		float foldedX = (1.f - std::fabs(y)) * (x >= 0.f ? 1.f : -1.f);
+		float foldedY = (1.f - std::fabs(x)) * (y >= 0.f ? 1.f : -1.f);
+		x = foldedX;
+		y = foldedY;
+	}
+
+	/* rounding each component on its own is not always the closest direction */
+	float	bestDot		= -2.f;
+	float	baseX		= std::floor(std::min(std::max(x, -1.f), 1.f) * 32767.f);
+	float	baseY		= std::floor(std::min(std::max(y, -1.f), 1.f) * 32767.f);
+	for (int i = 0; i < 4; i++)
+	{
+		int16_t candidate[2] = { ToSnorm16((baseX + (i & 1)) / 32767.f), ToSnorm16((baseY + (i >> 1)) / 32767.f) };
+
+		float decoded[3];
+		DecodeOctahedral(candidate, decoded);
+
+		float dot = decoded[0] * normal[0] + decoded[1] * normal[1] + decoded[2] * normal[2];
+		if (dot > bestDot)
+		{
+			bestDot			= dot;
+			octahedral[0]	= candidate[0];
+			octahedral[1]	= candidate[1];
+		}
+	}
+}
+
+float VertexQuantize::QuantizeNormals(const float* normals, size_t count, uint8_t* dst, size_t dstStride)
+{
+	float minDot = 1.f;
+	for (size_t i = 0; i < count; i++)
+	{
+		float normal[3] = { normals[i * 3 + 0], normals[i * 3 + 1], normals[i * 3 + 2] };
+		float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length > 0.f)
+		{
+			for (int c = 0; c < 3; c++)
+				normal[c] /= length;
+		}
+
+		int16_t octahedral[2];
+		EncodeOctahedral(normal, octahedral);
+		memcpy(dst + i * dstStride, octahedral, sizeof(octahedral));
+
+		if (length > 0.f)
+		{
+			float decoded[3];
+			DecodeOctahedral(octahedral, decoded);
+			minDot = std::min(minDot, decoded[0] * normal[0] + decoded[1] * normal[1] + decoded[2] * normal[2]);
+		}
+	}
+
+	return std::acos(std::min(std::max(minDot, -1.f), 1.f));
+}
+
+float VertexQuantize::QuantizeTangents(const float* tangents, size_t count, uint8_t* dst, size_t dstStride)
+{
+	float minDot = 1.f;
+	for (size_t i = 0; i < count; i++)
+	{
+		const float*	tangent	= tangents + i * 4;
+		float			length	= std::sqrt(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
+
+		int8_t snorm[4];
+		float decoded[3];
+		for (int c = 0; c < 3; c++)
+		{
+			snorm[c]	= static_cast<int8_t>(std::lround(length > 0.f ? std::min(std::max(tangent[c] / length, -1.f), 1.f) * 127.f : 0.f));
+			decoded[c]	= snorm[c] / 127.f;
+		}
+		snorm[3] = tangent[3] < 0.f ? -127 : 127;
+		memcpy(dst + i * dstStride, snorm, sizeof(snorm));
+
+		float decodedLength = std::sqrt(decoded[0] * decoded[0] + decoded[1] * decoded[1] + decoded[2] * decoded[2]);
+		if (length > 0.f && decodedLength > 0.f)
+			minDot = std::min(minDot, (decoded[0] * tangent[0] + decoded[1] * tangent[1] + decoded[2] * tangent[2]) / (length * decodedLength));
+	}
+
+	return std::acos(std::min(std::max(minDot, -1.f), 1.f));
+}
+
+/*===== UNORM8 =====*/
+
+float VertexQuantize::QuantizeUnorm8(const float* values, size_t count, uint32_t components, uint8_t* dst, size_t dstStride)
+{
+	float maxError = 0.f;
+	for (size_t i = 0; i < count; i++)
+	{
+		for (uint32_t c = 0; c < components; c++)
+		{
+			float	value	= values[i * components + c];
+			uint8_t	unorm	= static_cast<uint8_t>(std::min(std::max(value, 0.f), 1.f) * 255.f + 0.5f);
+			dst[i * dstStride + c] = unorm;
+
+			maxError = std::max(maxError, std::fabs(unorm / 255.f - value));
+		}
+	}
+
+	return maxError;
+}
+
+/*===== HALF =====*/
+
+float VertexQuantize::QuantizeHalf(const float* values, size_t count, uint32_t components, uint8_t* dst, size_t dstStride)
+{
+	float maxError = 0.f;
+	for (size_t i = 0; i < count; i++)
+	{
+		const float*	value = values + i * components;
+		uint16_t		half[4];
+		float			decoded[4];
+		PixelConvert::FloatToHalf(value, half, components);
+		PixelConvert::HalfToFloat(half, decoded, components);
+		memcpy(dst + i * dstStride, half, components * sizeof(uint16_t));
+
+		for (uint32_t c = 0; c < components; c++)
+			maxError = std::max(maxError, std::fabs(decoded[c] - value[c]));
+	}
+
+	return maxError;
+}
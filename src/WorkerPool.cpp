@@ -0,0 +1,127 @@
+/* system include */
+#include <atomic>
+#include <memory>
+
+#include "WorkerPool.hpp"
+
+WorkerPool::WorkerPool(unsigned int threadCount)
+{
+	if (threadCount == 0)
+	{
+		unsigned int coreCount = std::thread::hardware_concurrency();
+		threadCount = coreCount > 1 ? coreCount - 1 : 0;
+	}
+
+	workers.reserve(threadCount);
+	for (unsigned int i = 0; i < threadCount; i++)
+		workers.emplace_back(&WorkerPool::WorkerLoop, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(jobsMutex);
+		isStopping = true;
+	}
+	jobsCondition.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+WorkerPool& WorkerPool::Get()
+{
+	static WorkerPool pool;
+	return pool;
+}
+
+void WorkerPool::Submit(std::function<void()> job)
+{
+	/* without workers the job would never run */
+	if (workers.empty())
+	{
+		job();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(jobsMutex);
+		jobs.push_back(std::move(job));
+	}
+	jobsCondition.notify_one();
+}
+
+void WorkerPool::WorkerLoop()
+{
+	for (;;)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(jobsMutex);
+			jobsCondition.wait(lock, [this] { return isStopping || !jobs.empty(); });
+
+			/* the queued jobs are still run when stopping, someone may wait on them */
+			if (jobs.empty())
+				return;
+
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		job();
+	}
+}
+
+/* shared by the caller and the helpers, a helper starting after the end only sees next >= count */
+struct ParallelForState
+{
+	const std::function<void(size_t)>*	task	= nullptr;
+	size_t								count	= 0;
+	std::atomic<size_t>					next	{ 0 };
+	std::atomic<size_t>					done	{ 0 };
+	std::mutex							doneMutex;
+	std::condition_variable				doneCondition;
+};
+
+static void RunParallelFor(ParallelForState& state)
+{
+	size_t finished = 0;
+	for (size_t i = state.next.fetch_add(1); i < state.count; i = state.next.fetch_add(1))
+	{
+		(*state.task)(i);
+		finished++;
+	}
+
+	if (finished > 0 && state.done.fetch_add(finished) + finished == state.count)
+	{
+		std::lock_guard<std::mutex> lock(state.doneMutex);
+		state.doneCondition.notify_all();
+	}
+}
+
+void WorkerPool::ParallelFor(size_t count, const std::function<void(size_t)>& task)
+{
+	if (count == 0)
+		return;
+
+	if (count == 1 || workers.empty())
+	{
+		for (size_t i = 0; i < count; i++)
+			task(i);
+		return;
+	}
+
+	std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+	state->task		= &task;
+	state->count	= count;
+
+	size_t helperCount = count - 1 < workers.size() ? count - 1 : workers.size();
+	for (size_t i = 0; i < helperCount; i++)
+		Submit([state] { RunParallelFor(*state); });
+
+	RunParallelFor(*state);
+
+	/* wait for the indices still running on the helpers, the unstarted helpers will find nothing to do */
+	std::unique_lock<std::mutex> lock(state->doneMutex);
+	state->doneCondition.wait(lock, [&state] { return state->done.load() == state->count; });
+}
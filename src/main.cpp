@@ -1,5 +1,7 @@
 /* system */
 #include <cstdio>
+#include <cstring>
+#include <chrono>
 #include <system_error>
 
 /* GLFW */
@@ -14,9 +16,12 @@
 /* Dx12 */
 #include "DX12Helper.hpp"
 #include "DX12Handle.hpp"
+#include "MeshCache.hpp"
+#include "StartupProfile.hpp"
 
 /* Demo */
 #include "Demo.hpp"
+#include "DemoRegistry.hpp"
 #include "Demo/DemoTriangle.hpp"
 #include "Demo/DemoRayCPUGradiant.hpp"
 #include "Demo/DemoRayCPUSphere.hpp"
@@ -69,40 +74,76 @@ CameraInputs getCameraInputs(bool mouseCaptured, float mouseDX, float mouseDY)
 	return cameraInputs;
 }
 
-int main()
+/* "--bake model.gltf..." fills the mesh and texture caches without opening a window, to ship them with the assets */
+static int BakeAssets(int argc, char** argv)
 {
+	int result = 0;
+	for (int i = 2; i < argc; i++)
+	{
+		MeshCache::CachedModel model;
+		if (MeshCache::Load(argv[i], model))
+			printf("Baked %s\n", argv[i]);
+		else
+			result = 1;
+	}
+
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc > 1 && strcmp(argv[1], "--bake") == 0)
+		return BakeAssets(argc, argv);
+
+	/* "--warm-up" fills the caches of the demos not opened yet in the background, after the first frame */
+	bool isWarmingUp = false;
+	for (int i = 1; i < argc; i++)
+		isWarmingUp |= strcmp(argv[i], "--warm-up") == 0;
+
+	/* time to first frame, includes the window, the device and the first demo loading (see StartupProfile) */
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	bool isFirstFrame = true;
+
 	/*===== Setup GLFW window =====*/
-	glfwSetErrorCallback(glfw_error_callback);
-	if (!glfwInit())
-		return 1;
+	GLFWwindow* window = nullptr;
+	{
+		StartupProfile::Scope scope(StartupProfile::PHASE_WINDOW);
+
+		glfwSetErrorCallback(glfw_error_callback);
+		if (!glfwInit())
+			return 1;
 
-	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-	GLFWwindow* window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "DX12Example", NULL, NULL);
-	glfwSetWindowSizeCallback(window, glfw_WindowSize_callback);
+		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+		window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "DX12Example", NULL, NULL);
+		glfwSetWindowSizeCallback(window, glfw_WindowSize_callback);
+	}
 
 	/*===== Setup Dx12 =====*/
 	DX12Handle dx12handle;
+	ImGuiHandle imGuiHandle;
+	{
+		StartupProfile::Scope scope(StartupProfile::PHASE_DEVICE);
 
-	if (!dx12handle.Init(window, WINDOW_WIDTH, WINDOW_HEIGHT, FRAME_BUFFER_COUNT))
-		return 1;
+		if (!dx12handle.Init(window, WINDOW_WIDTH, WINDOW_HEIGHT, FRAME_BUFFER_COUNT))
+			return 1;
 
-	glfwSetWindowUserPointer(window, &dx12handle);
+		glfwSetWindowUserPointer(window, &dx12handle);
 
-	/*==== Setup ImGui =====*/
-	ImGuiHandle imGuiHandle;
-	if (!imGuiHandle.Init(window, dx12handle))
-		return 1;
+		/*==== Setup ImGui =====*/
+		if (!imGuiHandle.Init(window, dx12handle))
+			return 1;
+	}
 	
-	/* Demo */
+	/* Demo, each one built the first time it is shown */
 	DemoInputs	demoInputs(dx12handle._context);
 	int demoId = 0;
-	std::vector<std::unique_ptr<Demo>> demos;
-	demos.push_back(std::make_unique<DemoTriangle>(demoInputs,dx12handle));
-	demos.push_back(std::make_unique<DemoQuad>(demoInputs, dx12handle));
-	demos.push_back(std::make_unique<DemoModel>(demoInputs, dx12handle));
-	demos.push_back(std::make_unique<DemoScene>(demoInputs, dx12handle));
-	demos.push_back(std::make_unique<DemoRayCPUGradiant>(demoInputs, dx12handle));
-	demos.push_back(std::make_unique<DemoRayCPUSphere>(demoInputs, dx12handle));
+	DemoRegistry demos(demoInputs, dx12handle);
+	demos.Add<DemoTriangle>("Triangle");
+	demos.Add<DemoQuad>("Quad");
+	demos.Add<DemoModel>("Model", DemoModel::WarmUp);
+	demos.Add<DemoScene>("Scene", DemoScene::WarmUp);
+	demos.Add<DemoRayCPUGradiant>("Ray CPU Gradient");
+	demos.Add<DemoRayCPUSphere>("Ray CPU Sphere");
 
 	/* Loop Var */
 	bool		mouseCaptured = false;
@@ -115,10 +156,14 @@ int main()
 		imGuiHandle.NewFrame();
 
 		/* init dx12 and Imgui For Drawing */
-		if (!dx12handle.WaitForPrevFrame() 
-			|| !dx12handle.StartDrawing())
+		if (!dx12handle.WaitForPrevFrame())
 			break;
 
+		/* the demo uploads its resources with the allocator of the frame, before the frame records on it */
+		Demo* demo = demos.Get(demoId);
+
+		if (!dx12handle.StartDrawing())
+			break;
 
 		imGuiHandle.ChooseDemo(demos, demoId);
 
@@ -153,7 +198,7 @@ int main()
 		demoInputs.windowSize = { ImGui::GetIO().DisplaySize.x,ImGui::GetIO().DisplaySize.y };
 		demoInputs.cameraInputs = getCameraInputs(mouseCaptured, mouseDX, mouseDY);
 
-		demos[demoId]->UpdateAndRender(demoInputs);
+		demo->UpdateAndRender(demoInputs);
 
 		imGuiHandle.Render(dx12handle._context);
 
@@ -172,11 +217,20 @@ int main()
 
 		if (!dx12handle.Render())
 			break;
-		
+
+		if (isFirstFrame)
+		{
+			double firstFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+			StartupProfile::Print(firstFrameMs);
+			isFirstFrame = false;
+
+			if (isWarmingUp)
+				demos.WarmUp();
+		}
 	}
 
 	dx12handle.YieldGPU();
-	demos.clear();
+	demos.Clear();
 	imGuiHandle.Terminate();
 
 	glfwDestroyWindow(window);
@@ -0,0 +1,111 @@
+/* system include */
+#include <cmath>
+#include <cstdio>
+
+#include "Test.hpp"
+#include "GPM/Calc.hpp"
+#include "GPM/constants.hpp"
+
+using namespace GPM;
+
+/* samples of each range, evenly spaced */
+#define CALC_SAMPLE_COUNT (1 << 20)
+
+/* max error of a fast approximation against the double precision libm over [min, max],
+ * relative to the expected value when isRelative. Printed, so that the margin to the bound is seen in the log */
+template <typename Fast, typename Reference>
+static double GetMaxError(const char* name, double min, double max, bool isRelative, Fast fast, Reference reference)
+{
+	double maxError		= 0.0;
+	double maxErrorAt	= min;
+	for (int i = 0; i <= CALC_SAMPLE_COUNT; i++)
+	{
+		float	x			= static_cast<float>(min + (max - min) * i / CALC_SAMPLE_COUNT);
+		double	expected	= reference(static_cast<double>(x));
+		double	error		= std::fabs(static_cast<double>(fast(x)) - expected);
+		if (isRelative)
+			error /= std::fabs(expected);
+
+		if (error > maxError)
+		{
+			maxError	= error;
+			maxErrorAt	= x;
+		}
+	}
+
+	printf("  %-24s max %s error %.3e at %g on [%g, %g]\n", name, isRelative ? "rel" : "abs", maxError, maxErrorAt, min, max);
+	return maxError;
+}
+
+int main()
+{
+	Test::Runner runner;
+
+	/* the bounds are the ones documented in Calc.hpp */
+	runner.Run("fastSinCos is within 1e-7 of sin and cos for |x| < 1e4", []()
+	{
+		TEST_CHECK(GetMaxError("fastSinCos (sin)", -1e4, 1e4, false,
+							   [](float x) { float s, c; fastSinCos(x, s, c); return s; }, [](double x) { return std::sin(x); }) < 1e-7);
+		TEST_CHECK(GetMaxError("fastSinCos (cos)", -1e4, 1e4, false,
+							   [](float x) { float s, c; fastSinCos(x, s, c); return c; }, [](double x) { return std::cos(x); }) < 1e-7);
+		TEST_CHECK(GetMaxError("fastSinCos (sin)", -1e5, 1e5, false,
+							   [](float x) { float s, c; fastSinCos(x, s, c); return s; }, [](double x) { return std::sin(x); }) < 1e-6);
+	});
+
+	runner.Run("fastRsqrt is within 1.8e-3 of 1 / sqrt", []()
+	{
+		TEST_CHECK(GetMaxError("fastRsqrt", 1e-6, 1e6, true,
+							   [](float x) { return fastRsqrt(x); }, [](double x) { return 1.0 / std::sqrt(x); }) < 1.8e-3);
+	});
+
+	runner.Run("fastExp2 is within 3e-7 of exp2 on [-126, 127]", []()
+	{
+		TEST_CHECK(GetMaxError("fastExp2", -126.0, 127.0, true,
+							   [](float x) { return fastExp2(x); }, [](double x) { return std::exp2(x); }) < 3e-7);
+	});
+
+	runner.Run("fastLog2 is within 2e-7 of log2", []()
+	{
+		/* absolute around 1 where log2 goes to 0, relative out of it */
+		TEST_CHECK(GetMaxError("fastLog2", 0.5, 2.0, false,
+							   [](float x) { return fastLog2(x); }, [](double x) { return std::log2(x); }) < 2e-7);
+		TEST_CHECK(GetMaxError("fastLog2", 2.0, 1e30, true,
+							   [](float x) { return fastLog2(x); }, [](double x) { return std::log2(x); }) < 2e-7);
+		TEST_CHECK(GetMaxError("fastLog2", 1e-30, 0.5, true,
+							   [](float x) { return fastLog2(x); }, [](double x) { return std::log2(x); }) < 2e-7);
+	});
+
+	runner.Run("fastPow is within 2e-7 * (1 + |y * log2(x)|) of pow", []()
+	{
+		/* |y * log2(x)| stays under 2.2 * 10 on [1e-3, 1] and under 0.45 * 20 on [1, 1e6] */
+		TEST_CHECK(GetMaxError("fastPow (x^2.2)", 1e-3, 1.0, true,
+							   [](float x) { return fastPow(x, 2.2f); }, [](double x) { return std::pow(x, 2.2); }) < 2e-7 * (1.0 + 2.2 * 10.0));
+		TEST_CHECK(GetMaxError("fastPow (x^0.45)", 1.0, 1e6, true,
+							   [](float x) { return fastPow(x, 0.45f); }, [](double x) { return std::pow(x, 0.45); }) < 2e-7 * (1.0 + 0.45 * 20.0));
+	});
+
+	runner.Run("fastAcos is within 5e-7 of acos on [-1, 1]", []()
+	{
+		TEST_CHECK(GetMaxError("fastAcos", -1.0, 1.0, false,
+							   [](float x) { return fastAcos(x); }, [](double x) { return std::acos(x); }) < 5e-7);
+	});
+
+	runner.Run("fastAtan2 is within 4e-7 of atan2", []()
+	{
+		/* around circles of a few radii, the reference takes the same float coordinates */
+		for (float radius : { 1e-3f, 1.f, 1e3f })
+		{
+			TEST_CHECK(GetMaxError("fastAtan2", -PI, PI, false,
+								   [radius](float x) { return fastAtan2(radius * std::sin(x), radius * std::cos(x)); },
+								   [radius](double x)
+								   {
+									   float angle = static_cast<float>(x);
+									   return std::atan2(static_cast<double>(radius * std::sin(angle)), static_cast<double>(radius * std::cos(angle)));
+								   }) < 4e-7);
+		}
+
+		TEST_CHECK(fastAtan2(0.f, 0.f) == 0.f);
+	});
+
+	return runner.Finish();
+}
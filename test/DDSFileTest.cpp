@@ -0,0 +1,303 @@
+/* system include */
+#include <cstring>
+#include <vector>
+
+#include "Test.hpp"
+#include "DDSFile.hpp"
+
+/* the header values the tests write, as the dds writers do */
+#define TEST_DDS_PIXEL_FORMAT_FOURCC	0x4u
+#define TEST_DDS_PIXEL_FORMAT_RGB		0x40u
+#define TEST_DDS_HEADER_FLAGS_VOLUME	0x800000u
+#define TEST_DDS_CAPS2_CUBEMAP			0x200u
+#define TEST_DDS_CAPS2_ALLFACES			0xFC00u
+#define TEST_DDS_MISC_TEXTURECUBE		0x4u
+
+#define TEST_DXGI_R8G8B8A8_UNORM		28u
+#define TEST_DXGI_BC1_UNORM				71u
+#define TEST_DXGI_BC3_UNORM				77u
+
+#define TEST_FOURCC(a, b, c, d) (uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24))
+
+static DDSFile::Header MakeHeader(uint32_t width, uint32_t height, uint32_t mipCount)
+{
+	DDSFile::Header header = {};
+	header.size					= sizeof(DDSFile::Header);
+	header.width				= width;
+	header.height				= height;
+	header.mipMapCount			= mipCount;
+	header.pixelFormat.size		= sizeof(DDSFile::PixelFormat);
+	return header;
+}
+
+static DDSFile::Header MakeFourCCHeader(uint32_t width, uint32_t height, uint32_t mipCount, uint32_t fourCC)
+{
+	DDSFile::Header header = MakeHeader(width, height, mipCount);
+	header.pixelFormat.flags	= TEST_DDS_PIXEL_FORMAT_FOURCC;
+	header.pixelFormat.fourCC	= fourCC;
+	return header;
+}
+
+/* the file of header (and headerDX10 when given), followed by payloadSize bytes counting up */
+static std::vector<uint8_t> MakeFile(const DDSFile::Header& header, const DDSFile::HeaderDX10* headerDX10, size_t payloadSize)
+{
+	uint32_t magic = DDS_MAGIC;
+
+	std::vector<uint8_t> file(sizeof(magic) + sizeof(header) + (headerDX10 ? sizeof(*headerDX10) : 0));
+	memcpy(file.data(), &magic, sizeof(magic));
+	memcpy(file.data() + sizeof(magic), &header, sizeof(header));
+	if (headerDX10)
+		memcpy(file.data() + sizeof(magic) + sizeof(header), headerDX10, sizeof(*headerDX10));
+
+	for (size_t i = 0; i < payloadSize; i++)
+		file.push_back(static_cast<uint8_t>(i * 7 + i / 251));
+
+	return file;
+}
+
+static size_t GetPayloadSize(uint32_t dxgiFormat, uint32_t width, uint32_t height, uint32_t depth, uint32_t mipCount, uint32_t arraySize)
+{
+	size_t size = 0;
+	for (uint32_t mip = 0; mip < mipCount; mip++)
+	{
+		size_t		rowSize;
+		uint32_t	rowCount;
+		DDSFile::GetSurfaceSize(dxgiFormat, width > 1u << mip ? width >> mip : 1, height > 1u << mip ? height >> mip : 1, rowSize, rowCount);
+		size += rowSize * rowCount * (depth > 1u << mip ? depth >> mip : 1);
+	}
+
+	return size * arraySize;
+}
+
+/* the surfaces follow each other from the end of the headers, in the order of D3D12CalcSubresource */
+static void CheckSurfacesPacked(const std::vector<DDSFile::Surface>& surfaces, size_t headerSize, size_t fileSize)
+{
+	size_t offset = headerSize;
+	for (const DDSFile::Surface& surface : surfaces)
+	{
+		TEST_CHECK(surface.offset == offset);
+		offset += surface.rowSize * surface.rowCount * surface.depth;
+	}
+
+	TEST_CHECK(offset == fileSize);
+}
+
+/* the rules of GetCopyableFootprints : placement and pitch alignments, subresources in order without overlap */
+static void CheckFootprints(const std::vector<DDSFile::Surface>& surfaces, const std::vector<DDSFile::Footprint>& footprints, uint64_t totalSize)
+{
+	TEST_CHECK(footprints.size() == surfaces.size());
+
+	uint64_t end = 0;
+	for (size_t i = 0; i < footprints.size() && i < surfaces.size(); i++)
+	{
+		const DDSFile::Footprint& footprint = footprints[i];
+		TEST_CHECK(footprint.offset % DDS_FOOTPRINT_PLACEMENT_ALIGNMENT == 0);
+		TEST_CHECK(footprint.rowPitch % DDS_FOOTPRINT_PITCH_ALIGNMENT == 0);
+		TEST_CHECK(footprint.rowPitch >= surfaces[i].rowSize && footprint.rowPitch < surfaces[i].rowSize + DDS_FOOTPRINT_PITCH_ALIGNMENT);
+		TEST_CHECK(footprint.depth == surfaces[i].depth);
+		TEST_CHECK(footprint.offset >= end);
+
+		end = footprint.offset + uint64_t(footprint.rowPitch) * (uint64_t(surfaces[i].rowCount) * footprint.depth - 1) + surfaces[i].rowSize;
+	}
+
+	TEST_CHECK(totalSize == end);
+}
+
+/* every row of every surface lands at its pitch in the upload buffer, the padding is left alone */
+static void CheckCopy(const std::vector<uint8_t>& file, const std::vector<DDSFile::Surface>& surfaces, const std::vector<DDSFile::Footprint>& footprints,
+					  uint64_t totalSize)
+{
+	const uint8_t padding = 0xCD;
+	std::vector<uint8_t> upload(totalSize, padding);
+	for (size_t i = 0; i < surfaces.size(); i++)
+		DDSFile::CopySurface(file.data(), surfaces[i], footprints[i], upload.data());
+
+	size_t copied = 0;
+	for (size_t i = 0; i < surfaces.size(); i++)
+	{
+		const DDSFile::Surface&		surface		= surfaces[i];
+		const DDSFile::Footprint&	footprint	= footprints[i];
+		for (uint32_t row = 0; row < surface.rowCount * surface.depth; row++)
+		{
+			const uint8_t*	src = file.data() + surface.offset + size_t(row) * surface.rowSize;
+			const uint8_t*	dst = upload.data() + footprint.offset + size_t(row) * footprint.rowPitch;
+			TEST_CHECK(memcmp(src, dst, surface.rowSize) == 0);
+			copied += surface.rowSize;
+		}
+	}
+
+	size_t untouched = 0;
+	for (uint8_t byte : upload)
+		untouched += byte == padding ? 1 : 0;
+
+	/* the payload bytes may equal the padding, so only a lower bound of what was left alone */
+	TEST_CHECK(upload.size() - untouched <= copied);
+}
+
+int main()
+{
+	Test::Runner runner;
+
+	runner.Run("Parse reads a DX10 header array with its mips in subresource order", []()
+	{
+		DDSFile::Header		header		= MakeFourCCHeader(100, 60, 3, DDS_FOURCC_DX10);
+		DDSFile::HeaderDX10	headerDX10	= { TEST_DXGI_R8G8B8A8_UNORM, DDS_DIMENSION_TEXTURE2D, 0, 2, 0 };
+		std::vector<uint8_t> file		= MakeFile(header, &headerDX10, GetPayloadSize(TEST_DXGI_R8G8B8A8_UNORM, 100, 60, 1, 3, 2));
+
+		DDSFile::Desc					desc;
+		std::vector<DDSFile::Surface>	surfaces;
+		if (!TEST_CHECK(DDSFile::Parse(file.data(), file.size(), desc, surfaces)))
+			return;
+
+		TEST_CHECK(desc.dxgiFormat == TEST_DXGI_R8G8B8A8_UNORM && desc.dimension == DDS_DIMENSION_TEXTURE2D);
+		TEST_CHECK(desc.width == 100 && desc.height == 60 && desc.depth == 1);
+		TEST_CHECK(desc.arraySize == 2 && desc.mipCount == 3 && !desc.isCube);
+		TEST_CHECK(surfaces.size() == 6);
+		CheckSurfacesPacked(surfaces, 4 + sizeof(DDSFile::Header) + sizeof(DDSFile::HeaderDX10), file.size());
+
+		/* the mips of the first slice, then the ones of the second */
+		const size_t rowSizes[6]	= { 400, 200, 100, 400, 200, 100 };
+		const uint32_t rowCounts[6]	= { 60, 30, 15, 60, 30, 15 };
+		for (size_t i = 0; i < surfaces.size(); i++)
+			TEST_CHECK(surfaces[i].rowSize == rowSizes[i] && surfaces[i].rowCount == rowCounts[i]);
+
+		std::vector<DDSFile::Footprint> footprints;
+		uint64_t totalSize = DDSFile::GetFootprints(desc, footprints);
+		CheckFootprints(surfaces, footprints, totalSize);
+
+		/* 400 bytes rows are padded to 512, the smaller ones to 256 */
+		TEST_CHECK(footprints[0].rowPitch == 512 && footprints[1].rowPitch == 256 && footprints[2].rowPitch == 256);
+		TEST_CHECK(footprints[0].offset == 0);
+		TEST_CHECK(footprints[1].offset == 30720);	/* 512 * 59 + 400, up to 512 */
+		TEST_CHECK(footprints[3].width == 100 && footprints[3].height == 60);
+
+		CheckCopy(file, surfaces, footprints, totalSize);
+	});
+
+	runner.Run("Parse reads a legacy DXT1 header down to its 1x1 mip", []()
+	{
+		DDSFile::Header			header	= MakeFourCCHeader(256, 128, 9, TEST_FOURCC('D', 'X', 'T', '1'));
+		std::vector<uint8_t>	file	= MakeFile(header, nullptr, GetPayloadSize(TEST_DXGI_BC1_UNORM, 256, 128, 1, 9, 1));
+
+		DDSFile::Desc					desc;
+		std::vector<DDSFile::Surface>	surfaces;
+		if (!TEST_CHECK(DDSFile::Parse(file.data(), file.size(), desc, surfaces)))
+			return;
+
+		TEST_CHECK(desc.dxgiFormat == TEST_DXGI_BC1_UNORM && desc.mipCount == 9 && desc.arraySize == 1);
+		TEST_CHECK(surfaces.size() == 9);
+		CheckSurfacesPacked(surfaces, 4 + sizeof(DDSFile::Header), file.size());
+
+		/* 64 blocks of 8 bytes per row, then the last levels still take a whole block */
+		TEST_CHECK(surfaces[0].rowSize == 512 && surfaces[0].rowCount == 32);
+		TEST_CHECK(surfaces[8].rowSize == 8 && surfaces[8].rowCount == 1);
+
+		std::vector<DDSFile::Footprint> footprints;
+		uint64_t totalSize = DDSFile::GetFootprints(desc, footprints);
+		CheckFootprints(surfaces, footprints, totalSize);
+
+		TEST_CHECK(footprints[0].rowPitch == 512 && footprints[8].rowPitch == 256);
+		TEST_CHECK(footprints[8].width == 4 && footprints[8].height == 4);
+
+		CheckCopy(file, surfaces, footprints, totalSize);
+	});
+
+	runner.Run("Parse reads the cubes of both headers as six slices", []()
+	{
+		/* legacy, every face */
+		DDSFile::Header header = MakeFourCCHeader(64, 64, 2, TEST_FOURCC('D', 'X', 'T', '5'));
+		header.caps[1] = TEST_DDS_CAPS2_CUBEMAP | TEST_DDS_CAPS2_ALLFACES;
+		std::vector<uint8_t> file = MakeFile(header, nullptr, GetPayloadSize(TEST_DXGI_BC3_UNORM, 64, 64, 1, 2, 6));
+
+		DDSFile::Desc					desc;
+		std::vector<DDSFile::Surface>	surfaces;
+		if (TEST_CHECK(DDSFile::Parse(file.data(), file.size(), desc, surfaces)))
+		{
+			TEST_CHECK(desc.isCube && desc.arraySize == 6 && desc.dxgiFormat == TEST_DXGI_BC3_UNORM);
+			TEST_CHECK(surfaces.size() == 12);
+			CheckSurfacesPacked(surfaces, 4 + sizeof(DDSFile::Header), file.size());
+
+			/* face by face, each with its two mips */
+			for (size_t face = 0; face < 6; face++)
+				TEST_CHECK(surfaces[face * 2].rowCount == 16 && surfaces[face * 2 + 1].rowCount == 8);
+
+			std::vector<DDSFile::Footprint> footprints;
+			uint64_t totalSize = DDSFile::GetFootprints(desc, footprints);
+			CheckFootprints(surfaces, footprints, totalSize);
+			CheckCopy(file, surfaces, footprints, totalSize);
+		}
+
+		/* d3d12 has no partial cubes */
+		header.caps[1] = TEST_DDS_CAPS2_CUBEMAP | 0x0400u;
+		file = MakeFile(header, nullptr, GetPayloadSize(TEST_DXGI_BC3_UNORM, 64, 64, 1, 2, 6));
+		TEST_CHECK(!DDSFile::Parse(file.data(), file.size(), desc, surfaces));
+
+		/* DX10, an array of two cubes */
+		DDSFile::Header		headerCube	= MakeFourCCHeader(32, 32, 1, DDS_FOURCC_DX10);
+		DDSFile::HeaderDX10	headerDX10	= { TEST_DXGI_R8G8B8A8_UNORM, DDS_DIMENSION_TEXTURE2D, TEST_DDS_MISC_TEXTURECUBE, 2, 0 };
+		file = MakeFile(headerCube, &headerDX10, GetPayloadSize(TEST_DXGI_R8G8B8A8_UNORM, 32, 32, 1, 1, 12));
+		if (TEST_CHECK(DDSFile::Parse(file.data(), file.size(), desc, surfaces)))
+		{
+			TEST_CHECK(desc.isCube && desc.arraySize == 12 && surfaces.size() == 12);
+			CheckSurfacesPacked(surfaces, 4 + sizeof(DDSFile::Header) + sizeof(DDSFile::HeaderDX10), file.size());
+		}
+	});
+
+	runner.Run("Parse reads a legacy volume with its slices halving", []()
+	{
+		DDSFile::Header header		= MakeHeader(16, 8, 3);
+		header.flags				= TEST_DDS_HEADER_FLAGS_VOLUME;
+		header.depth				= 4;
+		header.pixelFormat.flags	= TEST_DDS_PIXEL_FORMAT_RGB;
+		header.pixelFormat.rgbBitCount = 32;
+		header.pixelFormat.masks[0]	= 0x000000ff;
+		header.pixelFormat.masks[1]	= 0x0000ff00;
+		header.pixelFormat.masks[2]	= 0x00ff0000;
+		header.pixelFormat.masks[3]	= 0xff000000;
+		std::vector<uint8_t> file	= MakeFile(header, nullptr, GetPayloadSize(TEST_DXGI_R8G8B8A8_UNORM, 16, 8, 4, 3, 1));
+
+		DDSFile::Desc					desc;
+		std::vector<DDSFile::Surface>	surfaces;
+		if (!TEST_CHECK(DDSFile::Parse(file.data(), file.size(), desc, surfaces)))
+			return;
+
+		TEST_CHECK(desc.dimension == DDS_DIMENSION_TEXTURE3D && desc.dxgiFormat == TEST_DXGI_R8G8B8A8_UNORM && desc.depth == 4);
+		TEST_CHECK(surfaces.size() == 3 && surfaces[0].depth == 4 && surfaces[1].depth == 2 && surfaces[2].depth == 1);
+		CheckSurfacesPacked(surfaces, 4 + sizeof(DDSFile::Header), file.size());
+
+		std::vector<DDSFile::Footprint> footprints;
+		uint64_t totalSize = DDSFile::GetFootprints(desc, footprints);
+		CheckFootprints(surfaces, footprints, totalSize);
+		CheckCopy(file, surfaces, footprints, totalSize);
+	});
+
+	runner.Run("Parse refuses the invalid files", []()
+	{
+		DDSFile::Header			header	= MakeFourCCHeader(64, 64, 1, TEST_FOURCC('D', 'X', 'T', '1'));
+		std::vector<uint8_t>	file	= MakeFile(header, nullptr, GetPayloadSize(TEST_DXGI_BC1_UNORM, 64, 64, 1, 1, 1));
+
+		DDSFile::Desc					desc;
+		std::vector<DDSFile::Surface>	surfaces;
+		TEST_CHECK(DDSFile::Parse(file.data(), file.size(), desc, surfaces));
+
+		/* truncated in the middle of the texels */
+		TEST_CHECK(!DDSFile::Parse(file.data(), file.size() - 1, desc, surfaces));
+
+		/* more mips than down to 1x1 */
+		DDSFile::Header tooManyMips = MakeFourCCHeader(64, 64, 8, TEST_FOURCC('D', 'X', 'T', '1'));
+		std::vector<uint8_t> mipFile = MakeFile(tooManyMips, nullptr, GetPayloadSize(TEST_DXGI_BC1_UNORM, 64, 64, 1, 8, 1));
+		TEST_CHECK(!DDSFile::Parse(mipFile.data(), mipFile.size(), desc, surfaces));
+
+		/* not a dds */
+		std::vector<uint8_t> badMagic = file;
+		badMagic[0] = 'X';
+		TEST_CHECK(!DDSFile::Parse(badMagic.data(), badMagic.size(), desc, surfaces));
+
+		/* a fourCC nothing reads */
+		DDSFile::Header unknown = MakeFourCCHeader(64, 64, 1, TEST_FOURCC('Z', 'Z', 'Z', 'Z'));
+		std::vector<uint8_t> unknownFile = MakeFile(unknown, nullptr, 4096);
+		TEST_CHECK(!DDSFile::Parse(unknownFile.data(), unknownFile.size(), desc, surfaces));
+	});
+
+	return runner.Finish();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/* The meshes the tests of the mesh modules run on, and how they compare the triangles they give back. */
+namespace Test
+{
+	/* a grid of side x side quads in the xy plane, two triangles per quad facing +z (counter clockwise seen from +z) */
+	struct Grid
+	{
+		std::vector<float>		positions;
+		std::vector<uint32_t>	indices;
+		size_t					vertexCount = 0;
+	};
+
+	/* z bumped by a few waves of height bump, flat when it is 0 */
+	inline Grid MakeGrid(uint32_t side, float bump)
+	{
+		Grid grid;
+		grid.vertexCount = size_t(side + 1) * (side + 1);
+
+		for (uint32_t y = 0; y <= side; y++)
+		{
+			for (uint32_t x = 0; x <= side; x++)
+				grid.positions.insert(grid.positions.end(), { float(x), float(y), bump * std::sin(x * 0.4f) * std::cos(y * 0.3f) });
+		}
+
+		for (uint32_t y = 0; y < side; y++)
+		{
+			for (uint32_t x = 0; x < side; x++)
+			{
+				uint32_t corner = y * (side + 1) + x;
+				grid.indices.insert(grid.indices.end(), { corner, corner + 1, corner + side + 2, corner, corner + side + 2, corner + side + 1 });
+			}
+		}
+
+		return grid;
+	}
+
+	inline const uint8_t* GetPositions(const Grid& grid)
+	{
+		return reinterpret_cast<const uint8_t*>(grid.positions.data());
+	}
+
+	/* the triangles rotated to start at their smallest index then sorted, equal for the same triangles with the same winding */
+	inline std::vector<std::array<uint32_t, 3>> GetTriangleSet(const uint32_t* indices, size_t indexCount)
+	{
+		std::vector<std::array<uint32_t, 3>> triangles(indexCount / 3);
+		for (size_t i = 0; i < triangles.size(); i++)
+		{
+			const uint32_t* triangle	= indices + i * 3;
+			size_t			first		= std::min_element(triangle, triangle + 3) - triangle;
+			triangles[i] = { triangle[first], triangle[(first + 1) % 3], triangle[(first + 2) % 3] };
+		}
+
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+}
@@ -0,0 +1,139 @@
+/* system include */
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include "Test.hpp"
+#include "MeshFixture.hpp"
+#include "MeshOptimizer.hpp"
+
+
+/* the triangles in a random order, their winding kept */
+static void ShuffleTriangles(std::vector<uint32_t>& indices, uint32_t seed)
+{
+	std::vector<std::array<uint32_t, 3>> triangles(indices.size() / 3);
+	for (size_t i = 0; i < triangles.size(); i++)
+		triangles[i] = { indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2] };
+
+	std::shuffle(triangles.begin(), triangles.end(), std::mt19937(seed));
+
+	for (size_t i = 0; i < triangles.size(); i++)
+		std::copy(triangles[i].begin(), triangles[i].end(), indices.begin() + i * 3);
+}
+
+int main()
+{
+	Test::Runner runner;
+
+	runner.Run("OptimizeVertexCache keeps or lowers the ACMR of a grid", []()
+	{
+		for (bool isShuffled : { false, true })
+		{
+			Test::Grid grid = Test::MakeGrid(32, 0.f);
+			if (isShuffled)
+				ShuffleTriangles(grid.indices, 1);
+
+			std::vector<std::array<uint32_t, 3>> triangles = Test::GetTriangleSet(grid.indices.data(), grid.indices.size());
+
+			float before = MeshOptimizer::AnalyzeVertexCache(grid.indices.data(), grid.indices.size(), grid.vertexCount).acmr;
+			MeshOptimizer::OptimizeVertexCache(grid.indices.data(), grid.indices.size(), grid.vertexCount);
+			float after = MeshOptimizer::AnalyzeVertexCache(grid.indices.data(), grid.indices.size(), grid.vertexCount).acmr;
+
+			TEST_CHECK(after <= before);
+			TEST_CHECK(after < 1.f);
+			TEST_CHECK(Test::GetTriangleSet(grid.indices.data(), grid.indices.size()) == triangles);
+		}
+	});
+
+	runner.Run("OptimizeOverdraw only reorders the triangles", []()
+	{
+		Test::Grid grid = Test::MakeGrid(24, 0.1f);
+		ShuffleTriangles(grid.indices, 2);
+
+		std::vector<uint32_t> clusters;
+		MeshOptimizer::OptimizeVertexCache(grid.indices.data(), grid.indices.size(), grid.vertexCount, &clusters);
+		TEST_CHECK(!clusters.empty() && clusters[0] == 0);
+
+		std::vector<std::array<uint32_t, 3>> triangles = Test::GetTriangleSet(grid.indices.data(), grid.indices.size());
+		MeshOptimizer::OptimizeOverdraw(grid.indices.data(), grid.indices.size(), Test::GetPositions(grid), sizeof(float) * 3, grid.vertexCount, clusters);
+
+		TEST_CHECK(Test::GetTriangleSet(grid.indices.data(), grid.indices.size()) == triangles);
+	});
+
+	runner.Run("OptimizeVertexFetch remaps the used vertices to a permutation", []()
+	{
+		Test::Grid grid = Test::MakeGrid(16, 0.f);
+		ShuffleTriangles(grid.indices, 3);
+
+		/* one vertex no triangle uses */
+		size_t vertexCount = grid.vertexCount + 1;
+
+		std::vector<uint32_t> indices = grid.indices;
+		std::vector<uint32_t> remap(vertexCount);
+		size_t usedCount = MeshOptimizer::OptimizeVertexFetch(indices.data(), indices.size(), vertexCount, remap.data());
+
+		TEST_CHECK(usedCount == grid.vertexCount);
+		TEST_CHECK(remap[grid.vertexCount] == ~0u);
+
+		std::vector<uint32_t> used(remap.begin(), remap.begin() + grid.vertexCount);
+		std::sort(used.begin(), used.end());
+		for (uint32_t i = 0; i < used.size(); i++)
+			TEST_CHECK(used[i] == i);
+
+		/* the same triangles through the new numbering, first used first numbered */
+		for (size_t i = 0; i < indices.size(); i++)
+			TEST_CHECK(indices[i] == remap[grid.indices[i]]);
+		TEST_CHECK(indices[0] == 0);
+
+		/* and the vertices moved along draw the same positions */
+		std::vector<float> remapped(usedCount * 3);
+		MeshOptimizer::RemapVertices(Test::GetPositions(grid), sizeof(float) * 3, grid.vertexCount, remap.data(), reinterpret_cast<uint8_t*>(remapped.data()),
+									 sizeof(float) * 3, sizeof(float) * 3);
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			for (size_t c = 0; c < 3; c++)
+				TEST_CHECK(remapped[indices[i] * 3 + c] == grid.positions[grid.indices[i] * 3 + c]);
+		}
+	});
+
+	runner.Run("Simplify approaches its target with a growing error", []()
+	{
+		Test::Grid grid = Test::MakeGrid(32, 0.1f);
+
+		float	previousError		= 0.f;
+		size_t	previousIndexCount	= grid.indices.size();
+		for (size_t divisor : { 2u, 4u, 8u, 16u })
+		{
+			size_t					targetIndexCount = grid.indices.size() / divisor / 3 * 3;
+			std::vector<uint32_t>	simplified(grid.indices.size());
+			float					error = -1.f;
+
+			size_t indexCount = MeshOptimizer::Simplify(simplified.data(), grid.indices.data(), grid.indices.size(), Test::GetPositions(grid), sizeof(float) * 3,
+														grid.vertexCount, targetIndexCount, &error);
+
+			/* the open border of the grid only collapses along itself, the target may not be met exactly */
+			TEST_CHECK(indexCount % 3 == 0);
+			TEST_CHECK(indexCount < previousIndexCount);
+			TEST_CHECK(indexCount <= targetIndexCount + targetIndexCount / 2);
+			TEST_CHECK(error >= previousError);
+
+			for (size_t i = 0; i < indexCount; i++)
+				TEST_CHECK(simplified[i] < grid.vertexCount);
+
+			previousError		= error;
+			previousIndexCount	= indexCount;
+		}
+
+		/* a flat grid simplifies without moving away from its plane */
+		Test::Grid	flat = Test::MakeGrid(16, 0.f);
+		float		flatError = -1.f;
+		std::vector<uint32_t> simplified(flat.indices.size());
+		size_t indexCount = MeshOptimizer::Simplify(simplified.data(), flat.indices.data(), flat.indices.size(), Test::GetPositions(flat), sizeof(float) * 3,
+													flat.vertexCount, flat.indices.size() / 4 / 3 * 3, &flatError);
+		TEST_CHECK(indexCount < flat.indices.size());
+		TEST_CHECK(flatError < 1e-4f);
+	});
+
+	return runner.Finish();
+}
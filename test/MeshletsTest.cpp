@@ -0,0 +1,125 @@
+/* system include */
+#include <vector>
+
+#include "Test.hpp"
+#include "MeshFixture.hpp"
+#include "Meshlets.hpp"
+
+/* a frustum no meshlet of the tests is out of */
+static Meshlets::Frustum MakeInfiniteFrustum()
+{
+	Meshlets::Frustum frustum = {};
+	for (int plane = 0; plane < 6; plane++)
+	{
+		frustum.planes[plane][plane / 2] = plane % 2 == 0 ? 1.f : -1.f;
+		frustum.planes[plane][3] = 1e6f;
+	}
+
+	return frustum;
+}
+
+struct BuiltMeshlets
+{
+	std::vector<Meshlets::Meshlet>	meshlets;
+	std::vector<uint32_t>			vertices;
+	std::vector<uint8_t>			triangles;
+};
+
+static BuiltMeshlets Build(const Test::Grid& grid)
+{
+	BuiltMeshlets built;
+	Meshlets::Build(grid.indices.data(), grid.indices.size(), Test::GetPositions(grid), sizeof(float) * 3, grid.vertexCount,
+					built.meshlets, built.vertices, built.triangles);
+	return built;
+}
+
+int main()
+{
+	Test::Runner runner;
+
+	runner.Run("Build keeps every meshlet within the limits", []()
+	{
+		Test::Grid		grid	= Test::MakeGrid(40, 0.3f);
+		BuiltMeshlets	built	= Build(grid);
+
+		TEST_CHECK(built.meshlets.size() > 1);
+		for (const Meshlets::Meshlet& meshlet : built.meshlets)
+		{
+			TEST_CHECK(meshlet.vertexCount > 0 && meshlet.vertexCount <= MESHLET_MAX_VERTICES);
+			TEST_CHECK(meshlet.triangleCount > 0 && meshlet.triangleCount <= MESHLET_MAX_TRIANGLES);
+			TEST_CHECK(meshlet.vertexOffset + meshlet.vertexCount <= built.vertices.size());
+			TEST_CHECK((size_t(meshlet.triangleOffset) + meshlet.triangleCount) * 3 <= built.triangles.size());
+
+			for (uint32_t i = 0; i < meshlet.triangleCount * 3; i++)
+				TEST_CHECK(built.triangles[size_t(meshlet.triangleOffset) * 3 + i] < meshlet.vertexCount);
+		}
+	});
+
+	runner.Run("Build puts every triangle in exactly one meshlet", []()
+	{
+		Test::Grid		grid	= Test::MakeGrid(40, 0.3f);
+		BuiltMeshlets	built	= Build(grid);
+
+		std::vector<uint32_t> indices;
+		for (const Meshlets::Meshlet& meshlet : built.meshlets)
+		{
+			const uint32_t* vertices	= built.vertices.data() + meshlet.vertexOffset;
+			const uint8_t*	triangles	= built.triangles.data() + size_t(meshlet.triangleOffset) * 3;
+			for (uint32_t i = 0; i < meshlet.triangleCount * 3; i++)
+				indices.push_back(vertices[triangles[i]]);
+		}
+
+		/* the same multiset, so no triangle is lost nor repeated, and the winding is kept */
+		TEST_CHECK(Test::GetTriangleSet(indices.data(), indices.size()) == Test::GetTriangleSet(grid.indices.data(), grid.indices.size()));
+	});
+
+	runner.Run("Cull drops the meshlets facing away and keeps the ones facing the eye", []()
+	{
+		Test::Grid		grid	= Test::MakeGrid(16, 0.f);
+		BuiltMeshlets	built	= Build(grid);
+		TEST_CHECK(!built.meshlets.empty());
+
+		Meshlets::Frustum		frustum = MakeInfiniteFrustum();
+		std::vector<uint32_t>	visible(grid.indices.size());
+		Meshlets::CullStatistics statistics;
+
+		/* in front of the flat grid every meshlet is kept, with all its triangles */
+		const float front[3] = { 8.f, 8.f, 100.f };
+		size_t indexCount = Meshlets::Cull(built.meshlets.data(), built.meshlets.size(), built.vertices.data(), built.triangles.data(), frustum, front,
+										   visible.data(), &statistics);
+		TEST_CHECK(indexCount == grid.indices.size());
+		TEST_CHECK(statistics.visible == built.meshlets.size());
+		TEST_CHECK(statistics.backfaceCulled == 0);
+		TEST_CHECK(statistics.triangles * 3 == grid.indices.size());
+
+		/* behind it every meshlet is culled by its cone */
+		const float back[3] = { 8.f, 8.f, -100.f };
+		indexCount = Meshlets::Cull(built.meshlets.data(), built.meshlets.size(), built.vertices.data(), built.triangles.data(), frustum, back,
+									visible.data(), &statistics);
+		TEST_CHECK(indexCount == 0);
+		TEST_CHECK(statistics.backfaceCulled == built.meshlets.size());
+		TEST_CHECK(statistics.frustumCulled == 0);
+	});
+
+	runner.Run("Cull drops the meshlets out of the frustum", []()
+	{
+		Test::Grid		grid	= Test::MakeGrid(16, 0.f);
+		BuiltMeshlets	built	= Build(grid);
+
+		/* only x < -10 is inside, the grid is in [0, 16] */
+		Meshlets::Frustum frustum = MakeInfiniteFrustum();
+		frustum.planes[0][0] = -1.f;
+		frustum.planes[0][3] = -10.f;
+
+		std::vector<uint32_t>		visible(grid.indices.size());
+		Meshlets::CullStatistics	statistics;
+		const float					eye[3] = { 8.f, 8.f, 100.f };
+
+		size_t indexCount = Meshlets::Cull(built.meshlets.data(), built.meshlets.size(), built.vertices.data(), built.triangles.data(), frustum, eye,
+										   visible.data(), &statistics);
+		TEST_CHECK(indexCount == 0);
+		TEST_CHECK(statistics.frustumCulled == built.meshlets.size());
+	});
+
+	return runner.Finish();
+}
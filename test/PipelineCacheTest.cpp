@@ -0,0 +1,208 @@
+/* system include */
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "Test.hpp"
+#include "PipelineCache.hpp"
+
+/* the file of the tests, removed before each of them */
+#define TEST_CACHE_PATH "PipelineCacheTest" PIPELINE_CACHE_EXT
+
+/* what the mock creates its objects from */
+struct MockDesc
+{
+	std::string name;
+	bool		isFailing = false;
+};
+
+struct MockObject
+{
+	std::string name;
+};
+
+/* a device whose blob of a desc spells its name, keeping what it was given and what it released */
+class MockDevice : public PipelineCache::Device
+{
+public:
+
+	void* Create(const void* desc, const std::vector<uint8_t>& blob, std::vector<uint8_t>& createdBlob) override
+	{
+		const MockDesc* mockDesc = static_cast<const MockDesc*>(desc);
+		createCount++;
+		givenBlobs.push_back(blob);
+
+		if (mockDesc->isFailing)
+			return nullptr;
+
+		createdBlob = GetBlob(mockDesc->name);
+
+		MockObject* object = new MockObject { mockDesc->name };
+		objects.push_back(object);
+		return object;
+	}
+
+	void Release(void* object) override
+	{
+		released.push_back(object);
+		delete static_cast<MockObject*>(object);
+	}
+
+	static std::vector<uint8_t> GetBlob(const std::string& name)
+	{
+		std::string text = "blob of " + name;
+		return std::vector<uint8_t>(text.begin(), text.end());
+	}
+
+	int									createCount = 0;
+	std::vector<std::vector<uint8_t>>	givenBlobs;
+	std::vector<void*>					objects;
+	std::vector<void*>					released;
+};
+
+static void RemoveCacheFile()
+{
+	std::error_code error;
+	std::filesystem::remove(TEST_CACHE_PATH, error);
+}
+
+static uint64_t GetHash(const MockDesc& desc)
+{
+	PipelineCache::Hasher hasher;
+	hasher.AddString(desc.name.c_str());
+	return hasher.Get();
+}
+
+int main()
+{
+	Test::Runner runner;
+
+	runner.Run("Get creates the object of a hash once", []()
+	{
+		MockDevice				device;
+		PipelineCache::Cache	cache(device);
+		MockDesc				desc = { "opaque" };
+
+		void* object = cache.Get(GetHash(desc), &desc);
+		TEST_CHECK(object != nullptr);
+		TEST_CHECK(cache.Get(GetHash(desc), &desc) == object);
+		TEST_CHECK(cache.Get(GetHash(desc), &desc) == object);
+
+		TEST_CHECK(device.createCount == 1);
+		TEST_CHECK(cache.GetCreatedCount() == 1);
+		TEST_CHECK(cache.GetSharedCount() == 2);
+
+		uint64_t hash = 0;
+		TEST_CHECK(cache.GetHash(object, hash) && hash == GetHash(desc));
+		TEST_CHECK(!cache.GetHash(&desc, hash));
+	});
+
+	runner.Run("Get creates a new object for another hash", []()
+	{
+		MockDevice				device;
+		PipelineCache::Cache	cache(device);
+		MockDesc				opaque = { "opaque" };
+		MockDesc				blend = { "blend" };
+
+		TEST_CHECK(GetHash(opaque) != GetHash(blend));
+
+		void* opaqueObject	= cache.Get(GetHash(opaque), &opaque);
+		void* blendObject	= cache.Get(GetHash(blend), &blend);
+		TEST_CHECK(opaqueObject && blendObject && opaqueObject != blendObject);
+		TEST_CHECK(static_cast<MockObject*>(blendObject)->name == "blend");
+		TEST_CHECK(device.createCount == 2);
+		TEST_CHECK(cache.GetSharedCount() == 0);
+
+		/* a failed creation is tried again on the next call */
+		MockDesc failing = { "failing", true };
+		TEST_CHECK(cache.Get(GetHash(failing), &failing) == nullptr);
+		failing.isFailing = false;
+		TEST_CHECK(cache.Get(GetHash(failing), &failing) != nullptr);
+		TEST_CHECK(cache.GetCreatedCount() == 3);
+	});
+
+	runner.Run("The cache releases every object it created once", []()
+	{
+		MockDevice device;
+		{
+			PipelineCache::Cache cache(device);
+			for (const char* name : { "a", "b", "a", "c" })
+			{
+				MockDesc desc = { name };
+				cache.Get(GetHash(desc), &desc);
+			}
+
+			MockDesc failing = { "failing", true };
+			cache.Get(GetHash(failing), &failing);
+			TEST_CHECK(device.released.empty());
+		}
+
+		TEST_CHECK(device.objects.size() == 3);
+		TEST_CHECK(device.released.size() == device.objects.size());
+
+		std::vector<void*> released = device.released;
+		std::sort(released.begin(), released.end());
+		std::sort(device.objects.begin(), device.objects.end());
+		TEST_CHECK(released == device.objects);
+	});
+
+	runner.Run("Read gives back the blobs Write wrote", []()
+	{
+		RemoveCacheFile();
+		MockDesc opaque = { "opaque" };
+		MockDesc blend = { "blend" };
+
+		{
+			MockDevice				device;
+			PipelineCache::Cache	cache(device);
+			TEST_CHECK(!cache.Read(TEST_CACHE_PATH));
+
+			cache.Get(GetHash(opaque), &opaque);
+			cache.Get(GetHash(blend), &blend);
+			TEST_CHECK(device.givenBlobs.size() == 2 && device.givenBlobs[0].empty() && device.givenBlobs[1].empty());
+			TEST_CHECK(cache.Write(TEST_CACHE_PATH));
+		}
+
+		MockDevice				device;
+		PipelineCache::Cache	cache(device);
+		TEST_CHECK(cache.Read(TEST_CACHE_PATH));
+
+		cache.Get(GetHash(blend), &blend);
+		cache.Get(GetHash(opaque), &opaque);
+		TEST_CHECK(device.givenBlobs.size() == 2);
+		TEST_CHECK(device.givenBlobs[0] == MockDevice::GetBlob("blend"));
+		TEST_CHECK(device.givenBlobs[1] == MockDevice::GetBlob("opaque"));
+
+		/* the driver gave the same blobs back, there is nothing to write */
+		std::filesystem::remove(TEST_CACHE_PATH);
+		TEST_CHECK(cache.Write(TEST_CACHE_PATH));
+		TEST_CHECK(!std::filesystem::exists(TEST_CACHE_PATH));
+	});
+
+	runner.Run("Read ignores a truncated file", []()
+	{
+		RemoveCacheFile();
+		MockDesc desc = { "opaque" };
+
+		{
+			MockDevice				device;
+			PipelineCache::Cache	cache(device);
+			cache.Get(GetHash(desc), &desc);
+			TEST_CHECK(cache.Write(TEST_CACHE_PATH));
+		}
+
+		std::filesystem::resize_file(TEST_CACHE_PATH, std::filesystem::file_size(TEST_CACHE_PATH) - 1);
+
+		MockDevice				device;
+		PipelineCache::Cache	cache(device);
+		TEST_CHECK(!cache.Read(TEST_CACHE_PATH));
+
+		cache.Get(GetHash(desc), &desc);
+		TEST_CHECK(device.givenBlobs.size() == 1 && device.givenBlobs[0].empty());
+	});
+
+	RemoveCacheFile();
+	return runner.Finish();
+}
@@ -0,0 +1,213 @@
+/* system include */
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "Test.hpp"
+#include "ShaderCache.hpp"
+
+/* the directory of the tests, emptied before each of them */
+#define TEST_CACHE_DIR "ShaderCacheTest.cache"
+
+/* a compiler whose bytecode spells its inputs, failing on the sources containing "error" */
+class StubCompiler : public ShaderCache::Compiler
+{
+public:
+
+	bool Compile(const std::string& source, const char* entryPoint, const char* target, uint32_t flags,
+				 std::vector<uint8_t>& bytecode, std::string& errors) override
+	{
+		compileCount++;
+
+		if (source.find("error") != std::string::npos)
+		{
+			errors = "stub: error in the source";
+			return false;
+		}
+
+		bytecode = GetBytecode(source, entryPoint, target, flags);
+		return true;
+	}
+
+	static std::vector<uint8_t> GetBytecode(const std::string& source, const char* entryPoint, const char* target, uint32_t flags)
+	{
+		std::string text = source + "|" + entryPoint + "|" + target + "|" + std::to_string(flags);
+		return std::vector<uint8_t>(text.begin(), text.end());
+	}
+
+	int compileCount = 0;
+};
+
+/* the inputs of one shader */
+struct Shader
+{
+	std::string source		= "float4 main() : SV_TARGET { return 1; }";
+	std::string entryPoint	= "main";
+	std::string target		= "ps_5_0";
+	uint32_t	flags		= 0;
+};
+
+static void ClearCache()
+{
+	std::error_code error;
+	std::filesystem::remove_all(TEST_CACHE_DIR, error);
+}
+
+/* compiles shader through the cache, checking the bytecode is the one of its inputs. Returns whether it was a hit */
+static bool Compile(StubCompiler& compiler, const Shader& shader)
+{
+	std::vector<uint8_t>	bytecode;
+	std::string				errors;
+	bool					isHit = false;
+
+	TEST_CHECK(ShaderCache::Compile(compiler, TEST_CACHE_DIR, shader.source, shader.entryPoint.c_str(), shader.target.c_str(), shader.flags,
+									bytecode, errors, &isHit));
+	TEST_CHECK(errors.empty());
+	TEST_CHECK(bytecode == StubCompiler::GetBytecode(shader.source, shader.entryPoint.c_str(), shader.target.c_str(), shader.flags));
+
+	return isHit;
+}
+
+static std::string GetCachePath(const Shader& shader)
+{
+	uint64_t hash = ShaderCache::GetHash(shader.source, shader.entryPoint.c_str(), shader.target.c_str(), shader.flags);
+	return ShaderCache::GetCachePath(TEST_CACHE_DIR, hash);
+}
+
+/* flips the bits of one byte of a file, offset counted from its end when negative */
+static void DamageFile(const std::string& path, long long offset)
+{
+	std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+	file.seekg(offset, offset < 0 ? std::ios::end : std::ios::beg);
+	std::streampos position = file.tellg();
+
+	char byte = 0;
+	file.read(&byte, 1);
+	byte = static_cast<char>(~byte);
+	file.seekp(position);
+	file.write(&byte, 1);
+}
+
+int main()
+{
+	Test::Runner runner;
+
+	runner.Run("Compile misses then hits", []()
+	{
+		ClearCache();
+		StubCompiler	compiler;
+		Shader			shader;
+
+		TEST_CHECK(!Compile(compiler, shader));
+		TEST_CHECK(compiler.compileCount == 1);
+		TEST_CHECK(std::filesystem::exists(GetCachePath(shader)));
+
+		TEST_CHECK(Compile(compiler, shader));
+		TEST_CHECK(Compile(compiler, shader));
+		TEST_CHECK(compiler.compileCount == 1);
+	});
+
+	runner.Run("Compile rebuilds when the source, entry point, target or flags change", []()
+	{
+		ClearCache();
+		StubCompiler	compiler;
+		Shader			shader;
+		TEST_CHECK(!Compile(compiler, shader));
+
+		Shader changed[4]		= { shader, shader, shader, shader };
+		changed[0].source		+= " ";
+		changed[1].entryPoint	= "mainPS";
+		changed[2].target		= "ps_5_1";
+		changed[3].flags		= 1u << 12;
+
+		for (const Shader& other : changed)
+		{
+			int compileCount = compiler.compileCount;
+			TEST_CHECK(GetCachePath(other) != GetCachePath(shader));
+			TEST_CHECK(!Compile(compiler, other));
+			TEST_CHECK(compiler.compileCount == compileCount + 1);
+
+			TEST_CHECK(Compile(compiler, other));
+			TEST_CHECK(compiler.compileCount == compileCount + 1);
+		}
+
+		/* the first one is still there */
+		TEST_CHECK(Compile(compiler, shader));
+		TEST_CHECK(compiler.compileCount == 5);
+
+		/* a character moved from one input to the next is another shader */
+		Shader moved	= shader;
+		moved.entryPoint = "mai";
+		moved.target	= "nps_5_0";
+		TEST_CHECK(GetCachePath(moved) != GetCachePath(shader));
+	});
+
+	runner.Run("Compile rebuilds when the cached file is truncated or damaged", []()
+	{
+		ClearCache();
+		StubCompiler	compiler;
+		Shader			shader;
+		std::string		cachePath = GetCachePath(shader);
+
+		TEST_CHECK(!Compile(compiler, shader));
+		uint64_t fileSize = std::filesystem::file_size(cachePath);
+
+		/* cut in the bytecode, then in the header */
+		for (uint64_t size : { fileSize - 1, uint64_t(8), uint64_t(0) })
+		{
+			int compileCount = compiler.compileCount;
+			std::filesystem::resize_file(cachePath, size);
+
+			TEST_CHECK(!Compile(compiler, shader));
+			TEST_CHECK(compiler.compileCount == compileCount + 1);
+			TEST_CHECK(std::filesystem::file_size(cachePath) == fileSize);
+			TEST_CHECK(Compile(compiler, shader));
+		}
+
+		/* a byte of the magic, then of the bytecode */
+		for (long long offset : { 0ll, -1ll })
+		{
+			int compileCount = compiler.compileCount;
+			DamageFile(cachePath, offset);
+
+			TEST_CHECK(!Compile(compiler, shader));
+			TEST_CHECK(compiler.compileCount == compileCount + 1);
+			TEST_CHECK(Compile(compiler, shader));
+		}
+
+		/* the file of another shader copied over it */
+		Shader other = shader;
+		other.flags = 1;
+		TEST_CHECK(!Compile(compiler, other));
+		std::filesystem::copy_file(GetCachePath(other), cachePath, std::filesystem::copy_options::overwrite_existing);
+
+		int compileCount = compiler.compileCount;
+		TEST_CHECK(!Compile(compiler, shader));
+		TEST_CHECK(compiler.compileCount == compileCount + 1);
+	});
+
+	runner.Run("Compile keeps nothing of a shader that does not compile", []()
+	{
+		ClearCache();
+		StubCompiler	compiler;
+		Shader			shader;
+		shader.source	= "error";
+
+		std::vector<uint8_t>	bytecode;
+		std::string				errors;
+		for (int i = 0; i < 2; i++)
+		{
+			TEST_CHECK(!ShaderCache::Compile(compiler, TEST_CACHE_DIR, shader.source, shader.entryPoint.c_str(), shader.target.c_str(), shader.flags,
+											 bytecode, errors));
+			TEST_CHECK(!errors.empty());
+		}
+
+		TEST_CHECK(compiler.compileCount == 2);
+		TEST_CHECK(!std::filesystem::exists(GetCachePath(shader)));
+	});
+
+	ClearCache();
+	return runner.Finish();
+}
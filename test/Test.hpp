@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdio>
+#include <functional>
+
+/* Minimal test harness : every test is a function checking what it expects with TEST_CHECK.
+ * A failed check prints its file, line and expression and fails its test without stopping it,
+ * the executable returns the number of failed tests so that ctest reports it. */
+namespace Test
+{
+	/* checks failed since the start of the program */
+	inline int& GetFailedChecks()
+	{
+		static int failedChecks = 0;
+		return failedChecks;
+	}
+
+	inline bool Check(bool condition, const char* expression, const char* file, int line)
+	{
+		if (!condition)
+		{
+			printf("%s(%d): check failed: %s\n", file, line, expression);
+			GetFailedChecks()++;
+		}
+
+		return condition;
+	}
+
+	class Runner
+	{
+	public:
+
+		void Run(const char* name, const std::function<void()>& function)
+		{
+			int failedChecks = GetFailedChecks();
+			function();
+
+			bool isPassed = GetFailedChecks() == failedChecks;
+			failedTests += isPassed ? 0 : 1;
+			printf("[%s] %s\n", isPassed ? "PASS" : "FAIL", name);
+		}
+
+		/* the exit code of the test executable */
+		int Finish() const
+		{
+			printf("%d test(s) failed\n", failedTests);
+			return failedTests;
+		}
+
+	private:
+
+		int failedTests = 0;
+	};
+}
+
+/* evaluates to the condition, so that a test can stop on a failed check it depends on */
+#define TEST_CHECK(condition) Test::Check((condition), #condition, __FILE__, __LINE__)